@@ -83,10 +83,23 @@ src/optimize.c \
 src/sequence.c \
 src/range_mapping.c \
 src/string_hash_map.c \
+src/allocator.c \
 src/utils.c \
 src/print_utils.c \
 src/utf8_utils.c \
 src/compute_moved_lines.c \
+src/render_plan.c \
+src/cost_model.c \
+src/inflate.c \
+src/git_object_store.c \
+src/unified_patch.c \
+src/trace.c \
+src/simd_kernels.c \
+src/progress.c \
+src/long_line.c \
+src/line_anchors.c \
+src/binary_content.c \
+src/diff_stat.c \
 vendor/utf8proc.c"
 
 # Build
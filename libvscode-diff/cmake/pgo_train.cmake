@@ -0,0 +1,83 @@
+# Profile-guided optimization training run (cmake -P, see the pgo-train target)
+#
+# Runs the diff CLI built with DIFF_PGO=GENERATE over a corpus that covers
+# the library's hot paths:
+# - scripts/test_pairs, both directions: move detection
+# - library sources with identifiers renamed on many lines: character-level
+#   refinement of small intra-line edits
+# - library sources with comment lines removed and lines inserted:
+#   line-level DP/Myers over many small regions
+#
+# Required: DIFF_EXE, CORPUS_DIR, SOURCE_DIR, WORK_DIR, PROFILE_DIR
+# Optional: LLVM_PROFDATA (Clang: merges the raw profiles for DIFF_PGO=USE)
+
+foreach(var DIFF_EXE CORPUS_DIR SOURCE_DIR WORK_DIR PROFILE_DIR)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "pgo_train.cmake: ${var} is not set")
+    endif()
+endforeach()
+
+# Counters accumulate across runs: start from an empty profile
+file(REMOVE_RECURSE "${PROFILE_DIR}" "${WORK_DIR}")
+file(MAKE_DIRECTORY "${PROFILE_DIR}" "${WORK_DIR}")
+
+set(PAIR_COUNT 0)
+
+function(train original modified)
+    execute_process(
+        COMMAND "${DIFF_EXE}" "${original}" "${modified}"
+        OUTPUT_QUIET
+        RESULT_VARIABLE result
+    )
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "Training run failed (${result}): ${original} ${modified}")
+    endif()
+    math(EXPR count "${PAIR_COUNT} + 1")
+    set(PAIR_COUNT ${count} PARENT_SCOPE)
+endfunction()
+
+# Move detection corpus
+file(GLOB pair_dirs LIST_DIRECTORIES true "${CORPUS_DIR}/*")
+foreach(dir IN LISTS pair_dirs)
+    if(EXISTS "${dir}/original.txt" AND EXISTS "${dir}/modified.txt")
+        train("${dir}/original.txt" "${dir}/modified.txt")
+        train("${dir}/modified.txt" "${dir}/original.txt")
+    endif()
+endforeach()
+
+# Renames spread over a whole file
+file(GLOB sources "${SOURCE_DIR}/src/*.c" "${SOURCE_DIR}/vendor/utf8proc.c")
+list(SORT sources)
+foreach(source IN LISTS sources)
+    get_filename_component(name "${source}" NAME)
+    file(READ "${source}" content)
+    string(REGEX REPLACE "([a-z]+)_count" "\\1_total" content "${content}")
+    string(REPLACE "return NULL;" "return 0;" content "${content}")
+    string(REPLACE "diff_" "df_" content "${content}")
+    file(WRITE "${WORK_DIR}/${name}" "${content}")
+    train("${source}" "${WORK_DIR}/${name}")
+endforeach()
+
+# Inserted and deleted lines: comment lines dropped, a line added before
+# every return
+foreach(source IN LISTS sources)
+    get_filename_component(name "${source}" NAME_WE)
+    file(READ "${source}" content)
+    string(REGEX REPLACE "\n[ ]*//[^\n]*" "" content "${content}")
+    string(REGEX REPLACE "\n([ ]*)return" "\n\\1// exit\n\\1return" content "${content}")
+    file(WRITE "${WORK_DIR}/${name}.lines.c" "${content}")
+    train("${source}" "${WORK_DIR}/${name}.lines.c")
+endforeach()
+
+message(STATUS "PGO training: ${PAIR_COUNT} diffs, profiles in ${PROFILE_DIR}")
+
+if(LLVM_PROFDATA)
+    file(GLOB raw_profiles "${PROFILE_DIR}/*.profraw")
+    execute_process(
+        COMMAND "${LLVM_PROFDATA}" merge -output=${PROFILE_DIR}/diff.profdata ${raw_profiles}
+        RESULT_VARIABLE result
+    )
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "llvm-profdata merge failed")
+    endif()
+endif()
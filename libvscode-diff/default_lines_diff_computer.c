@@ -12,11 +12,17 @@
 // ============================================================================
 
 #include "default_lines_diff_computer.h"
+#include "allocator.h"
+#include "binary_content.h"
+#include "line_anchors.h"
 #include "line_level.h"
 #include "char_level.h"
 #include "range_mapping.h"
+#include "sequence.h"
 #include "compute_moved_lines.h"
+#include "progress.h"
 #include "string_hash_map.h"
+#include "trace.h"
 #include "utils.h"
 #include <stdlib.h>
 #include <string.h>
@@ -46,7 +52,8 @@ static RangeMappingArray* refine_diff(
     Timeout* timeout,
     bool consider_whitespace_changes,
     const DiffOptions* options,
-    bool* hit_timeout
+    bool* hit_timeout,
+    int* degradations
 );
 
 // ============================================================================
@@ -60,7 +67,7 @@ static RangeMappingArray* refine_diff(
  * VSCode Parity: 100%
  */
 static LinesDiff* create_empty_lines_diff(void) {
-    LinesDiff* result = (LinesDiff*)malloc(sizeof(LinesDiff));
+    LinesDiff* result = (LinesDiff*)diff_malloc(sizeof(LinesDiff));
     if (!result) return NULL;
     
     result->changes.mappings = NULL;
@@ -72,6 +79,9 @@ static LinesDiff* create_empty_lines_diff(void) {
     result->moves.capacity = 0;
     
     result->hit_timeout = false;
+    result->degradations = DIFF_DEGRADED_NONE;
+    result->is_binary = false;
+    result->deferred_alignments = NULL;
     
     return result;
 }
@@ -90,13 +100,13 @@ static LinesDiff* create_full_file_diff(
     const char** modified_lines,
     int modified_count
 ) {
-    LinesDiff* result = (LinesDiff*)malloc(sizeof(LinesDiff));
+    LinesDiff* result = (LinesDiff*)diff_malloc(sizeof(LinesDiff));
     if (!result) return NULL;
     
     // Allocate one DetailedLineRangeMapping
-    result->changes.mappings = (DetailedLineRangeMapping*)malloc(sizeof(DetailedLineRangeMapping));
+    result->changes.mappings = (DetailedLineRangeMapping*)diff_malloc(sizeof(DetailedLineRangeMapping));
     if (!result->changes.mappings) {
-        free(result);
+        diff_free(result);
         return NULL;
     }
     result->changes.count = 1;
@@ -109,10 +119,10 @@ static LinesDiff* create_full_file_diff(
     result->changes.mappings[0].modified.end_line = modified_count + 1;
     
     // Create one RangeMapping for the entire content
-    result->changes.mappings[0].inner_changes = (RangeMapping*)malloc(sizeof(RangeMapping));
+    result->changes.mappings[0].inner_changes = (RangeMapping*)diff_malloc(sizeof(RangeMapping));
     if (!result->changes.mappings[0].inner_changes) {
-        free(result->changes.mappings);
-        free(result);
+        diff_free(result->changes.mappings);
+        diff_free(result);
         return NULL;
     }
     result->changes.mappings[0].inner_change_count = 1;
@@ -145,6 +155,9 @@ static LinesDiff* create_full_file_diff(
     result->moves.capacity = 0;
     
     result->hit_timeout = false;
+    result->degradations = DIFF_DEGRADED_NONE;
+    result->is_binary = false;
+    result->deferred_alignments = NULL;
     
     return result;
 }
@@ -166,6 +179,23 @@ static bool arrays_equal(const char** a, int a_len, const char** b, int b_len) {
     return true;
 }
 
+#ifdef USE_OPENMP
+/**
+ * Number of threads for parallel character refinement.
+ * 
+ * options->max_threads if set, otherwise the OpenMP default (which honors
+ * OMP_NUM_THREADS, read once by the runtime) capped at 4. Reads no global
+ * mutable state, so concurrent calls each get their own team size.
+ */
+static int resolve_thread_count(const DiffOptions* options) {
+    if (options->max_threads > 0) {
+        return options->max_threads;
+    }
+    int max_threads = omp_get_max_threads();
+    return max_threads > 4 ? 4 : max_threads;
+}
+#endif
+
 /**
  * Refine a SequenceDiff to character-level RangeMappings.
  * 
@@ -180,6 +210,7 @@ static bool arrays_equal(const char** a, int a_len, const char** b, int b_len) {
  * @param consider_whitespace_changes If true, include whitespace changes
  * @param options Diff options
  * @param hit_timeout Output: set to true if timeout was hit
+ * @param degradations Output: DiffDegradation flags OR-ed in when over the memory budget
  * @return Array of RangeMappings (character-level changes)
  * 
  * VSCode Reference: defaultLinesDiffComputer.ts refineDiff() lines 220-259
@@ -194,13 +225,17 @@ static RangeMappingArray* refine_diff(
     Timeout* timeout,
     bool consider_whitespace_changes,
     const DiffOptions* options,
-    bool* hit_timeout
+    bool* hit_timeout,
+    int* degradations
 ) {
     // Call our existing refine_diff_char_level function
     CharLevelOptions char_opts;
     char_opts.consider_whitespace_changes = consider_whitespace_changes;
     char_opts.extend_to_subwords = options->extend_to_subwords;
     char_opts.timeout_ms = timeout->timeout_ms;
+    char_opts.max_memory_bytes = options->max_memory_bytes;
+    char_opts.out_degradations = degradations;
+    char_opts.strip_affixes = options->strip_char_affixes;
     
     bool local_timeout = false;
     RangeMappingArray* result = refine_diff_char_level(
@@ -218,6 +253,35 @@ static RangeMappingArray* refine_diff(
     return result;
 }
 
+/**
+ * Append every mapping of src to dst, growing dst from initial_capacity.
+ * 
+ * @return false if growing dst failed (dst keeps the mappings that fit)
+ */
+static bool append_range_mappings(
+    RangeMappingArray* dst,
+    const RangeMappingArray* src,
+    int initial_capacity
+) {
+    for (int j = 0; j < src->count; j++) {
+        if (dst->count >= dst->capacity) {
+            size_t new_capacity = (size_t)(dst->capacity == 0 ? initial_capacity : dst->capacity * 2);
+            RangeMapping* new_mappings = (RangeMapping*)diff_realloc_array(
+                dst->mappings,
+                new_capacity,
+                sizeof(RangeMapping)
+            );
+            if (!new_mappings) {
+                return false;
+            }
+            dst->mappings = new_mappings;
+            dst->capacity = (int)new_capacity;
+        }
+        dst->mappings[dst->count++] = src->mappings[j];
+    }
+    return true;
+}
+
 /**
  * Scan equal-length line regions for whitespace-only changes.
  * 
@@ -232,16 +296,20 @@ static RangeMappingArray* refine_diff(
  * @param original_count Number of original lines
  * @param modified_lines Modified file lines
  * @param modified_count Number of modified lines
+ * @param identities Untrimmed line IDs (exact equality without strcmp), or
+ *                   NULL to compare the lines themselves
  * @param consider_whitespace_changes If false, skip scanning
  * @param timeout Timeout for computation
  * @param options Diff options
  * @param alignments Output: accumulate RangeMappings here
  * @param hit_timeout Output: set to true if any refinement times out
+ * @param degradations Output: DiffDegradation flags OR-ed in by refinements
+ * @return false if an allocation failed
  * 
  * VSCode Reference: defaultLinesDiffComputer.ts scanForWhitespaceChanges() lines 100-118
  * VSCode Parity: 100%
  */
-static void scan_for_whitespace_changes(
+static bool scan_for_whitespace_changes(
     int equal_lines_count,
     int seq1_last_start,
     int seq2_last_start,
@@ -249,21 +317,26 @@ static void scan_for_whitespace_changes(
     int original_count,
     const char** modified_lines,
     int modified_count,
+    const LineIdentities* identities,
     bool consider_whitespace_changes,
     Timeout* timeout,
     const DiffOptions* options,
     RangeMappingArray* alignments,
-    bool* hit_timeout
+    bool* hit_timeout,
+    int* degradations
 ) {
     if (!consider_whitespace_changes) {
-        return;
+        return true;
     }
     
     for (int i = 0; i < equal_lines_count; i++) {
         int seq1_offset = seq1_last_start + i;
         int seq2_offset = seq2_last_start + i;
         
-        if (strcmp(original_lines[seq1_offset], modified_lines[seq2_offset]) != 0) {
+        bool differs = identities
+            ? identities->original[seq1_offset] != identities->modified[seq2_offset]
+            : strcmp(original_lines[seq1_offset], modified_lines[seq2_offset]) != 0;
+        if (differs) {
             // This is because of whitespace changes, diff these lines
             SequenceDiff line_diff = {
                 .seq1_start = seq1_offset,
@@ -280,38 +353,22 @@ static void scan_for_whitespace_changes(
                 timeout,
                 consider_whitespace_changes,
                 options,
-                &local_timeout
+                &local_timeout,
+                degradations
             );
             
-            if (character_diffs) {
-                // Add all mappings to alignments array
-                for (int j = 0; j < character_diffs->count; j++) {
-                    // Grow alignments array if needed
-                    if (alignments->count >= alignments->capacity) {
-                        size_t new_capacity = (size_t)(alignments->capacity == 0 ? 8 : alignments->capacity * 2);
-                        RangeMapping* new_mappings = (RangeMapping*)realloc(
-                            alignments->mappings,
-                            new_capacity * sizeof(RangeMapping)
-                        );
-                        if (new_mappings) {
-                            alignments->mappings = new_mappings;
-                            alignments->capacity = (int)new_capacity;
-                        }
-                    }
-                    
-                    if (alignments->count < alignments->capacity) {
-                        alignments->mappings[alignments->count++] = character_diffs->mappings[j];
-                    }
-                }
-                
-                range_mapping_array_free(character_diffs);
-            }
-            
             if (local_timeout) {
                 *hit_timeout = true;
             }
+            if (!character_diffs ||
+                !append_range_mappings(alignments, character_diffs, 8)) {
+                range_mapping_array_free(character_diffs);
+                return false;
+            }
+            range_mapping_array_free(character_diffs);
         }
     }
+    return true;
 }
 
 // ============================================================================
@@ -345,83 +402,179 @@ LinesDiff* compute_diff(
     int modified_count,
     const DiffOptions* options
 ) {
-    // Early exit: 0-1 lines and equal
-    if (original_count <= 1 && arrays_equal(original_lines, original_count, 
-                                            modified_lines, modified_count)) {
-        return create_empty_lines_diff();
+    return compute_diff_ex(original_lines, original_count, modified_lines, modified_count,
+                           options, NULL, NULL);
+}
+
+/**
+ * Diff binary content as changed line blocks between identical chunks, with
+ * no character refinement or move detection.
+ */
+static LinesDiff* create_binary_diff(
+    const char** original_lines,
+    int original_count,
+    const char** modified_lines,
+    int modified_count
+) {
+    SequenceDiffArray* blocks = compute_anchored_line_blocks(original_lines, original_count,
+                                                             modified_lines, modified_count);
+    LinesDiff* result = blocks ? create_empty_lines_diff() : NULL;
+    if (result && blocks->count > 0) {
+        result->changes.mappings = (DetailedLineRangeMapping*)diff_calloc(
+            (size_t)blocks->count, sizeof(DetailedLineRangeMapping));
+        if (!result->changes.mappings) {
+            free_lines_diff(result);
+            result = NULL;
+        } else {
+            for (int i = 0; i < blocks->count; i++) {
+                DetailedLineRangeMapping* m = &result->changes.mappings[i];
+                m->original.start_line = blocks->diffs[i].seq1_start + 1;
+                m->original.end_line = blocks->diffs[i].seq1_end + 1;
+                m->modified.start_line = blocks->diffs[i].seq2_start + 1;
+                m->modified.end_line = blocks->diffs[i].seq2_end + 1;
+            }
+            result->changes.count = blocks->count;
+            result->changes.capacity = blocks->count;
+        }
     }
-    
-    // Early exit: single empty line
-    if ((original_count == 1 && strlen(original_lines[0]) == 0) ||
-        (modified_count == 1 && strlen(modified_lines[0]) == 0)) {
-        return create_full_file_diff(original_lines, original_count,
-                                     modified_lines, modified_count);
+    if (result) {
+        result->is_binary = true;
+    }
+    sequence_diff_array_free(blocks);
+    return result;
+}
+
+/**
+ * Detach and free the progress state at the end of compute_diff_ex().
+ */
+static void end_progress(DiffProgress* progress) {
+    diff_progress_attach(NULL, false);
+    diff_progress_destroy(progress);
+}
+
+/**
+ * Line-level-only result: each alignment becomes its whole-line range
+ * mapping, as if refinement had been skipped for every region.
+ *
+ * Takes ownership of line_alignments, which the result keeps for
+ * refine_lines_diff() (freed here on failure).
+ */
+static LinesDiff* create_line_level_diff(
+    SequenceDiffArray* line_alignments,
+    const char** original_lines,
+    int original_count,
+    const char** modified_lines,
+    int modified_count
+) {
+    RangeMappingArray alignments = {NULL, 0, 0};
+    if (line_alignments->count > 0) {
+        alignments.mappings = (RangeMapping*)diff_malloc_array(
+            (size_t)line_alignments->count, sizeof(RangeMapping));
+        if (!alignments.mappings) {
+            sequence_diff_array_free(line_alignments);
+            return NULL;
+        }
+        alignments.capacity = line_alignments->count;
+    }
+    for (int i = 0; i < line_alignments->count; i++) {
+        alignments.mappings[alignments.count++] = line_diff_to_range_mapping(
+            &line_alignments->diffs[i],
+            original_lines, original_count,
+            modified_lines, modified_count);
     }
     
-    // Setup timeout
-    Timeout timeout;
-    timeout.timeout_ms = options->max_computation_time_ms;
-    timeout.start_time_ms = get_current_time_ms();
-    
-    bool consider_whitespace_changes = !options->ignore_trim_whitespace;
-    
-    // Line-level diff
-    // Use our compute_line_alignments which internally selects DP (<1700 lines) or Myers
-    // VSCode Reference: defaultLinesDiffComputer.ts lines 66-77
-    bool line_hit_timeout = false;
-    SequenceDiffArray* line_alignments = compute_line_alignments(
+    DIFF_TRACE_BEGIN("line_mappings");
+    DetailedLineRangeMappingArray* changes = line_range_mapping_from_range_mappings(
+        &alignments,
         original_lines, original_count,
         modified_lines, modified_count,
-        timeout.timeout_ms,
-        &line_hit_timeout
+        false  // dontAssertStartLine
     );
-    bool hit_timeout = line_hit_timeout;
+    DIFF_TRACE_END("line_mappings");
+    diff_free(alignments.mappings);
     
-    if (!line_alignments) {
+    LinesDiff* result = changes ? create_empty_lines_diff() : NULL;
+    if (!result) {
+        free_detailed_line_range_mapping_array(changes);
+        sequence_diff_array_free(line_alignments);
         return NULL;
     }
-    
-    // Optimize line diffs (already done inside compute_line_diff)
-    // No need to call optimize_sequence_diffs or remove_very_short_matching_lines_between_diffs
+    result->changes = *changes;
+    diff_free(changes);  // Free the container, not the contents
+    result->deferred_alignments = line_alignments;
+    return result;
+}
+
+/**
+ * Refine line alignments into the final result: whitespace scanning and
+ * character refinement per region, line mappings, then move detection.
+ *
+ * @param line_alignments Line-level diffs (not freed)
+ * @param line_identities Untrimmed line IDs, or NULL to compare the lines
+ * @param hit_timeout Whether line alignment already timed out
+ * @param degradations DiffDegradation flags from line alignment
+ * @return LinesDiff (caller must free), or NULL if cancelled or out of memory
+ */
+static LinesDiff* refine_line_alignments(
+    const SequenceDiffArray* line_alignments,
+    const LineIdentities* line_identities,
+    const char** original_lines,
+    int original_count,
+    const char** modified_lines,
+    int modified_count,
+    const DiffOptions* options,
+    Timeout* timeout,
+    DiffProgress* progress,
+    bool hit_timeout,
+    int degradations
+) {
+    bool consider_whitespace_changes = !options->ignore_trim_whitespace;
+#ifndef USE_OPENMP
+    (void)progress;
+#endif
     
     // Initialize character mappings array
-    RangeMappingArray* alignments = (RangeMappingArray*)malloc(sizeof(RangeMappingArray));
+    RangeMappingArray* alignments = (RangeMappingArray*)diff_malloc(sizeof(RangeMappingArray));
     if (!alignments) {
-        sequence_diff_array_free(line_alignments);
         return NULL;
     }
     alignments->mappings = NULL;
     alignments->count = 0;
     alignments->capacity = 0;
     
+    DIFF_TRACE_BEGIN("refine");
+    diff_progress_stage("refine", false);
+    int regions_done = 0;
+    bool out_of_memory = false;
+    
 #ifdef USE_OPENMP
     // Parallel character refinement (OpenMP)
-    // Set default thread count if not explicitly configured by user
-    if (getenv("OMP_NUM_THREADS") == NULL) {
-        int num_procs = omp_get_num_procs();
-        omp_set_num_threads(num_procs > 4 ? 4 : num_procs);
-    }
+    // The team size is passed per call (num_threads clause) rather than set with
+    // omp_set_num_threads(), so concurrent compute_diff() calls don't interfere
+    int num_threads = resolve_thread_count(options);
     
     // Only parallelize if we have enough diffs to justify thread overhead
     const int MIN_DIFFS_FOR_PARALLEL = 1;
-    int use_parallel = line_alignments->count >= MIN_DIFFS_FOR_PARALLEL;
+    int use_parallel = num_threads > 1 && line_alignments->count >= MIN_DIFFS_FOR_PARALLEL;
     
     if (use_parallel) {
         // Pre-allocate thread-local result arrays
         int num_diffs = line_alignments->count;
-        RangeMappingArray** thread_results = (RangeMappingArray**)calloc((size_t)num_diffs, sizeof(RangeMappingArray*));
-        int* thread_equal_lines = (int*)calloc((size_t)num_diffs, sizeof(int));
-        int* thread_seq1_starts = (int*)calloc((size_t)num_diffs, sizeof(int));
-        int* thread_seq2_starts = (int*)calloc((size_t)num_diffs, sizeof(int));
-        int* thread_timeouts = (int*)calloc((size_t)num_diffs, sizeof(int));
+        RangeMappingArray** thread_results = (RangeMappingArray**)diff_calloc((size_t)num_diffs, sizeof(RangeMappingArray*));
+        int* thread_equal_lines = (int*)diff_calloc((size_t)num_diffs, sizeof(int));
+        int* thread_seq1_starts = (int*)diff_calloc((size_t)num_diffs, sizeof(int));
+        int* thread_seq2_starts = (int*)diff_calloc((size_t)num_diffs, sizeof(int));
+        int* thread_timeouts = (int*)diff_calloc((size_t)num_diffs, sizeof(int));
+        int* thread_degradations = (int*)diff_calloc((size_t)num_diffs, sizeof(int));
         
         if (!thread_results || !thread_equal_lines || !thread_seq1_starts || 
-            !thread_seq2_starts || !thread_timeouts) {
-            free(thread_results);
-            free(thread_equal_lines);
-            free(thread_seq1_starts);
-            free(thread_seq2_starts);
-            free(thread_timeouts);
+            !thread_seq2_starts || !thread_timeouts || !thread_degradations) {
+            diff_free(thread_results);
+            diff_free(thread_equal_lines);
+            diff_free(thread_seq1_starts);
+            diff_free(thread_seq2_starts);
+            diff_free(thread_timeouts);
+            diff_free(thread_degradations);
             use_parallel = 0; // Fallback to sequential
         } else {
             // Precompute position data (sequential, fast)
@@ -443,56 +596,85 @@ LinesDiff* compute_diff(
             #pragma warning(disable: 4101) // unreferenced local variable (false positive with OpenMP)
 #endif
             int diff_idx;
-            #pragma omp parallel for schedule(dynamic, 1) shared(thread_results, thread_timeouts) private(diff_idx)
+            #pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads) shared(thread_results, thread_timeouts, thread_degradations, out_of_memory) private(diff_idx)
             for (diff_idx = 0; diff_idx < num_diffs; diff_idx++) {
                 const SequenceDiff* diff = &line_alignments->diffs[diff_idx];
+                // Workers see the progress state only to poll for cancellation;
+                // thread 0 is the calling thread and stays the reporter
+                bool is_worker = omp_get_thread_num() != 0;
+                if (is_worker) diff_progress_attach(progress, false);
+                if (diff_progress_cancelled()) {
+                    if (is_worker) diff_progress_attach(NULL, false);
+                    continue;
+                }
+                DIFF_TRACE_BEGIN_ARG("refine_task", diff_idx);
                 
                 // Thread-local timeout flags
                 bool ws_timeout = false;
                 bool char_timeout = false;
                 
                 // Thread-local whitespace change scanning
-                RangeMappingArray* ws_changes = (RangeMappingArray*)malloc(sizeof(RangeMappingArray));
-                ws_changes->mappings = NULL;
-                ws_changes->count = 0;
-                ws_changes->capacity = 0;
+                bool task_ok = true;
+                RangeMappingArray* ws_changes = (RangeMappingArray*)diff_malloc(sizeof(RangeMappingArray));
+                if (ws_changes) {
+                    ws_changes->mappings = NULL;
+                    ws_changes->count = 0;
+                    ws_changes->capacity = 0;
+                } else {
+                    task_ok = false;
+                }
                 
-                scan_for_whitespace_changes(
+                task_ok = task_ok && scan_for_whitespace_changes(
                     thread_equal_lines[diff_idx],
                     thread_seq1_starts[diff_idx],
                     thread_seq2_starts[diff_idx],
                     original_lines, original_count,
                     modified_lines, modified_count,
+                    line_identities,
                     consider_whitespace_changes,
-                    &timeout,
+                    timeout,
                     options,
                     ws_changes,
-                    &ws_timeout
+                    &ws_timeout,
+                    &thread_degradations[diff_idx]
                 );
                 
                 // Thread-local character diff refinement
-                RangeMappingArray* character_diffs = refine_diff(
+                RangeMappingArray* character_diffs = !task_ok ? NULL : refine_diff(
                     diff,
                     original_lines, original_count,
                     modified_lines, modified_count,
-                    &timeout,
+                    timeout,
                     consider_whitespace_changes,
                     options,
-                    &char_timeout
+                    &char_timeout,
+                    &thread_degradations[diff_idx]
                 );
                 
                 // Store timeout flags - no race condition since each thread writes to its own index
                 if (ws_timeout || char_timeout) {
                     thread_timeouts[diff_idx] = 1;
                 }
+                task_ok = task_ok && character_diffs != NULL;
                 
                 // Merge ws_changes and character_diffs into thread_results[diff_idx]
                 int total_count = (ws_changes ? ws_changes->count : 0) + 
                                  (character_diffs ? character_diffs->count : 0);
                 
-                if (total_count > 0) {
-                    RangeMappingArray* combined = (RangeMappingArray*)malloc(sizeof(RangeMappingArray));
-                    combined->mappings = (RangeMapping*)malloc((size_t)total_count * sizeof(RangeMapping));
+                RangeMappingArray* combined = NULL;
+                RangeMapping* combined_mappings = NULL;
+                if (task_ok && total_count > 0) {
+                    combined = (RangeMappingArray*)diff_malloc(sizeof(RangeMappingArray));
+                    combined_mappings = (RangeMapping*)diff_malloc_array((size_t)total_count, sizeof(RangeMapping));
+                    if (!combined || !combined_mappings) {
+                        diff_free(combined);
+                        diff_free(combined_mappings);
+                        combined = NULL;
+                        task_ok = false;
+                    }
+                }
+                if (combined) {
+                    combined->mappings = combined_mappings;
                     combined->count = 0;
                     combined->capacity = total_count;
                     
@@ -513,17 +695,31 @@ LinesDiff* compute_diff(
                 
                 if (ws_changes) range_mapping_array_free(ws_changes);
                 if (character_diffs) range_mapping_array_free(character_diffs);
+                if (!task_ok) {
+                    #pragma omp critical(diff_out_of_memory)
+                    out_of_memory = true;
+                }
+                DIFF_TRACE_END_ARG("refine_task", diff_idx);
+                
+                int done;
+                #pragma omp critical(diff_progress_regions) // OpenMP 2.0: no atomic capture
+                done = ++regions_done;
+                if (is_worker) {
+                    diff_progress_attach(NULL, false);
+                } else {
+                    diff_progress_update((double)done / num_diffs);
+                }
             }
 #ifdef _MSC_VER
             #pragma warning(pop)
 #endif
             
-            // Check timeout flags
+            // Check timeout and degradation flags
             for (int i = 0; i < num_diffs; i++) {
                 if (thread_timeouts[i]) {
                     hit_timeout = true;
-                    break;
                 }
+                degradations |= thread_degradations[i];
             }
             
             // Optimized merge: calculate total size and do single allocation + batch copy
@@ -534,9 +730,11 @@ LinesDiff* compute_diff(
                 }
             }
             
-            if (total_size > 0) {
-                alignments->mappings = (RangeMapping*)malloc((size_t)total_size * sizeof(RangeMapping));
-                if (alignments->mappings) {
+            if (total_size > 0 && !out_of_memory) {
+                alignments->mappings = (RangeMapping*)diff_malloc_array((size_t)total_size, sizeof(RangeMapping));
+                if (!alignments->mappings) {
+                    out_of_memory = true;
+                } else {
                     alignments->capacity = total_size;
                     int offset = 0;
                     for (int i = 0; i < num_diffs; i++) {
@@ -558,11 +756,12 @@ LinesDiff* compute_diff(
                 }
             }
             
-            free(thread_results);
-            free(thread_equal_lines);
-            free(thread_seq1_starts);
-            free(thread_seq2_starts);
-            free(thread_timeouts);
+            diff_free(thread_results);
+            diff_free(thread_equal_lines);
+            diff_free(thread_seq1_starts);
+            diff_free(thread_seq2_starts);
+            diff_free(thread_timeouts);
+            diff_free(thread_degradations);
         }
     }
     
@@ -576,21 +775,27 @@ LinesDiff* compute_diff(
         
         for (int diff_idx = 0; diff_idx < line_alignments->count; diff_idx++) {
             const SequenceDiff* diff = &line_alignments->diffs[diff_idx];
+            if (diff_progress_cancelled() || out_of_memory) {
+                break;
+            }
+            DIFF_TRACE_BEGIN_ARG("refine_task", diff_idx);
             
             int equal_lines_count = diff->seq1_start - seq1_last_start;
             
             // Scan equal lines for whitespace changes
-            scan_for_whitespace_changes(
+            out_of_memory = !scan_for_whitespace_changes(
                 equal_lines_count,
                 seq1_last_start,
                 seq2_last_start,
                 original_lines, original_count,
                 modified_lines, modified_count,
+                line_identities,
                 consider_whitespace_changes,
-                &timeout,
+                timeout,
                 options,
                 alignments,
-                &hit_timeout
+                &hit_timeout,
+                &degradations
             );
             
             seq1_last_start = diff->seq1_end;
@@ -602,38 +807,24 @@ LinesDiff* compute_diff(
                 diff,
                 original_lines, original_count,
                 modified_lines, modified_count,
-                &timeout,
+                timeout,
                 consider_whitespace_changes,
                 options,
-                &local_timeout
+                &local_timeout,
+                &degradations
             );
             
             if (local_timeout) {
                 hit_timeout = true;
             }
             
-            if (character_diffs) {
-                // Add all character mappings
-                for (int j = 0; j < character_diffs->count; j++) {
-                    if (alignments->count >= alignments->capacity) {
-                        size_t new_capacity = (size_t)(alignments->capacity == 0 ? 16 : alignments->capacity * 2);
-                        RangeMapping* new_mappings = (RangeMapping*)realloc(
-                            alignments->mappings,
-                            new_capacity * sizeof(RangeMapping)
-                        );
-                        if (new_mappings) {
-                            alignments->mappings = new_mappings;
-                            alignments->capacity = (int)new_capacity;
-                        }
-                    }
-                    
-                    if (alignments->count < alignments->capacity) {
-                        alignments->mappings[alignments->count++] = character_diffs->mappings[j];
-                    }
-                }
-                
-                range_mapping_array_free(character_diffs);
+            // Add all character mappings
+            if (!character_diffs || !append_range_mappings(alignments, character_diffs, 16)) {
+                out_of_memory = true;
             }
+            range_mapping_array_free(character_diffs);
+            DIFF_TRACE_END_ARG("refine_task", diff_idx);
+            diff_progress_update((double)++regions_done / line_alignments->count);
         }
     }
     
@@ -646,90 +837,274 @@ LinesDiff* compute_diff(
     }
     
     int remaining = original_count - seq1_final;
-    scan_for_whitespace_changes(
+    out_of_memory = out_of_memory || !scan_for_whitespace_changes(
         remaining,
         seq1_final,
         seq2_final,
         original_lines, original_count,
         modified_lines, modified_count,
+        line_identities,
         consider_whitespace_changes,
-        &timeout,
+        timeout,
         options,
         alignments,
-        &hit_timeout
+        &hit_timeout,
+        &degradations
     );
+    DIFF_TRACE_END("refine");
+    // Workers finish regions without reporting; close the stage from here
+    diff_progress_update(1.0);
+    
+    if (diff_progress_cancelled() || out_of_memory) {
+        range_mapping_array_free(alignments);
+        return NULL;
+    }
     
     // Convert to line mappings
+    DIFF_TRACE_BEGIN("line_mappings");
     DetailedLineRangeMappingArray* changes = line_range_mapping_from_range_mappings(
         alignments,
         original_lines, original_count,
         modified_lines, modified_count,
         false  // dontAssertStartLine
     );
+    DIFF_TRACE_END("line_mappings");
+    if (!changes) {
+        range_mapping_array_free(alignments);
+        return NULL;
+    }
     
     // Compute moves if requested
     MovedTextArray computed_moves = { NULL, 0, 0 };
-    if (options->compute_moves && changes && changes->count > 0) {
+    bool moves_fit_budget = true;
+    if (options->compute_moves && changes->count > 0 &&
+        options->max_memory_bytes > 0 &&
+        compute_moved_lines_memory_bytes(changes->mappings, changes->count) > options->max_memory_bytes) {
+        // Similarity histograms over budget: skip move detection
+        moves_fit_budget = false;
+        degradations |= DIFF_DEGRADED_NO_MOVES;
+    }
+    if (options->compute_moves && moves_fit_budget && changes->count > 0) {
+        DIFF_TRACE_BEGIN("moves");
+        diff_progress_stage("moves", true);
         // Recompute line hashes (same algorithm as LineSequence: trimmed perfect hash)
         StringHashMap *move_hash_map = string_hash_map_create();
-        uint32_t *hashed_orig = (uint32_t *)malloc((size_t)original_count * sizeof(uint32_t));
-        uint32_t *hashed_mod = (uint32_t *)malloc((size_t)modified_count * sizeof(uint32_t));
+        uint32_t *hashed_orig = (uint32_t *)diff_malloc_array((size_t)(original_count > 0 ? original_count : 1), sizeof(uint32_t));
+        uint32_t *hashed_mod = (uint32_t *)diff_malloc_array((size_t)(modified_count > 0 ? modified_count : 1), sizeof(uint32_t));
+        out_of_memory = !move_hash_map || !hashed_orig || !hashed_mod;
 
-        for (int i = 0; i < original_count; i++) {
+        for (int i = 0; i < original_count && !out_of_memory; i++) {
             char *trimmed = trim_string(original_lines[i]);
-            hashed_orig[i] = string_hash_map_get_or_create(move_hash_map, trimmed);
-            free(trimmed);
+            hashed_orig[i] = trimmed ? string_hash_map_get_or_create(move_hash_map, trimmed)
+                                     : STRING_HASH_MAP_NO_MEMORY;
+            out_of_memory = hashed_orig[i] == STRING_HASH_MAP_NO_MEMORY;
+            diff_free(trimmed);
         }
-        for (int i = 0; i < modified_count; i++) {
+        for (int i = 0; i < modified_count && !out_of_memory; i++) {
             char *trimmed = trim_string(modified_lines[i]);
-            hashed_mod[i] = string_hash_map_get_or_create(move_hash_map, trimmed);
-            free(trimmed);
+            hashed_mod[i] = trimmed ? string_hash_map_get_or_create(move_hash_map, trimmed)
+                                    : STRING_HASH_MAP_NO_MEMORY;
+            out_of_memory = hashed_mod[i] == STRING_HASH_MAP_NO_MEMORY;
+            diff_free(trimmed);
         }
 
-        compute_moved_lines(
+        out_of_memory = out_of_memory || !compute_moved_lines(
             changes->mappings, changes->count,
             original_lines, original_count,
             modified_lines, modified_count,
             hashed_orig, hashed_mod,
-            timeout.timeout_ms,
+            timeout->timeout_ms,
             &computed_moves);
 
-        free(hashed_orig);
-        free(hashed_mod);
+        diff_free(hashed_orig);
+        diff_free(hashed_mod);
         string_hash_map_destroy(move_hash_map);
+        DIFF_TRACE_END("moves");
     }
     
-    // Create LinesDiff result
-    LinesDiff* result = (LinesDiff*)malloc(sizeof(LinesDiff));
+    // Create LinesDiff result (dropped if cancelled or out of memory during move detection)
+    LinesDiff* result = diff_progress_cancelled() || out_of_memory
+                            ? NULL : (LinesDiff*)diff_malloc(sizeof(LinesDiff));
     if (!result) {
         free_detailed_line_range_mapping_array(changes);
+        diff_free(computed_moves.moves);
         range_mapping_array_free(alignments);
-        sequence_diff_array_free(line_alignments);
         return NULL;
     }
     
     // Transfer changes
-    if (changes) {
-        result->changes = *changes;
-        free(changes);  // Free the container, not the contents
-    } else {
-        result->changes.mappings = NULL;
-        result->changes.count = 0;
-        result->changes.capacity = 0;
-    }
+    result->changes = *changes;
+    diff_free(changes);  // Free the container, not the contents
     
     // Transfer moves
     result->moves = computed_moves;
     
     result->hit_timeout = hit_timeout;
+    result->degradations = degradations;
+    result->is_binary = false;
+    result->deferred_alignments = NULL;
     
-    // Cleanup
     range_mapping_array_free(alignments);
+    return result;
+}
+
+/**
+ * Compute diff with progress reporting - see compute_diff().
+ *
+ * Cancellation is checked after each stage; a cancelled diff frees what it
+ * has built so far and returns NULL.
+ */
+LinesDiff* compute_diff_ex(
+    const char** original_lines,
+    int original_count,
+    const char** modified_lines,
+    int modified_count,
+    const DiffOptions* options,
+    DiffProgressCallback progress_callback,
+    void* user_data
+) {
+    // Positions are int inside the engines: inputs too large to align
+    // become one whole-file change
+    if ((int64_t)original_count + modified_count > SEQUENCE_MAX_COMBINED_LENGTH) {
+        LinesDiff* result = create_full_file_diff(original_lines, original_count,
+                                                  modified_lines, modified_count);
+        if (result) {
+            result->degradations = DIFF_DEGRADED_WHOLE_FILE;
+        }
+        return result;
+    }
+    
+    // Binary content: only which blocks changed is meaningful
+    if (diff_lines_look_binary(original_lines, original_count) ||
+        diff_lines_look_binary(modified_lines, modified_count)) {
+        return create_binary_diff(original_lines, original_count,
+                                  modified_lines, modified_count);
+    }
+    
+    // Early exit: 0-1 lines and equal
+    if (original_count <= 1 && arrays_equal(original_lines, original_count, 
+                                            modified_lines, modified_count)) {
+        return create_empty_lines_diff();
+    }
+    
+    // Early exit: single empty line
+    if ((original_count == 1 && strlen(original_lines[0]) == 0) ||
+        (modified_count == 1 && strlen(modified_lines[0]) == 0)) {
+        return create_full_file_diff(original_lines, original_count,
+                                     modified_lines, modified_count);
+    }
+    
+    DIFF_TRACE_BEGIN("compute_diff");
+
+    // Progress is reported from this thread only (see progress.h)
+    DiffProgress* progress = diff_progress_create(progress_callback, user_data);
+    diff_progress_attach(progress, true);
+
+    // Setup timeout
+    Timeout timeout;
+    timeout.timeout_ms = options->max_computation_time_ms;
+    timeout.start_time_ms = get_current_time_ms();
+    
+    // Line-level diff
+    // Use our compute_line_alignments which internally selects DP (<1700 lines) or Myers
+    // VSCode Reference: defaultLinesDiffComputer.ts lines 66-77
+    bool line_hit_timeout = false;
+    int degradations = DIFF_DEGRADED_NONE;
+    LineIdentities line_identities = {NULL, NULL};
+    DIFF_TRACE_BEGIN("line_alignments");
+    diff_progress_stage("line_alignments", true);
+    // Optional pre-stage: anchor identical chunks, align only the spans between
+    SequenceDiffArray* line_alignments = (options->chunk_anchors
+                                              ? compute_anchored_line_alignments
+                                              : compute_line_alignments)(
+        original_lines, original_count,
+        modified_lines, modified_count,
+        timeout.timeout_ms,
+        &line_hit_timeout,
+        &line_identities,
+        options->max_memory_bytes,
+        &degradations
+    );
+    DIFF_TRACE_END("line_alignments");
+    bool hit_timeout = line_hit_timeout;
+    
+    if (!line_alignments || diff_progress_cancelled()) {
+        if (line_alignments) sequence_diff_array_free(line_alignments);
+        line_identities_free(&line_identities);
+        end_progress(progress);
+        DIFF_TRACE_END("compute_diff");
+        return NULL;
+    }
+    
+    // Line-level-only mode: the alignments wait in the result for refine_lines_diff()
+    if (options->line_level_only) {
+        line_identities_free(&line_identities);
+        LinesDiff* result = create_line_level_diff(line_alignments,
+                                                   original_lines, original_count,
+                                                   modified_lines, modified_count);
+        if (result) {
+            result->hit_timeout = hit_timeout;
+            result->degradations = degradations;
+            diff_progress_finish();
+        }
+        end_progress(progress);
+        DIFF_TRACE_END("compute_diff");
+        return result;
+    }
+    
+    LinesDiff* result = refine_line_alignments(line_alignments, &line_identities,
+                                               original_lines, original_count,
+                                               modified_lines, modified_count,
+                                               options, &timeout, progress,
+                                               hit_timeout, degradations);
     sequence_diff_array_free(line_alignments);
+    line_identities_free(&line_identities);
     
+    if (result) {
+        diff_progress_finish();
+    }
+    end_progress(progress);
+    DIFF_TRACE_END("compute_diff");
     return result;
 }
 
+/**
+ * Upgrade a line-level-only diff to full detail in place - see
+ * refine_lines_diff() in the header.
+ */
+bool refine_lines_diff(
+    LinesDiff* diff,
+    const char** original_lines,
+    int original_count,
+    const char** modified_lines,
+    int modified_count,
+    const DiffOptions* options
+) {
+    if (!diff) return false;
+    if (!diff->deferred_alignments) return true;
+    
+    DIFF_TRACE_BEGIN("refine_lines_diff");
+    Timeout timeout;
+    timeout.timeout_ms = options->max_computation_time_ms;
+    timeout.start_time_ms = get_current_time_ms();
+    
+    // Unchanged lines are compared directly: their identities were dropped
+    LinesDiff* refined = refine_line_alignments(diff->deferred_alignments, NULL,
+                                                original_lines, original_count,
+                                                modified_lines, modified_count,
+                                                options, &timeout, NULL,
+                                                diff->hit_timeout, diff->degradations);
+    DIFF_TRACE_END("refine_lines_diff");
+    if (!refined) return false;
+    
+    // Swap the contents so the caller's pointer stays valid
+    LinesDiff previous = *diff;
+    *diff = *refined;
+    *refined = previous;
+    free_lines_diff(refined);
+    return true;
+}
+
 /**
  * Free LinesDiff structure.
  * 
@@ -741,17 +1116,19 @@ void free_lines_diff(LinesDiff* diff) {
     if (diff->changes.mappings) {
         for (int i = 0; i < diff->changes.count; i++) {
             if (diff->changes.mappings[i].inner_changes) {
-                free(diff->changes.mappings[i].inner_changes);
+                diff_free(diff->changes.mappings[i].inner_changes);
             }
         }
-        free(diff->changes.mappings);
+        diff_free(diff->changes.mappings);
     }
     
     if (diff->moves.moves) {
-        free(diff->moves.moves);
+        diff_free(diff->moves.moves);
     }
     
-    free(diff);
+    sequence_diff_array_free(diff->deferred_alignments);
+    
+    diff_free(diff);
 }
 
 /**
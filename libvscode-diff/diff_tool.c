@@ -6,17 +6,25 @@
 //
 // Options:
 //   -t    Show timing information for compute_diff
+//   --trace <file>  Write a Chrome trace of the diff stages (needs DIFF_ENABLE_TRACING)
+//   --progress      Print stage progress to stderr while diffing
+//   --anchors       Anchor identical line chunks before Myers (huge near-identical files)
 //
 // This tool:
 // 1. Reads two files from disk
-// 2. Uses compute_diff() to compute their LinesDiff
+// 2. Uses compute_diff_ex() to compute their LinesDiff
 // 3. Uses print_utils to print the results
 //
 // ============================================================================
 
+#include "cost_model.h"
 #include "default_lines_diff_computer.h"
 #include "print_utils.h"
+#include "simd_kernels.h"
+#include "trace.h"
 #include "types.h"
+#include <limits.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -80,33 +88,53 @@ static int read_file_lines(const char* filename, char*** lines_out) {
         return -1;
     }
     
-    // Read entire file content
-    fseek(file, 0, SEEK_END);
-    long file_size = ftell(file);
-    fseek(file, 0, SEEK_SET);
-    
-    char* content = (char*)malloc(file_size + 1);
-    if (!content) {
-        fclose(file);
+    // Read entire file content in chunks: no ftell(), whose long is 32-bit
+    // on Windows, so files over 2GB read the same everywhere
+    size_t capacity = (size_t)1 << 20;
+    size_t bytes_read = 0;
+    char* content = (char*)malloc(capacity + 1);
+    while (content) {
+        bytes_read += fread(content + bytes_read, 1, capacity - bytes_read, file);
+        if (bytes_read < capacity) {
+            break;
+        }
+        char* grown = capacity <= (SIZE_MAX - 1) / 2 ? (char*)realloc(content, capacity * 2 + 1) : NULL;
+        if (!grown) {
+            free(content);
+            content = NULL;
+            break;
+        }
+        content = grown;
+        capacity *= 2;
+    }
+    bool read_error = ferror(file) != 0;
+    fclose(file);
+    if (!content || read_error) {
+        fprintf(stderr, "Error: Cannot read file '%s'\n", filename);
+        free(content);
         return -1;
     }
-    
-    size_t bytes_read = fread(content, 1, file_size, file);
     content[bytes_read] = '\0';
-    fclose(file);
     
     // Count lines by counting '\n' characters (matching JavaScript split('\n'))
     // This matches: "a\nb\nc".split('\n') -> ["a", "b", "c"] (3 lines)
     //               "a\nb\nc\n".split('\n') -> ["a", "b", "c", ""] (4 lines)
-    int line_count = 1;  // At least one line (even empty file has 1 empty line)
-    for (size_t i = 0; i < bytes_read; i++) {
-        if (content[i] == '\n') {
-            line_count++;
-        }
+    const SimdKernels* simd = simd_kernels();
+    size_t newline_count = 0;
+    for (size_t i = simd->find_byte(content, bytes_read, '\n'); i < bytes_read;
+         i += 1 + simd->find_byte(content + i + 1, bytes_read - i - 1, '\n')) {
+        newline_count++;
     }
+    // Line numbers are int in the diff API
+    if (newline_count >= INT_MAX) {
+        fprintf(stderr, "Error: '%s' has more than %d lines\n", filename, INT_MAX);
+        free(content);
+        return -1;
+    }
+    int line_count = (int)newline_count + 1;  // At least one line (even empty file has 1 empty line)
     
     // Allocate lines array
-    char** lines = (char**)malloc(line_count * sizeof(char*));
+    char** lines = (char**)malloc((size_t)line_count * sizeof(char*));
     if (!lines) {
         free(content);
         return -1;
@@ -117,26 +145,30 @@ static int read_file_lines(const char* filename, char*** lines_out) {
     int line_idx = 0;
     size_t line_start = 0;
     
-    for (size_t i = 0; i <= bytes_read; i++) {
-        if (i == bytes_read || content[i] == '\n') {
-            // Extract line: everything from line_start to current position (excluding '\n')
-            size_t line_len = i - line_start;
-            
-            lines[line_idx] = (char*)malloc(line_len + 1);
-            if (!lines[line_idx]) {
-                for (int j = 0; j < line_idx; j++) {
-                    free(lines[j]);
-                }
-                free(lines);
-                free(content);
-                return -1;
+    while (line_idx < line_count) {
+        size_t i = line_start + simd->find_byte(content + line_start, bytes_read - line_start, '\n');
+        // Extract line: everything from line_start to current position (excluding '\n')
+        size_t line_len = i - line_start;
+        
+        lines[line_idx] = (char*)malloc(line_len + 1);
+        if (!lines[line_idx]) {
+            for (int j = 0; j < line_idx; j++) {
+                free(lines[j]);
             }
-            
-            memcpy(lines[line_idx], content + line_start, line_len);
-            lines[line_idx][line_len] = '\0';
-            line_idx++;
-            line_start = i + 1;
+            free(lines);
+            free(content);
+            return -1;
         }
+        
+        memcpy(lines[line_idx], content + line_start, line_len);
+        lines[line_idx][line_len] = '\0';
+        // NUL bytes become '\n' inside the line, as in Vim buffers (binary_content.h)
+        for (size_t j = simd->find_byte(lines[line_idx], line_len, '\0'); j < line_len;
+             j += 1 + simd->find_byte(lines[line_idx] + j + 1, line_len - j - 1, '\0')) {
+            lines[line_idx][j] = '\n';
+        }
+        line_idx++;
+        line_start = i + 1;
     }
     
     free(content);
@@ -155,6 +187,19 @@ static void free_lines(char** lines, int count) {
     free(lines);
 }
 
+/**
+ * Progress callback for --progress: one status line on stderr, redrawn in place.
+ */
+static bool print_progress(const char* stage, double fraction, void* user_data) {
+    (void)user_data;
+    fprintf(stderr, "\r%-16s %5.1f%%", stage, fraction * 100.0);
+    if (strcmp(stage, "done") == 0) {
+        fputc('\n', stderr);
+    }
+    fflush(stderr);
+    return true;
+}
+
 // ============================================================================
 // Main Program
 // ============================================================================
@@ -163,6 +208,11 @@ int main(int argc, char* argv[]) {
     // Parse arguments
     bool show_timing = false;
     int timeout_ms = 5000; // Default timeout: 5 seconds
+    const char* trace_file = NULL;
+    bool show_progress = false;
+    bool chunk_anchors = false;
+    bool strip_char_affixes = false;
+    bool line_level_only = false;
     int arg_idx = 1;
 
     // Parse optional flags
@@ -170,6 +220,12 @@ int main(int argc, char* argv[]) {
         if (strcmp(argv[arg_idx], "--version") == 0 || strcmp(argv[arg_idx], "-v") == 0) {
             printf("vscode-diff %s\n", get_version());
             return 0;
+        } else if (strcmp(argv[arg_idx], "--calibrate") == 0) {
+            // Emit a CMake initial-cache script (cmake -C <file>) for cost_model_config.h
+            double nd_ns = cost_model_calibrate_nd();
+            printf("# Generated by: diff --calibrate\n");
+            printf("set(DIFF_COST_ND_NS_PER_STEP \"%.3f\" CACHE STRING \"\" FORCE)\n", nd_ns);
+            return 0;
         } else if (strcmp(argv[arg_idx], "-b") == 0) {
             show_timing = true;
             arg_idx++;
@@ -185,6 +241,25 @@ int main(int argc, char* argv[]) {
                 return 1;
             }
             arg_idx += 2;
+        } else if (strcmp(argv[arg_idx], "--trace") == 0) {
+            if (arg_idx + 1 >= argc) {
+                fprintf(stderr, "Error: %s requires a file\n", argv[arg_idx]);
+                return 1;
+            }
+            trace_file = argv[arg_idx + 1];
+            arg_idx += 2;
+        } else if (strcmp(argv[arg_idx], "--progress") == 0) {
+            show_progress = true;
+            arg_idx++;
+        } else if (strcmp(argv[arg_idx], "--anchors") == 0) {
+            chunk_anchors = true;
+            arg_idx++;
+        } else if (strcmp(argv[arg_idx], "--strip-affixes") == 0) {
+            strip_char_affixes = true;
+            arg_idx++;
+        } else if (strcmp(argv[arg_idx], "--line-level") == 0) {
+            line_level_only = true;
+            arg_idx++;
         } else {
             fprintf(stderr, "Error: Unknown option: %s\n", argv[arg_idx]);
             fprintf(stderr, "Usage: %s [options] <original_file> <modified_file>\n", argv[0]);
@@ -201,6 +276,17 @@ int main(int argc, char* argv[]) {
         fprintf(stderr, "  -b              Show benchmark timing information\n");
         fprintf(stderr, "  -T <ms>         Set timeout in milliseconds (default: 5000, 0 = no timeout)\n");
         fprintf(stderr, "  --timeout <ms>  Same as -T\n");
+        fprintf(stderr, "  --calibrate     Measure engine costs, print CMake cache settings\n");
+        fprintf(stderr, "  --trace <file>  Write a Chrome trace (chrome://tracing, Perfetto) of the diff\n");
+        fprintf(stderr, "  --progress      Print stage progress to stderr (diffs over 100ms)\n");
+        fprintf(stderr, "  --anchors       Anchor identical line chunks first (huge near-identical files)\n");
+        fprintf(stderr, "  --strip-affixes Refine only between the common prefix/suffix of each change\n");
+        fprintf(stderr, "  --line-level    Stop after line alignment (no character refinement or moves)\n");
+        return 1;
+    }
+
+    if (trace_file && !diff_trace_start(0)) {
+        fprintf(stderr, "Error: --trace requires a build with -DDIFF_ENABLE_TRACING=ON\n");
         return 1;
     }
 
@@ -234,7 +320,10 @@ int main(int argc, char* argv[]) {
         .ignore_trim_whitespace = false,
         .max_computation_time_ms = timeout_ms,
         .compute_moves = true,
-        .extend_to_subwords = false
+        .extend_to_subwords = false,
+        .chunk_anchors = chunk_anchors,
+        .strip_char_affixes = strip_char_affixes,
+        .line_level_only = line_level_only
     };
 
     // Compute diff with timing
@@ -243,16 +332,27 @@ int main(int argc, char* argv[]) {
     
     portable_gettime(&start_time);
     cpu_start = clock();
-    LinesDiff* diff = compute_diff(
+    LinesDiff* diff = compute_diff_ex(
         (const char**)original_lines,
         original_count,
         (const char**)modified_lines,
         modified_count,
-        &options
+        &options,
+        show_progress ? print_progress : NULL,
+        NULL
     );
     cpu_end = clock();
     portable_gettime(&end_time);
     
+    bool trace_written = false;
+    if (trace_file) {
+        diff_trace_stop();
+        trace_written = diff_trace_write_json(trace_file);
+        if (!trace_written) {
+            fprintf(stderr, "Error: Cannot write trace file: %s\n", trace_file);
+        }
+    }
+    
     double wall_clock_ms = portable_time_diff_ms(&start_time, &end_time);
     double cpu_time_ms = ((double)(cpu_end - cpu_start)) / CLOCKS_PER_SEC * 1000.0;
     
@@ -268,6 +368,9 @@ int main(int argc, char* argv[]) {
     printf("=================================================================\n");
     printf("Number of changes: %d\n", diff->changes.count);
     printf("Hit timeout: %s\n", diff->hit_timeout ? "yes" : "no");
+    if (diff->is_binary) {
+        printf("Binary files: %s\n", diff->changes.count > 0 ? "differ" : "identical");
+    }
     printf("\n");
     
     if (diff->changes.count > 0) {
@@ -301,6 +404,10 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    if (trace_written) {
+        printf("Trace written to %s\n", trace_file);
+    }
+    
     // Cleanup
     free_lines_diff(diff);
     free_lines(original_lines, original_count);
@@ -0,0 +1,54 @@
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include "default_lines_diff_computer.h"
+#include <stddef.h>
+
+/**
+ * Pluggable Allocator
+ *
+ * Every allocation the library makes - including the LinesDiff and RenderPlan
+ * results handed to the caller - goes through the allocator installed with
+ * diff_set_allocator(). The default is the C runtime malloc/realloc/free.
+ *
+ * Embedders can route diff memory into their own pools, track per-diff usage
+ * or enforce a hard cap by returning NULL from malloc_fn/realloc_fn: the
+ * diff (or render plan) being computed is then abandoned, its memory
+ * released, and NULL returned to the caller.
+ *
+ * Install the allocator once, before computing any diff, and keep it until
+ * every result obtained with it has been freed: results must be released by
+ * the allocator that created them. The functions are called from OpenMP
+ * worker threads and concurrent compute_diff() callers, so they must be
+ * thread-safe unless DiffOptions.max_threads is 1 and calls are serialized.
+ */
+
+typedef struct {
+  void *(*malloc_fn)(size_t size, void *user_data);
+  void *(*realloc_fn)(void *ptr, size_t size, void *user_data); // ptr may be NULL
+  void (*free_fn)(void *ptr, void *user_data);                  // ptr is never NULL
+  void *user_data; // Passed to every call
+} DiffAllocator;
+
+/**
+ * Install the allocator used by all library modules.
+ *
+ * Not synchronized with running diffs: call it before the first diff (or
+ * when no diff is in flight).
+ *
+ * @param allocator Allocator to copy, or NULL to restore malloc/realloc/free
+ */
+DLL_EXPORT void diff_set_allocator(const DiffAllocator *allocator);
+
+// Library-internal allocation entry points (used instead of malloc & co.)
+void *diff_malloc(size_t size);
+void *diff_calloc(size_t count, size_t size);
+void *diff_realloc(void *ptr, size_t size);
+void diff_free(void *ptr);
+
+// Overflow-checked count * size variants: NULL (nothing allocated, ptr left
+// untouched) when the product does not fit in size_t
+void *diff_malloc_array(size_t count, size_t size);
+void *diff_realloc_array(void *ptr, size_t count, size_t size);
+
+#endif // ALLOCATOR_H
@@ -0,0 +1,35 @@
+#ifndef BINARY_CONTENT_H
+#define BINARY_CONTENT_H
+
+#include <stdbool.h>
+
+/**
+ * Binary Content Detection
+ *
+ * Images, archives and other non-text files reach the diff as "lines" split
+ * at arbitrary 0x0A bytes. Interning them and refining them character by
+ * character costs seconds and produces highlights nobody can read, so
+ * compute_diff() checks the start of each side first and diffs binary
+ * content as changed blocks only (LinesDiff.is_binary).
+ *
+ * Lines are C strings and cannot hold a NUL byte. Like Vim and Neovim
+ * buffers, a NUL inside a line is passed as '\n' (the diff CLI converts
+ * them when reading), which only a NUL can produce.
+ */
+
+// Bytes examined per side (the same window git uses)
+#define DIFF_BINARY_SCAN_BYTES 8000
+
+/**
+ * Check whether lines look like binary content: a NUL byte (see above) in
+ * the scanned window, or more than 1 in 10 scanned bytes that are invalid
+ * UTF-8 or control characters other than whitespace, backspace and escape.
+ * Latin-1 text with some accented letters stays text.
+ *
+ * @param lines Lines of one side
+ * @param count Number of lines
+ * @return true if the content should be treated as binary
+ */
+bool diff_lines_look_binary(const char **lines, int count);
+
+#endif // BINARY_CONTENT_H
@@ -28,6 +28,9 @@ typedef struct {
   bool consider_whitespace_changes; // If false, trim whitespace
   bool extend_to_subwords;          // If true, extend to CamelCase subwords
   int timeout_ms;                   // Timeout in milliseconds (0 = infinite)
+  int64_t max_memory_bytes;         // Working memory budget (0 = unlimited)
+  int *out_degradations;            // Output: DiffDegradation flags OR-ed in (can be NULL)
+  bool strip_affixes;               // If true, run the engine between common prefix/suffix only
 } CharLevelOptions;
 
 /**
@@ -49,6 +52,16 @@ typedef struct {
  * 7. removeVeryShortMatchingTextBetweenLongDiffs(slice1, slice2, diffs)
  * 8. Translate character offsets to Range positions
  * 
+ * With options->max_memory_bytes set, a region whose character sequences
+ * alone exceed the budget is returned as one mapping covering it (line-level
+ * only), and the engines degrade as in compute_line_alignments().
+ *
+ * With options->strip_affixes set, step 2 picks and runs the engine on the
+ * code units between the common prefix and suffix of the region only. The
+ * DP engine scores long runs higher, so dropping the shared ends can change
+ * which of several equally short alignments it returns: results may differ
+ * from VSCode where the changed text repeats the text around it.
+ * 
  * @param line_diff Single line-level diff region to refine
  * @param lines_a Original file lines
  * @param len_a Number of lines in original
@@ -56,7 +69,8 @@ typedef struct {
  * @param len_b Number of lines in modified
  * @param options Refinement options
  * @param out_hit_timeout Output: Set to true if timeout occurred, can be NULL
- * @return RangeMappingArray* Character-level mappings (caller must free)
+ * @return RangeMappingArray* Character-level mappings (caller must free), or
+ *         NULL on invalid arguments or allocation failure
  */
 RangeMappingArray *refine_diff_char_level(const SequenceDiff *line_diff, const char **lines_a,
                                           int len_a, const char **lines_b, int len_b,
@@ -78,7 +92,8 @@ RangeMappingArray *refine_diff_char_level(const SequenceDiff *line_diff, const c
  * @param len_b Number of lines in modified
  * @param options Refinement options
  * @param out_hit_timeout Output: Set to true if any timeout occurred, can be NULL
- * @return RangeMappingArray* All character-level mappings (caller must free)
+ * @return RangeMappingArray* All character-level mappings (caller must free), or
+ *         NULL on invalid arguments or allocation failure
  */
 RangeMappingArray *refine_all_diffs_char_level(const SequenceDiffArray *line_diffs,
                                                const char **lines_a, int len_a,
@@ -86,6 +101,15 @@ RangeMappingArray *refine_all_diffs_char_level(const SequenceDiffArray *line_dif
                                                const CharLevelOptions *options,
                                                bool *out_hit_timeout);
 
+/**
+ * Whole-line character range of a line diff (VSCode toRangeMapping2()).
+ *
+ * This is where refinement starts, and what a region keeps as its only inner
+ * change when refinement is skipped.
+ */
+RangeMapping line_diff_to_range_mapping(const SequenceDiff *line_diff, const char **lines_a,
+                                        int len_a, const char **lines_b, int len_b);
+
 /**
  * Helper: Free RangeMappingArray
  */
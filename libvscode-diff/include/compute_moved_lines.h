@@ -19,8 +19,9 @@
  * @param hashed_modified Trimmed-hash of each modified line (0-indexed, length = modified_count)
  * @param timeout_ms     Timeout in milliseconds (0 = infinite)
  * @param out_moves      Output: array of MovedText (caller must free .moves)
+ * @return false if an allocation failed (out_moves is then empty)
  */
-void compute_moved_lines(
+bool compute_moved_lines(
     const DetailedLineRangeMapping *changes, int change_count,
     const char **original_lines, int original_count,
     const char **modified_lines, int modified_count,
@@ -28,4 +29,12 @@ void compute_moved_lines(
     int timeout_ms,
     MovedTextArray *out_moves);
 
+/**
+ * Estimate the peak working memory compute_moved_lines() needs for these
+ * changes, dominated by one character-pair histogram per candidate fragment.
+ * Used to skip move detection under DiffOptions.max_memory_bytes.
+ */
+int64_t compute_moved_lines_memory_bytes(const DetailedLineRangeMapping *changes,
+                                         int change_count);
+
 #endif // COMPUTE_MOVED_LINES_H
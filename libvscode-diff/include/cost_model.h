@@ -0,0 +1,74 @@
+#ifndef COST_MODEL_H
+#define COST_MODEL_H
+
+#include "sequence.h"
+#include "types.h"
+
+/**
+ * Diff Engine Cost Model
+ *
+ * Chooses the Myers engine for a region from a cost estimate instead of the
+ * input size alone.
+ *
+ * VSCode Parity: the DP vs O(ND) split is fixed by size (lines < 1700,
+ * chars < 500) because the two engines pick different alignments, so the
+ * model never moves a region between them. What it does decide is whether the
+ * exact O(ND) search can finish within the timeout at all: if even a lower
+ * bound on its cost is far over budget, the region goes straight to the
+ * cost-capped search that a timeout would fall back to anyway, without first
+ * burning the whole timeout.
+ *
+ * Per-step costs come from cost_model_config.h, generated by CMake from the
+ * DIFF_COST_* cache variables (see `diff --calibrate`). Builds without it
+ * (build.sh / build.cmd) use the conservative defaults below.
+ */
+
+#ifdef DIFF_HAVE_COST_MODEL_CONFIG
+#include "cost_model_config.h"
+#endif
+
+// Nanoseconds per diagonal step of the forward O(ND) search (lower is safer)
+#ifndef DIFF_COST_ND_NS_PER_STEP
+#define DIFF_COST_ND_NS_PER_STEP 0.5
+#endif
+
+// Predicted O(ND) time must exceed the timeout by this factor to skip it
+#ifndef DIFF_COST_TIMEOUT_SAFETY
+#define DIFF_COST_TIMEOUT_SAFETY 2.0
+#endif
+
+typedef enum {
+  DIFF_ENGINE_DP,       // O(MN) DP (VSCode: small inputs)
+  DIFF_ENGINE_ND,       // Exact forward O(ND) Myers
+  DIFF_ENGINE_ND_CAPPED // Cost-capped O(ND), reported as a timeout
+} DiffEngine;
+
+typedef struct {
+  int min_edit_distance; // Lower-bound estimate of D (0 if not sampled)
+  double nd_min_ms;      // Lower bound of exact O(ND) run time
+} DiffCostEstimate;
+
+/**
+ * Select the engine for a region.
+ *
+ * @param seq1 First sequence
+ * @param seq2 Second sequence
+ * @param dp_threshold Total length below which VSCode uses DP
+ * @param timeout_ms Time budget (0 = none, always exact)
+ * @param estimate Output: cost estimate used for the decision (can be NULL)
+ * @return Engine to run
+ */
+DiffEngine diff_select_engine(const ISequence *seq1, const ISequence *seq2, int dp_threshold,
+                              int timeout_ms, DiffCostEstimate *estimate);
+
+/**
+ * Measure this machine's O(ND) cost per diagonal step.
+ *
+ * Runs the forward engine on inputs with no common elements, where the
+ * number of diagonal steps is known exactly. Used by `diff --calibrate`.
+ *
+ * @return Nanoseconds per diagonal step (best of several runs)
+ */
+double cost_model_calibrate_nd(void);
+
+#endif // COST_MODEL_H
@@ -19,6 +19,14 @@
  * 
  * Main entry point for computing a complete diff with line and character
  * level changes. Implements VSCode's DefaultLinesDiffComputer.computeDiff().
+ *
+ * Inputs too large for the engines' int positions degrade instead of
+ * overflowing: a region over about 2^31 characters keeps its line-level
+ * change (DIFF_DEGRADED_LINE_LEVEL_ONLY), and over about 2^31 lines in total
+ * the result is one whole-file change (DIFF_DEGRADED_WHOLE_FILE).
+ *
+ * Binary content (see binary_content.h) is diffed as changed line blocks
+ * only, without inner changes or moves, and flagged in LinesDiff.is_binary.
  * 
  * @param original_lines Original file lines
  * @param original_count Number of lines in original
@@ -34,6 +42,69 @@ DLL_EXPORT LinesDiff *compute_diff(const char **original_lines, int original_cou
                         const char **modified_lines, int modified_count,
                         const DiffOptions *options);
 
+/**
+ * Progress callback for compute_diff_ex().
+ *
+ * Called only on the thread that called compute_diff_ex(), never from the
+ * refinement worker threads, so it can safely call back into a LuaJIT VM.
+ *
+ * @param stage "line_alignments", "refine", "moves", or "done" (fraction 1.0,
+ *              sent once at the end if any progress was reported)
+ * @param fraction Progress within the stage, 0.0 to 1.0 (never decreases
+ *                 within a stage)
+ * @param user_data Pointer passed to compute_diff_ex()
+ * @return true to continue, false to cancel the diff
+ */
+typedef bool (*DiffProgressCallback)(const char *stage, double fraction, void *user_data);
+
+/**
+ * Compute diff with progress reporting and cancellation.
+ *
+ * Same as compute_diff(), plus a progress callback. Reports are rate-limited:
+ * none during the first 100ms (so small diffs never see a call), then at most
+ * one every 50ms. Line alignment reports the Myers edit distance D explored
+ * against its upper bound N + M. Refinement reports regions completed out of
+ * the total. Move detection reports move candidates evaluated.
+ *
+ * When the callback returns false, running searches stop at their next
+ * timeout check, remaining work is skipped and NULL is returned.
+ *
+ * @param progress Progress callback (NULL = same as compute_diff())
+ * @param user_data Passed through to the callback
+ * @return LinesDiff structure, or NULL if cancelled (caller must free with free_lines_diff())
+ */
+DLL_EXPORT LinesDiff *compute_diff_ex(const char **original_lines, int original_count,
+                           const char **modified_lines, int modified_count,
+                           const DiffOptions *options, DiffProgressCallback progress,
+                           void *user_data);
+
+/**
+ * Upgrade a line-level-only diff to full detail, in place.
+ *
+ * With DiffOptions.line_level_only, compute_diff() stops after line
+ * alignment: each change carries its whole-line range as its only inner
+ * change, there are no moves, and the alignments are kept in
+ * LinesDiff.deferred_alignments. Line ranges are those of the alignment;
+ * refinement can still narrow a change, and adds changes for lines that differ
+ * only in leading/trailing whitespace (unless ignore_trim_whitespace is set).
+ *
+ * This call runs the skipped stages (whitespace scanning, character
+ * refinement, move detection) on the kept alignments and replaces the
+ * changes and moves, giving the same result as compute_diff() without
+ * line_level_only. The timeout starts over for this call.
+ *
+ * @param diff Result of compute_diff() (already refined: nothing to do)
+ * @param original_lines The original lines passed to compute_diff()
+ * @param original_count Number of original lines
+ * @param modified_lines The modified lines passed to compute_diff()
+ * @param modified_count Number of modified lines
+ * @param options Options for the refinement (line_level_only is ignored)
+ * @return false if out of memory (diff is then left unchanged)
+ */
+DLL_EXPORT bool refine_lines_diff(LinesDiff *diff, const char **original_lines, int original_count,
+                                  const char **modified_lines, int modified_count,
+                                  const DiffOptions *options);
+
 /**
  * Free LinesDiff structure and all contained data.
  * 
@@ -0,0 +1,60 @@
+#ifndef DIFF_STAT_H
+#define DIFF_STAT_H
+
+#include "default_lines_diff_computer.h"
+#include <stdbool.h>
+
+/**
+ * Diff Statistics - line counts and edit distance without a LinesDiff
+ *
+ * History and explorer views show per-file insertion/deletion counts, and
+ * rename heuristics only need to know how different two files are. Neither
+ * needs the alignment itself, so diff_stat() skips everything compute_diff()
+ * does besides measuring: no interning, no traceback, no optimization passes,
+ * no character refinement and no result allocation.
+ *
+ * Lines are compared byte for byte (like `git diff --numstat`). Each line is
+ * hashed once; the common prefix and suffix are skipped, lines that occur on
+ * only one side are counted directly (they can never be matched), and a
+ * forward Myers search over the rest keeps only its V array, so memory is
+ * O(N + M). The counts are those of a minimal diff, which compute_diff()
+ * usually reproduces but is not required to (it aligns trimmed lines and may
+ * give up on optimality after its timeout).
+ */
+
+typedef struct {
+  int insertions;    // Lines only in the modified side
+  int deletions;     // Lines only in the original side
+  int edit_distance; // insertions + deletions
+  bool exceeded;     // Bounded run stopped early; the fields above are lower bounds
+} DiffStat;
+
+/**
+ * Count inserted and deleted lines of a minimal line diff.
+ *
+ * @param lines_a Original lines
+ * @param len_a Number of original lines
+ * @param lines_b Modified lines
+ * @param len_b Number of modified lines
+ * @param out Output statistics
+ * @return false if allocation failed (out is then unchanged)
+ */
+DLL_EXPORT bool diff_stat(const char **lines_a, int len_a, const char **lines_b, int len_b,
+                          DiffStat *out);
+
+/**
+ * Like diff_stat(), but stop as soon as the edit distance is known to exceed
+ * max_edit_distance. The search then costs O((N + M) * max_edit_distance) at
+ * most, which makes "are these files at least X% similar" cheap to ask for
+ * many candidate pairs.
+ *
+ * When the limit is exceeded, out->exceeded is set, out->edit_distance is
+ * max_edit_distance + 1 and the line counts are lower bounds.
+ *
+ * @param max_edit_distance Largest edit distance worth computing (>= 0)
+ * @return false if allocation failed (out is then unchanged)
+ */
+DLL_EXPORT bool diff_stat_bounded(const char **lines_a, int len_a, const char **lines_b,
+                                  int len_b, int max_edit_distance, DiffStat *out);
+
+#endif // DIFF_STAT_H
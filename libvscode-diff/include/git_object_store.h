@@ -0,0 +1,69 @@
+/**
+ * Native Git Object Store Reader
+ *
+ * Reads blobs straight out of a repository's object database (loose objects
+ * and v2 packfiles, including OFS/REF deltas) so the editor can fetch
+ * `<commit>:<path>` contents without spawning one `git show` per file.
+ *
+ * Scope is deliberately narrow - a read-only fast path, not a git
+ * implementation:
+ * - Revisions are full 40-hex SHA-1 ids of a commit, tag or tree; symbolic
+ *   revisions (HEAD~1, branch names) are resolved by the caller
+ * - SHA-256 repositories, the index (":0") and anything unusual report
+ *   GIT_STORE_ERROR so the caller can fall back to the git CLI
+ *
+ * Pack indexes and packs are mmap'd once per store and reused across reads.
+ * A store is not thread-safe; use one store per thread.
+ */
+
+#ifndef GIT_OBJECT_STORE_H
+#define GIT_OBJECT_STORE_H
+
+#include "default_lines_diff_computer.h"
+#include <stddef.h>
+
+typedef struct GitObjectStore GitObjectStore;
+
+/**
+ * Result of git_store_read_blob().
+ */
+typedef enum {
+  GIT_STORE_OK = 0,         // Blob found
+  GIT_STORE_NOT_FOUND = 1,  // Revision was read, but has no file at that path
+  GIT_STORE_ERROR = -1      // Could not answer natively (missing object, unsupported format, ...)
+} GitStoreStatus;
+
+/**
+ * Open the object database of a repository.
+ *
+ * @param path Work tree root (containing .git, which may be a `gitdir:` file
+ *             for linked worktrees and submodules) or a git directory itself
+ * @return Store handle (free with git_store_close), or NULL if no object
+ *         database was found
+ */
+DLL_EXPORT GitObjectStore *git_store_open(const char *path);
+
+/**
+ * Close a store and unmap its packs.
+ */
+DLL_EXPORT void git_store_close(GitObjectStore *store);
+
+/**
+ * Read the contents of `<revision>:<path>`.
+ *
+ * @param store     Store from git_store_open
+ * @param revision  40-hex id of a commit, annotated tag or tree
+ * @param path      Repository-relative path with forward slashes
+ * @param out_data  Output: blob bytes (free with git_store_free_blob); NULL unless GIT_STORE_OK
+ * @param out_len   Output: blob size in bytes
+ * @return GitStoreStatus
+ */
+DLL_EXPORT int git_store_read_blob(GitObjectStore *store, const char *revision, const char *path,
+                                   char **out_data, size_t *out_len);
+
+/**
+ * Free blob data returned by git_store_read_blob.
+ */
+DLL_EXPORT void git_store_free_blob(char *data);
+
+#endif // GIT_OBJECT_STORE_H
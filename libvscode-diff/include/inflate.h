@@ -0,0 +1,37 @@
+/**
+ * Minimal zlib/DEFLATE Decoder
+ *
+ * Decompresses zlib streams (RFC 1950 wrapper around RFC 1951 DEFLATE) as
+ * stored by git for loose objects and packfile entries. Decode-only, one-shot:
+ * the whole compressed input is in memory (usually an mmap'd pack) and the
+ * whole output is produced in a single call.
+ *
+ * Not a general zlib replacement - no streaming, no preset dictionaries,
+ * no gzip wrapper.
+ */
+
+#ifndef INFLATE_H
+#define INFLATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Inflate one zlib stream.
+ *
+ * Trailing bytes after the end of the stream are ignored, so a packfile
+ * entry can be decoded directly from its offset in the mapped pack.
+ *
+ * @param src       Compressed input
+ * @param src_len   Bytes available at src
+ * @param size_hint Expected output size (0 if unknown); when exact, the
+ *                  output buffer is allocated once
+ * @param out_data  Output: diff_malloc'd buffer (caller must diff_free); NULL on failure
+ * @param out_len   Output: number of decompressed bytes
+ * @return true on success, false on malformed or truncated input
+ */
+bool zlib_inflate(const uint8_t *src, size_t src_len, size_t size_hint, uint8_t **out_data,
+                  size_t *out_len);
+
+#endif // INFLATE_H
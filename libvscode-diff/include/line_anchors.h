@@ -0,0 +1,56 @@
+#ifndef LINE_ANCHORS_H
+#define LINE_ANCHORS_H
+
+#include "line_level.h"
+#include "types.h"
+
+/**
+ * Chunk Anchors - line alignment pre-stage for near-identical huge files
+ *
+ * compute_line_alignments() interns every line into the perfect hash map and
+ * runs Myers over the whole file, even when two 500 MB dumps differ in ten
+ * places. This pre-stage hashes each line once, splits both sides into
+ * content-defined chunks of lines (a boundary follows every line whose hash
+ * has its low bits zero, so boundaries depend only on the line itself and
+ * re-synchronize right after an edit), and matches chunks that occur exactly
+ * once on each side and have equal content. The longest run of such matches
+ * that is in order on both sides becomes the set of anchors; only the spans
+ * between anchors go through compute_line_alignments().
+ *
+ * VSCode Parity: VSCode aligns the whole file at once. Anchored results can
+ * differ where a change sits next to an anchor or where Myers would have
+ * paired a unique chunk differently, so the stage is opt-in
+ * (DiffOptions.chunk_anchors). Files under LINE_ANCHORS_MIN_LINES, and files
+ * without any anchor, get the plain compute_line_alignments() result.
+ */
+
+// Combined line count below which the pre-stage is skipped
+#define LINE_ANCHORS_MIN_LINES 8192
+
+/**
+ * Same contract as compute_line_alignments(), with the anchor pre-stage.
+ *
+ * The returned identities keep the guarantee the refinement relies on: two
+ * lines that the alignment keeps as unchanged have equal IDs iff they are
+ * byte-for-byte equal. IDs of lines in different spans are not comparable.
+ */
+SequenceDiffArray *compute_anchored_line_alignments(const char **lines_a, int len_a,
+                                                    const char **lines_b, int len_b,
+                                                    int timeout_ms, bool *hit_timeout,
+                                                    LineIdentities *identities,
+                                                    int64_t max_memory_bytes, int *degradations);
+
+/**
+ * Changed blocks between anchors, without aligning inside them.
+ *
+ * Used for binary content, where a line is just the bytes between two
+ * newlines and Myers over them is wasted work. Each span between anchors,
+ * minus its equal first and last lines, is reported as one changed block.
+ * There is no size threshold.
+ *
+ * @return Line diffs (caller must free), or NULL if allocation failed
+ */
+SequenceDiffArray *compute_anchored_line_blocks(const char **lines_a, int len_a,
+                                                const char **lines_b, int len_b);
+
+#endif // LINE_ANCHORS_H
@@ -15,6 +15,7 @@
  * 2. Create LineSequence with hashed lines
  * 3. Run Myers diff (DP for small files <1700 lines, O(ND) for large)
  *    - DP uses equality scoring for whitespace sensitivity
+ *    - O(ND) skips lines that occur on one side only (same alignments)
  * 4. optimizeSequenceDiffs() - Step 2 optimization
  * 5. removeVeryShortMatchingLinesBetweenDiffs() - Step 3 optimization
  * 
@@ -26,6 +27,21 @@
  * REUSED BY: Step 4 (character-level refinement operates on line alignments)
  */
 
+/**
+ * Untrimmed line IDs of both sides, interned in one perfect hash map while
+ * building the line sequences. original[i] == modified[j] iff the lines are
+ * byte-for-byte equal.
+ */
+typedef struct {
+  uint32_t *original; // One ID per original line
+  uint32_t *modified; // One ID per modified line
+} LineIdentities;
+
+/**
+ * Free arrays handed out by compute_line_alignments() (struct itself not freed)
+ */
+void line_identities_free(LineIdentities *identities);
+
 /**
  * Compute line-level diff alignments - VSCode Parity
  * 
@@ -50,13 +66,19 @@
  * @param len_b Number of lines in modified
  * @param timeout_ms Maximum milliseconds (0 = no timeout)
  * @param hit_timeout Output: set to true if timeout reached
+ * @param identities Output: untrimmed line IDs, for exact line comparisons after alignment
+ *                   (can be NULL; caller frees with line_identities_free)
+ * @param max_memory_bytes Working memory budget for the Myers engine (0 = unlimited)
+ * @param degradations Output: DiffDegradation flags OR-ed in when over budget (can be NULL)
  * @return SequenceDiffArray* Line alignments (caller must free with free_sequence_diff_array)
  * 
  * NOTE: This is the consolidation of Steps 1-3, producing the exact same output
  * as VSCode's lineAlignments variable at line 245.
  */
 SequenceDiffArray *compute_line_alignments(const char **lines_a, int len_a, const char **lines_b,
-                                           int len_b, int timeout_ms, bool *hit_timeout);
+                                           int len_b, int timeout_ms, bool *hit_timeout,
+                                           LineIdentities *identities, int64_t max_memory_bytes,
+                                           int *degradations);
 
 /**
  * Helper: Free SequenceDiffArray
@@ -0,0 +1,52 @@
+#ifndef LONG_LINE_H
+#define LONG_LINE_H
+
+#include "sequence.h"
+#include "types.h"
+
+/**
+ * Long-Line Mode - character diff of minified and generated text
+ *
+ * A minified JS or JSON file is one line of megabytes. Character Myers over millions of UTF-16
+ * units is fast for a handful of point edits, but any larger change (a moved or rewritten block)
+ * pushes D into the tens of thousands and the search times out, losing all detail.
+ *
+ * Long-line mode splits both sides into content-defined chunks: a rolling gear hash over the last
+ * 32 code units picks the boundaries, so they depend only on nearby content and re-synchronize
+ * right after an edit. Myers runs on the chunk sequences (about 48 units per chunk, so N and D
+ * shrink accordingly), and only the character ranges of differing chunks are diffed: with DP where
+ * the table is small (this includes the lopsided range left by a moved block), otherwise with
+ * O(ND). Unchanged chunks are exactly equal text, so the combined result is a valid alignment. It
+ * goes through the same optimization steps as a plain character diff.
+ *
+ * VSCode Parity: VSCode runs character Myers on the whole region. Results can differ where a change
+ * straddles a chunk boundary, so the mode is only used for regions that are both large and made of
+ * long lines (long_line_mode_applies()).
+ */
+
+// Combined length of both sides (UTF-16 units) before long-line mode is considered
+#define LONG_LINE_MIN_TOTAL_LENGTH 65536
+
+// Average line length (UTF-16 units) over both sides for long-line mode
+#define LONG_LINE_MIN_AVERAGE_LENGTH 1000
+
+/**
+ * @return true if a region with these character sequences should be diffed
+ *         in long-line mode
+ */
+bool long_line_mode_applies(const CharSequence *seq1, const CharSequence *seq2);
+
+/**
+ * Diff two character sequences through content-defined chunks.
+ *
+ * @param seq1 First sequence (must provide elements)
+ * @param seq2 Second sequence (must provide elements)
+ * @param timeout_ms Time budget shared by all searches (0 = none)
+ * @param hit_timeout Output: set to true if a search timed out
+ * @return Character-offset diffs (caller must free), or NULL if the
+ *         sequences have no element arrays or allocation failed
+ */
+SequenceDiffArray *long_line_diff(const ISequence *seq1, const ISequence *seq2, int timeout_ms,
+                                  bool *hit_timeout);
+
+#endif // LONG_LINE_H
@@ -47,6 +47,66 @@ SequenceDiffArray *myers_dp_diff_algorithm(const ISequence *seq1, const ISequenc
 SequenceDiffArray *myers_nd_diff_algorithm(const ISequence *seq1, const ISequence *seq2,
                                            int timeout_ms, bool *hit_timeout);
 
+/**
+ * Cost-capped Myers O(ND) Algorithm
+ * 
+ * Greedy forward search that commits to the furthest-reaching point every
+ * max(256, sqrt(N+M)) edits. Valid but possibly non-minimal; this is what
+ * myers_nd_diff_algorithm() continues with after a timeout.
+ * 
+ * @param seq1 First sequence
+ * @param seq2 Second sequence
+ * @return Array of SequenceDiff structures (caller must free)
+ */
+SequenceDiffArray *myers_nd_capped_diff_algorithm(const ISequence *seq1, const ISequence *seq2);
+
+/**
+ * Myers O(ND) Bidirectional Algorithm (middle snake)
+ * 
+ * Searches forward and backward at the same time, splits on the middle snake
+ * and recurses, using O(N+M) memory. Produces a minimal diff, but may choose a
+ * different one than myers_nd_diff_algorithm() when several exist, so it is not
+ * used by the VSCode parity pipeline.
+ * 
+ * @param seq1 First sequence
+ * @param seq2 Second sequence
+ * @param timeout_ms Maximum milliseconds to run (0 = no timeout)
+ * @param hit_timeout Output: set to true if timeout was reached
+ * @return Array of SequenceDiff structures (caller must free)
+ */
+SequenceDiffArray *myers_bidir_diff_algorithm(const ISequence *seq1, const ISequence *seq2,
+                                              int timeout_ms, bool *hit_timeout);
+
+/**
+ * Memory-Bounded Myers O(ND) Algorithm
+ * 
+ * Runs myers_nd_diff_algorithm() while its path storage fits in
+ * max_memory_bytes. If the snake pool outgrows the budget, the search is
+ * abandoned and myers_bidir_diff_algorithm() (O(N+M) memory, minimal but not
+ * always VSCode's alignment) finishes with the remaining timeout.
+ * 
+ * @param seq1 First sequence
+ * @param seq2 Second sequence
+ * @param timeout_ms Maximum milliseconds to run (0 = no timeout)
+ * @param max_memory_bytes Working memory budget (0 = unlimited, same as myers_nd_diff_algorithm)
+ * @param hit_timeout Output: set to true if timeout was reached
+ * @param hit_memory_limit Output: set to true if the linear-space engine was used (can be NULL)
+ * @return Array of SequenceDiff structures (caller must free)
+ */
+SequenceDiffArray *myers_nd_bounded_diff_algorithm(const ISequence *seq1, const ISequence *seq2,
+                                                   int timeout_ms, int64_t max_memory_bytes,
+                                                   bool *hit_timeout, bool *hit_memory_limit);
+
+/**
+ * Working memory of myers_dp_diff_algorithm() for the given sizes.
+ * 
+ * @param len1 Length of first sequence
+ * @param len2 Length of second sequence
+ * @param scored True if a score function will be passed
+ * @return Bytes allocated for the DP tables
+ */
+int64_t myers_dp_memory_bytes(int len1, int len2, bool scored);
+
 /**
  * Legacy wrapper for backward compatibility
  * 
@@ -28,7 +28,8 @@
  * @param seq1 First sequence (ISequence interface)
  * @param seq2 Second sequence (ISequence interface)
  * @param diffs Input/output array of diffs (modified in-place)
- * @return Optimized diff array (same pointer as input)
+ * @return Optimized diff array (same pointer as input), or NULL if allocation
+ *         failed (diffs is then still a valid, possibly partly optimized array)
  * 
  * REUSED BY: Step 4 for character-level optimization
  */
@@ -44,7 +45,8 @@ SequenceDiffArray *optimize_sequence_diffs(const ISequence *seq1, const ISequenc
  * @param seq1 First sequence (can be NULL, not used in current impl)
  * @param seq2 Second sequence (can be NULL, not used in current impl)
  * @param diffs Input/output array of diffs (modified in-place)
- * @return Modified diff array (same pointer as input)
+ * @return Modified diff array (same pointer as input), or NULL if allocation
+ *         failed (diffs is then left unchanged)
  * 
  * REUSED BY: Step 4 for character-level short match removal
  */
@@ -62,6 +64,7 @@ SequenceDiffArray *remove_short_matches(const ISequence *seq1, const ISequence *
  * - Iterates up to 10 times until no more joins
  * 
  * This is the CORRECT Step 3 for line-level optimization.
+ * Returns diffs, or NULL if allocation failed (diffs is then still valid).
  * 
  * VSCode: removeVeryShortMatchingLinesBetweenDiffs() from heuristicSequenceOptimizations.ts
  */
@@ -8,6 +8,7 @@
 #ifndef PLATFORM_H
 #define PLATFORM_H
 
+#include "allocator.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -23,13 +24,13 @@
  * - MSVC Windows: _strdup() available
  * - C89/C99: Not standard, need manual implementation
  * 
- * Returns: Allocated copy of string (caller must free), or NULL on failure
+ * Returns: Allocated copy of string (caller must diff_free), or NULL on failure
  */
 static inline char *diff_strdup(const char *s) {
   if (!s)
     return NULL;
   size_t len = strlen(s) + 1;
-  char *copy = (char *)malloc(len);
+  char *copy = (char *)diff_malloc(len);
   if (copy) {
     memcpy(copy, s, len);
   }
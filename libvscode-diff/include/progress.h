@@ -0,0 +1,83 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include "default_lines_diff_computer.h"
+#include <stdbool.h>
+
+/**
+ * Progress Reporting - plumbing behind compute_diff_ex()
+ *
+ * compute_diff_ex() attaches a DiffProgress to the calling thread (the
+ * reporter) and to each refinement worker (poll-only). The algorithms reach
+ * it through a thread-local pointer, so Myers and move detection can report
+ * and notice cancellation without a progress parameter on every function.
+ * Without an attached DiffProgress every call below is a thread-local load
+ * and a branch.
+ *
+ * The orchestrator reports its own stage fractions with diff_progress_update().
+ * Algorithms call diff_progress_nested(), which only reports when the current
+ * stage was started as nested: Myers D progress counts for line alignment,
+ * but not for the many small searches inside refinement.
+ */
+
+typedef struct DiffProgress DiffProgress;
+
+/**
+ * Create progress state for one compute_diff_ex() call.
+ *
+ * @return NULL if callback is NULL or allocation fails (progress disabled)
+ */
+DiffProgress *diff_progress_create(DiffProgressCallback callback, void *user_data);
+
+void diff_progress_destroy(DiffProgress *progress);
+
+/**
+ * Attach progress to the current thread (NULL detaches).
+ *
+ * @param reporter true on the thread that called compute_diff_ex(); only that
+ *                 thread invokes the callback, the others just poll for
+ *                 cancellation
+ */
+void diff_progress_attach(DiffProgress *progress, bool reporter);
+
+/**
+ * Start a stage on the reporting thread.
+ *
+ * @param stage Stage name passed to the callback (string literal)
+ * @param nested If true, diff_progress_nested() fractions are reported for it
+ */
+void diff_progress_stage(const char *stage, bool nested);
+
+/**
+ * Report the current stage's fraction (rate-limited).
+ *
+ * @return false once the diff was cancelled
+ */
+bool diff_progress_update(double fraction);
+
+/**
+ * Report progress from inside an algorithm (rate-limited; only for nested
+ * stages). Pass a negative fraction to only poll for cancellation.
+ *
+ * @return false once the diff was cancelled
+ */
+bool diff_progress_nested(double fraction);
+
+/**
+ * @return true if the attached diff was cancelled
+ */
+bool diff_progress_cancelled(void);
+
+/**
+ * Send the final "done" report if anything was reported before.
+ */
+void diff_progress_finish(void);
+
+/**
+ * Override the rate limit (tests): no report until first_ms after the diff
+ * started, then at most one every interval_ms. Negative values restore the
+ * defaults (100ms, 50ms).
+ */
+void diff_progress_set_rate_limit(int first_ms, int interval_ms);
+
+#endif // PROGRESS_H
@@ -0,0 +1,79 @@
+#ifndef RENDER_PLAN_H
+#define RENDER_PLAN_H
+
+#include "default_lines_diff_computer.h"
+#include "types.h"
+
+/**
+ * Render Plan - Pre-computed extmark placement for the side-by-side view
+ *
+ * Flattens a LinesDiff into the exact list of highlights and filler lines the
+ * Neovim UI places, so the Lua side only loops and calls nvim_buf_set_extmark.
+ *
+ * Everything that used to be computed in lua/codediff/ui/core.lua is done here:
+ * - Line highlights per mapping (one item per changed line range)
+ * - Character highlights, split per line and converted from UTF-16 columns
+ *   (diff core) to UTF-8 byte columns (Neovim)
+ * - Filler line insert points and counts (docs/filler-line-algorithm.md,
+ *   port of VSCode's computeRangeAlignment())
+ *
+ * Coordinates are 0-based lines and 0-based byte columns, end exclusive,
+ * matching nvim_buf_set_extmark() arguments directly.
+ */
+
+typedef enum {
+  RENDER_ITEM_LINE_HIGHLIGHT = 0, // Full lines [start_line, end_line) with hl_eol
+  RENDER_ITEM_CHAR_HIGHLIGHT = 1, // (start_line, start_col) -> (end_line, end_col)
+  RENDER_ITEM_FILLER = 2,         // `count` virtual filler lines below start_line
+  RENDER_ITEM_FILLER_ABOVE = 3    // `count` virtual filler lines above start_line
+} RenderItemKind;
+
+typedef enum {
+  RENDER_SIDE_ORIGINAL = 0, // Left buffer (deletions)
+  RENDER_SIDE_MODIFIED = 1  // Right buffer (insertions)
+} RenderSide;
+
+typedef struct {
+  int kind;       // RenderItemKind
+  int side;       // RenderSide
+  int start_line; // 0-based
+  int start_col;  // 0-based byte column
+  int end_line;   // 0-based (exclusive for line highlights)
+  int end_col;    // 0-based byte column, exclusive
+  int count;      // Number of filler lines (fillers only)
+} RenderItem;
+
+typedef struct {
+  RenderItem *items;
+  int count;
+  int capacity;
+  int original_filler_count; // Total filler lines on the original side
+  int modified_filler_count; // Total filler lines on the modified side
+} RenderPlan;
+
+/**
+ * Build the render plan for a computed diff.
+ *
+ * Items are emitted in the same order as the Lua renderer used to place them:
+ * for each mapping, line highlights (original, modified), then character
+ * highlights, then fillers.
+ *
+ * @param diff LinesDiff from compute_diff()
+ * @param original_lines Original file lines (the ones passed to compute_diff)
+ * @param original_count Number of original lines
+ * @param modified_lines Modified file lines
+ * @param modified_count Number of modified lines
+ * @return RenderPlan (caller must free with free_render_plan()), NULL on error
+ */
+DLL_EXPORT RenderPlan *compute_render_plan(const LinesDiff *diff, const char **original_lines,
+                                           int original_count, const char **modified_lines,
+                                           int modified_count);
+
+/**
+ * Free RenderPlan structure.
+ *
+ * @param plan RenderPlan to free (can be NULL)
+ */
+DLL_EXPORT void free_render_plan(RenderPlan *plan);
+
+#endif // RENDER_PLAN_H
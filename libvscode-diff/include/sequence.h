@@ -3,8 +3,20 @@
 
 #include "types.h"
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
+/**
+ * Largest combined length of two sequences diffed against each other.
+ *
+ * Offsets, lengths and diagonals are int, and Myers explores edit distances
+ * up to N + M, so N + M must fit in an int with room for the diagonal
+ * padding. Inputs over the limit never reach the engines: compute_diff()
+ * reports one whole-file change and refine_diff_char_level() keeps the
+ * line-level change (see DiffDegradation).
+ */
+#define SEQUENCE_MAX_COMBINED_LENGTH ((int64_t)INT32_MAX - 16)
+
 /**
  * Generic Sequence Interface
  * 
@@ -25,6 +37,14 @@ struct ISequence {
   // Opaque data pointer - actual sequence implementation
   void *data;
 
+  /**
+     * Optional: getElement() values as one contiguous array, or NULL
+     *
+     * Lets hot loops (Myers snake extension) compare runs of elements with
+     * the SIMD kernels instead of one vtable call per element.
+     */
+  const uint32_t *elements;
+
   // Function pointers (vtable pattern)
 
   /**
@@ -93,6 +113,8 @@ struct ISequence {
 typedef struct {
   const char **lines;     // Original lines (NOT owned - just a reference)
   uint32_t *trimmed_hash; // Perfect hash of each line after trimming (collision-free)
+  uint32_t *full_hash;    // Perfect hash of each untrimmed line (same map as trimmed_hash)
+  size_t *line_lengths;   // Byte length of each untrimmed line
   int length;
   bool ignore_whitespace; // If true, getElement returns hash of trimmed line
 } LineSequence;
@@ -105,12 +127,16 @@ typedef struct StringHashMap StringHashMap;
  * 
  * Uses a hash map to ensure collision-free hashing, matching VSCode's Map<string, number>.
  * The hash_map parameter allows sharing the map across sequences for consistent hashing.
+ *
+ * The untrimmed lines are interned in the same pass (full_hash), so exact line
+ * equality - within a sequence or across sequences sharing the map - is an
+ * integer compare instead of strcmp.
  * 
  * @param lines Array of line strings (must remain valid for lifetime of sequence)
  * @param length Number of lines
  * @param ignore_whitespace If true, trim whitespace before hashing
  * @param hash_map StringHashMap for perfect hashing (can be NULL to create internal map)
- * @return ISequence* that wraps the LineSequence
+ * @return ISequence* that wraps the LineSequence, or NULL if allocation failed
  * 
  * REUSED BY: Step 1 entry point, Step 2-3 optimization
  * 
@@ -119,6 +145,28 @@ typedef struct StringHashMap StringHashMap;
 ISequence *line_sequence_create(const char **lines, int length, bool ignore_whitespace,
                                 StringHashMap *hash_map);
 
+/**
+ * ArraySequence - Read-only ISequence over a slice of an element array
+ *
+ * For Myers runs over IDs computed elsewhere (interned chunks, reduced line
+ * sequences). Elements compare by value; there is no boundary scoring. The
+ * struct is usually a local, so destroy() does not free it.
+ */
+typedef struct {
+  ISequence iface;
+  const uint32_t *elements; // NOT owned
+  int length;
+} ArraySequence;
+
+/**
+ * Initialize an ArraySequence; use &seq->iface as the ISequence.
+ *
+ * @param seq Sequence to initialize
+ * @param elements Element values (must outlive the sequence)
+ * @param length Number of elements
+ */
+void array_sequence_init(ArraySequence *seq, const uint32_t *elements, int length);
+
 /**
  * CharSequence - Sequence of characters with line boundary tracking
  * 
@@ -0,0 +1,97 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * SIMD Kernels with Runtime CPU Dispatch
+ *
+ * The inner loops that scan long runs of bytes or 32-bit elements, with one
+ * implementation per instruction set. Every variant is compiled into the same
+ * library with per-function target attributes (no -mavx2 on the command line),
+ * and the best one the CPU supports is picked once, on first use. The same
+ * binary therefore runs on any x86-64 CPU and uses AVX2/AVX-512 where present.
+ *
+ * Non-x86 targets and compilers without target attributes get the scalar
+ * variant only. All variants return identical results.
+ *
+ * REUSED BY:
+ * - myers.c: snake extension (match_length_u32)
+ * - char_level.c: common prefix/suffix of refined regions (match_length_u32,
+ *   match_length_reverse_u32)
+ * - sequence.c: ASCII widening in char_sequence_create_from_range (widen_ascii)
+ * - compute_moved_lines.c: histogram similarity (sum_abs_diff_i32)
+ * - diff_tool.c: newline splitting (find_byte)
+ */
+
+typedef enum {
+  SIMD_SCALAR = 0,
+  SIMD_SSE2,
+  SIMD_AVX2,
+  SIMD_AVX512, // AVX-512F + AVX-512BW
+  SIMD_VARIANT_COUNT
+} SimdVariant;
+
+typedef struct {
+  /**
+   * Index of the first byte equal to c in s[0, n), or n if there is none.
+   */
+  size_t (*find_byte)(const char *s, size_t n, char c);
+
+  /**
+   * Length of the common prefix of a[0, n) and b[0, n).
+   */
+  int (*match_length_u32)(const uint32_t *a, const uint32_t *b, int n);
+
+  /**
+   * Length of the common suffix of a[0, n) and b[0, n).
+   */
+  int (*match_length_reverse_u32)(const uint32_t *a, const uint32_t *b, int n);
+
+  /**
+   * Widen the leading run of ASCII bytes (0x01-0x7F) of src into dst, one
+   * element per byte, stopping at the first NUL or non-ASCII byte or after n
+   * bytes. src[0, n) must be readable.
+   *
+   * @return Number of bytes widened
+   */
+  int (*widen_ascii)(const char *src, int n, uint32_t *dst);
+
+  /**
+   * Sum of |a[i] - b[i]| over [0, n). The sum must fit in an int.
+   */
+  int (*sum_abs_diff_i32)(const int *a, const int *b, int n);
+} SimdKernels;
+
+/**
+ * Kernels for the active variant (the best supported one unless forced).
+ * Thread-safe; detection runs on the first call.
+ */
+const SimdKernels *simd_kernels(void);
+
+/**
+ * Best variant this CPU and build support.
+ */
+SimdVariant simd_detect_variant(void);
+
+/**
+ * Select a variant for all later simd_kernels() calls, e.g. to compare
+ * variants in tests. Not safe to call while diffs run on other threads.
+ *
+ * @return false if the variant is not supported (the active one is kept)
+ */
+bool simd_force_variant(SimdVariant variant);
+
+/**
+ * Currently active variant.
+ */
+SimdVariant simd_active_variant(void);
+
+/**
+ * Display name of a variant ("scalar", "sse2", "avx2", "avx512").
+ */
+const char *simd_variant_name(SimdVariant variant);
+
+#endif // SIMD_KERNELS_H
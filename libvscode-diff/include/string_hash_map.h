@@ -28,9 +28,13 @@
 
 typedef struct StringHashMap StringHashMap;
 
+// Returned by string_hash_map_get_or_create() when allocation failed
+#define STRING_HASH_MAP_NO_MEMORY UINT32_MAX
+
 /**
  * Create a new string hash map
  * Initial capacity will be automatically adjusted
+ * Returns NULL if allocation failed
  */
 StringHashMap *string_hash_map_create(void);
 
@@ -44,7 +48,8 @@ StringHashMap *string_hash_map_create(void);
  * 
  * @param map The hash map
  * @param str The string to hash (will be copied internally)
- * @return Unique integer for this string
+ * @return Unique integer for this string, or STRING_HASH_MAP_NO_MEMORY if a new
+ *         entry could not be allocated
  */
 uint32_t string_hash_map_get_or_create(StringHashMap *map, const char *str);
 
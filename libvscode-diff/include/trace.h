@@ -0,0 +1,75 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "default_lines_diff_computer.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Timeline Tracing - per-stage and per-task begin/end events
+ *
+ * Records when each stage of compute_diff() (line alignment, refinement,
+ * line mappings, moves) and each character-level refinement task starts and
+ * ends, on which thread. The result opens in chrome://tracing or Perfetto and
+ * shows where the time goes and how well the OpenMP workers are balanced.
+ *
+ * Each thread appends to its own fixed-size ring buffer (oldest events are
+ * overwritten), so recording takes no locks and threads never share a cache
+ * line. Buffers are registered once per thread in a lock-free list.
+ *
+ * Only built with -DDIFF_ENABLE_TRACING=ON (DIFF_TRACING). Otherwise the
+ * DIFF_TRACE_* macros expand to nothing and diff_trace_start() returns false.
+ */
+
+#ifdef DIFF_TRACING
+
+/**
+ * Record one event on the calling thread (use the macros below).
+ *
+ * @param name Event name; must be a string literal (stored by pointer, not escaped)
+ * @param phase 'B' (begin) or 'E' (end)
+ * @param arg Task index shown in the event's args, or -1 for none
+ */
+void diff_trace_event(const char *name, char phase, int arg);
+
+#define DIFF_TRACE_BEGIN(name) diff_trace_event((name), 'B', -1)
+#define DIFF_TRACE_END(name) diff_trace_event((name), 'E', -1)
+#define DIFF_TRACE_BEGIN_ARG(name, arg) diff_trace_event((name), 'B', (arg))
+#define DIFF_TRACE_END_ARG(name, arg) diff_trace_event((name), 'E', (arg))
+
+#else
+
+#define DIFF_TRACE_BEGIN(name) ((void)0)
+#define DIFF_TRACE_END(name) ((void)0)
+#define DIFF_TRACE_BEGIN_ARG(name, arg) ((void)0)
+#define DIFF_TRACE_END_ARG(name, arg) ((void)0)
+
+#endif
+
+/**
+ * Start (or restart) recording. Events from a previous session are dropped.
+ *
+ * @param events_per_thread Ring buffer size per thread (0 = 65536; rounded up
+ *                          to a power of two)
+ * @return false if tracing was not compiled in or the size is too large
+ */
+DLL_EXPORT bool diff_trace_start(size_t events_per_thread);
+
+/**
+ * Stop recording. Recorded events are kept until the next diff_trace_start().
+ */
+DLL_EXPORT void diff_trace_stop(void);
+
+/**
+ * Write the recorded events as Chrome trace JSON ({"traceEvents": [...]}).
+ *
+ * Reads every thread's buffer without synchronization: call it after
+ * diff_trace_stop() once the traced compute_diff() calls have returned.
+ * Timestamps are microseconds since diff_trace_start().
+ *
+ * @param path Output file
+ * @return false if tracing was not compiled in or the file can't be written
+ */
+DLL_EXPORT bool diff_trace_write_json(const char *path);
+
+#endif // TRACE_H
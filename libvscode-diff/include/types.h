@@ -112,8 +112,27 @@ typedef struct {
   int max_computation_time_ms; // 0 = infinite timeout
   bool compute_moves;          // If true, compute moved blocks (not implemented yet)
   bool extend_to_subwords;     // If true, extend diffs to subword boundaries
+  int max_threads;             // Char-level refinement threads (0 = default, 1 = serial)
+  int64_t max_memory_bytes;    // Working memory per stage (0 = unlimited), see DiffDegradation
+  bool chunk_anchors;          // If true, anchor identical line chunks first (see line_anchors.h)
+  bool strip_char_affixes;     // If true, refine between common prefix/suffix only (see char_level.h)
+  bool line_level_only;        // If true, stop after line alignment (see refine_lines_diff())
 } DiffOptions;
 
+/**
+ * DiffDegradation - Cheaper strategies taken to honor max_memory_bytes, or
+ * because an input is too large for the 32-bit sequence indices.
+ * Bit flags reported in LinesDiff.degradations.
+ */
+typedef enum {
+  DIFF_DEGRADED_NONE = 0,
+  DIFF_DEGRADED_DP_TO_ND = 1 << 0,        // DP table over budget: O(ND) Myers used instead
+  DIFF_DEGRADED_LINEAR_SPACE = 1 << 1,    // O(ND) path storage over budget: linear-space Myers
+  DIFF_DEGRADED_NO_MOVES = 1 << 2,        // Move detection skipped
+  DIFF_DEGRADED_LINE_LEVEL_ONLY = 1 << 3, // Character refinement skipped for some regions
+  DIFF_DEGRADED_WHOLE_FILE = 1 << 4       // Too many lines to align: one whole-file change
+} DiffDegradation;
+
 /**
  * LinesDiff - Complete algorithm output
  * Maps to VSCode's LinesDiff interface.
@@ -122,6 +141,9 @@ typedef struct {
   DetailedLineRangeMappingArray changes;
   MovedTextArray moves;
   bool hit_timeout;
+  int degradations; // DiffDegradation flags (0 = full quality)
+  bool is_binary;   // Binary content: changed blocks only, no inner changes or moves
+  SequenceDiffArray *deferred_alignments; // line_level_only: line diffs kept for refine_lines_diff()
 } LinesDiff;
 
 #endif // DIFF_TYPES_H
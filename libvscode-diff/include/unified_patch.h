@@ -0,0 +1,65 @@
+#ifndef UNIFIED_PATCH_H
+#define UNIFIED_PATCH_H
+
+#include "default_lines_diff_computer.h"
+#include "types.h"
+#include <stddef.h>
+
+/**
+ * Unified Patch Builder - patch text for staging, unstaging and discarding hunks
+ *
+ * Emits a `git apply`-compatible unified diff for a selected subset of the
+ * changes in a LinesDiff. Only the selected changes end up in the patch;
+ * everything else is treated as unchanged, so the hunk headers describe the
+ * file with just those changes applied.
+ *
+ * The "base" side is the file the patch is applied to:
+ * - forward (`git apply [--cached]`, staging): the original side
+ * - reverse (`git apply --reverse`, unstaging/discarding): the modified side
+ * Context lines come from the base side and its line numbers are exact; the
+ * other side's numbers are shifted by the selected changes before each hunk.
+ *
+ * Lines are referenced in place and the patch is written into one allocation
+ * sized by a counting pass, so batches of hundreds of hunks cost one malloc.
+ */
+
+typedef struct {
+  const char *path;  // Repository-relative path for the ---/+++ headers
+  int context_lines; // Unchanged lines around each change (0 = --unidiff-zero hunks)
+  bool reverse;      // Patch will be reverse-applied: the modified side is the base
+} UnifiedPatchOptions;
+
+/**
+ * Build a unified patch for selected changes.
+ *
+ * Selected changes whose context ranges touch or overlap are merged into one
+ * hunk, like `git diff -U<n>`. Headers always carry explicit counts
+ * ("@@ -s,n +s,n @@"); an empty side uses the line before the change as its
+ * start, as git expects.
+ *
+ * @param diff LinesDiff from compute_diff() (only line ranges are used)
+ * @param change_indices 0-based indices into diff->changes (any order), or NULL for all
+ * @param index_count Number of indices
+ * @param original_lines Original file lines (the ones passed to compute_diff)
+ * @param original_count Number of original lines
+ * @param modified_lines Modified file lines
+ * @param modified_count Number of modified lines
+ * @param options Path, context and direction
+ * @param out_length Output: patch length in bytes (excluding the NUL terminator)
+ * @return NUL-terminated patch (free with free_unified_patch()), or NULL if
+ *         nothing was selected or an index is out of range
+ */
+DLL_EXPORT char *build_unified_patch(const LinesDiff *diff, const int *change_indices,
+                                     int index_count, const char **original_lines,
+                                     int original_count, const char **modified_lines,
+                                     int modified_count, const UnifiedPatchOptions *options,
+                                     size_t *out_length);
+
+/**
+ * Free a patch returned by build_unified_patch().
+ *
+ * @param patch Patch to free (can be NULL)
+ */
+DLL_EXPORT void free_unified_patch(char *patch);
+
+#endif // UNIFIED_PATCH_H
@@ -5,7 +5,9 @@
 #include <stdbool.h>
 #include <stdint.h>
 
-// Memory management helpers
+// Memory management helpers (create returns NULL, append false on allocation failure)
+SequenceDiffArray *sequence_diff_array_create(void);
+bool sequence_diff_array_append(SequenceDiffArray *arr, SequenceDiff diff);
 void sequence_diff_array_free(SequenceDiffArray *arr);
 void range_mapping_array_free(RangeMappingArray *arr);
 void detailed_line_range_mapping_array_free(DetailedLineRangeMappingArray *arr);
@@ -0,0 +1,84 @@
+/**
+ * Pluggable Allocator
+ *
+ * Thin dispatch to the installed DiffAllocator (see allocator.h).
+ * diff_calloc is built on malloc_fn, so allocators only implement three
+ * functions.
+ */
+
+#include "allocator.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void *default_malloc(size_t size, void *user_data) {
+  (void)user_data;
+  return malloc(size);
+}
+
+static void *default_realloc(void *ptr, size_t size, void *user_data) {
+  (void)user_data;
+  return realloc(ptr, size);
+}
+
+static void default_free(void *ptr, void *user_data) {
+  (void)user_data;
+  free(ptr);
+}
+
+static const DiffAllocator default_allocator = {
+    default_malloc, default_realloc, default_free, NULL};
+
+static DiffAllocator current_allocator = {default_malloc, default_realloc, default_free, NULL};
+
+void diff_set_allocator(const DiffAllocator *allocator) {
+  if (allocator && allocator->malloc_fn && allocator->realloc_fn && allocator->free_fn) {
+    current_allocator = *allocator;
+  } else {
+    current_allocator = default_allocator;
+  }
+}
+
+void *diff_malloc(size_t size) {
+  return current_allocator.malloc_fn(size, current_allocator.user_data);
+}
+
+static bool size_product_overflows(size_t count, size_t size) {
+  return size != 0 && count > SIZE_MAX / size;
+}
+
+void *diff_calloc(size_t count, size_t size) {
+  if (size_product_overflows(count, size)) {
+    return NULL;
+  }
+  void *ptr = current_allocator.malloc_fn(count * size, current_allocator.user_data);
+  if (ptr) {
+    memset(ptr, 0, count * size);
+  }
+  return ptr;
+}
+
+void *diff_realloc(void *ptr, size_t size) {
+  return current_allocator.realloc_fn(ptr, size, current_allocator.user_data);
+}
+
+void *diff_malloc_array(size_t count, size_t size) {
+  if (size_product_overflows(count, size)) {
+    return NULL;
+  }
+  return current_allocator.malloc_fn(count * size, current_allocator.user_data);
+}
+
+void *diff_realloc_array(void *ptr, size_t count, size_t size) {
+  if (size_product_overflows(count, size)) {
+    return NULL;
+  }
+  return current_allocator.realloc_fn(ptr, count * size, current_allocator.user_data);
+}
+
+void diff_free(void *ptr) {
+  if (ptr) {
+    current_allocator.free_fn(ptr, current_allocator.user_data);
+  }
+}
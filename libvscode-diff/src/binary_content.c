@@ -0,0 +1,81 @@
+/**
+ * Binary Content Detection (see binary_content.h)
+ */
+
+#include "binary_content.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Length of the valid UTF-8 sequence at p (1-4), or 0 if it is invalid.
+ * Overlong forms and surrogates are invalid (RFC 3629).
+ */
+static int utf8_sequence_length(const unsigned char *p, size_t available) {
+  unsigned char c = p[0];
+  int length;
+  unsigned char min2 = 0x80;
+  unsigned char max2 = 0xBF;
+  if (c < 0x80) {
+    return 1;
+  } else if (c >= 0xC2 && c <= 0xDF) {
+    length = 2;
+  } else if (c >= 0xE0 && c <= 0xEF) {
+    length = 3;
+    min2 = c == 0xE0 ? 0xA0 : 0x80;
+    max2 = c == 0xED ? 0x9F : 0xBF;
+  } else if (c >= 0xF0 && c <= 0xF4) {
+    length = 4;
+    min2 = c == 0xF0 ? 0x90 : 0x80;
+    max2 = c == 0xF4 ? 0x8F : 0xBF;
+  } else {
+    return 0;
+  }
+  if ((size_t)length > available || p[1] < min2 || p[1] > max2) {
+    return 0;
+  }
+  for (int i = 2; i < length; i++) {
+    if (p[i] < 0x80 || p[i] > 0xBF) {
+      return 0;
+    }
+  }
+  return length;
+}
+
+static bool is_text_control(unsigned char c) {
+  // Tab, vertical tab, form feed, carriage return, backspace, escape
+  return c == '\t' || c == '\v' || c == '\f' || c == '\r' || c == '\b' || c == 0x1B;
+}
+
+bool diff_lines_look_binary(const char **lines, int count) {
+  size_t scanned = 0;
+  size_t suspicious = 0;
+  for (int i = 0; i < count && scanned < DIFF_BINARY_SCAN_BYTES; i++) {
+    const unsigned char *p = (const unsigned char *)lines[i];
+    // Stop at the window end, but finish a UTF-8 sequence that straddles it
+    size_t budget = DIFF_BINARY_SCAN_BYTES - scanned;
+    size_t pos = 0;
+    while (p[pos] && pos < budget) {
+      unsigned char c = p[pos];
+      if (c == '\n') {
+        return true; // NUL byte
+      }
+      if (c < 0x20 || c == 0x7F) {
+        suspicious += is_text_control(c) ? 0 : 1;
+        pos++;
+        continue;
+      }
+      size_t available = 1;
+      while (available < 4 && p[pos + available]) {
+        available++;
+      }
+      int length = utf8_sequence_length(p + pos, available);
+      if (length == 0) {
+        suspicious++;
+        length = 1;
+      }
+      pos += (size_t)length;
+    }
+    scanned += pos + 1; // Line feed
+  }
+  return suspicious * 10 > scanned;
+}
@@ -11,11 +11,15 @@
  */
 
 #include "char_level.h"
+#include "allocator.h"
+#include "cost_model.h"
+#include "long_line.h"
 #include "myers.h"
 #include "optimize.h"
 #include "sequence.h"
+#include "simd_kernels.h"
 #include "types.h"
-#include <ctype.h>
+#include "utils.h"
 #include <limits.h>
 #include <math.h>
 #include <stdbool.h>
@@ -41,7 +45,12 @@ static int safe_line_length(const char **lines, int line_count, int line_number)
     return 0;
   }
   const char *line = lines[line_number - 1];
-  return line ? (int)strlen(line) : 0;
+  if (!line) {
+    return 0;
+  }
+  // Columns are int: a line over 2GB is clamped (its refinement is skipped)
+  size_t len = strlen(line);
+  return len < INT_MAX ? (int)len : INT_MAX - 1;
 }
 
 static void normalize_position(int *line, int *column, const char **lines, int line_count) {
@@ -185,13 +194,14 @@ static RangeMapping line_range_mapping_to_range_mapping2(LineRange original, Lin
  * Create RangeMappingArray with initial capacity
  */
 static RangeMappingArray *create_range_mapping_array(int capacity) {
-  RangeMappingArray *arr = (RangeMappingArray *)malloc(sizeof(RangeMappingArray));
+  RangeMappingArray *arr = (RangeMappingArray *)diff_malloc(sizeof(RangeMappingArray));
   if (!arr)
     return NULL;
 
-  arr->mappings = (RangeMapping *)malloc(sizeof(RangeMapping) * (size_t)capacity);
+  capacity = max_int(capacity, 1);
+  arr->mappings = (RangeMapping *)diff_malloc_array((size_t)capacity, sizeof(RangeMapping));
   if (!arr->mappings) {
-    free(arr);
+    diff_free(arr);
     return NULL;
   }
 
@@ -206,7 +216,7 @@ static RangeMappingArray *create_range_mapping_array(int capacity) {
 static bool grow_range_mapping_array(RangeMappingArray *arr) {
   int new_capacity = arr->capacity * 2;
   RangeMapping *new_mappings =
-      (RangeMapping *)realloc(arr->mappings, sizeof(RangeMapping) * (size_t)new_capacity);
+      (RangeMapping *)diff_realloc_array(arr->mappings, (size_t)new_capacity, sizeof(RangeMapping));
   if (!new_mappings)
     return false;
 
@@ -241,14 +251,31 @@ typedef struct {
   int offset2;
 } OffsetPair;
 
+/**
+ * Allocate an empty SequenceDiffArray with room for capacity diffs (NULL if
+ * out of memory).
+ */
+static SequenceDiffArray *create_sequence_diff_array(int capacity) {
+  SequenceDiffArray *result = sequence_diff_array_create();
+  if (!result)
+    return NULL;
+  result->diffs = (SequenceDiff *)diff_malloc_array((size_t)max_int(capacity, 1),
+                                                    sizeof(SequenceDiff));
+  if (!result->diffs) {
+    diff_free(result);
+    return NULL;
+  }
+  result->capacity = max_int(capacity, 1);
+  return result;
+}
+
 /**
  * Invert diffs to get equal mappings - VSCode SequenceDiff.invert()
  */
 static SequenceDiffArray *invert_diffs(const SequenceDiffArray *diffs, int length1, int length2) {
-  SequenceDiffArray *result = (SequenceDiffArray *)malloc(sizeof(SequenceDiffArray));
-  result->capacity = diffs->count + 2;
-  result->diffs = (SequenceDiff *)malloc(sizeof(SequenceDiff) * (size_t)result->capacity);
-  result->count = 0;
+  SequenceDiffArray *result = create_sequence_diff_array(diffs->count + 2);
+  if (!result)
+    return NULL;
 
   int prev_end1 = 0;
   int prev_end2 = 0;
@@ -283,10 +310,9 @@ static SequenceDiffArray *invert_diffs(const SequenceDiffArray *diffs, int lengt
  * Merge two sorted diff arrays - VSCode mergeSequenceDiffs()
  */
 static SequenceDiffArray *merge_diffs(SequenceDiffArray *arr1, SequenceDiffArray *arr2) {
-  SequenceDiffArray *result = (SequenceDiffArray *)malloc(sizeof(SequenceDiffArray));
-  result->capacity = arr1->count + arr2->count;
-  result->diffs = (SequenceDiff *)malloc(sizeof(SequenceDiff) * (size_t)result->capacity);
-  result->count = 0;
+  SequenceDiffArray *result = create_sequence_diff_array(arr1->count + arr2->count);
+  if (!result)
+    return NULL;
 
   int i1 = 0, i2 = 0;
 
@@ -335,12 +361,14 @@ typedef struct {
  * 
  * NOTE: This modifies the queue_pos to consume equal mappings from the shared queue,
  * matching VSCode's closure-based approach where scanWord modifies the same array.
+ *
+ * @return false if the word could not be added (out of memory)
  */
-static void scan_word(ScanWordContext *ctx, int offset1, int offset2,
+static bool scan_word(ScanWordContext *ctx, int offset1, int offset2,
                       SequenceDiffArray *all_equal_mappings, int *queue_start_pos,
                       const SequenceDiff *current_equal_mapping) {
   if (offset1 < *ctx->last_offset1 || offset2 < *ctx->last_offset2) {
-    return;
+    return true;
   }
 
   int w1_start, w1_end, w2_start, w2_end;
@@ -355,7 +383,7 @@ static void scan_word(ScanWordContext *ctx, int offset1, int offset2,
   }
 
   if (!found1 || !found2) {
-    return;
+    return true;
   }
 
   SequenceDiff word = {w1_start, w1_end, w2_start, w2_end};
@@ -441,33 +469,32 @@ static void scan_word(ScanWordContext *ctx, int offset1, int offset2,
 
   bool should_extend = (ctx->force && equal_len < word_len) || (equal_len < word_len * 2.0 / 3.0);
 
-  if (should_extend) {
-    if (ctx->additional->count >= ctx->additional->capacity) {
-      ctx->additional->capacity *= 2;
-      ctx->additional->diffs = (SequenceDiff *)realloc(
-          ctx->additional->diffs, sizeof(SequenceDiff) * (size_t)ctx->additional->capacity);
-    }
-    ctx->additional->diffs[ctx->additional->count++] = word;
+  if (should_extend && !sequence_diff_array_append(ctx->additional, word)) {
+    return false;
   }
 
   *ctx->last_offset1 = word.seq1_end;
   *ctx->last_offset2 = word.seq2_end;
+  return true;
 }
 
 /**
  * Extend diffs to entire word boundaries if appropriate - VSCode Parity
  * 
  * This is the complex function from VSCode's heuristicSequenceOptimizations.ts
+ * Returns a new array (diffs is not modified), or NULL if out of memory.
  */
 static SequenceDiffArray *extend_diffs_to_entire_word(const CharSequence *seq1,
                                                       const CharSequence *seq2,
                                                       const SequenceDiffArray *diffs,
                                                       bool use_subwords, bool force) {
   SequenceDiffArray *equal_mappings = invert_diffs(diffs, seq1->length, seq2->length);
-  SequenceDiffArray *additional = (SequenceDiffArray *)malloc(sizeof(SequenceDiffArray));
-  additional->capacity = 100;
-  additional->diffs = (SequenceDiff *)malloc(sizeof(SequenceDiff) * (size_t)additional->capacity);
-  additional->count = 0;
+  SequenceDiffArray *additional = create_sequence_diff_array(100);
+  if (!equal_mappings || !additional) {
+    sequence_diff_array_free(equal_mappings);
+    sequence_diff_array_free(additional);
+    return NULL;
+  }
 
   int last_offset1 = 0;
   int last_offset2 = 0;
@@ -485,7 +512,8 @@ static SequenceDiffArray *extend_diffs_to_entire_word(const CharSequence *seq1,
   // We simulate with a position that advances. The key is that scan_word can also
   // advance queue_pos (consuming mappings), matching VSCode's closure-based approach.
   int queue_pos = 0;
-  while (queue_pos < equal_mappings->count) {
+  bool ok = true;
+  while (ok && queue_pos < equal_mappings->count) {
     const SequenceDiff current = equal_mappings->diffs[queue_pos];
     queue_pos++; // Consume current mapping (like shift())
 
@@ -495,24 +523,23 @@ static SequenceDiffArray *extend_diffs_to_entire_word(const CharSequence *seq1,
 
     // Scan at start of equal region
     // Pass queue_pos as the start of remaining items (what's left after shift)
-    scan_word(&ctx, current.seq1_start, current.seq2_start, equal_mappings, &queue_pos, &current);
+    ok = scan_word(&ctx, current.seq1_start, current.seq2_start, equal_mappings, &queue_pos,
+                   &current);
 
     // Scan at end of equal region (one char before end)
     // VSCode: next.getEndExclusives().delta(-1)
-    if (current.seq1_end > current.seq1_start + 1) {
-      scan_word(&ctx, current.seq1_end - 1, current.seq2_end - 1, equal_mappings, &queue_pos,
-                &current);
+    if (ok && current.seq1_end > current.seq1_start + 1) {
+      ok = scan_word(&ctx, current.seq1_end - 1, current.seq2_end - 1, equal_mappings, &queue_pos,
+                     &current);
     }
   }
 
   // Merge original diffs with additional word extensions
-  SequenceDiffArray *merged = merge_diffs((SequenceDiffArray *)diffs, additional);
+  SequenceDiffArray *merged = ok ? merge_diffs((SequenceDiffArray *)diffs, additional) : NULL;
 
   // Cleanup
-  free(equal_mappings->diffs);
-  free(equal_mappings);
-  free(additional->diffs);
-  free(additional);
+  sequence_diff_array_free(equal_mappings);
+  sequence_diff_array_free(additional);
 
   return merged;
 }
@@ -521,10 +548,24 @@ static SequenceDiffArray *extend_diffs_to_entire_word(const CharSequence *seq1,
 // removeVeryShortMatchingTextBetweenLongDiffs() - VSCode Parity
 // =============================================================================
 
+/**
+ * Shrink [*start, *end) past whitespace at both ends (JS String.trim()).
+ *
+ * Works on the elements directly: only the whitespace runs at the ends are
+ * visited, so checking a slice of a long line does not copy the line.
+ */
+static void trim_whitespace_range(const CharSequence *seq, int *start, int *end) {
+  while (*start < *end && is_unicode_whitespace(seq->elements[*start]))
+    (*start)++;
+  while (*end > *start && is_unicode_whitespace(seq->elements[*end - 1]))
+    (*end)--;
+}
+
 /**
  * Remove very short matching text between long diffs - VSCode Parity
  * 
  * Complex heuristic from VSCode's heuristicSequenceOptimizations.ts
+ * Returns diffs, or NULL if out of memory (diffs is then still valid).
  */
 static SequenceDiffArray *remove_very_short_text(const CharSequence *seq1, const CharSequence *seq2,
                                                  SequenceDiffArray *diffs) {
@@ -537,7 +578,10 @@ static SequenceDiffArray *remove_very_short_text(const CharSequence *seq1, const
 
   do {
     should_repeat = false;
-    SequenceDiff *result = (SequenceDiff *)malloc(sizeof(SequenceDiff) * (size_t)diffs->capacity);
+    SequenceDiff *result =
+        (SequenceDiff *)diff_malloc_array((size_t)diffs->capacity, sizeof(SequenceDiff));
+    if (!result)
+      return NULL;
     int result_count = 0;
 
     result[result_count++] = diffs->diffs[0];
@@ -565,33 +609,22 @@ static SequenceDiffArray *remove_very_short_text(const CharSequence *seq1, const
         continue;
       }
 
-      // Get unchanged text and check length
-      char *unchanged_text = char_sequence_get_text(seq1, unchanged_start, unchanged_end);
-      if (!unchanged_text) {
-        result[result_count++] = cur;
-        continue;
-      }
+      // Trim and check (in place, without copying the text)
+      int trimmed_start = unchanged_start;
+      int trimmed_end = unchanged_end;
+      trim_whitespace_range(seq1, &trimmed_start, &trimmed_end);
 
-      // Trim and check
-      char *trimmed = unchanged_text;
-      while (*trimmed && isspace(*trimmed))
-        trimmed++;
-      char *end = trimmed + strlen(trimmed) - 1;
-      while (end > trimmed && isspace(*end))
-        *end-- = '\0';
-
-      bool short_text = (strlen(trimmed) <= 20);
+      bool short_text = (trimmed_end - trimmed_start <= 20);
 
       // Count newlines
       int newline_count = 0;
-      for (char *p = trimmed; *p; p++) {
-        if (*p == '\n' || *p == '\r')
+      for (int k = trimmed_start; k < trimmed_end; k++) {
+        uint32_t c = seq1->elements[k];
+        if (c == '\n' || c == '\r')
           newline_count++;
       }
       bool single_line = (newline_count <= 1);
 
-      free(unchanged_text);
-
       if (!short_text || !single_line) {
         result[result_count++] = cur;
         continue;
@@ -634,7 +667,7 @@ static SequenceDiffArray *remove_very_short_text(const CharSequence *seq1, const
       }
     }
 
-    free(diffs->diffs);
+    diff_free(diffs->diffs);
     diffs->diffs = result;
     diffs->count = result_count;
     diffs->capacity = diffs->capacity; // Keep same capacity
@@ -642,7 +675,10 @@ static SequenceDiffArray *remove_very_short_text(const CharSequence *seq1, const
   } while (counter++ < 10 && should_repeat);
 
   // Second phase: Remove short prefixes/suffixes (VSCode's forEachWithNeighbors logic)
-  SequenceDiff *new_diffs = (SequenceDiff *)malloc(sizeof(SequenceDiff) * (size_t)(diffs->capacity + 10));
+  SequenceDiff *new_diffs =
+      (SequenceDiff *)diff_malloc_array((size_t)diffs->capacity + 10, sizeof(SequenceDiff));
+  if (!new_diffs)
+    return NULL;
   int new_count = 0;
 
   for (int i = 0; i < diffs->count; i++) {
@@ -664,50 +700,34 @@ static SequenceDiffArray *remove_very_short_text(const CharSequence *seq1, const
     // Check prefix
     if (full_start < cur->seq1_start && is_large_diff) {
       int text_len = cur->seq1_start - full_start;
-      char *prefix = char_sequence_get_text(seq1, full_start, cur->seq1_start);
-      if (prefix) {
-        // Trim whitespace
-        const char *start = prefix;
-        const char *end = prefix + strlen(prefix) - 1;
-        while (*start && isspace((unsigned char)*start))
-          start++;
-        while (end > start && isspace((unsigned char)*end))
-          end--;
-
-        int trimmed_len = (start > end) ? 0 : (int)(end - start + 1);
-        bool should_include = (text_len > 0 && trimmed_len <= 3);
-
-        if (should_include) {
-          int prefix_len = cur->seq1_start - full_start;
-          new_diff.seq1_start -= prefix_len;
-          new_diff.seq2_start -= prefix_len;
-        }
-        free(prefix);
+      int trimmed_start = full_start;
+      int trimmed_end = cur->seq1_start;
+      trim_whitespace_range(seq1, &trimmed_start, &trimmed_end);
+
+      int trimmed_len = trimmed_end - trimmed_start;
+      bool should_include = (text_len > 0 && trimmed_len <= 3);
+
+      if (should_include) {
+        int prefix_len = cur->seq1_start - full_start;
+        new_diff.seq1_start -= prefix_len;
+        new_diff.seq2_start -= prefix_len;
       }
     }
 
     // Check suffix
     if (cur->seq1_end < full_end && is_large_diff) {
       int text_len = full_end - cur->seq1_end;
-      char *suffix = char_sequence_get_text(seq1, cur->seq1_end, full_end);
-      if (suffix) {
-        // Trim whitespace
-        const char *start = suffix;
-        const char *end = suffix + strlen(suffix) - 1;
-        while (*start && isspace((unsigned char)*start))
-          start++;
-        while (end > start && isspace((unsigned char)*end))
-          end--;
-
-        int trimmed_len = (start > end) ? 0 : (int)(end - start + 1);
-        bool should_include = (text_len > 0 && trimmed_len <= 3);
-
-        if (should_include) {
-          int suffix_len = full_end - cur->seq1_end;
-          new_diff.seq1_end += suffix_len;
-          new_diff.seq2_end += suffix_len;
-        }
-        free(suffix);
+      int trimmed_start = cur->seq1_end;
+      int trimmed_end = full_end;
+      trim_whitespace_range(seq1, &trimmed_start, &trimmed_end);
+
+      int trimmed_len = trimmed_end - trimmed_start;
+      bool should_include = (text_len > 0 && trimmed_len <= 3);
+
+      if (should_include) {
+        int suffix_len = full_end - cur->seq1_end;
+        new_diff.seq1_end += suffix_len;
+        new_diff.seq2_end += suffix_len;
       }
     }
 
@@ -737,7 +757,7 @@ static SequenceDiffArray *remove_very_short_text(const CharSequence *seq1, const
     new_diffs[new_count++] = new_diff;
   }
 
-  free(diffs->diffs);
+  diff_free(diffs->diffs);
   diffs->diffs = new_diffs;
   diffs->count = new_count;
   diffs->capacity = diffs->capacity + 10;
@@ -780,6 +800,111 @@ static RangeMapping translate_diff_to_range(const CharSequence *seq1, const Char
   return mapping;
 }
 
+/**
+ * CharSequence length for a character range (upper bound: whole lines, one
+ * UTF-16 unit per byte).
+ */
+static int64_t char_range_max_length(const CharRange *range, const char **lines, int line_count) {
+  int64_t chars = 0;
+  for (int line = range->start_line; line <= range->end_line; line++) {
+    if (line >= 1 && line <= line_count && lines[line - 1]) {
+      chars += (int64_t)strlen(lines[line - 1]);
+    }
+    chars++;
+  }
+  return chars;
+}
+
+/**
+ * Keep a region's line-level change as its only inner change (character
+ * refinement skipped).
+ */
+static RangeMappingArray *line_level_only(const RangeMapping *base_range,
+                                          const CharLevelOptions *options) {
+  if (options->out_degradations)
+    *options->out_degradations |= DIFF_DEGRADED_LINE_LEVEL_ONLY;
+  RangeMappingArray *result = create_range_mapping_array(1);
+  if (result) {
+    add_range_mapping(result, base_range);
+  }
+  return result;
+}
+
+/**
+ * Step 2 engines: VSCode uses DP if length < 500, otherwise Myers O(ND)
+ * (diff_select_engine() also skips O(ND) searches that cannot finish in time)
+ *
+ * With options->strip_affixes, the common prefix and suffix are cut off
+ * first and the engine is picked and run on the rest: a long line with one
+ * token changed costs a DP table over the token instead of over the line.
+ */
+static SequenceDiffArray *run_char_diff_engine(const ISequence *seq1, const ISequence *seq2,
+                                               const CharLevelOptions *options,
+                                               bool *hit_timeout) {
+  int prefix = 0;
+  ArraySequence middle1;
+  ArraySequence middle2;
+  if (options->strip_affixes && seq1->elements && seq2->elements) {
+    const SimdKernels *simd = simd_kernels();
+    int len1 = seq1->getLength(seq1);
+    int len2 = seq2->getLength(seq2);
+    prefix = simd->match_length_u32(seq1->elements, seq2->elements, min_int(len1, len2));
+    int rest = min_int(len1, len2) - prefix;
+    int suffix = simd->match_length_reverse_u32(seq1->elements + len1 - rest,
+                                                seq2->elements + len2 - rest, rest);
+    array_sequence_init(&middle1, seq1->elements + prefix, len1 - prefix - suffix);
+    array_sequence_init(&middle2, seq2->elements + prefix, len2 - prefix - suffix);
+    seq1 = &middle1.iface;
+    seq2 = &middle2.iface;
+  }
+
+  SequenceDiffArray *diffs;
+  DiffEngine engine = diff_select_engine(seq1, seq2, 500, options->timeout_ms, NULL);
+  if (engine == DIFF_ENGINE_DP && options->max_memory_bytes > 0 &&
+      myers_dp_memory_bytes(seq1->getLength(seq1), seq2->getLength(seq2), false) >
+          options->max_memory_bytes) {
+    engine = DIFF_ENGINE_ND;
+    if (options->out_degradations)
+      *options->out_degradations |= DIFF_DEGRADED_DP_TO_ND;
+  }
+
+  if (engine == DIFF_ENGINE_DP) {
+    // Use DP algorithm for small character sequences
+    diffs = myers_dp_diff_algorithm(seq1, seq2, options->timeout_ms, hit_timeout, NULL, NULL);
+  } else if (engine == DIFF_ENGINE_ND) {
+    // Use O(ND) algorithm for large character sequences
+    bool hit_memory_limit = false;
+    diffs = myers_nd_bounded_diff_algorithm(seq1, seq2, options->timeout_ms,
+                                            options->max_memory_bytes, hit_timeout,
+                                            &hit_memory_limit);
+    if (hit_memory_limit && options->out_degradations)
+      *options->out_degradations |= DIFF_DEGRADED_LINEAR_SPACE;
+  } else {
+    // Exact search cannot finish in time: go straight to the timeout fallback
+    diffs = myers_nd_capped_diff_algorithm(seq1, seq2);
+    *hit_timeout = true;
+  }
+
+  // Back to offsets of the full sequences
+  for (int i = 0; diffs && prefix > 0 && i < diffs->count; i++) {
+    diffs->diffs[i].seq1_start += prefix;
+    diffs->diffs[i].seq1_end += prefix;
+    diffs->diffs[i].seq2_start += prefix;
+    diffs->diffs[i].seq2_end += prefix;
+  }
+  return diffs;
+}
+
+RangeMapping line_diff_to_range_mapping(const SequenceDiff *line_diff, const char **lines_a,
+                                        int len_a, const char **lines_b, int len_b) {
+  LineRange original_line_range = {.start_line = line_diff->seq1_start + 1,
+                                   .end_line = line_diff->seq1_end + 1};
+  LineRange modified_line_range = {.start_line = line_diff->seq2_start + 1,
+                                   .end_line = line_diff->seq2_end + 1};
+  return line_range_mapping_to_range_mapping2(original_line_range, modified_line_range, lines_a,
+                                              len_a, lines_b, len_b);
+}
+
 /**
  * Main refinement function - VSCode's refineDiff() - FULL PARITY
  */
@@ -796,13 +921,17 @@ RangeMappingArray *refine_diff_char_level(const SequenceDiff *line_diff, const c
   }
 
   // Step 1: Map line diff to character ranges using VSCode's toRangeMapping2 logic
-  LineRange original_line_range = {.start_line = line_diff->seq1_start + 1,
-                                   .end_line = line_diff->seq1_end + 1};
-  LineRange modified_line_range = {.start_line = line_diff->seq2_start + 1,
-                                   .end_line = line_diff->seq2_end + 1};
-
-  RangeMapping base_range = line_range_mapping_to_range_mapping2(
-      original_line_range, modified_line_range, lines_a, len_a, lines_b, len_b);
+  RangeMapping base_range = line_diff_to_range_mapping(line_diff, lines_a, len_a, lines_b, len_b);
+
+  // Character sequences alone exceed the budget or the engines' int range:
+  // keep the line-level change
+  int64_t max_chars = char_range_max_length(&base_range.original, lines_a, len_a) +
+                      char_range_max_length(&base_range.modified, lines_b, len_b);
+  if (max_chars > SEQUENCE_MAX_COMBINED_LENGTH ||
+      (options->max_memory_bytes > 0 &&
+       max_chars * (int64_t)sizeof(uint32_t) > options->max_memory_bytes)) {
+    return line_level_only(&base_range, options);
+  }
 
   ISequence *seq1_iface = char_sequence_create_from_range(lines_a, len_a, &base_range.original,
                                                           options->consider_whitespace_changes);
@@ -810,11 +939,12 @@ RangeMappingArray *refine_diff_char_level(const SequenceDiff *line_diff, const c
                                                           options->consider_whitespace_changes);
 
   if (!seq1_iface || !seq2_iface) {
+    // Out of memory: degrade like an over-budget region
     if (seq1_iface)
       seq1_iface->destroy(seq1_iface);
     if (seq2_iface)
       seq2_iface->destroy(seq2_iface);
-    return NULL;
+    return line_level_only(&base_range, options);
   }
 
   // Extract CharSequence from ISequence
@@ -826,19 +956,14 @@ RangeMappingArray *refine_diff_char_level(const SequenceDiff *line_diff, const c
   int base_line2 = base_range.modified.start_line - 1;
 
   // Step 2: Run Myers on characters
-  // VSCode uses DP if length < 500, otherwise Myers O(ND)
-  // We now have automatic selection based on size
-  int len1 = seq1_iface->getLength(seq1_iface);
-  int len2 = seq2_iface->getLength(seq2_iface);
+  // Minified / generated text goes through content-defined chunks first
   bool hit_timeout = false;
-  SequenceDiffArray *diffs;
-
-  if (len1 + len2 < 500) {
-    // Use DP algorithm for small character sequences
-    diffs = myers_dp_diff_algorithm(seq1_iface, seq2_iface, options->timeout_ms, &hit_timeout, NULL, NULL);
-  } else {
-    // Use O(ND) algorithm for large character sequences
-    diffs = myers_nd_diff_algorithm(seq1_iface, seq2_iface, options->timeout_ms, &hit_timeout);
+  SequenceDiffArray *diffs = NULL;
+  if (long_line_mode_applies(seq1, seq2)) {
+    diffs = long_line_diff(seq1_iface, seq2_iface, options->timeout_ms, &hit_timeout);
+  }
+  if (!diffs) {
+    diffs = run_char_diff_engine(seq1_iface, seq2_iface, options, &hit_timeout);
   }
 
   if (!diffs) {
@@ -848,38 +973,35 @@ RangeMappingArray *refine_diff_char_level(const SequenceDiff *line_diff, const c
   }
 
   // Step 3: optimizeSequenceDiffs() - Reuse Step 2 optimization
-  optimize_sequence_diffs(seq1_iface, seq2_iface, diffs);
+  bool ok = optimize_sequence_diffs(seq1_iface, seq2_iface, diffs) != NULL;
 
   // Step 4: extendDiffsToEntireWordIfAppropriate() - Word boundaries
-  SequenceDiffArray *extended = extend_diffs_to_entire_word(seq1, seq2, diffs, false, false);
-  free(diffs->diffs);
-  free(diffs);
-  diffs = extended;
-
   // Step 5: extendDiffsToEntireWordIfAppropriate() for subwords (if enabled)
-  if (options->extend_to_subwords) {
-    extended = extend_diffs_to_entire_word(seq1, seq2, diffs, true, true);
-    free(diffs->diffs);
-    free(diffs);
-    diffs = extended;
+  for (int pass = 0; ok && pass < (options->extend_to_subwords ? 2 : 1); pass++) {
+    SequenceDiffArray *extended =
+        extend_diffs_to_entire_word(seq1, seq2, diffs, pass == 1, pass == 1);
+    if (extended) {
+      sequence_diff_array_free(diffs);
+      diffs = extended;
+    }
+    ok = extended != NULL;
   }
 
   // Step 6: removeShortMatches() - Remove ≤2 char gaps
-  remove_short_matches(seq1_iface, seq2_iface, diffs);
-
   // Step 7: removeVeryShortMatchingTextBetweenLongDiffs()
-  remove_very_short_text(seq1, seq2, diffs);
+  ok = ok && remove_short_matches(seq1_iface, seq2_iface, diffs) &&
+       remove_very_short_text(seq1, seq2, diffs);
 
   // Step 8: Translate to RangeMapping with (line, column) positions
-  RangeMappingArray *result = create_range_mapping_array(diffs->count);
+  RangeMappingArray *result = ok ? create_range_mapping_array(diffs->count) : NULL;
   if (!result) {
-    free(diffs->diffs);
-    free(diffs);
+    sequence_diff_array_free(diffs);
     seq1_iface->destroy(seq1_iface);
     seq2_iface->destroy(seq2_iface);
     return NULL;
   }
 
+  // Capacity covers every diff, so adding cannot fail
   for (int i = 0; i < diffs->count; i++) {
     RangeMapping mapping =
         translate_diff_to_range(seq1, seq2, &diffs->diffs[i], base_line1, base_line2);
@@ -892,8 +1014,7 @@ RangeMappingArray *refine_diff_char_level(const SequenceDiff *line_diff, const c
   }
 
   // Cleanup
-  free(diffs->diffs);
-  free(diffs);
+  sequence_diff_array_free(diffs);
   seq1_iface->destroy(seq1_iface);
   seq2_iface->destroy(seq2_iface);
 
@@ -919,12 +1040,15 @@ RangeMappingArray *refine_all_diffs_char_level(const SequenceDiffArray *line_dif
 
   RangeMappingArray *result =
       create_range_mapping_array(line_diffs->count > 0 ? line_diffs->count * 4 : 10);
+  if (!result) {
+    return NULL;
+  }
 
   // Track if any refinement hit timeout
   bool any_timeout = false;
 
   // Refine each line diff
-  for (int i = 0; i < line_diffs->count; i++) {
+  for (int i = 0; result && i < line_diffs->count; i++) {
     bool local_timeout = false;
     RangeMappingArray *char_mappings = refine_diff_char_level(
         &line_diffs->diffs[i], lines_a, len_a, lines_b, len_b, options, &local_timeout);
@@ -934,11 +1058,14 @@ RangeMappingArray *refine_all_diffs_char_level(const SequenceDiffArray *line_dif
       any_timeout = true;
     }
 
-    if (char_mappings) {
-      for (int j = 0; j < char_mappings->count; j++) {
-        add_range_mapping(result, &char_mappings->mappings[j]);
-      }
-      free_range_mapping_array(char_mappings);
+    bool ok = char_mappings != NULL;
+    for (int j = 0; ok && j < char_mappings->count; j++) {
+      ok = add_range_mapping(result, &char_mappings->mappings[j]);
+    }
+    free_range_mapping_array(char_mappings);
+    if (!ok) {
+      free_range_mapping_array(result);
+      result = NULL;
     }
   }
 
@@ -960,6 +1087,6 @@ void free_range_mapping_array(RangeMappingArray *arr) {
   if (!arr)
     return;
   if (arr->mappings)
-    free(arr->mappings);
-  free(arr);
+    diff_free(arr->mappings);
+  diff_free(arr);
 }
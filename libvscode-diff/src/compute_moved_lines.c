@@ -13,8 +13,12 @@
 #include <string.h>
 
 #include "compute_moved_lines.h"
+#include "allocator.h"
 #include "myers.h"
+#include "progress.h"
+#include "platform.h"
 #include "sequence.h"
+#include "simd_kernels.h"
 #include "utils.h"
 
 // ============================================================================
@@ -24,9 +28,12 @@
 typedef struct {
   int timeout_ms;
   int64_t start_time_ms;
+  bool out_of_memory; // An allocation failed; stops the search like a timeout
 } MoveTimeout;
 
 static bool timeout_is_valid(const MoveTimeout *t) {
+  if (t->out_of_memory || diff_progress_cancelled())
+    return false;
   if (t->timeout_ms <= 0)
     return true;
   return (get_current_time_ms() - t->start_time_ms) < t->timeout_ms;
@@ -70,16 +77,22 @@ static void ma_init(MoveArray *a) {
   a->cap = 0;
 }
 
-static void ma_push(MoveArray *a, MovedText m) {
+// Returns false (array unchanged) if growing it fails
+static bool ma_push(MoveArray *a, MovedText m) {
   if (a->count >= a->cap) {
-    a->cap = a->cap == 0 ? 8 : a->cap * 2;
-    a->items = (MovedText *)realloc(a->items, (size_t)a->cap * sizeof(MovedText));
+    int cap = a->cap == 0 ? 8 : a->cap * 2;
+    MovedText *items = (MovedText *)diff_realloc_array(a->items, (size_t)cap, sizeof(MovedText));
+    if (!items)
+      return false;
+    a->items = items;
+    a->cap = cap;
   }
   a->items[a->count++] = m;
+  return true;
 }
 
 static void ma_free(MoveArray *a) {
-  free(a->items);
+  diff_free(a->items);
   a->items = NULL;
   a->count = 0;
   a->cap = 0;
@@ -103,11 +116,15 @@ typedef struct {
   int *histogram; // dynamically allocated [HIST_SIZE]
 } LineRangeFragment;
 
+// histogram is NULL if it could not be allocated
 static LineRangeFragment lrf_create(LineRange range, const char **lines, int source_idx) {
   LineRangeFragment f;
   f.range = range;
   f.source_idx = source_idx;
-  f.histogram = (int *)calloc(HIST_SIZE, sizeof(int));
+  f.total_count = 0;
+  f.histogram = (int *)diff_calloc(HIST_SIZE, sizeof(int));
+  if (!f.histogram)
+    return f;
   int counter = 0;
   for (int i = range.start_line - 1; i < range.end_line - 1; i++) {
     const char *line = lines[i];
@@ -124,18 +141,12 @@ static LineRangeFragment lrf_create(LineRange range, const char **lines, int sou
 }
 
 static double lrf_compute_similarity(const LineRangeFragment *a, const LineRangeFragment *b) {
-  int sum_diff = 0;
-  for (int i = 0; i < HIST_SIZE; i++) {
-    int va = a->histogram[i];
-    int vb = b->histogram[i];
-    int d = va - vb;
-    sum_diff += d < 0 ? -d : d;
-  }
+  int sum_diff = simd_kernels()->sum_abs_diff_i32(a->histogram, b->histogram, HIST_SIZE);
   return 1.0 - (double)sum_diff / (double)(a->total_count + b->total_count);
 }
 
 static void lrf_free(LineRangeFragment *f) {
-  free(f->histogram);
+  diff_free(f->histogram);
   f->histogram = NULL;
 }
 
@@ -176,9 +187,14 @@ static SetMapEntry *setmap_get_or_create(SetMap *m, const char *key) {
       return e;
     e = e->next;
   }
-  e = (SetMapEntry *)malloc(sizeof(SetMapEntry));
-  e->key = (char *)malloc(strlen(key) + 1);
-  strcpy(e->key, key);
+  e = (SetMapEntry *)diff_malloc(sizeof(SetMapEntry));
+  if (!e)
+    return NULL;
+  e->key = diff_strdup(key);
+  if (!e->key) {
+    diff_free(e);
+    return NULL;
+  }
   e->ranges = NULL;
   e->count = 0;
   e->cap = 0;
@@ -187,13 +203,20 @@ static SetMapEntry *setmap_get_or_create(SetMap *m, const char *key) {
   return e;
 }
 
-static void setmap_add(SetMap *m, const char *key, LineRange range) {
+static bool setmap_add(SetMap *m, const char *key, LineRange range) {
   SetMapEntry *e = setmap_get_or_create(m, key);
+  if (!e)
+    return false;
   if (e->count >= e->cap) {
-    e->cap = e->cap == 0 ? 4 : e->cap * 2;
-    e->ranges = (LineRange *)realloc(e->ranges, (size_t)e->cap * sizeof(LineRange));
+    int cap = e->cap == 0 ? 4 : e->cap * 2;
+    LineRange *ranges = (LineRange *)diff_realloc_array(e->ranges, (size_t)cap, sizeof(LineRange));
+    if (!ranges)
+      return false;
+    e->ranges = ranges;
+    e->cap = cap;
   }
   e->ranges[e->count++] = range;
+  return true;
 }
 
 static SetMapEntry *setmap_find(SetMap *m, const char *key) {
@@ -212,9 +235,9 @@ static void setmap_free(SetMap *m) {
     SetMapEntry *e = m->buckets[i];
     while (e) {
       SetMapEntry *next = e->next;
-      free(e->key);
-      free(e->ranges);
-      free(e);
+      diff_free(e->key);
+      diff_free(e->ranges);
+      diff_free(e);
       e = next;
     }
   }
@@ -236,11 +259,12 @@ static void lrs_init(LineRangeSet *s) {
   s->count = 0;
   s->cap = 0;
 }
-static void lrs_free(LineRangeSet *s) { free(s->ranges); }
+static void lrs_free(LineRangeSet *s) { diff_free(s->ranges); }
 
-static void lrs_add_range(LineRangeSet *s, LineRange r) {
+// Returns false (set unchanged) if growing it fails
+static bool lrs_add_range(LineRangeSet *s, LineRange r) {
   if (lr_length(r) <= 0)
-    return;
+    return true;
   // Find insertion position (sorted by start_line)
   int pos = 0;
   while (pos < s->count && s->ranges[pos].start_line < r.start_line)
@@ -271,13 +295,19 @@ static void lrs_add_range(LineRangeSet *s, LineRange r) {
   } else {
     // Insert new range at pos
     if (s->count >= s->cap) {
-      s->cap = s->cap == 0 ? 8 : s->cap * 2;
-      s->ranges = (LineRange *)realloc(s->ranges, (size_t)s->cap * sizeof(LineRange));
+      int cap = s->cap == 0 ? 8 : s->cap * 2;
+      LineRange *ranges =
+          (LineRange *)diff_realloc_array(s->ranges, (size_t)cap, sizeof(LineRange));
+      if (!ranges)
+        return false;
+      s->ranges = ranges;
+      s->cap = cap;
     }
     memmove(&s->ranges[pos + 1], &s->ranges[pos], (size_t)(s->count - pos) * sizeof(LineRange));
     s->ranges[pos] = r;
     s->count++;
   }
+  return true;
 }
 
 static bool lrs_contains(const LineRangeSet *s, int line) {
@@ -300,12 +330,30 @@ static bool lrs_contains(const LineRangeSet *s, int line) {
 typedef struct {
   LineRange *ranges;
   int count;
+  bool failed; // An append failed; ranges holds what fit before it
 } LineRangeArray;
 
+static void lra_push(LineRangeArray *a, int *cap, LineRange r) {
+  if (a->failed)
+    return;
+  if (a->count >= *cap) {
+    int grown = *cap == 0 ? 4 : *cap * 2;
+    LineRange *ranges = (LineRange *)diff_realloc_array(a->ranges, (size_t)grown, sizeof(LineRange));
+    if (!ranges) {
+      a->failed = true;
+      return;
+    }
+    a->ranges = ranges;
+    *cap = grown;
+  }
+  a->ranges[a->count++] = r;
+}
+
 static LineRangeArray lrs_subtract_from(const LineRangeSet *s, LineRange r) {
   LineRangeArray result;
   result.ranges = NULL;
   result.count = 0;
+  result.failed = false;
   int cap = 0;
 
   int current_start = r.start_line;
@@ -315,22 +363,12 @@ static LineRangeArray lrs_subtract_from(const LineRangeSet *s, LineRange r) {
     if (s->ranges[i].start_line >= r.end_line)
       break;
     int gap_end = s->ranges[i].start_line < r.end_line ? s->ranges[i].start_line : r.end_line;
-    if (gap_end > current_start) {
-      if (result.count >= cap) {
-        cap = cap == 0 ? 4 : cap * 2;
-        result.ranges = (LineRange *)realloc(result.ranges, (size_t)cap * sizeof(LineRange));
-      }
-      result.ranges[result.count++] = lr_new(current_start, gap_end);
-    }
+    if (gap_end > current_start)
+      lra_push(&result, &cap, lr_new(current_start, gap_end));
     current_start = s->ranges[i].end_line;
   }
-  if (current_start < r.end_line) {
-    if (result.count >= cap) {
-      cap = cap == 0 ? 4 : cap * 2;
-      result.ranges = (LineRange *)realloc(result.ranges, (size_t)cap * sizeof(LineRange));
-    }
-    result.ranges[result.count++] = lr_new(current_start, r.end_line);
-  }
+  if (current_start < r.end_line)
+    lra_push(&result, &cap, lr_new(current_start, r.end_line));
   return result;
 }
 
@@ -348,6 +386,7 @@ static LineRangeArray lra_intersect(LineRangeArray a, LineRangeArray b) {
   LineRangeArray result;
   result.ranges = NULL;
   result.count = 0;
+  result.failed = false;
   int cap = 0;
   int j = 0;
   for (int i = 0; i < a.count; i++) {
@@ -359,13 +398,8 @@ static LineRangeArray lra_intersect(LineRangeArray a, LineRangeArray b) {
                                                               : b.ranges[k].start_line;
       int e =
           a.ranges[i].end_line < b.ranges[k].end_line ? a.ranges[i].end_line : b.ranges[k].end_line;
-      if (s < e) {
-        if (result.count >= cap) {
-          cap = cap == 0 ? 4 : cap * 2;
-          result.ranges = (LineRange *)realloc(result.ranges, (size_t)cap * sizeof(LineRange));
-        }
-        result.ranges[result.count++] = lr_new(s, e);
-      }
+      if (s < e)
+        lra_push(&result, &cap, lr_new(s, e));
       k++;
     }
   }
@@ -443,13 +477,19 @@ static bool are_lines_similar(const char *line1, const char *line2, MoveTimeout
   // Trim compare
   char *t1 = trim_string(line1);
   char *t2 = trim_string(line2);
+  if (!t1 || !t2) {
+    diff_free(t1);
+    diff_free(t2);
+    timeout->out_of_memory = true;
+    return false;
+  }
   if (strcmp(t1, t2) == 0) {
-    free(t1);
-    free(t2);
+    diff_free(t1);
+    diff_free(t2);
     return true;
   }
-  free(t1);
-  free(t2);
+  diff_free(t1);
+  diff_free(t2);
 
   int len1 = (int)strlen(line1);
   int len2 = (int)strlen(line2);
@@ -472,6 +512,7 @@ static bool are_lines_similar(const char *line1, const char *line2, MoveTimeout
       seq1->destroy(seq1);
     if (seq2)
       seq2->destroy(seq2);
+    timeout->out_of_memory = true;
     return false;
   }
 
@@ -494,6 +535,7 @@ static bool are_lines_similar(const char *line1, const char *line2, MoveTimeout
   if (!diffs) {
     seq1->destroy(seq1);
     seq2->destroy(seq2);
+    timeout->out_of_memory = true;
     return false;
   }
 
@@ -562,7 +604,11 @@ static SimpleMovesResult compute_simple_moves(const DetailedLineRangeMapping *ch
                                               const char **modified_lines, MoveTimeout *timeout) {
   SimpleMovesResult result;
   ma_init(&result.moves);
-  result.excluded = (bool *)calloc((size_t)change_count, sizeof(bool));
+  result.excluded = (bool *)diff_calloc((size_t)change_count, sizeof(bool));
+  if (!result.excluded) {
+    timeout->out_of_memory = true;
+    return result;
+  }
 
   // Build deletions and insertions
   int del_count = 0, ins_count = 0;
@@ -576,35 +622,42 @@ static SimpleMovesResult compute_simple_moves(const DetailedLineRangeMapping *ch
   if (del_count == 0 || ins_count == 0)
     return result;
 
-  // Build deletion fragments
-  int *del_indices = (int *)malloc((size_t)del_count * sizeof(int));
+  // Zeroed so that fragments never built have a NULL histogram for cleanup
+  int *del_indices = (int *)diff_malloc_array((size_t)del_count, sizeof(int));
   LineRangeFragment *deletions =
-      (LineRangeFragment *)malloc((size_t)del_count * sizeof(LineRangeFragment));
+      (LineRangeFragment *)diff_calloc((size_t)del_count, sizeof(LineRangeFragment));
+  int *ins_indices = (int *)diff_malloc_array((size_t)ins_count, sizeof(int));
+  LineRangeFragment *insertions =
+      (LineRangeFragment *)diff_calloc((size_t)ins_count, sizeof(LineRangeFragment));
+  bool *ins_used = (bool *)diff_calloc((size_t)ins_count, sizeof(bool));
+  bool ok = del_indices && deletions && ins_indices && insertions && ins_used;
+
+  // Build deletion fragments
   int di = 0;
-  for (int i = 0; i < change_count; i++) {
+  for (int i = 0; ok && i < change_count; i++) {
     if (lr_is_empty(changes[i].modified) && lr_length(changes[i].original) >= 3) {
       del_indices[di] = i;
       deletions[di] = lrf_create(changes[i].original, original_lines, i);
+      ok = deletions[di].histogram != NULL;
       di++;
     }
   }
 
   // Build insertion fragments
-  int *ins_indices = (int *)malloc((size_t)ins_count * sizeof(int));
-  LineRangeFragment *insertions =
-      (LineRangeFragment *)malloc((size_t)ins_count * sizeof(LineRangeFragment));
-  bool *ins_used = (bool *)calloc((size_t)ins_count, sizeof(bool));
   int ii = 0;
-  for (int i = 0; i < change_count; i++) {
+  for (int i = 0; ok && i < change_count; i++) {
     if (lr_is_empty(changes[i].original) && lr_length(changes[i].modified) >= 3) {
       ins_indices[ii] = i;
       insertions[ii] = lrf_create(changes[i].modified, modified_lines, i);
+      ok = insertions[ii].histogram != NULL;
       ii++;
     }
   }
+  if (!ok)
+    timeout->out_of_memory = true;
 
   // Match deletions to insertions
-  for (int d = 0; d < del_count; d++) {
+  for (int d = 0; ok && d < del_count; d++) {
     double highest = -1.0;
     int best = -1;
     for (int j = 0; j < ins_count; j++) {
@@ -621,24 +674,29 @@ static SimpleMovesResult compute_simple_moves(const DetailedLineRangeMapping *ch
       MovedText m;
       m.original = deletions[d].range;
       m.modified = insertions[best].range;
-      ma_push(&result.moves, m);
+      if (!ma_push(&result.moves, m)) {
+        timeout->out_of_memory = true;
+        break;
+      }
       result.excluded[del_indices[d]] = true;
       result.excluded[ins_indices[best]] = true;
     }
+    // First half of the moves stage: deletions matched against all insertions
+    diff_progress_nested(0.5 * (d + 1) / del_count);
     if (!timeout_is_valid(timeout))
       break;
   }
 
   // Cleanup
-  for (int i = 0; i < del_count; i++)
+  for (int i = 0; i < di; i++)
     lrf_free(&deletions[i]);
-  for (int i = 0; i < ins_count; i++)
+  for (int i = 0; i < ii; i++)
     lrf_free(&insertions[i]);
-  free(deletions);
-  free(insertions);
-  free(del_indices);
-  free(ins_indices);
-  free(ins_used);
+  diff_free(deletions);
+  diff_free(insertions);
+  diff_free(del_indices);
+  diff_free(ins_indices);
+  diff_free(ins_used);
 
   return result;
 }
@@ -668,12 +726,18 @@ typedef struct {
   int cap;
 } PossibleMappingArray;
 
-static void pma_push(PossibleMappingArray *a, PossibleMapping m) {
+static bool pma_push(PossibleMappingArray *a, PossibleMapping m) {
   if (a->count >= a->cap) {
-    a->cap = a->cap == 0 ? 16 : a->cap * 2;
-    a->items = (PossibleMapping *)realloc(a->items, (size_t)a->cap * sizeof(PossibleMapping));
+    int cap = a->cap == 0 ? 16 : a->cap * 2;
+    PossibleMapping *items =
+        (PossibleMapping *)diff_realloc_array(a->items, (size_t)cap, sizeof(PossibleMapping));
+    if (!items)
+      return false;
+    a->items = items;
+    a->cap = cap;
   }
   a->items[a->count++] = m;
+  return true;
 }
 
 // Sort possible mappings by modified range length descending (reverseOrder)
@@ -709,7 +773,7 @@ static void compute_unchanged_moves(const DetailedLineRangeMapping *changes, int
   } while (0)
 
   char key_buf[64];
-  for (int ci = 0; ci < change_count; ci++) {
+  for (int ci = 0; ci < change_count && !timeout->out_of_memory; ci++) {
     LineRange orig = changes[ci].original;
     for (int i = orig.start_line; i < orig.end_line - 2; i++) {
       int pos = 0;
@@ -719,13 +783,22 @@ static void compute_unchanged_moves(const DetailedLineRangeMapping *changes, int
       key_buf[pos++] = ':';
       WRITE_U32(key_buf, pos, hashed_original[i + 1]);
       key_buf[pos] = '\0';
-      setmap_add(&original3, key_buf, lr_new(i, i + 3));
+      if (!setmap_add(&original3, key_buf, lr_new(i, i + 3))) {
+        timeout->out_of_memory = true;
+        break;
+      }
     }
   }
 
   // Sort changes by modified start (we need a mutable copy)
-  DetailedLineRangeMapping *sorted_changes =
-      (DetailedLineRangeMapping *)malloc((size_t)change_count * sizeof(DetailedLineRangeMapping));
+  DetailedLineRangeMapping *sorted_changes = (DetailedLineRangeMapping *)diff_malloc_array(
+      (size_t)(change_count > 0 ? change_count : 1), sizeof(DetailedLineRangeMapping));
+  if (!sorted_changes || timeout->out_of_memory) {
+    timeout->out_of_memory = true;
+    diff_free(sorted_changes);
+    setmap_free(&original3);
+    return;
+  }
   memcpy(sorted_changes, changes, (size_t)change_count * sizeof(DetailedLineRangeMapping));
   qsort(sorted_changes, (size_t)change_count, sizeof(DetailedLineRangeMapping), cmp_by_mod_start);
 
@@ -748,7 +821,7 @@ static void compute_unchanged_moves(const DetailedLineRangeMapping *changes, int
     LineRange mod = sorted_changes[ci].modified;
     last_count = 0;
 
-    for (int i = mod.start_line; i < mod.end_line - 2; i++) {
+    for (int i = mod.start_line; i < mod.end_line - 2 && !timeout->out_of_memory; i++) {
       int pos = 0;
       WRITE_U32(key_buf, pos, hashed_modified[i - 1]);
       key_buf[pos++] = ':';
@@ -761,7 +834,7 @@ static void compute_unchanged_moves(const DetailedLineRangeMapping *changes, int
       next_count = 0;
       SetMapEntry *entry = setmap_find(&original3, key_buf);
       if (entry) {
-        for (int ri = 0; ri < entry->count; ri++) {
+        for (int ri = 0; ri < entry->count && !timeout->out_of_memory; ri++) {
           LineRange orig_range = entry->ranges[ri];
           bool extended = false;
 
@@ -774,9 +847,15 @@ static void compute_unchanged_moves(const DetailedLineRangeMapping *changes, int
               lm->modified_range = lr_new(lm->modified_range.start_line, current_mod.end_line);
               // Push to next
               if (next_count >= next_cap) {
-                next_cap = next_cap == 0 ? 8 : next_cap * 2;
-                next_mappings = (ActiveMapping *)realloc(next_mappings,
-                                                         (size_t)next_cap * sizeof(ActiveMapping));
+                int cap = next_cap == 0 ? 8 : next_cap * 2;
+                ActiveMapping *grown = (ActiveMapping *)diff_realloc_array(
+                    next_mappings, (size_t)cap, sizeof(ActiveMapping));
+                if (!grown) {
+                  timeout->out_of_memory = true;
+                  break;
+                }
+                next_mappings = grown;
+                next_cap = cap;
               }
               next_mappings[next_count++] = last_mappings[li];
               extended = true;
@@ -784,15 +863,24 @@ static void compute_unchanged_moves(const DetailedLineRangeMapping *changes, int
             }
           }
 
-          if (!extended) {
+          if (!extended && !timeout->out_of_memory) {
             PossibleMapping pm;
             pm.modified_range = current_mod;
             pm.original_range = orig_range;
-            pma_push(&possible, pm);
+            if (!pma_push(&possible, pm)) {
+              timeout->out_of_memory = true;
+              break;
+            }
             if (next_count >= next_cap) {
-              next_cap = next_cap == 0 ? 8 : next_cap * 2;
-              next_mappings =
-                  (ActiveMapping *)realloc(next_mappings, (size_t)next_cap * sizeof(ActiveMapping));
+              int cap = next_cap == 0 ? 8 : next_cap * 2;
+              ActiveMapping *grown = (ActiveMapping *)diff_realloc_array(
+                  next_mappings, (size_t)cap, sizeof(ActiveMapping));
+              if (!grown) {
+                timeout->out_of_memory = true;
+                break;
+              }
+              next_mappings = grown;
+              next_cap = cap;
             }
             next_mappings[next_count++] = (ActiveMapping){possible.count - 1};
           }
@@ -810,18 +898,20 @@ static void compute_unchanged_moves(const DetailedLineRangeMapping *changes, int
       next_cap = tc;
     }
 
+    // Second half: 3-line windows of each change looked up as move candidates
+    diff_progress_nested(0.5 + 0.5 * (ci + 1) / change_count);
     if (!timeout_is_valid(timeout)) {
-      free(last_mappings);
-      free(next_mappings);
-      free(possible.items);
-      free(sorted_changes);
+      diff_free(last_mappings);
+      diff_free(next_mappings);
+      diff_free(possible.items);
+      diff_free(sorted_changes);
       setmap_free(&original3);
       return;
     }
   }
 
-  free(last_mappings);
-  free(next_mappings);
+  diff_free(last_mappings);
+  diff_free(next_mappings);
 
   // Sort by modified range length descending
   qsort(possible.items, (size_t)possible.count, sizeof(PossibleMapping), cmp_pm_by_length_desc);
@@ -833,7 +923,7 @@ static void compute_unchanged_moves(const DetailedLineRangeMapping *changes, int
   MoveArray moves;
   ma_init(&moves);
 
-  for (int pi = 0; pi < possible.count; pi++) {
+  for (int pi = 0; pi < possible.count && !timeout->out_of_memory; pi++) {
     PossibleMapping *pm = &possible.items[pi];
     int diff_orig_to_mod = pm->modified_range.start_line - pm->original_range.start_line;
 
@@ -841,8 +931,10 @@ static void compute_unchanged_moves(const DetailedLineRangeMapping *changes, int
     LineRangeArray orig_sections = lrs_subtract_from(&original_set, pm->original_range);
     LineRangeArray orig_translated = lra_with_delta(orig_sections, diff_orig_to_mod);
     LineRangeArray intersected = lra_intersect(mod_sections, orig_translated);
+    if (mod_sections.failed || orig_sections.failed || intersected.failed)
+      timeout->out_of_memory = true;
 
-    for (int si = 0; si < intersected.count; si++) {
+    for (int si = 0; si < intersected.count && !timeout->out_of_memory; si++) {
       LineRange s = intersected.ranges[si];
       if (lr_length(s) < 3)
         continue;
@@ -850,14 +942,14 @@ static void compute_unchanged_moves(const DetailedLineRangeMapping *changes, int
       LineRange orig_lr = lr_delta(s, -diff_orig_to_mod);
 
       MovedText m = {orig_lr, mod_lr};
-      ma_push(&moves, m);
-      lrs_add_range(&modified_set, mod_lr);
-      lrs_add_range(&original_set, orig_lr);
+      if (!ma_push(&moves, m) || !lrs_add_range(&modified_set, mod_lr) ||
+          !lrs_add_range(&original_set, orig_lr))
+        timeout->out_of_memory = true;
     }
 
-    free(mod_sections.ranges);
-    free(orig_translated.ranges);
-    free(intersected.ranges);
+    diff_free(mod_sections.ranges);
+    diff_free(orig_translated.ranges);
+    diff_free(intersected.ranges);
   }
 
   // Sort moves by original start
@@ -875,7 +967,7 @@ static void compute_unchanged_moves(const DetailedLineRangeMapping *changes, int
   // Use the original unsorted changes for findLastMonotonous lookups
   // (changes must be sorted by original.start_line for MonotonousArray — they already are)
   int mono_last_idx = 0;
-  for (int mi = 0; mi < moves.count; mi++) {
+  for (int mi = 0; mi < moves.count && !timeout->out_of_memory; mi++) {
     MovedText *mv = &moves.items[mi];
 
     // Find first touching change for original
@@ -920,11 +1012,13 @@ static void compute_unchanged_moves(const DetailedLineRangeMapping *changes, int
       if (!are_lines_similar(original_lines[orig_line - 1], modified_lines[mod_line - 1], timeout))
         break;
     }
-    if (extend_top > 0) {
-      lrs_add_range(&original_set,
-                    lr_new(mv->original.start_line - extend_top, mv->original.start_line));
-      lrs_add_range(&modified_set,
-                    lr_new(mv->modified.start_line - extend_top, mv->modified.start_line));
+    if (extend_top > 0 &&
+        (!lrs_add_range(&original_set,
+                        lr_new(mv->original.start_line - extend_top, mv->original.start_line)) ||
+         !lrs_add_range(&modified_set,
+                        lr_new(mv->modified.start_line - extend_top, mv->modified.start_line)))) {
+      timeout->out_of_memory = true;
+      break;
     }
 
     // Extend downward
@@ -939,11 +1033,13 @@ static void compute_unchanged_moves(const DetailedLineRangeMapping *changes, int
       if (!are_lines_similar(original_lines[orig_line - 1], modified_lines[mod_line - 1], timeout))
         break;
     }
-    if (extend_bottom > 0) {
-      lrs_add_range(&original_set,
-                    lr_new(mv->original.end_line, mv->original.end_line + extend_bottom));
-      lrs_add_range(&modified_set,
-                    lr_new(mv->modified.end_line, mv->modified.end_line + extend_bottom));
+    if (extend_bottom > 0 &&
+        (!lrs_add_range(&original_set,
+                        lr_new(mv->original.end_line, mv->original.end_line + extend_bottom)) ||
+         !lrs_add_range(&modified_set,
+                        lr_new(mv->modified.end_line, mv->modified.end_line + extend_bottom)))) {
+      timeout->out_of_memory = true;
+      break;
     }
 
     if (extend_top > 0 || extend_bottom > 0) {
@@ -955,16 +1051,17 @@ static void compute_unchanged_moves(const DetailedLineRangeMapping *changes, int
   }
 
   // Copy results
-  for (int i = 0; i < moves.count; i++) {
-    ma_push(out_moves, moves.items[i]);
+  for (int i = 0; i < moves.count && !timeout->out_of_memory; i++) {
+    if (!ma_push(out_moves, moves.items[i]))
+      timeout->out_of_memory = true;
   }
 
   // Cleanup
   ma_free(&moves);
   lrs_free(&modified_set);
   lrs_free(&original_set);
-  free(possible.items);
-  free(sorted_changes);
+  diff_free(possible.items);
+  diff_free(sorted_changes);
   setmap_free(&original3);
 }
 
@@ -978,7 +1075,7 @@ static int cmp_move_by_orig_start(const void *a, const void *b) {
   return ma->original.start_line - mb->original.start_line;
 }
 
-static MoveArray join_close_consecutive_moves(MoveArray *moves) {
+static MoveArray join_close_consecutive_moves(MoveArray *moves, bool *out_of_memory) {
   MoveArray result;
   ma_init(&result);
   if (moves->count == 0)
@@ -986,7 +1083,10 @@ static MoveArray join_close_consecutive_moves(MoveArray *moves) {
 
   qsort(moves->items, (size_t)moves->count, sizeof(MovedText), cmp_move_by_orig_start);
 
-  ma_push(&result, moves->items[0]);
+  if (!ma_push(&result, moves->items[0])) {
+    *out_of_memory = true;
+    return result;
+  }
   for (int i = 1; i < moves->count; i++) {
     MovedText *last = &result.items[result.count - 1];
     MovedText *current = &moves->items[i];
@@ -1001,7 +1101,10 @@ static MoveArray join_close_consecutive_moves(MoveArray *moves) {
       last->modified = lr_join(last->modified, current->modified);
       continue;
     }
-    ma_push(&result, *current);
+    if (!ma_push(&result, *current)) {
+      *out_of_memory = true;
+      break;
+    }
   }
   return result;
 }
@@ -1011,7 +1114,8 @@ static MoveArray join_close_consecutive_moves(MoveArray *moves) {
 // ============================================================================
 
 static MoveArray remove_moves_in_same_diff(const DetailedLineRangeMapping *changes,
-                                           int change_count, MoveArray *moves) {
+                                           int change_count, MoveArray *moves,
+                                           bool *out_of_memory) {
   MoveArray result;
   ma_init(&result);
 
@@ -1039,8 +1143,9 @@ static MoveArray remove_moves_in_same_diff(const DetailedLineRangeMapping *chang
       different = (orig_idx != mod_idx);
     }
 
-    if (different) {
-      ma_push(&result, *m);
+    if (different && !ma_push(&result, *m)) {
+      *out_of_memory = true;
+      break;
     }
   }
   (void)mono_idx;
@@ -1068,11 +1173,28 @@ static int count_where_len_ge2(const char **lines, int start_line, int end_line)
   return count;
 }
 
+// ============================================================================
+// Memory estimate
+// ============================================================================
+
+int64_t compute_moved_lines_memory_bytes(const DetailedLineRangeMapping *changes,
+                                         int change_count) {
+  // Every candidate fragment carries its own character-pair histogram
+  int64_t fragments = 0;
+  for (int i = 0; i < change_count; i++) {
+    if (lr_is_empty(changes[i].modified) && lr_length(changes[i].original) >= 3)
+      fragments++;
+    if (lr_is_empty(changes[i].original) && lr_length(changes[i].modified) >= 3)
+      fragments++;
+  }
+  return fragments * HIST_SIZE * (int64_t)sizeof(int);
+}
+
 // ============================================================================
 // Main entry point: compute_moved_lines
 // ============================================================================
 
-void compute_moved_lines(const DetailedLineRangeMapping *changes, int change_count,
+bool compute_moved_lines(const DetailedLineRangeMapping *changes, int change_count,
                          const char **original_lines, int original_count,
                          const char **modified_lines, int modified_count,
                          const uint32_t *hashed_original, const uint32_t *hashed_modified,
@@ -1082,11 +1204,12 @@ void compute_moved_lines(const DetailedLineRangeMapping *changes, int change_cou
   out_moves->capacity = 0;
 
   if (change_count == 0)
-    return;
+    return true;
 
   MoveTimeout timeout;
   timeout.timeout_ms = timeout_ms;
   timeout.start_time_ms = get_current_time_ms();
+  timeout.out_of_memory = false;
 
   // Step 1: Simple deletion-to-insertion moves
   SimpleMovesResult simple =
@@ -1094,8 +1217,8 @@ void compute_moved_lines(const DetailedLineRangeMapping *changes, int change_cou
 
   if (!timeout_is_valid(&timeout)) {
     ma_free(&simple.moves);
-    free(simple.excluded);
-    return;
+    diff_free(simple.excluded);
+    return !timeout.out_of_memory;
   }
 
   // Step 2: Filter excluded changes and compute unchanged moves
@@ -1105,8 +1228,13 @@ void compute_moved_lines(const DetailedLineRangeMapping *changes, int change_cou
       filtered_count++;
   }
 
-  DetailedLineRangeMapping *filtered = (DetailedLineRangeMapping *)malloc(
-      (size_t)(filtered_count > 0 ? filtered_count : 1) * sizeof(DetailedLineRangeMapping));
+  DetailedLineRangeMapping *filtered = (DetailedLineRangeMapping *)diff_malloc_array(
+      (size_t)(filtered_count > 0 ? filtered_count : 1), sizeof(DetailedLineRangeMapping));
+  if (!filtered) {
+    ma_free(&simple.moves);
+    diff_free(simple.excluded);
+    return false;
+  }
   int fi = 0;
   for (int i = 0; i < change_count; i++) {
     if (!simple.excluded[i]) {
@@ -1123,19 +1251,22 @@ void compute_moved_lines(const DetailedLineRangeMapping *changes, int change_cou
   // Combine moves
   MoveArray all_moves;
   ma_init(&all_moves);
-  for (int i = 0; i < simple.moves.count; i++)
-    ma_push(&all_moves, simple.moves.items[i]);
-  for (int i = 0; i < unchanged_moves.count; i++)
-    ma_push(&all_moves, unchanged_moves.items[i]);
+  for (int i = 0; i < simple.moves.count && !timeout.out_of_memory; i++)
+    timeout.out_of_memory = !ma_push(&all_moves, simple.moves.items[i]);
+  for (int i = 0; i < unchanged_moves.count && !timeout.out_of_memory; i++)
+    timeout.out_of_memory = !ma_push(&all_moves, unchanged_moves.items[i]);
 
   // Step 3: Join close consecutive moves
-  MoveArray joined = join_close_consecutive_moves(&all_moves);
+  MoveArray joined;
+  ma_init(&joined);
+  if (!timeout.out_of_memory)
+    joined = join_close_consecutive_moves(&all_moves, &timeout.out_of_memory);
 
   // Step 4: Filter too-short moves
   // original text must be >= 15 chars AND >= 2 lines with trimmed length >= 2
   MoveArray filtered_moves;
   ma_init(&filtered_moves);
-  for (int i = 0; i < joined.count; i++) {
+  for (int i = 0; i < joined.count && !timeout.out_of_memory; i++) {
     MovedText *m = &joined.items[i];
     // Build trimmed text of original lines
     int total_len = 0;
@@ -1153,16 +1284,19 @@ void compute_moved_lines(const DetailedLineRangeMapping *changes, int change_cou
     }
     int count_ge2 =
         count_where_len_ge2(original_lines, m->original.start_line, m->original.end_line);
-    if (total_len >= 15 && count_ge2 >= 2) {
-      ma_push(&filtered_moves, *m);
-    }
+    if (total_len >= 15 && count_ge2 >= 2 && !ma_push(&filtered_moves, *m))
+      timeout.out_of_memory = true;
   }
 
   // Step 5: Remove moves in same diff
-  MoveArray final_moves = remove_moves_in_same_diff(changes, change_count, &filtered_moves);
+  MoveArray final_moves;
+  ma_init(&final_moves);
+  if (!timeout.out_of_memory)
+    final_moves = remove_moves_in_same_diff(changes, change_count, &filtered_moves,
+                                            &timeout.out_of_memory);
 
   // Output
-  if (final_moves.count > 0) {
+  if (final_moves.count > 0 && !timeout.out_of_memory) {
     out_moves->moves = final_moves.items;
     out_moves->count = final_moves.count;
     out_moves->capacity = final_moves.cap;
@@ -1172,10 +1306,11 @@ void compute_moved_lines(const DetailedLineRangeMapping *changes, int change_cou
 
   // Cleanup
   ma_free(&simple.moves);
-  free(simple.excluded);
-  free(filtered);
+  diff_free(simple.excluded);
+  diff_free(filtered);
   ma_free(&unchanged_moves);
   ma_free(&all_moves);
   ma_free(&joined);
   ma_free(&filtered_moves);
+  return !timeout.out_of_memory;
 }
@@ -0,0 +1,213 @@
+/**
+ * Diff Engine Cost Model
+ *
+ * Lower-bounds the cost of the exact forward O(ND) search from a sampled
+ * estimate of the edit distance, and sends regions that cannot finish within
+ * the timeout straight to the cost-capped search.
+ *
+ * Edit distance estimate: an element that never occurs on the other side
+ * must be inserted or deleted, so the number of such elements is a lower
+ * bound on D. It is measured on an evenly spaced sample of each side and
+ * reduced by three standard deviations of the sampling error, so noise can
+ * only make the model more conservative.
+ *
+ * Cost: the forward search processes every diagonal of every layer below D,
+ * which is counted exactly with the engine's own diagonal bounds.
+ */
+
+#include "cost_model.h"
+#include "allocator.h"
+#include "myers.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Elements sampled per side (whole side if shorter)
+#define COST_SAMPLE_SIZE 1024
+
+// Empty slot marker for the element set (element values are hashes/code units)
+#define ELEMENT_SET_EMPTY UINT32_MAX
+
+typedef struct {
+  uint32_t *slots;
+  uint32_t mask;
+  bool has_empty_value; // ELEMENT_SET_EMPTY itself is in the set
+} ElementSet;
+
+static uint32_t element_slot(uint32_t value, uint32_t mask) {
+  // Fibonacci hashing spreads sequential line IDs across the table
+  return (uint32_t)((value * 2654435769u) >> 7) & mask;
+}
+
+static bool element_set_build(ElementSet *set, const ISequence *seq, int len) {
+  uint32_t capacity = 16;
+  while (capacity < (uint32_t)len * 2u) {
+    capacity <<= 1;
+  }
+  set->slots = (uint32_t *)diff_malloc((size_t)capacity * sizeof(uint32_t));
+  if (!set->slots) {
+    return false;
+  }
+  memset(set->slots, 0xFF, (size_t)capacity * sizeof(uint32_t));
+  set->mask = capacity - 1;
+  set->has_empty_value = false;
+
+  for (int i = 0; i < len; i++) {
+    uint32_t value = seq->getElement(seq, i);
+    if (value == ELEMENT_SET_EMPTY) {
+      set->has_empty_value = true;
+      continue;
+    }
+    uint32_t slot = element_slot(value, set->mask);
+    while (set->slots[slot] != ELEMENT_SET_EMPTY && set->slots[slot] != value) {
+      slot = (slot + 1) & set->mask;
+    }
+    set->slots[slot] = value;
+  }
+  return true;
+}
+
+static bool element_set_contains(const ElementSet *set, uint32_t value) {
+  if (value == ELEMENT_SET_EMPTY) {
+    return set->has_empty_value;
+  }
+  uint32_t slot = element_slot(value, set->mask);
+  while (set->slots[slot] != ELEMENT_SET_EMPTY) {
+    if (set->slots[slot] == value) {
+      return true;
+    }
+    slot = (slot + 1) & set->mask;
+  }
+  return false;
+}
+
+/**
+ * Lower-bound the number of elements of `from` that do not occur in `to`.
+ */
+static double estimate_unmatched(const ISequence *from, int from_len, const ElementSet *to) {
+  int samples = from_len < COST_SAMPLE_SIZE ? from_len : COST_SAMPLE_SIZE;
+  if (samples == 0) {
+    return 0;
+  }
+
+  int missing = 0;
+  for (int i = 0; i < samples; i++) {
+    int offset = (int)((int64_t)i * from_len / samples);
+    if (!element_set_contains(to, from->getElement(from, offset))) {
+      missing++;
+    }
+  }
+
+  if (samples == from_len) {
+    return missing; // Exhaustive: exact count
+  }
+
+  double p = (double)missing / samples;
+  double margin = 3.0 * sqrt(samples * p * (1.0 - p));
+  double lower = (missing - margin) / samples * from_len;
+  return lower > 0 ? lower : 0;
+}
+
+/**
+ * Diagonal steps the forward search performs in layers 1..d_max
+ * (same bounds as myers_nd_diff_algorithm).
+ */
+static double nd_diagonal_steps(int d_max, int len_a, int len_b) {
+  double steps = 0;
+  for (int d = 1; d <= d_max; d++) {
+    int lower = -(d < len_b + (d % 2) ? d : len_b + (d % 2));
+    int upper = d < len_a + (d % 2) ? d : len_a + (d % 2);
+    steps += (upper - lower) / 2 + 1;
+  }
+  return steps;
+}
+
+DiffEngine diff_select_engine(const ISequence *seq1, const ISequence *seq2, int dp_threshold,
+                              int timeout_ms, DiffCostEstimate *estimate) {
+  int len1 = seq1->getLength(seq1);
+  int len2 = seq2->getLength(seq2);
+
+  if (estimate) {
+    estimate->min_edit_distance = 0;
+    estimate->nd_min_ms = 0;
+  }
+
+  // VSCode Parity: DP below the size threshold, regardless of cost
+  if (len1 + len2 < dp_threshold) {
+    return DIFF_ENGINE_DP;
+  }
+  if (timeout_ms <= 0 || len1 == 0 || len2 == 0) {
+    return DIFF_ENGINE_ND;
+  }
+
+  // Cheap exit: even D = N + M would finish in time
+  double budget_ms = timeout_ms * DIFF_COST_TIMEOUT_SAFETY;
+  double max_ms = nd_diagonal_steps(len1 + len2, len1, len2) * DIFF_COST_ND_NS_PER_STEP / 1e6;
+  if (max_ms <= budget_ms) {
+    return DIFF_ENGINE_ND;
+  }
+
+  ElementSet set1;
+  ElementSet set2;
+  if (!element_set_build(&set1, seq1, len1)) {
+    return DIFF_ENGINE_ND;
+  }
+  if (!element_set_build(&set2, seq2, len2)) {
+    diff_free(set1.slots);
+    return DIFF_ENGINE_ND;
+  }
+
+  double unmatched = estimate_unmatched(seq1, len1, &set2) + estimate_unmatched(seq2, len2, &set1);
+  diff_free(set1.slots);
+  diff_free(set2.slots);
+
+  int min_d = (int)unmatched;
+  double nd_min_ms = nd_diagonal_steps(min_d - 1, len1, len2) * DIFF_COST_ND_NS_PER_STEP / 1e6;
+
+  if (estimate) {
+    estimate->min_edit_distance = min_d;
+    estimate->nd_min_ms = nd_min_ms;
+  }
+
+  return nd_min_ms > budget_ms ? DIFF_ENGINE_ND_CAPPED : DIFF_ENGINE_ND;
+}
+
+double cost_model_calibrate_nd(void) {
+  // No common elements: D = N + M and every layer is fully explored
+  const int len = 4000;
+  char *text_a = (char *)diff_malloc((size_t)len + 1);
+  char *text_b = (char *)diff_malloc((size_t)len + 1);
+  memset(text_a, 'a', (size_t)len);
+  memset(text_b, 'b', (size_t)len);
+  text_a[len] = '\0';
+  text_b[len] = '\0';
+
+  const char *lines_a[] = {text_a};
+  const char *lines_b[] = {text_b};
+  ISequence *seq_a = char_sequence_create(lines_a, 0, 1, false);
+  ISequence *seq_b = char_sequence_create(lines_b, 0, 1, false);
+  int len_a = seq_a->getLength(seq_a);
+  int len_b = seq_b->getLength(seq_b);
+  double steps = nd_diagonal_steps(len_a + len_b, len_a, len_b);
+
+  double best_ns = 0;
+  for (int run = 0; run < 3; run++) {
+    bool hit_timeout = false;
+    clock_t start = clock();
+    SequenceDiffArray *diffs = myers_nd_diff_algorithm(seq_a, seq_b, 0, &hit_timeout);
+    double ns = (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / steps;
+    diff_free(diffs->diffs);
+    diff_free(diffs);
+    if (run == 0 || ns < best_ns) {
+      best_ns = ns;
+    }
+  }
+
+  seq_a->destroy(seq_a);
+  seq_b->destroy(seq_b);
+  diff_free(text_a);
+  diff_free(text_b);
+  return best_ns;
+}
@@ -0,0 +1,204 @@
+/**
+ * Diff Statistics (see diff_stat.h)
+ */
+
+#include "diff_stat.h"
+#include "allocator.h"
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef struct {
+  uint64_t hash;
+  const char *text;
+} StatLine;
+
+typedef struct {
+  uint64_t hash;
+  uint8_t sides; // Bit 0: seen in the original, bit 1: in the modified (0 = free slot)
+} SideSlot;
+
+static uint64_t line_hash(const char *line) {
+  uint64_t h = 0xCBF29CE484222325ull; // FNV-1a
+  for (const unsigned char *p = (const unsigned char *)line; *p; p++) {
+    h = (h ^ *p) * 0x100000001B3ull;
+  }
+  return h;
+}
+
+static bool stat_lines_equal(const StatLine *a, const StatLine *b) {
+  return a->hash == b->hash && strcmp(a->text, b->text) == 0;
+}
+
+static SideSlot *find_slot(SideSlot *slots, size_t mask, uint64_t hash) {
+  size_t slot = (size_t)(hash ^ (hash >> 32)) & mask;
+  while (slots[slot].sides && slots[slot].hash != hash) {
+    slot = (slot + 1) & mask;
+  }
+  return &slots[slot];
+}
+
+/**
+ * Drop lines whose hash occurs on one side only, compacting both arrays in
+ * place. Such lines cannot be part of any match, so the edit distance of the
+ * remaining lines plus the dropped count is the edit distance of the whole.
+ * Distinct lines that share a hash are kept, which is merely conservative.
+ */
+static bool drop_one_sided_lines(StatLine *a, int *len_a, StatLine *b, int *len_b,
+                                 int *dropped_a, int *dropped_b) {
+  size_t capacity = 16;
+  while (capacity < ((size_t)*len_a + (size_t)*len_b) * 2) {
+    capacity <<= 1;
+  }
+  SideSlot *slots = (SideSlot *)diff_calloc(capacity, sizeof(SideSlot));
+  if (!slots) {
+    return false;
+  }
+  size_t mask = capacity - 1;
+  for (int i = 0; i < *len_a; i++) {
+    SideSlot *s = find_slot(slots, mask, a[i].hash);
+    s->hash = a[i].hash;
+    s->sides |= 1;
+  }
+  for (int i = 0; i < *len_b; i++) {
+    SideSlot *s = find_slot(slots, mask, b[i].hash);
+    s->hash = b[i].hash;
+    s->sides |= 2;
+  }
+
+  int n = 0;
+  for (int i = 0; i < *len_a; i++) {
+    if (find_slot(slots, mask, a[i].hash)->sides == 3) {
+      a[n++] = a[i];
+    }
+  }
+  *dropped_a = *len_a - n;
+  *len_a = n;
+  n = 0;
+  for (int i = 0; i < *len_b; i++) {
+    if (find_slot(slots, mask, b[i].hash)->sides == 3) {
+      b[n++] = b[i];
+    }
+  }
+  *dropped_b = *len_b - n;
+  *len_b = n;
+
+  diff_free(slots);
+  return true;
+}
+
+/**
+ * Edit distance by forward Myers, keeping only the furthest x per diagonal.
+ *
+ * @return Edit distance, -1 if it exceeds max_d, or -2 if allocation failed
+ */
+static int myers_edit_distance(const StatLine *a, int n, const StatLine *b, int m, int max_d) {
+  int64_t total = (int64_t)n + m;
+  int limit = total < max_d ? (int)total : max_d;
+  int *v = (int *)diff_malloc_array((size_t)limit * 2 + 3, sizeof(int));
+  if (!v) {
+    return -2;
+  }
+  int offset = limit + 1;
+  v[offset + 1] = 0;
+  for (int d = 0; d <= limit; d++) {
+    for (int k = -d; k <= d; k += 2) {
+      int x;
+      if (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1])) {
+        x = v[offset + k + 1];
+      } else {
+        x = v[offset + k - 1] + 1;
+      }
+      int y = x - k;
+      while (x < n && y < m && stat_lines_equal(&a[x], &b[y])) {
+        x++;
+        y++;
+      }
+      v[offset + k] = x;
+      if (x >= n && y >= m) {
+        diff_free(v);
+        return d;
+      }
+    }
+  }
+  diff_free(v);
+  return -1;
+}
+
+static StatLine *hash_lines(const char **lines, int start, int end) {
+  StatLine *out = (StatLine *)diff_malloc_array(end > start ? (size_t)(end - start) : 1,
+                                                sizeof(StatLine));
+  if (!out) {
+    return NULL;
+  }
+  for (int i = start; i < end; i++) {
+    out[i - start].hash = line_hash(lines[i]);
+    out[i - start].text = lines[i];
+  }
+  return out;
+}
+
+static bool compute_stat(const char **lines_a, int len_a, const char **lines_b, int len_b,
+                         int max_d, DiffStat *out) {
+  // Common prefix and suffix need no hashing
+  int start = 0;
+  while (start < len_a && start < len_b && strcmp(lines_a[start], lines_b[start]) == 0) {
+    start++;
+  }
+  int end_a = len_a;
+  int end_b = len_b;
+  while (end_a > start && end_b > start && strcmp(lines_a[end_a - 1], lines_b[end_b - 1]) == 0) {
+    end_a--;
+    end_b--;
+  }
+
+  StatLine *a = hash_lines(lines_a, start, end_a);
+  StatLine *b = hash_lines(lines_b, start, end_b);
+  int n = end_a - start;
+  int m = end_b - start;
+  int dropped_a = 0;
+  int dropped_b = 0;
+  if (!a || !b || !drop_one_sided_lines(a, &n, b, &m, &dropped_a, &dropped_b)) {
+    diff_free(a);
+    diff_free(b);
+    return false;
+  }
+
+  // Every remaining line beyond the shorter side is an edit as well
+  int64_t lower_bound = (int64_t)dropped_a + dropped_b + (n > m ? n - m : m - n);
+  int d = -1;
+  if (lower_bound <= max_d) {
+    d = myers_edit_distance(a, n, b, m, max_d - dropped_a - dropped_b);
+  }
+  diff_free(a);
+  diff_free(b);
+  if (d == -2) {
+    return false;
+  }
+
+  if (d < 0) {
+    out->exceeded = true;
+    out->edit_distance = max_d + 1;
+    out->insertions = dropped_b + (m > n ? m - n : 0);
+    out->deletions = dropped_a + (n > m ? n - m : 0);
+    return true;
+  }
+  // A path with d edits over n x m has (d - n + m) / 2 insertions
+  out->exceeded = false;
+  out->insertions = dropped_b + (d - n + m) / 2;
+  out->deletions = dropped_a + (d + n - m) / 2;
+  out->edit_distance = out->insertions + out->deletions;
+  return true;
+}
+
+bool diff_stat(const char **lines_a, int len_a, const char **lines_b, int len_b,
+               DiffStat *out) {
+  return compute_stat(lines_a, len_a, lines_b, len_b, INT_MAX - 1, out);
+}
+
+bool diff_stat_bounded(const char **lines_a, int len_a, const char **lines_b, int len_b,
+                       int max_edit_distance, DiffStat *out) {
+  return compute_stat(lines_a, len_a, lines_b, len_b,
+                      max_edit_distance < 0 ? 0 : max_edit_distance, out);
+}
@@ -0,0 +1,965 @@
+/**
+ * Native Git Object Store Reader
+ *
+ * Object lookup order matches git: every pack index (binary search inside the
+ * fanout bucket), then the loose object file. Packs are mapped once when the
+ * store is opened; if an object is missing the pack list is rescanned once,
+ * since `git gc` or a fetch may have replaced the packs since.
+ *
+ * Trees and commits are kept in a small round-robin cache because stepping
+ * through the files of one commit walks the same root and directory trees
+ * over and over. Blobs are never cached - the caller owns them.
+ *
+ * On-disk formats: gitformat-pack(5) (pack v2/v3, index v2) and the loose
+ * object layout `objects/xx/<38 hex>` holding zlib("<type> <size>\0<data>").
+ */
+
+#include "git_object_store.h"
+#include "allocator.h"
+#include "inflate.h"
+#include "platform.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifndef S_ISDIR // MSVC
+#define S_ISDIR(mode) (((mode) & _S_IFMT) == _S_IFDIR)
+#endif
+
+#define GIT_ID_LEN 20
+#define GIT_HEX_LEN 40
+#define OBJECT_CACHE_SIZE 64
+#define MAX_DELTA_DEPTH 4096 // git itself caps --depth at 4095
+#define MAX_PEEL_DEPTH 8
+
+typedef enum {
+  OBJ_NONE = -1,
+  OBJ_COMMIT = 1,
+  OBJ_TREE = 2,
+  OBJ_BLOB = 3,
+  OBJ_TAG = 4,
+  OBJ_OFS_DELTA = 6,
+  OBJ_REF_DELTA = 7
+} ObjectType;
+
+typedef struct {
+  const uint8_t *data;
+  size_t size;
+} MappedFile;
+
+typedef struct {
+  MappedFile idx;
+  MappedFile pack;
+  uint32_t object_count;
+  const uint8_t *fanout;    // 256 big-endian counts
+  const uint8_t *ids;       // object_count sorted ids
+  const uint8_t *offsets32; // object_count big-endian offsets
+  const uint8_t *offsets64; // Large offsets, indexed by the low 31 bits of offsets32
+  size_t offsets64_count;
+} GitPack;
+
+typedef struct {
+  uint8_t id[GIT_ID_LEN];
+  int type;
+  uint8_t *data; // NULL = empty slot
+  size_t len;
+} CachedObject;
+
+struct GitObjectStore {
+  char **object_dirs; // [0] = the repository, then alternates
+  int object_dir_count;
+  GitPack *packs;
+  int pack_count;
+  CachedObject cache[OBJECT_CACHE_SIZE];
+  int cache_next;
+  bool missing_object; // Set when a lookup found no pack entry or loose file
+};
+
+// ============================================================================
+// Filesystem Helpers
+// ============================================================================
+
+static char *path_join(const char *dir, const char *name) {
+  size_t dir_len = strlen(dir);
+  size_t name_len = strlen(name);
+  bool need_sep = dir_len > 0 && dir[dir_len - 1] != '/' && dir[dir_len - 1] != '\\';
+  char *joined = (char *)diff_malloc(dir_len + need_sep + name_len + 1);
+  if (!joined)
+    return NULL;
+  memcpy(joined, dir, dir_len);
+  if (need_sep)
+    joined[dir_len] = '/';
+  memcpy(joined + dir_len + need_sep, name, name_len + 1);
+  return joined;
+}
+
+static bool is_absolute_path(const char *path) {
+  if (path[0] == '/' || path[0] == '\\')
+    return true;
+  // Windows drive letter
+  return path[0] != '\0' && path[1] == ':';
+}
+
+static bool path_is_dir(const char *path) {
+  struct stat st;
+  return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+/**
+ * Read a whole file. Returns a NUL-terminated diff_malloc'd buffer, or NULL.
+ */
+static uint8_t *read_whole_file(const char *path, size_t *out_len) {
+  FILE *file = fopen(path, "rb");
+  if (!file)
+    return NULL;
+  size_t cap = 4096, len = 0;
+  uint8_t *buf = (uint8_t *)diff_malloc(cap);
+  while (buf) {
+    len += fread(buf + len, 1, cap - len - 1, file);
+    if (len < cap - 1)
+      break;
+    cap *= 2;
+    uint8_t *grown = (uint8_t *)diff_realloc(buf, cap);
+    if (!grown) {
+      diff_free(buf);
+      buf = NULL;
+    } else {
+      buf = grown;
+    }
+  }
+  bool failed = ferror(file) != 0;
+  fclose(file);
+  if (!buf || failed) {
+    diff_free(buf);
+    return NULL;
+  }
+  buf[len] = '\0';
+  if (out_len)
+    *out_len = len;
+  return buf;
+}
+
+/**
+ * Read the first line of a small text file (gitdir, commondir), trimmed.
+ */
+static char *read_first_line(const char *path) {
+  char *text = (char *)read_whole_file(path, NULL);
+  if (!text)
+    return NULL;
+  size_t len = strcspn(text, "\r\n");
+  while (len > 0 && (text[len - 1] == ' ' || text[len - 1] == '\t'))
+    len--;
+  text[len] = '\0';
+  return text;
+}
+
+static bool map_file(const char *path, MappedFile *out) {
+  out->data = NULL;
+  out->size = 0;
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE)
+    return false;
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+    CloseHandle(file);
+    return false;
+  }
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  CloseHandle(file);
+  if (!mapping)
+    return false;
+  // The view keeps the mapping alive after its handle is closed
+  void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (!view)
+    return false;
+  out->data = (const uint8_t *)view;
+  out->size = (size_t)size.QuadPart;
+#else
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return false;
+  }
+  void *view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (view == MAP_FAILED)
+    return false;
+  out->data = (const uint8_t *)view;
+  out->size = (size_t)st.st_size;
+#endif
+  return true;
+}
+
+static void unmap_file(MappedFile *file) {
+  if (!file->data)
+    return;
+#ifdef _WIN32
+  UnmapViewOfFile((void *)file->data);
+#else
+  munmap((void *)file->data, file->size);
+#endif
+  file->data = NULL;
+  file->size = 0;
+}
+
+// ============================================================================
+// Ids and Integers
+// ============================================================================
+
+static int hex_value(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+/**
+ * Parse exactly GIT_HEX_LEN hex digits.
+ */
+static bool parse_hex_id(const char *hex, uint8_t id[GIT_ID_LEN]) {
+  for (int i = 0; i < GIT_ID_LEN; i++) {
+    int hi = hex_value(hex[2 * i]);
+    int lo = hi < 0 ? -1 : hex_value(hex[2 * i + 1]);
+    if (lo < 0)
+      return false;
+    id[i] = (uint8_t)((hi << 4) | lo);
+  }
+  return true;
+}
+
+static void format_hex_id(const uint8_t id[GIT_ID_LEN], char hex[GIT_HEX_LEN + 1]) {
+  static const char DIGITS[] = "0123456789abcdef";
+  for (int i = 0; i < GIT_ID_LEN; i++) {
+    hex[2 * i] = DIGITS[id[i] >> 4];
+    hex[2 * i + 1] = DIGITS[id[i] & 0xf];
+  }
+  hex[GIT_HEX_LEN] = '\0';
+}
+
+static uint32_t read_be32(const uint8_t *p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint64_t read_be64(const uint8_t *p) {
+  return ((uint64_t)read_be32(p) << 32) | read_be32(p + 4);
+}
+
+// ============================================================================
+// Packs
+// ============================================================================
+
+static bool pack_load(const char *idx_path, GitPack *pack) {
+  memset(pack, 0, sizeof(*pack));
+
+  // "<name>.idx" -> "<name>.pack"
+  size_t base_len = strlen(idx_path) - 4;
+  char *pack_path = (char *)diff_malloc(base_len + 6);
+  if (!pack_path)
+    return false;
+  memcpy(pack_path, idx_path, base_len);
+  memcpy(pack_path + base_len, ".pack", 6);
+
+  bool ok = map_file(idx_path, &pack->idx) && map_file(pack_path, &pack->pack);
+  diff_free(pack_path);
+
+  // Index v2: magic, version, fanout, ids, crc32s, offsets, large offsets, 2 trailing ids
+  const uint8_t *idx = pack->idx.data;
+  size_t idx_size = pack->idx.size;
+  if (ok) {
+    ok = idx_size >= 8 + 256 * 4 + 2 * GIT_ID_LEN && memcmp(idx, "\377tOc", 4) == 0 &&
+         read_be32(idx + 4) == 2;
+  }
+  if (ok) {
+    pack->fanout = idx + 8;
+    pack->object_count = read_be32(pack->fanout + 255 * 4);
+    size_t base = 8 + 256 * 4;
+    size_t count = pack->object_count;
+    size_t tables = count * (GIT_ID_LEN + 4 + 4);
+    ok = tables <= idx_size - base - 2 * GIT_ID_LEN;
+    if (ok) {
+      pack->ids = idx + base;
+      pack->offsets32 = pack->ids + count * (GIT_ID_LEN + 4);
+      pack->offsets64 = pack->offsets32 + count * 4;
+      pack->offsets64_count = (idx_size - base - tables - 2 * GIT_ID_LEN) / 8;
+    }
+  }
+  // Pack header: "PACK", version 2 or 3
+  if (ok) {
+    const uint8_t *data = pack->pack.data;
+    ok = pack->pack.size >= 12 + GIT_ID_LEN && memcmp(data, "PACK", 4) == 0 &&
+         (read_be32(data + 4) == 2 || read_be32(data + 4) == 3);
+  }
+
+  if (!ok) {
+    unmap_file(&pack->idx);
+    unmap_file(&pack->pack);
+  }
+  return ok;
+}
+
+static void pack_unload(GitPack *pack) {
+  unmap_file(&pack->idx);
+  unmap_file(&pack->pack);
+}
+
+/**
+ * Find an object in a pack index. Returns false if the pack does not have it.
+ */
+static bool pack_find(const GitPack *pack, const uint8_t id[GIT_ID_LEN], uint64_t *out_offset) {
+  uint32_t lo = id[0] == 0 ? 0 : read_be32(pack->fanout + (id[0] - 1) * 4);
+  uint32_t hi = read_be32(pack->fanout + id[0] * 4);
+  if (hi > pack->object_count || lo > hi)
+    return false;
+
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    int cmp = memcmp(pack->ids + (size_t)mid * GIT_ID_LEN, id, GIT_ID_LEN);
+    if (cmp == 0) {
+      uint32_t offset = read_be32(pack->offsets32 + (size_t)mid * 4);
+      if (offset & 0x80000000u) {
+        size_t large = offset & 0x7fffffffu;
+        if (large >= pack->offsets64_count)
+          return false;
+        *out_offset = read_be64(pack->offsets64 + large * 8);
+      } else {
+        *out_offset = offset;
+      }
+      return true;
+    }
+    if (cmp < 0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return false;
+}
+
+#ifdef _WIN32
+static void scan_pack_dir(const char *pack_dir, GitPack **packs, int *count, int *capacity) {
+  char *pattern = path_join(pack_dir, "*.idx");
+  if (!pattern)
+    return;
+  WIN32_FIND_DATAA entry;
+  HANDLE find = FindFirstFileA(pattern, &entry);
+  diff_free(pattern);
+  if (find == INVALID_HANDLE_VALUE)
+    return;
+  do {
+    const char *name = entry.cFileName;
+#else
+static void scan_pack_dir(const char *pack_dir, GitPack **packs, int *count, int *capacity) {
+  DIR *dir = opendir(pack_dir);
+  if (!dir)
+    return;
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL) {
+    const char *name = entry->d_name;
+#endif
+    size_t name_len = strlen(name);
+    if (name_len > 4 && strcmp(name + name_len - 4, ".idx") == 0) {
+      if (*count == *capacity) {
+        int grown_capacity = *capacity ? *capacity * 2 : 8;
+        GitPack *grown =
+            (GitPack *)diff_realloc(*packs, (size_t)grown_capacity * sizeof(GitPack));
+        if (grown) {
+          *packs = grown;
+          *capacity = grown_capacity;
+        }
+      }
+      char *idx_path = path_join(pack_dir, name);
+      if (idx_path && *count < *capacity && pack_load(idx_path, &(*packs)[*count]))
+        (*count)++;
+      diff_free(idx_path);
+    }
+#ifdef _WIN32
+  } while (FindNextFileA(find, &entry));
+  FindClose(find);
+#else
+  }
+  closedir(dir);
+#endif
+}
+
+static void store_unload_packs(GitObjectStore *store) {
+  for (int i = 0; i < store->pack_count; i++)
+    pack_unload(&store->packs[i]);
+  diff_free(store->packs);
+  store->packs = NULL;
+  store->pack_count = 0;
+}
+
+static void store_load_packs(GitObjectStore *store) {
+  store_unload_packs(store);
+  int capacity = 0;
+  for (int i = 0; i < store->object_dir_count; i++) {
+    char *pack_dir = path_join(store->object_dirs[i], "pack");
+    if (pack_dir)
+      scan_pack_dir(pack_dir, &store->packs, &store->pack_count, &capacity);
+    diff_free(pack_dir);
+  }
+}
+
+// ============================================================================
+// Object Decoding
+// ============================================================================
+
+static bool read_delta_size(const uint8_t **p, const uint8_t *end, size_t *out) {
+  size_t value = 0;
+  int shift = 0;
+  uint8_t c;
+  do {
+    if (*p >= end || shift > 56)
+      return false;
+    c = *(*p)++;
+    value |= (size_t)(c & 0x7f) << shift;
+    shift += 7;
+  } while (c & 0x80);
+  *out = value;
+  return true;
+}
+
+/**
+ * Apply a git delta (copy/insert instruction stream) to its base object.
+ */
+static bool apply_delta(const uint8_t *base, size_t base_len, const uint8_t *delta,
+                        size_t delta_len, uint8_t **out_data, size_t *out_len) {
+  const uint8_t *p = delta;
+  const uint8_t *end = delta + delta_len;
+  size_t src_size, dst_size;
+  if (!read_delta_size(&p, end, &src_size) || !read_delta_size(&p, end, &dst_size) ||
+      src_size != base_len)
+    return false;
+
+  uint8_t *dst = (uint8_t *)diff_malloc(dst_size + 1);
+  if (!dst)
+    return false;
+  size_t written = 0;
+  bool ok = true;
+
+  while (ok && p < end) {
+    uint8_t op = *p++;
+    if (op & 0x80) {
+      // Copy from base: offset and size bytes present per flag bit
+      size_t offset = 0, size = 0;
+      for (int i = 0; i < 4; i++) {
+        if (op & (1 << i)) {
+          ok = ok && p < end;
+          offset |= ok ? (size_t)*p++ << (8 * i) : 0;
+        }
+      }
+      for (int i = 0; i < 3; i++) {
+        if (op & (0x10 << i)) {
+          ok = ok && p < end;
+          size |= ok ? (size_t)*p++ << (8 * i) : 0;
+        }
+      }
+      if (size == 0)
+        size = 0x10000;
+      ok = ok && offset <= base_len && size <= base_len - offset && size <= dst_size - written;
+      if (ok) {
+        memcpy(dst + written, base + offset, size);
+        written += size;
+      }
+    } else if (op != 0) {
+      // Insert literal bytes
+      size_t size = op;
+      ok = size <= (size_t)(end - p) && size <= dst_size - written;
+      if (ok) {
+        memcpy(dst + written, p, size);
+        written += size;
+        p += size;
+      }
+    } else {
+      ok = false; // Reserved opcode
+    }
+  }
+
+  if (!ok || written != dst_size) {
+    diff_free(dst);
+    return false;
+  }
+  *out_data = dst;
+  *out_len = dst_size;
+  return true;
+}
+
+static int read_object(GitObjectStore *store, const uint8_t id[GIT_ID_LEN], int depth,
+                       uint8_t **out_data, size_t *out_len);
+
+/**
+ * Decode the pack entry at `offset`, resolving delta chains.
+ * Returns the object type, or OBJ_NONE.
+ */
+static int pack_read_entry(GitObjectStore *store, const GitPack *pack, uint64_t offset, int depth,
+                           uint8_t **out_data, size_t *out_len) {
+  *out_data = NULL;
+  *out_len = 0;
+  const uint8_t *data = pack->pack.data;
+  size_t end = pack->pack.size - GIT_ID_LEN; // Trailing pack checksum
+  if (depth > MAX_DELTA_DEPTH || offset < 12 || offset >= end)
+    return OBJ_NONE;
+
+  // Entry header: 3-bit type and a little-endian base-128 size
+  size_t pos = (size_t)offset;
+  uint8_t c = data[pos++];
+  int type = (c >> 4) & 7;
+  uint64_t size = c & 0x0f;
+  int shift = 4;
+  while (c & 0x80) {
+    if (pos >= end || shift > 57)
+      return OBJ_NONE;
+    c = data[pos++];
+    size |= (uint64_t)(c & 0x7f) << shift;
+    shift += 7;
+  }
+  if (size > SIZE_MAX - 1)
+    return OBJ_NONE;
+
+  if (type >= OBJ_COMMIT && type <= OBJ_TAG) {
+    if (!zlib_inflate(data + pos, end - pos, (size_t)size, out_data, out_len))
+      return OBJ_NONE;
+    if (*out_len != size) {
+      diff_free(*out_data);
+      *out_data = NULL;
+      return OBJ_NONE;
+    }
+    return type;
+  }
+
+  uint8_t *base = NULL;
+  size_t base_len = 0;
+  int base_type = OBJ_NONE;
+  if (type == OBJ_OFS_DELTA) {
+    // Negative offset to the base, big-endian base-128 with an implicit +1 per byte
+    if (pos >= end)
+      return OBJ_NONE;
+    c = data[pos++];
+    uint64_t back = c & 0x7f;
+    while (c & 0x80) {
+      if (pos >= end || back >= (UINT64_MAX >> 7))
+        return OBJ_NONE;
+      c = data[pos++];
+      back = ((back + 1) << 7) | (c & 0x7f);
+    }
+    if (back == 0 || back > offset)
+      return OBJ_NONE;
+    base_type = pack_read_entry(store, pack, offset - back, depth + 1, &base, &base_len);
+  } else if (type == OBJ_REF_DELTA) {
+    if (pos + GIT_ID_LEN > end)
+      return OBJ_NONE;
+    base_type = read_object(store, data + pos, depth + 1, &base, &base_len);
+    pos += GIT_ID_LEN;
+  }
+  if (base_type == OBJ_NONE)
+    return OBJ_NONE;
+
+  uint8_t *delta = NULL;
+  size_t delta_len = 0;
+  bool ok = zlib_inflate(data + pos, end - pos, (size_t)size, &delta, &delta_len) &&
+            apply_delta(base, base_len, delta, delta_len, out_data, out_len);
+  diff_free(delta);
+  diff_free(base);
+  return ok ? base_type : OBJ_NONE;
+}
+
+static int parse_loose_type(const char *name, size_t len) {
+  if (len == 4 && memcmp(name, "blob", 4) == 0)
+    return OBJ_BLOB;
+  if (len == 4 && memcmp(name, "tree", 4) == 0)
+    return OBJ_TREE;
+  if (len == 6 && memcmp(name, "commit", 6) == 0)
+    return OBJ_COMMIT;
+  if (len == 3 && memcmp(name, "tag", 3) == 0)
+    return OBJ_TAG;
+  return OBJ_NONE;
+}
+
+static int read_loose_object(GitObjectStore *store, const uint8_t id[GIT_ID_LEN],
+                             uint8_t **out_data, size_t *out_len) {
+  char hex[GIT_HEX_LEN + 1];
+  format_hex_id(id, hex);
+  // "xx/" + 38 hex digits
+  char rel[GIT_HEX_LEN + 2];
+  memcpy(rel, hex, 2);
+  rel[2] = '/';
+  memcpy(rel + 3, hex + 2, GIT_HEX_LEN - 1);
+
+  for (int i = 0; i < store->object_dir_count; i++) {
+    char *path = path_join(store->object_dirs[i], rel);
+    size_t compressed_len = 0;
+    uint8_t *compressed = path ? read_whole_file(path, &compressed_len) : NULL;
+    diff_free(path);
+    if (!compressed)
+      continue;
+
+    uint8_t *raw = NULL;
+    size_t raw_len = 0;
+    bool ok = zlib_inflate(compressed, compressed_len, 0, &raw, &raw_len);
+    diff_free(compressed);
+    if (!ok)
+      return OBJ_NONE;
+
+    // Header: "<type> <decimal size>\0"
+    const uint8_t *nul = (const uint8_t *)memchr(raw, '\0', raw_len);
+    const uint8_t *space = nul ? (const uint8_t *)memchr(raw, ' ', (size_t)(nul - raw)) : NULL;
+    int type = space ? parse_loose_type((const char *)raw, (size_t)(space - raw)) : OBJ_NONE;
+    size_t size = 0;
+    for (const uint8_t *d = space ? space + 1 : nul; type != OBJ_NONE && d < nul; d++) {
+      if (*d < '0' || *d > '9')
+        type = OBJ_NONE;
+      else
+        size = size * 10 + (size_t)(*d - '0');
+    }
+    size_t header_len = nul ? (size_t)(nul - raw) + 1 : 0;
+    if (type == OBJ_NONE || raw_len - header_len != size) {
+      diff_free(raw);
+      return OBJ_NONE;
+    }
+    memmove(raw, raw + header_len, size);
+    *out_data = raw;
+    *out_len = size;
+    return type;
+  }
+  store->missing_object = true;
+  return OBJ_NONE;
+}
+
+/**
+ * Read any object by id. Returns its type and a diff_malloc'd payload, or OBJ_NONE.
+ */
+static int read_object(GitObjectStore *store, const uint8_t id[GIT_ID_LEN], int depth,
+                       uint8_t **out_data, size_t *out_len) {
+  *out_data = NULL;
+  *out_len = 0;
+  for (int i = 0; i < store->pack_count; i++) {
+    uint64_t offset;
+    if (pack_find(&store->packs[i], id, &offset))
+      return pack_read_entry(store, &store->packs[i], offset, depth, out_data, out_len);
+  }
+  return read_loose_object(store, id, out_data, out_len);
+}
+
+/**
+ * Read a commit, tag or tree through the cache. The returned data is owned by
+ * the cache and stays valid until the next cached read.
+ */
+static int read_cached_object(GitObjectStore *store, const uint8_t id[GIT_ID_LEN],
+                              const uint8_t **out_data, size_t *out_len) {
+  for (int i = 0; i < OBJECT_CACHE_SIZE; i++) {
+    CachedObject *entry = &store->cache[i];
+    if (entry->data && memcmp(entry->id, id, GIT_ID_LEN) == 0) {
+      *out_data = entry->data;
+      *out_len = entry->len;
+      return entry->type;
+    }
+  }
+
+  uint8_t *data;
+  size_t len;
+  int type = read_object(store, id, 0, &data, &len);
+  if (type == OBJ_NONE)
+    return OBJ_NONE;
+  if (type == OBJ_BLOB) {
+    // Never worth caching; callers of this function only want containers
+    diff_free(data);
+    return OBJ_BLOB;
+  }
+
+  CachedObject *slot = &store->cache[store->cache_next];
+  store->cache_next = (store->cache_next + 1) % OBJECT_CACHE_SIZE;
+  diff_free(slot->data);
+  memcpy(slot->id, id, GIT_ID_LEN);
+  slot->type = type;
+  slot->data = data;
+  slot->len = len;
+  *out_data = data;
+  *out_len = len;
+  return type;
+}
+
+// ============================================================================
+// Revisions and Trees
+// ============================================================================
+
+/**
+ * Peel annotated tags and commits down to their root tree id.
+ */
+static bool resolve_root_tree(GitObjectStore *store, const uint8_t id[GIT_ID_LEN],
+                              uint8_t tree_id[GIT_ID_LEN]) {
+  uint8_t current[GIT_ID_LEN];
+  memcpy(current, id, GIT_ID_LEN);
+  for (int i = 0; i < MAX_PEEL_DEPTH; i++) {
+    const uint8_t *data;
+    size_t len;
+    int type = read_cached_object(store, current, &data, &len);
+    if (type == OBJ_TREE) {
+      memcpy(tree_id, current, GIT_ID_LEN);
+      return true;
+    }
+    // Both start with the id they point at: "tree <hex>\n" / "object <hex>\n"
+    const char *field = type == OBJ_COMMIT ? "tree " : type == OBJ_TAG ? "object " : NULL;
+    if (!field)
+      return false;
+    size_t field_len = strlen(field);
+    if (len < field_len + GIT_HEX_LEN || memcmp(data, field, field_len) != 0 ||
+        !parse_hex_id((const char *)data + field_len, current))
+      return false;
+  }
+  return false;
+}
+
+/**
+ * Find `name` in a tree. Tree entries are "<octal mode> <name>\0<20-byte id>".
+ * Returns 1 if found, 0 if absent, -1 if the tree is malformed.
+ */
+static int tree_find_entry(const uint8_t *tree, size_t tree_len, const char *name, size_t name_len,
+                           uint32_t *out_mode, uint8_t out_id[GIT_ID_LEN]) {
+  size_t pos = 0;
+  while (pos < tree_len) {
+    uint32_t mode = 0;
+    while (pos < tree_len && tree[pos] != ' ') {
+      if (tree[pos] < '0' || tree[pos] > '7')
+        return -1;
+      mode = mode * 8 + (uint32_t)(tree[pos++] - '0');
+    }
+    size_t entry_name = ++pos;
+    const uint8_t *nul =
+        pos < tree_len ? (const uint8_t *)memchr(tree + pos, '\0', tree_len - pos) : NULL;
+    if (!nul)
+      return -1;
+    size_t entry_name_len = (size_t)(nul - tree) - entry_name;
+    pos = (size_t)(nul - tree) + 1;
+    if (pos + GIT_ID_LEN > tree_len)
+      return -1;
+    if (entry_name_len == name_len && memcmp(tree + entry_name, name, name_len) == 0) {
+      *out_mode = mode;
+      memcpy(out_id, tree + pos, GIT_ID_LEN);
+      return 1;
+    }
+    pos += GIT_ID_LEN;
+  }
+  return 0;
+}
+
+#define MODE_TYPE_MASK 0170000
+#define MODE_TREE 0040000
+#define MODE_GITLINK 0160000
+
+static int read_blob_at(GitObjectStore *store, const uint8_t revision[GIT_ID_LEN], const char *path,
+                        char **out_data, size_t *out_len) {
+  uint8_t id[GIT_ID_LEN];
+  if (!resolve_root_tree(store, revision, id))
+    return GIT_STORE_ERROR;
+
+  uint32_t mode = MODE_TREE;
+  const char *component = path;
+  while (*component) {
+    const char *slash = strchr(component, '/');
+    size_t len = slash ? (size_t)(slash - component) : strlen(component);
+    if (len == 0) {
+      component++; // Tolerate "a//b" and a leading "/"
+      continue;
+    }
+    if ((mode & MODE_TYPE_MASK) != MODE_TREE)
+      return GIT_STORE_NOT_FOUND; // A file where a directory was expected
+
+    const uint8_t *tree;
+    size_t tree_len;
+    if (read_cached_object(store, id, &tree, &tree_len) != OBJ_TREE)
+      return GIT_STORE_ERROR;
+    int found = tree_find_entry(tree, tree_len, component, len, &mode, id);
+    if (found < 0)
+      return GIT_STORE_ERROR;
+    if (found == 0)
+      return GIT_STORE_NOT_FOUND;
+    component += len;
+  }
+
+  // Directories and submodules are left to `git show`
+  uint32_t kind = mode & MODE_TYPE_MASK;
+  if (kind == MODE_TREE || kind == MODE_GITLINK)
+    return GIT_STORE_ERROR;
+
+  uint8_t *data;
+  size_t len;
+  int type = read_object(store, id, 0, &data, &len);
+  if (type != OBJ_BLOB) {
+    diff_free(data);
+    return GIT_STORE_ERROR;
+  }
+  *out_data = (char *)data;
+  *out_len = len;
+  return GIT_STORE_OK;
+}
+
+// ============================================================================
+// Repository Discovery
+// ============================================================================
+
+/**
+ * Resolve `path` to a git directory: `<path>/.git` (directory or `gitdir:`
+ * file) or `path` itself when it already is one.
+ */
+static char *find_git_dir(const char *path) {
+  char *dot_git = path_join(path, ".git");
+  if (!dot_git)
+    return NULL;
+  if (path_is_dir(dot_git))
+    return dot_git;
+
+  char *line = read_first_line(dot_git);
+  diff_free(dot_git);
+  if (line) {
+    char *git_dir = NULL;
+    if (strncmp(line, "gitdir:", 7) == 0) {
+      const char *target = line + 7;
+      while (*target == ' ')
+        target++;
+      git_dir = is_absolute_path(target) ? diff_strdup(target) : path_join(path, target);
+    }
+    diff_free(line);
+    return git_dir;
+  }
+
+  char *objects = path_join(path, "objects");
+  bool is_git_dir = objects && path_is_dir(objects);
+  diff_free(objects);
+  return is_git_dir ? diff_strdup(path) : NULL;
+}
+
+static bool store_add_object_dir(GitObjectStore *store, char *dir) {
+  char **grown = (char **)diff_realloc(store->object_dirs,
+                                       (size_t)(store->object_dir_count + 1) * sizeof(char *));
+  if (!grown) {
+    diff_free(dir);
+    return false;
+  }
+  store->object_dirs = grown;
+  store->object_dirs[store->object_dir_count++] = dir;
+  return true;
+}
+
+/**
+ * Add the object directories listed in objects/info/alternates (one level).
+ */
+static void store_add_alternates(GitObjectStore *store, const char *objects_dir) {
+  char *alternates_path = path_join(objects_dir, "info/alternates");
+  char *text = alternates_path ? (char *)read_whole_file(alternates_path, NULL) : NULL;
+  diff_free(alternates_path);
+  if (!text)
+    return;
+
+  char *line = text;
+  while (*line) {
+    size_t len = strcspn(line, "\r\n");
+    char *next = line + len;
+    if (*next)
+      next += strspn(next, "\r\n");
+    line[len] = '\0';
+    if (len > 0 && line[0] != '#') {
+      char *dir = is_absolute_path(line) ? diff_strdup(line) : path_join(objects_dir, line);
+      if (dir && path_is_dir(dir))
+        store_add_object_dir(store, dir);
+      else
+        diff_free(dir);
+    }
+    line = next;
+  }
+  diff_free(text);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+GitObjectStore *git_store_open(const char *path) {
+  if (!path)
+    return NULL;
+  char *git_dir = find_git_dir(path);
+  if (!git_dir)
+    return NULL;
+
+  // Linked worktrees share the main repository's objects via "commondir"
+  char *common_dir = git_dir;
+  char *commondir_file = path_join(git_dir, "commondir");
+  char *common = commondir_file ? read_first_line(commondir_file) : NULL;
+  diff_free(commondir_file);
+  if (common && common[0]) {
+    common_dir = is_absolute_path(common) ? diff_strdup(common) : path_join(git_dir, common);
+  }
+  diff_free(common);
+
+  char *objects_dir = common_dir ? path_join(common_dir, "objects") : NULL;
+  if (common_dir != git_dir)
+    diff_free(common_dir);
+  diff_free(git_dir);
+  if (!objects_dir || !path_is_dir(objects_dir)) {
+    diff_free(objects_dir);
+    return NULL;
+  }
+
+  GitObjectStore *store = (GitObjectStore *)diff_calloc(1, sizeof(GitObjectStore));
+  if (!store) {
+    diff_free(objects_dir);
+    return NULL;
+  }
+  if (!store_add_object_dir(store, objects_dir)) {
+    diff_free(store);
+    return NULL;
+  }
+  store_add_alternates(store, store->object_dirs[0]);
+  store_load_packs(store);
+  return store;
+}
+
+void git_store_close(GitObjectStore *store) {
+  if (!store)
+    return;
+  store_unload_packs(store);
+  for (int i = 0; i < OBJECT_CACHE_SIZE; i++)
+    diff_free(store->cache[i].data);
+  for (int i = 0; i < store->object_dir_count; i++)
+    diff_free(store->object_dirs[i]);
+  diff_free(store->object_dirs);
+  diff_free(store);
+}
+
+int git_store_read_blob(GitObjectStore *store, const char *revision, const char *path,
+                        char **out_data, size_t *out_len) {
+  *out_data = NULL;
+  *out_len = 0;
+  uint8_t id[GIT_ID_LEN];
+  if (!store || !revision || !path || strlen(revision) != GIT_HEX_LEN ||
+      !parse_hex_id(revision, id))
+    return GIT_STORE_ERROR;
+
+  store->missing_object = false;
+  int status = read_blob_at(store, id, path, out_data, out_len);
+  if (status == GIT_STORE_ERROR && store->missing_object) {
+    // Objects may have moved into new packs (gc, fetch) since the store was opened
+    store_load_packs(store);
+    status = read_blob_at(store, id, path, out_data, out_len);
+  }
+  return status;
+}
+
+void git_store_free_blob(char *data) { diff_free(data); }
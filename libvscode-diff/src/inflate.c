@@ -0,0 +1,329 @@
+/**
+ * Minimal zlib/DEFLATE Decoder
+ *
+ * Straightforward RFC 1951 decoder in the style of zlib's contrib/puff:
+ * canonical Huffman codes are decoded from per-length counts, which keeps the
+ * tables tiny (no lookup table construction per block) at the cost of a
+ * bit-at-a-time decode loop. Git blobs are small enough that this is far
+ * cheaper than spawning `git show`.
+ *
+ * The Adler-32 trailer is not verified - git already checks object ids.
+ */
+
+#include "inflate.h"
+#include "allocator.h"
+#include <string.h>
+
+#define MAX_BITS 15       // Longest DEFLATE code
+#define MAX_LIT_CODES 286 // Literal/length codes in a dynamic block
+#define MAX_DIST_CODES 30 // Distance codes
+#define FIXED_LIT_CODES 288
+
+typedef struct {
+  const uint8_t *in;
+  size_t in_len;
+  size_t in_pos;
+  uint32_t bit_buf;
+  int bit_count;
+  uint8_t *out;
+  size_t out_len;
+  size_t out_cap;
+  bool error;
+} InflateState;
+
+/**
+ * Canonical Huffman code: number of codes of each length and the symbols
+ * ordered by code.
+ */
+typedef struct {
+  short count[MAX_BITS + 1];
+  short symbol[FIXED_LIT_CODES];
+} Huffman;
+
+// ============================================================================
+// Bit Input / Byte Output
+// ============================================================================
+
+static int take_bits(InflateState *s, int need) {
+  uint32_t val = s->bit_buf;
+  while (s->bit_count < need) {
+    if (s->in_pos >= s->in_len) {
+      s->error = true;
+      return 0;
+    }
+    val |= (uint32_t)s->in[s->in_pos++] << s->bit_count;
+    s->bit_count += 8;
+  }
+  s->bit_buf = val >> need;
+  s->bit_count -= need;
+  return (int)(val & ((1u << need) - 1));
+}
+
+static bool reserve_output(InflateState *s, size_t extra) {
+  if (s->out_len + extra <= s->out_cap)
+    return true;
+  size_t cap = s->out_cap ? s->out_cap : 256;
+  while (cap < s->out_len + extra)
+    cap *= 2;
+  uint8_t *grown = (uint8_t *)diff_realloc(s->out, cap);
+  if (!grown)
+    return false;
+  s->out = grown;
+  s->out_cap = cap;
+  return true;
+}
+
+// ============================================================================
+// Huffman Codes
+// ============================================================================
+
+/**
+ * Build a canonical code from code lengths. Returns 0 for a complete code,
+ * a positive value for an incomplete one, negative if over-subscribed.
+ */
+static int huffman_build(Huffman *h, const short *lengths, int n) {
+  memset(h->count, 0, sizeof(h->count));
+  for (int i = 0; i < n; i++)
+    h->count[lengths[i]]++;
+  if (h->count[0] == n)
+    return 0;
+
+  int left = 1;
+  for (int len = 1; len <= MAX_BITS; len++) {
+    left <<= 1;
+    left -= h->count[len];
+    if (left < 0)
+      return left;
+  }
+
+  short offs[MAX_BITS + 1];
+  offs[1] = 0;
+  for (int len = 1; len < MAX_BITS; len++)
+    offs[len + 1] = (short)(offs[len] + h->count[len]);
+  for (int i = 0; i < n; i++) {
+    if (lengths[i] != 0)
+      h->symbol[offs[lengths[i]]++] = (short)i;
+  }
+  return left;
+}
+
+static int huffman_decode(InflateState *s, const Huffman *h) {
+  int code = 0;  // Bits read so far, MSB first
+  int first = 0; // First code of the current length
+  int index = 0; // Index of the first code of this length in symbol[]
+  for (int len = 1; len <= MAX_BITS; len++) {
+    code |= take_bits(s, 1);
+    if (s->error)
+      return -1;
+    int count = h->count[len];
+    if (code - count < first)
+      return h->symbol[index + (code - first)];
+    index += count;
+    first += count;
+    first <<= 1;
+    code <<= 1;
+  }
+  s->error = true;
+  return -1;
+}
+
+// ============================================================================
+// Blocks
+// ============================================================================
+
+static const short LENGTH_BASE[29] = {3,  4,  5,  6,  7,  8,  9,  10,  11,  13,
+                                      15, 17, 19, 23, 27, 31, 35, 43,  51,  59,
+                                      67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const short LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                       2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const short DIST_BASE[30] = {1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+                                    33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+                                    1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const short DIST_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                     6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+static bool inflate_stored(InflateState *s) {
+  // Stored blocks start on a byte boundary
+  s->bit_buf = 0;
+  s->bit_count = 0;
+  if (s->in_pos + 4 > s->in_len)
+    return false;
+  unsigned len = s->in[s->in_pos] | ((unsigned)s->in[s->in_pos + 1] << 8);
+  unsigned nlen = s->in[s->in_pos + 2] | ((unsigned)s->in[s->in_pos + 3] << 8);
+  s->in_pos += 4;
+  if (len != (~nlen & 0xffff) || s->in_pos + len > s->in_len)
+    return false;
+  if (!reserve_output(s, len))
+    return false;
+  memcpy(s->out + s->out_len, s->in + s->in_pos, len);
+  s->out_len += len;
+  s->in_pos += len;
+  return true;
+}
+
+static bool inflate_codes(InflateState *s, const Huffman *lit, const Huffman *dist) {
+  for (;;) {
+    int symbol = huffman_decode(s, lit);
+    if (symbol < 0)
+      return false;
+    if (symbol < 256) {
+      if (!reserve_output(s, 1))
+        return false;
+      s->out[s->out_len++] = (uint8_t)symbol;
+      continue;
+    }
+    if (symbol == 256)
+      return true;
+
+    symbol -= 257;
+    if (symbol >= 29)
+      return false;
+    size_t len = (size_t)(LENGTH_BASE[symbol] + take_bits(s, LENGTH_EXTRA[symbol]));
+
+    symbol = huffman_decode(s, dist);
+    if (symbol < 0 || symbol >= 30)
+      return false;
+    size_t back = (size_t)(DIST_BASE[symbol] + take_bits(s, DIST_EXTRA[symbol]));
+    if (s->error || back > s->out_len)
+      return false;
+
+    if (!reserve_output(s, len))
+      return false;
+    // Byte-wise copy: source and destination may overlap (run-length matches)
+    uint8_t *dst = s->out + s->out_len;
+    const uint8_t *src = dst - back;
+    for (size_t i = 0; i < len; i++)
+      dst[i] = src[i];
+    s->out_len += len;
+  }
+}
+
+static bool inflate_fixed(InflateState *s) {
+  short lengths[FIXED_LIT_CODES];
+  Huffman lit, dist;
+  int sym = 0;
+  for (; sym < 144; sym++)
+    lengths[sym] = 8;
+  for (; sym < 256; sym++)
+    lengths[sym] = 9;
+  for (; sym < 280; sym++)
+    lengths[sym] = 7;
+  for (; sym < FIXED_LIT_CODES; sym++)
+    lengths[sym] = 8;
+  huffman_build(&lit, lengths, FIXED_LIT_CODES);
+  for (sym = 0; sym < MAX_DIST_CODES; sym++)
+    lengths[sym] = 5;
+  huffman_build(&dist, lengths, MAX_DIST_CODES);
+  return inflate_codes(s, &lit, &dist);
+}
+
+static bool inflate_dynamic(InflateState *s) {
+  static const short CODE_LENGTH_ORDER[19] = {16, 17, 18, 0, 8,  7, 9,  6, 10, 5,
+                                              11, 4,  12, 3, 13, 2, 14, 1, 15};
+  short lengths[MAX_LIT_CODES + MAX_DIST_CODES];
+  Huffman lit, dist;
+
+  int nlen = take_bits(s, 5) + 257;
+  int ndist = take_bits(s, 5) + 1;
+  int ncode = take_bits(s, 4) + 4;
+  if (s->error || nlen > MAX_LIT_CODES || ndist > MAX_DIST_CODES)
+    return false;
+
+  int index = 0;
+  for (; index < ncode; index++)
+    lengths[CODE_LENGTH_ORDER[index]] = (short)take_bits(s, 3);
+  for (; index < 19; index++)
+    lengths[CODE_LENGTH_ORDER[index]] = 0;
+  if (s->error || huffman_build(&lit, lengths, 19) != 0)
+    return false;
+
+  index = 0;
+  while (index < nlen + ndist) {
+    int symbol = huffman_decode(s, &lit);
+    if (symbol < 0)
+      return false;
+    if (symbol < 16) {
+      lengths[index++] = (short)symbol;
+      continue;
+    }
+    short repeat_len = 0;
+    int repeat;
+    if (symbol == 16) {
+      if (index == 0)
+        return false;
+      repeat_len = lengths[index - 1];
+      repeat = 3 + take_bits(s, 2);
+    } else if (symbol == 17) {
+      repeat = 3 + take_bits(s, 3);
+    } else {
+      repeat = 11 + take_bits(s, 7);
+    }
+    if (s->error || index + repeat > nlen + ndist)
+      return false;
+    while (repeat--)
+      lengths[index++] = repeat_len;
+  }
+  if (lengths[256] == 0)
+    return false;
+
+  // Incomplete codes are only allowed for a single length code
+  int err = huffman_build(&lit, lengths, nlen);
+  if (err < 0 || (err > 0 && nlen - lit.count[0] != 1))
+    return false;
+  err = huffman_build(&dist, lengths + nlen, ndist);
+  if (err < 0 || (err > 0 && ndist - dist.count[0] != 1))
+    return false;
+
+  return inflate_codes(s, &lit, &dist);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+bool zlib_inflate(const uint8_t *src, size_t src_len, size_t size_hint, uint8_t **out_data,
+                  size_t *out_len) {
+  *out_data = NULL;
+  *out_len = 0;
+
+  // zlib header: CM = 8 (deflate), no preset dictionary, header checksum
+  if (src_len < 2)
+    return false;
+  if ((src[0] & 0x0f) != 8 || (src[1] & 0x20) != 0 || ((src[0] << 8) | src[1]) % 31 != 0)
+    return false;
+
+  InflateState s;
+  memset(&s, 0, sizeof(s));
+  s.in = src;
+  s.in_len = src_len;
+  s.in_pos = 2;
+  // +1 so an empty result still owns a buffer
+  if (!reserve_output(&s, size_hint + 1))
+    return false;
+
+  bool ok = true;
+  int last;
+  do {
+    last = take_bits(&s, 1);
+    int type = take_bits(&s, 2);
+    if (s.error) {
+      ok = false;
+    } else if (type == 0) {
+      ok = inflate_stored(&s);
+    } else if (type == 1) {
+      ok = inflate_fixed(&s);
+    } else if (type == 2) {
+      ok = inflate_dynamic(&s);
+    } else {
+      ok = false;
+    }
+  } while (ok && !last);
+
+  if (!ok || s.error) {
+    diff_free(s.out);
+    return false;
+  }
+  *out_data = s.out;
+  *out_len = s.out_len;
+  return true;
+}
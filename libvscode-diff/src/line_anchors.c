@@ -0,0 +1,448 @@
+/**
+ * Chunk Anchors
+ *
+ * Content-defined chunking of lines before the line-level Myers pass (see
+ * line_anchors.h). Each line is hashed once with 64-bit FNV-1a; chunks are
+ * grouped by the combined hash of their lines, and a chunk that is unique on
+ * both sides is verified line by line before it may become an anchor. The
+ * anchors kept are a longest increasing run of those matches (patience
+ * sorting, O(k log k)).
+ */
+
+#include "line_anchors.h"
+#include "allocator.h"
+#include "utils.h"
+#include <string.h>
+
+// Chunk size bounds in lines
+#define ANCHOR_MIN_CHUNK_LINES 4
+#define ANCHOR_MAX_CHUNK_LINES 128
+
+// A boundary follows a line whose hash has these low bits zero (1 in 16)
+#define ANCHOR_BOUNDARY_MASK 15u
+
+typedef struct {
+  int *starts;      // Chunk i covers lines [starts[i], starts[i + 1])
+  uint64_t *hashes; // Combined line hash per chunk
+  int count;
+} LineChunks;
+
+typedef struct {
+  uint64_t hash;
+  int chunk_a; // Last chunk with this hash on each side
+  int chunk_b;
+  int count_a; // Occurrences on each side
+  int count_b;
+  bool used;
+} ChunkSlot;
+
+typedef struct {
+  int chunk_a;
+  int chunk_b;
+} AnchorMatch;
+
+static uint64_t line_hash(const char *line) {
+  uint64_t h = 0xCBF29CE484222325ull; // FNV-1a
+  for (const unsigned char *p = (const unsigned char *)line; *p; p++) {
+    h = (h ^ *p) * 0x100000001B3ull;
+  }
+  return h;
+}
+
+static bool line_chunks_build(LineChunks *chunks, const char **lines, int count) {
+  size_t capacity = (size_t)count / ANCHOR_MIN_CHUNK_LINES + 2;
+  chunks->starts = (int *)diff_malloc_array(capacity, sizeof(int));
+  chunks->hashes = (uint64_t *)diff_malloc_array(capacity, sizeof(uint64_t));
+  chunks->count = 0;
+  if (!chunks->starts || !chunks->hashes) {
+    return false;
+  }
+
+  int n = 0;
+  int start = 0;
+  uint64_t h = 0;
+  chunks->starts[0] = 0;
+  for (int i = 0; i < count; i++) {
+    uint64_t lh = line_hash(lines[i]);
+    h = (h ^ lh) * 0x100000001B3ull;
+    int size = i + 1 - start;
+    if (size >= ANCHOR_MIN_CHUNK_LINES &&
+        ((lh & ANCHOR_BOUNDARY_MASK) == 0 || size >= ANCHOR_MAX_CHUNK_LINES)) {
+      chunks->hashes[n] = h ^ (uint64_t)size;
+      chunks->starts[++n] = i + 1;
+      start = i + 1;
+      h = 0;
+    }
+  }
+  if (start < count) {
+    chunks->hashes[n] = h ^ (uint64_t)(count - start);
+    chunks->starts[++n] = count;
+  }
+  chunks->count = n;
+  return true;
+}
+
+static void line_chunks_free(LineChunks *chunks) {
+  diff_free(chunks->starts);
+  diff_free(chunks->hashes);
+}
+
+static bool chunks_equal(const char **lines_a, const LineChunks *chunks_a, int chunk_a,
+                         const char **lines_b, const LineChunks *chunks_b, int chunk_b) {
+  int a0 = chunks_a->starts[chunk_a];
+  int b0 = chunks_b->starts[chunk_b];
+  int length = chunks_a->starts[chunk_a + 1] - a0;
+  if (chunks_b->starts[chunk_b + 1] - b0 != length) {
+    return false;
+  }
+  for (int i = 0; i < length; i++) {
+    if (strcmp(lines_a[a0 + i], lines_b[b0 + i]) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Verified matches of chunks that occur exactly once on each side, in
+ * original order.
+ */
+static AnchorMatch *find_unique_matches(const char **lines_a, const LineChunks *chunks_a,
+                                        const char **lines_b, const LineChunks *chunks_b,
+                                        int *out_count) {
+  *out_count = 0;
+  size_t capacity = 16;
+  while (capacity < ((size_t)chunks_a->count + chunks_b->count) * 2) {
+    capacity <<= 1;
+  }
+  ChunkSlot *slots = (ChunkSlot *)diff_calloc(capacity, sizeof(ChunkSlot));
+  if (!slots) {
+    return NULL;
+  }
+
+  const LineChunks *sides[2] = {chunks_a, chunks_b};
+  for (int side = 0; side < 2; side++) {
+    for (int i = 0; i < sides[side]->count; i++) {
+      uint64_t hash = sides[side]->hashes[i];
+      size_t slot = (size_t)(hash ^ (hash >> 32)) & (capacity - 1);
+      while (slots[slot].used && slots[slot].hash != hash) {
+        slot = (slot + 1) & (capacity - 1);
+      }
+      ChunkSlot *s = &slots[slot];
+      s->used = true;
+      s->hash = hash;
+      if (side == 0) {
+        s->chunk_a = i;
+        s->count_a++;
+      } else {
+        s->chunk_b = i;
+        s->count_b++;
+      }
+    }
+  }
+
+  AnchorMatch *matches =
+      (AnchorMatch *)diff_malloc_array((size_t)chunks_a->count + 1, sizeof(AnchorMatch));
+  if (matches) {
+    int n = 0;
+    for (int i = 0; i < chunks_a->count; i++) {
+      uint64_t hash = chunks_a->hashes[i];
+      size_t slot = (size_t)(hash ^ (hash >> 32)) & (capacity - 1);
+      while (slots[slot].hash != hash) {
+        slot = (slot + 1) & (capacity - 1);
+      }
+      const ChunkSlot *s = &slots[slot];
+      if (s->count_a == 1 && s->count_b == 1 &&
+          chunks_equal(lines_a, chunks_a, i, lines_b, chunks_b, s->chunk_b)) {
+        matches[n].chunk_a = i;
+        matches[n].chunk_b = s->chunk_b;
+        n++;
+      }
+    }
+    *out_count = n;
+  }
+
+  diff_free(slots);
+  return matches;
+}
+
+/**
+ * Keep the longest subsequence of matches that is increasing on the modified
+ * side as well (in place). Returns the new count, or -1 on allocation failure.
+ */
+static int longest_increasing_matches(AnchorMatch *matches, int count) {
+  if (count == 0) {
+    return 0;
+  }
+  int *tails = (int *)diff_malloc_array((size_t)count, sizeof(int));
+  int *prev = (int *)diff_malloc_array((size_t)count, sizeof(int));
+  if (!tails || !prev) {
+    diff_free(tails);
+    diff_free(prev);
+    return -1;
+  }
+
+  int length = 0;
+  for (int i = 0; i < count; i++) {
+    int lo = 0;
+    int hi = length;
+    while (lo < hi) {
+      int mid = (lo + hi) / 2;
+      if (matches[tails[mid]].chunk_b < matches[i].chunk_b) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    prev[i] = lo > 0 ? tails[lo - 1] : -1;
+    tails[lo] = i;
+    if (lo == length) {
+      length++;
+    }
+  }
+
+  // Walk back from the last tail; indices only decrease, so in place is safe
+  int k = length - 1;
+  for (int i = tails[length - 1]; i >= 0; i = prev[i]) {
+    matches[k--] = matches[i];
+  }
+
+  diff_free(tails);
+  diff_free(prev);
+  return length;
+}
+
+//==============================================================================
+// Stitching
+//==============================================================================
+
+typedef struct {
+  const char **lines_a;
+  const char **lines_b;
+  SequenceDiffArray *result;
+  LineIdentities *identities; // Can be NULL
+  uint32_t next_id;
+  int timeout_ms;
+  int64_t start_ms;
+  int64_t max_memory_bytes;
+  bool *hit_timeout;
+  int *degradations;
+  bool blocks_only; // Report spans as changed blocks instead of aligning them
+} AnchorStitch;
+
+/**
+ * Give lines that only take part as changed lines their own IDs.
+ */
+static void assign_fresh_ids(AnchorStitch *st, int a0, int a1, int b0, int b1) {
+  if (!st->identities) {
+    return;
+  }
+  for (int i = a0; i < a1; i++) {
+    st->identities->original[i] = st->next_id++;
+  }
+  for (int i = b0; i < b1; i++) {
+    st->identities->modified[i] = st->next_id++;
+  }
+}
+
+/**
+ * Align the lines between two anchors and append the offset diffs.
+ */
+static bool align_span(AnchorStitch *st, int a0, int a1, int b0, int b1) {
+  if (st->blocks_only) {
+    // Equal lines at either end are not part of the block
+    while (a0 < a1 && b0 < b1 && strcmp(st->lines_a[a0], st->lines_b[b0]) == 0) {
+      a0++;
+      b0++;
+    }
+    while (a0 < a1 && b0 < b1 && strcmp(st->lines_a[a1 - 1], st->lines_b[b1 - 1]) == 0) {
+      a1--;
+      b1--;
+    }
+  }
+  if (a0 == a1 && b0 == b1) {
+    return true;
+  }
+  if (a0 == a1 || b0 == b1 || st->blocks_only) {
+    assign_fresh_ids(st, a0, a1, b0, b1);
+    return sequence_diff_array_append(st->result, (SequenceDiff){a0, a1, b0, b1});
+  }
+
+  // Spans share the time budget; once it is spent they get 1ms each,
+  // which sends them to the capped search
+  int timeout_ms = 0;
+  if (st->timeout_ms > 0) {
+    int64_t elapsed_ms = get_current_time_ms() - st->start_ms;
+    timeout_ms = elapsed_ms < st->timeout_ms ? (int)(st->timeout_ms - elapsed_ms) : 1;
+  }
+
+  bool span_timeout = false;
+  LineIdentities span_ids = {NULL, NULL};
+  SequenceDiffArray *diffs = compute_line_alignments(
+      st->lines_a + a0, a1 - a0, st->lines_b + b0, b1 - b0, timeout_ms, &span_timeout,
+      st->identities ? &span_ids : NULL, st->max_memory_bytes, st->degradations);
+  if (!diffs) {
+    line_identities_free(&span_ids);
+    return false;
+  }
+  if (span_timeout) {
+    *st->hit_timeout = true;
+  }
+
+  if (st->identities) {
+    uint32_t max_id = 0;
+    for (int i = 0; i < a1 - a0; i++) {
+      uint32_t id = span_ids.original[i];
+      st->identities->original[a0 + i] = st->next_id + id;
+      max_id = id > max_id ? id : max_id;
+    }
+    for (int i = 0; i < b1 - b0; i++) {
+      uint32_t id = span_ids.modified[i];
+      st->identities->modified[b0 + i] = st->next_id + id;
+      max_id = id > max_id ? id : max_id;
+    }
+    st->next_id += max_id + 1;
+    line_identities_free(&span_ids);
+  }
+
+  bool ok = true;
+  for (int i = 0; ok && i < diffs->count; i++) {
+    const SequenceDiff *d = &diffs->diffs[i];
+    SequenceDiff shifted = {a0 + d->seq1_start, a0 + d->seq1_end, b0 + d->seq2_start,
+                            b0 + d->seq2_end};
+    ok = sequence_diff_array_append(st->result, shifted);
+  }
+  sequence_diff_array_free(diffs);
+  return ok;
+}
+
+/**
+ * Find the anchors of both sides. Returns the anchor count (0 if there are
+ * none, -1 on allocation failure); the caller frees the chunks and anchors.
+ */
+static int find_anchors(const char **lines_a, int len_a, const char **lines_b, int len_b,
+                        LineChunks *chunks_a, LineChunks *chunks_b, AnchorMatch **anchors) {
+  *anchors = NULL;
+  if (!line_chunks_build(chunks_a, lines_a, len_a) ||
+      !line_chunks_build(chunks_b, lines_b, len_b)) {
+    return -1;
+  }
+  int count = 0;
+  *anchors = find_unique_matches(lines_a, chunks_a, lines_b, chunks_b, &count);
+  return *anchors ? longest_increasing_matches(*anchors, count) : -1;
+}
+
+/**
+ * Walk the anchors, handing each span between them to align_span().
+ */
+static SequenceDiffArray *stitch_anchors(AnchorStitch *st, int len_a, int len_b,
+                                         const LineChunks *chunks_a, const LineChunks *chunks_b,
+                                         const AnchorMatch *anchors, int anchor_count) {
+  LineIdentities *identities = st->identities;
+  st->result = (SequenceDiffArray *)diff_calloc(1, sizeof(SequenceDiffArray));
+  bool ok = st->result != NULL;
+  if (ok && identities) {
+    identities->original = (uint32_t *)diff_malloc_array((size_t)len_a, sizeof(uint32_t));
+    identities->modified = (uint32_t *)diff_malloc_array((size_t)len_b, sizeof(uint32_t));
+    ok = identities->original && identities->modified;
+  }
+
+  int a_done = 0;
+  int b_done = 0;
+  for (int i = 0; ok && i <= anchor_count; i++) {
+    int a_start = i < anchor_count ? chunks_a->starts[anchors[i].chunk_a] : len_a;
+    int b_start = i < anchor_count ? chunks_b->starts[anchors[i].chunk_b] : len_b;
+    ok = align_span(st, a_done, a_start, b_done, b_start);
+    if (!ok || i == anchor_count) {
+      break;
+    }
+
+    // Anchored lines are equal on both sides: one shared ID per pair
+    int length = chunks_a->starts[anchors[i].chunk_a + 1] - a_start;
+    if (identities) {
+      for (int j = 0; j < length; j++) {
+        identities->original[a_start + j] = st->next_id;
+        identities->modified[b_start + j] = st->next_id++;
+      }
+    }
+    a_done = a_start + length;
+    b_done = b_start + length;
+  }
+
+  if (!ok) {
+    sequence_diff_array_free(st->result);
+    line_identities_free(identities);
+    return NULL;
+  }
+  return st->result;
+}
+
+SequenceDiffArray *compute_anchored_line_alignments(const char **lines_a, int len_a,
+                                                    const char **lines_b, int len_b,
+                                                    int timeout_ms, bool *hit_timeout,
+                                                    LineIdentities *identities,
+                                                    int64_t max_memory_bytes, int *degradations) {
+  if (!lines_a || !lines_b || !hit_timeout) {
+    return NULL;
+  }
+  if ((int64_t)len_a + len_b < LINE_ANCHORS_MIN_LINES || len_a == 0 || len_b == 0) {
+    return compute_line_alignments(lines_a, len_a, lines_b, len_b, timeout_ms, hit_timeout,
+                                   identities, max_memory_bytes, degradations);
+  }
+  *hit_timeout = false;
+  int64_t start_ms = get_current_time_ms();
+
+  LineChunks chunks_a = {NULL, NULL, 0};
+  LineChunks chunks_b = {NULL, NULL, 0};
+  AnchorMatch *anchors = NULL;
+  int anchor_count = find_anchors(lines_a, len_a, lines_b, len_b, &chunks_a, &chunks_b, &anchors);
+
+  SequenceDiffArray *result;
+  if (anchor_count <= 0) {
+    // Nothing to anchor on (or out of memory): plain alignment
+    result = compute_line_alignments(lines_a, len_a, lines_b, len_b, timeout_ms, hit_timeout,
+                                     identities, max_memory_bytes, degradations);
+  } else {
+    AnchorStitch st = {.lines_a = lines_a,
+                       .lines_b = lines_b,
+                       .identities = identities,
+                       .timeout_ms = timeout_ms,
+                       .start_ms = start_ms,
+                       .max_memory_bytes = max_memory_bytes,
+                       .hit_timeout = hit_timeout,
+                       .degradations = degradations};
+    result = stitch_anchors(&st, len_a, len_b, &chunks_a, &chunks_b, anchors, anchor_count);
+  }
+
+  diff_free(anchors);
+  line_chunks_free(&chunks_a);
+  line_chunks_free(&chunks_b);
+  return result;
+}
+
+SequenceDiffArray *compute_anchored_line_blocks(const char **lines_a, int len_a,
+                                                const char **lines_b, int len_b) {
+  if (!lines_a || !lines_b) {
+    return NULL;
+  }
+
+  LineChunks chunks_a = {NULL, NULL, 0};
+  LineChunks chunks_b = {NULL, NULL, 0};
+  AnchorMatch *anchors = NULL;
+  int anchor_count = find_anchors(lines_a, len_a, lines_b, len_b, &chunks_a, &chunks_b, &anchors);
+
+  SequenceDiffArray *result = NULL;
+  if (anchor_count >= 0) {
+    bool unused_timeout = false;
+    AnchorStitch st = {.lines_a = lines_a,
+                       .lines_b = lines_b,
+                       .hit_timeout = &unused_timeout,
+                       .blocks_only = true};
+    result = stitch_anchors(&st, len_a, len_b, &chunks_a, &chunks_b, anchors, anchor_count);
+  }
+
+  diff_free(anchors);
+  line_chunks_free(&chunks_a);
+  line_chunks_free(&chunks_b);
+  return result;
+}
@@ -14,10 +14,13 @@
  */
 
 #include "line_level.h"
+#include "allocator.h"
+#include "cost_model.h"
 #include "myers.h"
 #include "optimize.h"
 #include "sequence.h"
 #include "string_hash_map.h"
+#include "utils.h"
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
@@ -37,10 +40,15 @@
  * 
  * This scoring function makes the DP algorithm prefer longer matching lines
  * and gives minimal score to empty line matches.
+ *
+ * The string compare is an untrimmed-ID compare (LineSequence.full_hash) and
+ * the match score is looked up from a per-line table, since the DP calls this
+ * for every cell.
  */
 typedef struct {
-  const char **lines_a;
-  const char **lines_b;
+  const uint32_t *full_a;      // Untrimmed line IDs of seq1
+  const uint32_t *full_b;      // Untrimmed line IDs of seq2
+  const double *match_score_b; // Score of a match ending on each seq2 line
 } LineEqualityContext;
 
 static double line_equality_score(const ISequence *seq1, const ISequence *seq2, int offset1,
@@ -49,18 +57,155 @@ static double line_equality_score(const ISequence *seq1, const ISequence *seq2,
   (void)seq2;
 
   LineEqualityContext *ctx = (LineEqualityContext *)user_data;
-  const char *line_a = ctx->lines_a[offset1];
-  const char *line_b = ctx->lines_b[offset2];
+  if (ctx->full_a[offset1] == ctx->full_b[offset2]) {
+    return ctx->match_score_b[offset2]; // Lines are equal
+  }
+
+  return 0.99; // Non-matching lines get nearly 1.0 (high penalty)
+}
+
+/**
+ * Precompute the match score of each modified line: 0.1 for an empty line
+ * (minimal score), 1 + log(1 + length) otherwise (prefer longer matches).
+ */
+static double *compute_match_scores(const LineSequence *seq) {
+  double *scores = (double *)diff_malloc_array((size_t)(seq->length > 0 ? seq->length : 1), sizeof(double));
+  if (!scores) {
+    return NULL;
+  }
+  for (int i = 0; i < seq->length; i++) {
+    size_t len = seq->line_lengths[i];
+    scores[i] = len == 0 ? 0.1 : 1.0 + log(1.0 + (double)len);
+  }
+  return scores;
+}
+
+/**
+ * One-sided line discard (xdiff's record cleanup, without its heuristics)
+ *
+ * A line whose trimmed ID never occurs on the other side can only ever be
+ * deleted or inserted, in every alignment. Dropping such lines before O(ND)
+ * Myers shrinks N + M and D, and the optimal alignments of the reduced
+ * sequences are exactly those of the full ones. The result is mapped back
+ * by turning the gaps between matched lines into diffs.
+ */
+typedef struct {
+  uint32_t *ids_a; // Trimmed IDs of the kept seq1 lines
+  uint32_t *ids_b;
+  int *index_a; // Original index of each kept seq1 line
+  int *index_b;
+  int len_a;
+  int len_b;
+} ReducedLines;
 
-  if (strcmp(line_a, line_b) == 0) {
-    // Lines are equal
-    if (strlen(line_b) == 0) {
-      return 0.1; // Empty line match gets minimal score
+static void reduced_lines_free(ReducedLines *r) {
+  diff_free(r->ids_a);
+  diff_free(r->ids_b);
+  diff_free(r->index_a);
+  diff_free(r->index_b);
+}
+
+/**
+ * Keep the lines of one side whose ID occurs on the other side.
+ */
+static bool reduce_side(const uint32_t *ids, int len, const uint8_t *sides, uint8_t other,
+                        uint32_t **out_ids, int **out_index, int *out_len) {
+  int kept = 0;
+  for (int i = 0; i < len; i++) {
+    kept += (sides[ids[i]] & other) ? 1 : 0;
+  }
+  *out_ids = (uint32_t *)diff_malloc_array((size_t)(kept > 0 ? kept : 1), sizeof(uint32_t));
+  *out_index = (int *)diff_malloc_array((size_t)(kept > 0 ? kept : 1), sizeof(int));
+  if (!*out_ids || !*out_index) {
+    return false;
+  }
+  int k = 0;
+  for (int i = 0; i < len; i++) {
+    if (sides[ids[i]] & other) {
+      (*out_ids)[k] = ids[i];
+      (*out_index)[k] = i;
+      k++;
     }
-    return 1.0 + log(1.0 + (double)strlen(line_b)); // Prefer longer matches
   }
+  *out_len = kept;
+  return true;
+}
 
-  return 0.99; // Non-matching lines get nearly 1.0 (high penalty)
+/**
+ * Drop the one-sided lines of both sequences.
+ *
+ * @return false if no line is one-sided (nothing to gain) or allocation failed
+ */
+static bool reduce_lines(const LineSequence *seq1, const LineSequence *seq2, int id_count,
+                         ReducedLines *r) {
+  memset(r, 0, sizeof(*r));
+  uint8_t *sides = (uint8_t *)diff_calloc((size_t)(id_count > 0 ? id_count : 1), 1);
+  if (!sides) {
+    return false;
+  }
+  for (int i = 0; i < seq1->length; i++) {
+    sides[seq1->trimmed_hash[i]] |= 1;
+  }
+  for (int i = 0; i < seq2->length; i++) {
+    sides[seq2->trimmed_hash[i]] |= 2;
+  }
+
+  bool ok = reduce_side(seq1->trimmed_hash, seq1->length, sides, 2, &r->ids_a, &r->index_a,
+                        &r->len_a) &&
+            reduce_side(seq2->trimmed_hash, seq2->length, sides, 1, &r->ids_b, &r->index_b,
+                        &r->len_b);
+  diff_free(sides);
+  if (!ok || (r->len_a == seq1->length && r->len_b == seq2->length)) {
+    reduced_lines_free(r);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Map diffs of the reduced sequences back to the full ones: every pair of
+ * lines the reduced diffs leave unchanged stays matched, everything between
+ * two matched pairs becomes one diff.
+ *
+ * @return Diffs over the full sequences (caller must free), or NULL if
+ *         allocation failed
+ */
+static SequenceDiffArray *expand_reduced_diffs(const SequenceDiffArray *reduced,
+                                               const ReducedLines *r, int len_a, int len_b) {
+  SequenceDiffArray *out = (SequenceDiffArray *)diff_calloc(1, sizeof(SequenceDiffArray));
+  if (!out) {
+    return NULL;
+  }
+  int next_a = 0; // First full-sequence line after the last matched pair
+  int next_b = 0;
+  int pos_a = 0;
+  int pos_b = 0;
+  bool ok = true;
+  for (int i = 0; ok && i <= reduced->count; i++) {
+    int equal_end_a = i < reduced->count ? reduced->diffs[i].seq1_start : r->len_a;
+    for (; ok && pos_a < equal_end_a; pos_a++, pos_b++) {
+      int a = r->index_a[pos_a];
+      int b = r->index_b[pos_b];
+      if (a > next_a || b > next_b) {
+        ok = sequence_diff_array_append(out, (SequenceDiff){next_a, a, next_b, b});
+      }
+      next_a = a + 1;
+      next_b = b + 1;
+    }
+    if (i < reduced->count) {
+      pos_a = reduced->diffs[i].seq1_end;
+      pos_b = reduced->diffs[i].seq2_end;
+    }
+  }
+  if (ok && (next_a < len_a || next_b < len_b)) {
+    ok = sequence_diff_array_append(out, (SequenceDiff){next_a, len_a, next_b, len_b});
+  }
+  if (!ok) {
+    diff_free(out->diffs);
+    diff_free(out);
+    return NULL;
+  }
+  return out;
 }
 
 /**
@@ -69,7 +214,9 @@ static double line_equality_score(const ISequence *seq1, const ISequence *seq2,
  * Implements exact VSCode pipeline from defaultLinesDiffComputer.ts:224-245
  */
 SequenceDiffArray *compute_line_alignments(const char **lines_a, int len_a, const char **lines_b,
-                                           int len_b, int timeout_ms, bool *hit_timeout) {
+                                           int len_b, int timeout_ms, bool *hit_timeout,
+                                           LineIdentities *identities, int64_t max_memory_bytes,
+                                           int *degradations) {
 
   if (!lines_a || !lines_b || !hit_timeout) {
     return NULL;
@@ -88,20 +235,80 @@ SequenceDiffArray *compute_line_alignments(const char **lines_a, int len_a, cons
   // Pass true to hash trimmed lines, matching VSCode's getOrCreateHash(l.trim())
   ISequence *seq1 = line_sequence_create(lines_a, len_a, true, hash_map);
   ISequence *seq2 = line_sequence_create(lines_b, len_b, true, hash_map);
+  if (!hash_map || !seq1 || !seq2) {
+    if (seq1)
+      seq1->destroy(seq1);
+    if (seq2)
+      seq2->destroy(seq2);
+    string_hash_map_destroy(hash_map);
+    return NULL;
+  }
 
   // Step 4: Run Myers diff with algorithm selection (VSCode line 83-97)
+  // (diff_select_engine() also skips O(ND) searches that cannot finish in time)
   SequenceDiffArray *line_alignments;
 
-  int total_lines = len_a + len_b;
-  if (total_lines < 1700) {
+  // Above VSCode's DP threshold, O(ND) runs on the lines that can match at all
+  const ISequence *search1 = seq1;
+  const ISequence *search2 = seq2;
+  ReducedLines reduced;
+  ArraySequence reduced1;
+  ArraySequence reduced2;
+  bool use_reduced = len_a + len_b >= 1700 &&
+                     reduce_lines((const LineSequence *)seq1->data,
+                                  (const LineSequence *)seq2->data,
+                                  string_hash_map_size(hash_map), &reduced);
+  if (use_reduced) {
+    array_sequence_init(&reduced1, reduced.ids_a, reduced.len_a);
+    array_sequence_init(&reduced2, reduced.ids_b, reduced.len_b);
+    search1 = &reduced1.iface;
+    search2 = &reduced2.iface;
+  }
+
+  DiffEngine engine = diff_select_engine(search1, search2, use_reduced ? 0 : 1700, timeout_ms,
+                                         NULL);
+  if (engine == DIFF_ENGINE_DP && max_memory_bytes > 0 &&
+      myers_dp_memory_bytes(len_a, len_b, true) > max_memory_bytes) {
+    // DP table over budget: O(ND) instead (may align differently from VSCode)
+    engine = DIFF_ENGINE_ND;
+    if (degradations)
+      *degradations |= DIFF_DEGRADED_DP_TO_ND;
+  }
+
+  if (engine == DIFF_ENGINE_DP) {
     // Use DP algorithm with equality scoring for small files
-    LineEqualityContext ctx = {.lines_a = lines_a, .lines_b = lines_b};
+    const LineSequence *line_seq1 = (const LineSequence *)seq1->data;
+    const LineSequence *line_seq2 = (const LineSequence *)seq2->data;
+    double *match_scores = compute_match_scores(line_seq2);
+    LineEqualityContext ctx = {.full_a = line_seq1->full_hash,
+                               .full_b = line_seq2->full_hash,
+                               .match_score_b = match_scores};
 
-    line_alignments =
-        myers_dp_diff_algorithm(seq1, seq2, timeout_ms, hit_timeout, line_equality_score, &ctx);
-  } else {
+    line_alignments = match_scores ? myers_dp_diff_algorithm(seq1, seq2, timeout_ms, hit_timeout,
+                                                             line_equality_score, &ctx)
+                                   : NULL;
+    diff_free(match_scores);
+  } else if (engine == DIFF_ENGINE_ND) {
     // Use Myers O(ND) for large files
-    line_alignments = myers_nd_diff_algorithm(seq1, seq2, timeout_ms, hit_timeout);
+    bool hit_memory_limit = false;
+    line_alignments = myers_nd_bounded_diff_algorithm(search1, search2, timeout_ms,
+                                                      max_memory_bytes, hit_timeout,
+                                                      &hit_memory_limit);
+    if (hit_memory_limit && degradations)
+      *degradations |= DIFF_DEGRADED_LINEAR_SPACE;
+  } else {
+    // Exact search cannot finish in time: go straight to the timeout fallback
+    line_alignments = myers_nd_capped_diff_algorithm(search1, search2);
+    *hit_timeout = true;
+  }
+
+  if (use_reduced) {
+    SequenceDiffArray *reduced_alignments = line_alignments;
+    line_alignments =
+        reduced_alignments ? expand_reduced_diffs(reduced_alignments, &reduced, len_a, len_b)
+                           : NULL;
+    free_sequence_diff_array(reduced_alignments);
+    reduced_lines_free(&reduced);
   }
 
   if (!line_alignments) {
@@ -112,10 +319,20 @@ SequenceDiffArray *compute_line_alignments(const char **lines_a, int len_a, cons
   }
 
   // Step 5: Apply Step 2 optimization (VSCode line 244)
-  line_alignments = optimize_sequence_diffs(seq1, seq2, line_alignments);
-
   // Step 6: Apply Step 3 optimization (VSCode line 245)
-  line_alignments = remove_very_short_matching_lines_between_diffs(seq1, seq2, line_alignments);
+  if (!optimize_sequence_diffs(seq1, seq2, line_alignments) ||
+      !remove_very_short_matching_lines_between_diffs(seq1, seq2, line_alignments)) {
+    free_sequence_diff_array(line_alignments);
+    line_alignments = NULL;
+  }
+
+  // Hand the untrimmed IDs to the caller instead of freeing them with the sequences
+  if (identities && line_alignments) {
+    identities->original = ((LineSequence *)seq1->data)->full_hash;
+    identities->modified = ((LineSequence *)seq2->data)->full_hash;
+    ((LineSequence *)seq1->data)->full_hash = NULL;
+    ((LineSequence *)seq2->data)->full_hash = NULL;
+  }
 
   // Cleanup sequences (but keep the result)
   seq1->destroy(seq1);
@@ -125,12 +342,21 @@ SequenceDiffArray *compute_line_alignments(const char **lines_a, int len_a, cons
   return line_alignments;
 }
 
+void line_identities_free(LineIdentities *identities) {
+  if (identities) {
+    diff_free(identities->original);
+    diff_free(identities->modified);
+    identities->original = NULL;
+    identities->modified = NULL;
+  }
+}
+
 /**
  * Helper: Free SequenceDiffArray
  */
 void free_sequence_diff_array(SequenceDiffArray *arr) {
   if (arr) {
-    free(arr->diffs);
-    free(arr);
+    diff_free(arr->diffs);
+    diff_free(arr);
   }
 }
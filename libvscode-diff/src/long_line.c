@@ -0,0 +1,266 @@
+/**
+ * Long-Line Mode
+ *
+ * Content-defined chunking of character sequences (see long_line.h).
+ *
+ * Boundaries use a gear hash: h = (h << 1) + gear(c). After 32 steps every
+ * earlier unit has been shifted out, so the top bits of h depend only on the
+ * last 32 units, and a boundary is placed where they are all zero. Chunks are
+ * interned to dense IDs by content (hash, then exact comparison), so equal
+ * IDs always mean equal text.
+ */
+
+#include "long_line.h"
+#include "allocator.h"
+#include "cost_model.h"
+#include "myers.h"
+#include "utils.h"
+#include <stdint.h>
+#include <string.h>
+
+// Chunk size bounds (UTF-16 units); the hash adds about 32 to the minimum
+#define LONG_LINE_MIN_CHUNK 16
+#define LONG_LINE_MAX_CHUNK 512
+
+// A boundary needs the top GEAR_BOUNDARY_BITS of the gear hash to be zero
+#define GEAR_BOUNDARY_BITS 5
+
+// Sub-ranges with at most this many DP cells (about 1 byte each unscored) go
+// to the DP engine. This covers VSCode's 500-unit threshold and also the
+// lopsided ranges of a moved block, where O(ND) explores a D x min(N, M) band.
+#define LONG_LINE_DP_MAX_CELLS ((int64_t)1 << 22)
+
+//==============================================================================
+// Chunking
+//==============================================================================
+
+typedef struct {
+  int *starts;   // Chunk i covers [starts[i], starts[i + 1])
+  uint32_t *ids; // Interned chunk IDs
+  int count;
+} Chunks;
+
+static uint32_t gear(uint32_t c) {
+  // murmur3 finalizer: spreads code units over all 32 bits
+  c ^= 0x9E3779B9u;
+  c ^= c >> 16;
+  c *= 0x85EBCA6Bu;
+  c ^= c >> 13;
+  c *= 0xC2B2AE35u;
+  c ^= c >> 16;
+  return c;
+}
+
+static bool chunks_build(Chunks *chunks, const uint32_t *elements, int length) {
+  // Every chunk but the last has at least LONG_LINE_MIN_CHUNK units
+  size_t capacity = (size_t)length / LONG_LINE_MIN_CHUNK + 2;
+  chunks->starts = (int *)diff_malloc_array(capacity, sizeof(int));
+  chunks->ids = (uint32_t *)diff_malloc_array(capacity, sizeof(uint32_t));
+  chunks->count = 0;
+  if (!chunks->starts || !chunks->ids) {
+    return false;
+  }
+
+  int n = 0;
+  int start = 0;
+  uint32_t h = 0;
+  chunks->starts[n++] = 0;
+  for (int i = 0; i < length; i++) {
+    h = (h << 1) + gear(elements[i]);
+    int size = i + 1 - start;
+    if (size >= LONG_LINE_MIN_CHUNK &&
+        ((h >> (32 - GEAR_BOUNDARY_BITS)) == 0 || size >= LONG_LINE_MAX_CHUNK)) {
+      chunks->starts[n++] = i + 1;
+      start = i + 1;
+    }
+  }
+  if (start < length) {
+    chunks->starts[n++] = length;
+  }
+  chunks->count = n - 1;
+  return true;
+}
+
+static void chunks_free(Chunks *chunks) {
+  diff_free(chunks->starts);
+  diff_free(chunks->ids);
+}
+
+typedef struct {
+  uint64_t hash;
+  const uint32_t *elements; // NULL = empty slot
+  int length;
+  uint32_t id;
+} ChunkSlot;
+
+static uint64_t chunk_hash(const uint32_t *elements, int length) {
+  uint64_t h = 0xCBF29CE484222325ull; // FNV-1a
+  for (int i = 0; i < length; i++) {
+    h = (h ^ elements[i]) * 0x100000001B3ull;
+  }
+  return h ^ (uint64_t)length;
+}
+
+/**
+ * Give equal chunks of both sides the same ID.
+ */
+static bool chunks_intern(Chunks *chunks1, const uint32_t *elements1, Chunks *chunks2,
+                          const uint32_t *elements2) {
+  size_t capacity = 16;
+  while (capacity < ((size_t)chunks1->count + chunks2->count) * 2) {
+    capacity <<= 1;
+  }
+  ChunkSlot *slots = (ChunkSlot *)diff_calloc(capacity, sizeof(ChunkSlot));
+  if (!slots) {
+    return false;
+  }
+
+  uint32_t next_id = 0;
+  Chunks *sides[2] = {chunks1, chunks2};
+  const uint32_t *side_elements[2] = {elements1, elements2};
+  for (int side = 0; side < 2; side++) {
+    Chunks *chunks = sides[side];
+    for (int i = 0; i < chunks->count; i++) {
+      const uint32_t *elements = side_elements[side] + chunks->starts[i];
+      int length = chunks->starts[i + 1] - chunks->starts[i];
+      uint64_t hash = chunk_hash(elements, length);
+      size_t slot = (size_t)(hash ^ (hash >> 32)) & (capacity - 1);
+      while (slots[slot].elements &&
+             (slots[slot].hash != hash || slots[slot].length != length ||
+              memcmp(slots[slot].elements, elements, (size_t)length * sizeof(uint32_t)) != 0)) {
+        slot = (slot + 1) & (capacity - 1);
+      }
+      if (!slots[slot].elements) {
+        slots[slot].hash = hash;
+        slots[slot].elements = elements;
+        slots[slot].length = length;
+        slots[slot].id = next_id++;
+      }
+      chunks->ids[i] = slots[slot].id;
+    }
+  }
+
+  diff_free(slots);
+  return true;
+}
+
+//==============================================================================
+// Diff
+//==============================================================================
+
+/**
+ * Character diff of one differing chunk range, appended at its offsets.
+ * A negative timeout_ms means the budget is spent.
+ */
+static bool diff_range(SequenceDiffArray *out, const uint32_t *elements1, int start1, int end1,
+                       const uint32_t *elements2, int start2, int end2, int timeout_ms,
+                       bool *hit_timeout) {
+  if (start1 == end1 || start2 == end2) {
+    return sequence_diff_array_append(out, (SequenceDiff){start1, end1, start2, end2});
+  }
+
+  ArraySequence sub1;
+  ArraySequence sub2;
+  array_sequence_init(&sub1, elements1 + start1, end1 - start1);
+  array_sequence_init(&sub2, elements2 + start2, end2 - start2);
+
+  bool local_timeout = false;
+  SequenceDiffArray *diffs;
+  DiffEngine engine;
+  if ((int64_t)(end1 - start1) * (end2 - start2) <= LONG_LINE_DP_MAX_CELLS) {
+    engine = DIFF_ENGINE_DP;
+  } else if (timeout_ms < 0) {
+    engine = DIFF_ENGINE_ND_CAPPED;
+  } else {
+    engine = diff_select_engine(&sub1.iface, &sub2.iface, 0, timeout_ms, NULL);
+  }
+  if (engine == DIFF_ENGINE_DP) {
+    diffs = myers_dp_diff_algorithm(&sub1.iface, &sub2.iface, timeout_ms, &local_timeout, NULL,
+                                    NULL);
+  } else if (engine == DIFF_ENGINE_ND) {
+    diffs = myers_nd_diff_algorithm(&sub1.iface, &sub2.iface, timeout_ms, &local_timeout);
+  } else {
+    diffs = myers_nd_capped_diff_algorithm(&sub1.iface, &sub2.iface);
+    local_timeout = true;
+  }
+  if (!diffs) {
+    return false;
+  }
+  if (local_timeout) {
+    *hit_timeout = true;
+  }
+
+  bool ok = true;
+  for (int i = 0; ok && i < diffs->count; i++) {
+    const SequenceDiff *d = &diffs->diffs[i];
+    SequenceDiff shifted = {start1 + d->seq1_start, start1 + d->seq1_end, start2 + d->seq2_start,
+                            start2 + d->seq2_end};
+    ok = sequence_diff_array_append(out, shifted);
+  }
+  sequence_diff_array_free(diffs);
+  return ok;
+}
+
+bool long_line_mode_applies(const CharSequence *seq1, const CharSequence *seq2) {
+  int64_t total = (int64_t)seq1->length + seq2->length;
+  int64_t lines = (int64_t)seq1->line_count + seq2->line_count;
+  return total >= LONG_LINE_MIN_TOTAL_LENGTH && total >= lines * LONG_LINE_MIN_AVERAGE_LENGTH;
+}
+
+SequenceDiffArray *long_line_diff(const ISequence *seq1, const ISequence *seq2, int timeout_ms,
+                                  bool *hit_timeout) {
+  const uint32_t *elements1 = seq1->elements;
+  const uint32_t *elements2 = seq2->elements;
+  if (!elements1 || !elements2) {
+    return NULL;
+  }
+  int64_t start_ms = get_current_time_ms();
+
+  Chunks chunks1 = {NULL, NULL, 0};
+  Chunks chunks2 = {NULL, NULL, 0};
+  bool ok = chunks_build(&chunks1, elements1, seq1->getLength(seq1)) &&
+            chunks_build(&chunks2, elements2, seq2->getLength(seq2)) &&
+            chunks_intern(&chunks1, elements1, &chunks2, elements2);
+  SequenceDiffArray *chunk_diffs = NULL;
+  if (ok) {
+    ArraySequence chunk_seq1;
+    ArraySequence chunk_seq2;
+    array_sequence_init(&chunk_seq1, chunks1.ids, chunks1.count);
+    array_sequence_init(&chunk_seq2, chunks2.ids, chunks2.count);
+    // Any minimal chunk alignment will do; the linear-space engine keeps no
+    // per-step path records
+    bool chunk_timeout = false;
+    chunk_diffs =
+        myers_bidir_diff_algorithm(&chunk_seq1.iface, &chunk_seq2.iface, timeout_ms, &chunk_timeout);
+    if (chunk_timeout) {
+      *hit_timeout = true;
+    }
+  }
+
+  SequenceDiffArray *result = NULL;
+  if (chunk_diffs) {
+    result = (SequenceDiffArray *)diff_calloc(1, sizeof(SequenceDiffArray));
+    ok = result != NULL;
+    for (int i = 0; ok && i < chunk_diffs->count; i++) {
+      const SequenceDiff *d = &chunk_diffs->diffs[i];
+      // Once the budget is spent, the remaining ranges take the capped search
+      int remaining_ms = 0;
+      if (timeout_ms > 0) {
+        int64_t elapsed_ms = get_current_time_ms() - start_ms;
+        remaining_ms = elapsed_ms < timeout_ms ? (int)(timeout_ms - elapsed_ms) : -1;
+      }
+      ok = diff_range(result, elements1, chunks1.starts[d->seq1_start],
+                      chunks1.starts[d->seq1_end], elements2, chunks2.starts[d->seq2_start],
+                      chunks2.starts[d->seq2_end], remaining_ms, hit_timeout);
+    }
+    if (!ok) {
+      sequence_diff_array_free(result);
+      result = NULL;
+    }
+    sequence_diff_array_free(chunk_diffs);
+  }
+
+  chunks_free(&chunks1);
+  chunks_free(&chunks2);
+  return result;
+}
@@ -24,14 +24,22 @@
  */
 
 #include "myers.h"
+#include "allocator.h"
+#include "progress.h"
 #include "sequence.h"
+#include "simd_kernels.h"
 #include "string_hash_map.h"
+#include "utils.h"
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
 // Forward declarations
 static int myers_get_x_after_snake(const ISequence *seq_a, const ISequence *seq_b, int x, int y);
+static SequenceDiffArray *myers_nd_run(const ISequence *seq1, const ISequence *seq2, int len_a,
+                                       int len_b, int timeout_ms, bool capped_only,
+                                       int snake_limit, bool *hit_timeout, bool *hit_snake_limit);
 
 // Helper: Min/Max functions
 static int min_int(int a, int b) { return a < b ? a : b; }
@@ -49,25 +57,46 @@ typedef struct {
   int cols;
 } Array2D;
 
+/**
+ * Cells of a len1 x len2 table, or SIZE_MAX if that does not fit in size_t
+ * (32-bit builds), so the allocation fails instead of coming out short.
+ */
+static size_t dp_cell_count(int len1, int len2) {
+  if (len2 > 0 && (size_t)len1 > SIZE_MAX / (size_t)len2) {
+    return SIZE_MAX;
+  }
+  return (size_t)len1 * (size_t)len2;
+}
+
+// NULL if out of memory
 static Array2D *array2d_create(int rows, int cols) {
-  Array2D *arr = (Array2D *)malloc(sizeof(Array2D));
+  Array2D *arr = (Array2D *)diff_malloc(sizeof(Array2D));
+  if (!arr) {
+    return NULL;
+  }
   arr->rows = rows;
   arr->cols = cols;
-  arr->data = (double *)calloc((size_t)(rows * cols), sizeof(double));
+  arr->data = (double *)diff_calloc(dp_cell_count(rows, cols), sizeof(double));
+  if (!arr->data) {
+    diff_free(arr);
+    return NULL;
+  }
   return arr;
 }
 
 static void array2d_free(Array2D *arr) {
-  free(arr->data);
-  free(arr);
+  if (arr) {
+    diff_free(arr->data);
+    diff_free(arr);
+  }
 }
 
 static double array2d_get(const Array2D *arr, int row, int col) {
-  return arr->data[row * arr->cols + col];
+  return arr->data[(size_t)row * arr->cols + col];
 }
 
 static void array2d_set(Array2D *arr, int row, int col, double value) {
-  arr->data[row * arr->cols + col] = value;
+  arr->data[(size_t)row * arr->cols + col] = value;
 }
 
 //==============================================================================
@@ -75,88 +104,182 @@ static void array2d_set(Array2D *arr, int row, int col, double value) {
 // VSCode Reference: dynamicProgrammingDiffing.ts
 //==============================================================================
 
+// Direction codes stored per cell for backtracking
+#define DP_DIR_HORIZONTAL 1 // Delete from seq1
+#define DP_DIR_VERTICAL 2   // Insert into seq1
+#define DP_DIR_DIAGONAL 3   // Match
+
+// Cells filled between two timeout checks
+#define DP_TIMEOUT_CHECK_INTERVAL 1024
+
 /**
- * Myers O(MN) DP-based Diff Algorithm
- * 
- * A O(MN) diffing algorithm that supports a score function.
- * Uses dynamic programming to find the longest common subsequence (LCS).
- * 
- * This implementation matches VSCode's DynamicProgrammingDiffing exactly:
- * - Uses 3 matrices: lcsLengths, directions, lengths
- * - Supports optional equality scoring
- * - Prefers consecutive diagonals for better diff quality
- * - Backtracks to build SequenceDiff array
- * 
- * VSCode uses this for small sequences:
- * - Line-level: when total lines < 1700
- * - Char-level: when total chars < 500
+ * Longest side the integer kernel accepts.
+ *
+ * Without a score function every diagonal adds its run length + 1, so a run of
+ * k matches scores k(k+1)/2. Capping the shorter side at 65535 keeps the
+ * total below INT_MAX.
  */
-SequenceDiffArray *myers_dp_diff_algorithm(const ISequence *seq1, const ISequence *seq2,
-                                           int timeout_ms, bool *hit_timeout,
-                                           EqualityScoreFn score_fn, void *user_data) {
-  if (hit_timeout)
-    *hit_timeout = false;
+#define DP_UNSCORED_MAX_LEN 65535
+
+// Single diff covering both sequences entirely (trivial or timed-out result),
+// NULL if out of memory
+static SequenceDiffArray *dp_full_diff(int len1, int len2) {
+  SequenceDiffArray *result = (SequenceDiffArray *)diff_malloc(sizeof(SequenceDiffArray));
+  if (!result) {
+    return NULL;
+  }
+  if (len1 == 0 && len2 == 0) {
+    result->diffs = NULL;
+    result->count = 0;
+    result->capacity = 0;
+  } else {
+    result->diffs = (SequenceDiff *)diff_malloc(sizeof(SequenceDiff));
+    if (!result->diffs) {
+      diff_free(result);
+      return NULL;
+    }
+    result->diffs[0].seq1_start = 0;
+    result->diffs[0].seq1_end = len1;
+    result->diffs[0].seq2_start = 0;
+    result->diffs[0].seq2_end = len2;
+    result->count = 1;
+    result->capacity = 1;
+  }
+  return result;
+}
 
-  int len1 = seq1->getLength(seq1);
-  int len2 = seq2->getLength(seq2);
+static bool dp_timed_out(clock_t start_time, int timeout_ms) {
+  double elapsed = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+  return elapsed > timeout_ms / 1000.0;
+}
 
-  // Handle trivial cases
-  if (len1 == 0 || len2 == 0) {
-    SequenceDiffArray *result = (SequenceDiffArray *)malloc(sizeof(SequenceDiffArray));
-    if (len1 == 0 && len2 == 0) {
-      result->diffs = NULL;
-      result->count = 0;
-      result->capacity = 0;
+/**
+ * Backtrack the direction matrix into SequenceDiffs (VSCode's algorithm).
+ * Returns NULL if out of memory.
+ *
+ * @param directions len1 x len2 row-major matrix of DP_DIR_* codes
+ */
+static SequenceDiffArray *dp_backtrack(const uint8_t *directions, int len1, int len2) {
+  // First pass: count diffs
+  int diff_count = 0;
+  int s1 = len1 - 1;
+  int s2 = len2 - 1;
+  int last_align_s1 = len1;
+  int last_align_s2 = len2;
+
+  while (s1 >= 0 && s2 >= 0) {
+    int dir = directions[(size_t)s1 * len2 + s2];
+    if (dir == DP_DIR_DIAGONAL) {
+      // Diagonal - this is a match, emit diff if needed
+      if (s1 + 1 != last_align_s1 || s2 + 1 != last_align_s2) {
+        diff_count++;
+      }
+      last_align_s1 = s1;
+      last_align_s2 = s2;
+      s1--;
+      s2--;
+    } else if (dir == DP_DIR_HORIZONTAL) {
+      s1--;
     } else {
-      result->diffs = (SequenceDiff *)malloc(sizeof(SequenceDiff));
-      result->diffs[0].seq1_start = 0;
-      result->diffs[0].seq1_end = len1;
-      result->diffs[0].seq2_start = 0;
-      result->diffs[0].seq2_end = len2;
-      result->count = 1;
-      result->capacity = 1;
+      s2--;
     }
-    return result;
   }
 
-  // Create 3 matrices as in VSCode's implementation
+  // Final diff if needed
+  if (0 != last_align_s1 || 0 != last_align_s2) {
+    diff_count++;
+  }
+
+  // Second pass: build result
+  SequenceDiffArray *result = (SequenceDiffArray *)diff_malloc(sizeof(SequenceDiffArray));
+  if (!result) {
+    return NULL;
+  }
+  result->count = diff_count;
+  result->capacity = diff_count;
+  result->diffs = diff_count > 0 ? (SequenceDiff *)diff_malloc_array((size_t)diff_count, sizeof(SequenceDiff)) : NULL;
+  if (diff_count > 0 && !result->diffs) {
+    diff_free(result);
+    return NULL;
+  }
+
+  s1 = len1 - 1;
+  s2 = len2 - 1;
+  last_align_s1 = len1;
+  last_align_s2 = len2;
+  int idx = diff_count - 1;
+
+  while (s1 >= 0 && s2 >= 0) {
+    int dir = directions[(size_t)s1 * len2 + s2];
+    if (dir == DP_DIR_DIAGONAL) {
+      // Diagonal - emit diff if there was a gap
+      if (s1 + 1 != last_align_s1 || s2 + 1 != last_align_s2) {
+        result->diffs[idx].seq1_start = s1 + 1;
+        result->diffs[idx].seq1_end = last_align_s1;
+        result->diffs[idx].seq2_start = s2 + 1;
+        result->diffs[idx].seq2_end = last_align_s2;
+        idx--;
+      }
+      last_align_s1 = s1;
+      last_align_s2 = s2;
+      s1--;
+      s2--;
+    } else if (dir == DP_DIR_HORIZONTAL) {
+      s1--;
+    } else {
+      s2--;
+    }
+  }
+
+  // Final diff
+  if (0 != last_align_s1 || 0 != last_align_s2) {
+    result->diffs[idx].seq1_start = 0;
+    result->diffs[idx].seq1_end = last_align_s1;
+    result->diffs[idx].seq2_start = 0;
+    result->diffs[idx].seq2_end = last_align_s2;
+  }
+
+  return result;
+}
+
+/**
+ * Fill the direction matrix using an arbitrary score function (double scores).
+ *
+ * Keeps VSCode's three matrices (lcsLengths, directions, lengths) so that
+ * fractional scores from score_fn compare exactly as in TypeScript.
+ *
+ * @param out_of_memory Output: set when the matrices could not be allocated
+ * @return Direction matrix, or NULL on timeout or out of memory
+ */
+static uint8_t *dp_fill_scored(const ISequence *seq1, const ISequence *seq2, int len1, int len2,
+                               int timeout_ms, EqualityScoreFn score_fn, void *user_data,
+                               bool *out_of_memory) {
   Array2D *lcs_lengths = array2d_create(len1, len2); // LCS length at each position
-  Array2D *directions =
-      array2d_create(len1, len2); // Direction taken (1=horizontal, 2=vertical, 3=diagonal)
-  Array2D *lengths = array2d_create(len1, len2); // Length of consecutive diagonals
+  Array2D *lengths = array2d_create(len1, len2);     // Length of consecutive diagonals
+  uint8_t *directions = (uint8_t *)diff_calloc(dp_cell_count(len1, len2), sizeof(uint8_t));
+  if (!lcs_lengths || !lengths || !directions) {
+    array2d_free(lcs_lengths);
+    array2d_free(lengths);
+    diff_free(directions);
+    *out_of_memory = true;
+    return NULL;
+  }
 
-  // Timeout tracking
   clock_t start_time = clock();
-  double timeout_seconds = timeout_ms / 1000.0;
   int timeout_check_counter = 0;
-  const int TIMEOUT_CHECK_INTERVAL = 1024;
 
   // Fill matrices (VSCode's algorithm)
   for (int s1 = 0; s1 < len1; s1++) {
     for (int s2 = 0; s2 < len2; s2++) {
       // Check timeout periodically (not on every iteration to avoid overhead)
-      if (timeout_ms > 0 && ++timeout_check_counter >= TIMEOUT_CHECK_INTERVAL) {
+      if (++timeout_check_counter >= DP_TIMEOUT_CHECK_INTERVAL) {
         timeout_check_counter = 0;
-        clock_t current_time = clock();
-        double elapsed = (double)(current_time - start_time) / CLOCKS_PER_SEC;
-        if (elapsed > timeout_seconds) {
-          if (hit_timeout)
-            *hit_timeout = true;
-
-          // Return trivial diff
+        if ((timeout_ms > 0 && dp_timed_out(start_time, timeout_ms)) ||
+            !diff_progress_nested((double)s1 / len1)) {
           array2d_free(lcs_lengths);
-          array2d_free(directions);
           array2d_free(lengths);
-
-          SequenceDiffArray *result = (SequenceDiffArray *)malloc(sizeof(SequenceDiffArray));
-          result->diffs = (SequenceDiff *)malloc(sizeof(SequenceDiff));
-          result->diffs[0].seq1_start = 0;
-          result->diffs[0].seq1_end = len1;
-          result->diffs[0].seq2_start = 0;
-          result->diffs[0].seq2_end = len2;
-          result->count = 1;
-          result->capacity = 1;
-          return result;
+          diff_free(directions);
+          return NULL;
         }
       }
 
@@ -174,7 +297,8 @@ SequenceDiffArray *myers_dp_diff_algorithm(const ISequence *seq1, const ISequenc
         }
 
         // Prefer consecutive diagonals (VSCode optimization)
-        if (s1 > 0 && s2 > 0 && array2d_get(directions, s1 - 1, s2 - 1) == 3) {
+        if (s1 > 0 && s2 > 0 &&
+            directions[(size_t)(s1 - 1) * len2 + (s2 - 1)] == DP_DIR_DIAGONAL) {
           extended_seq_score += array2d_get(lengths, s1 - 1, s2 - 1);
         }
 
@@ -190,252 +314,247 @@ SequenceDiffArray *myers_dp_diff_algorithm(const ISequence *seq1, const ISequenc
 
       // Choose best direction
       double new_value = max_double(max_double(horizontal_len, vertical_len), extended_seq_score);
+      uint8_t *dir = &directions[(size_t)s1 * len2 + s2];
 
       if (new_value == extended_seq_score) {
         // Prefer diagonals (matching elements)
         double prev_len = (s1 > 0 && s2 > 0) ? array2d_get(lengths, s1 - 1, s2 - 1) : 0;
         array2d_set(lengths, s1, s2, prev_len + 1);
-        array2d_set(directions, s1, s2, 3); // Diagonal
+        *dir = DP_DIR_DIAGONAL;
       } else if (new_value == horizontal_len) {
         array2d_set(lengths, s1, s2, 0);
-        array2d_set(directions, s1, s2, 1); // Horizontal (delete from seq1)
+        *dir = DP_DIR_HORIZONTAL;
       } else if (new_value == vertical_len) {
         array2d_set(lengths, s1, s2, 0);
-        array2d_set(directions, s1, s2, 2); // Vertical (insert into seq1)
+        *dir = DP_DIR_VERTICAL;
       }
 
       array2d_set(lcs_lengths, s1, s2, new_value);
     }
   }
 
-  // Backtrack to build diffs (VSCode's algorithm)
-  // First pass: count diffs
-  int diff_count = 0;
-  int s1 = len1 - 1;
-  int s2 = len2 - 1;
-  int last_align_s1 = len1;
-  int last_align_s2 = len2;
+  array2d_free(lcs_lengths);
+  array2d_free(lengths);
+  return directions;
+}
 
-  while (s1 >= 0 && s2 >= 0) {
-    int dir = (int)array2d_get(directions, s1, s2);
-    if (dir == 3) {
-      // Diagonal - this is a match, emit diff if needed
-      if (s1 + 1 != last_align_s1 || s2 + 1 != last_align_s2) {
-        diff_count++;
-      }
-      last_align_s1 = s1;
-      last_align_s2 = s2;
-      s1--;
-      s2--;
-    } else if (dir == 1) {
-      // Horizontal
-      s1--;
-    } else {
-      // Vertical
-      s2--;
-    }
+/**
+ * Fill the direction matrix for the unscored case (every match scores 1).
+ *
+ * Same recurrence as dp_fill_scored(), but all scores are integers, so it can
+ * run on two rolling int rows instead of two double matrices. Elements are
+ * fetched once up front instead of through the vtable in the inner loop.
+ * Only the 1-byte direction matrix is kept in full for backtracking.
+ *
+ * A bit-parallel LCS kernel does not apply here: VSCode's score adds the
+ * current diagonal run length for every match, which is not plain LCS and
+ * picks different alignments.
+ *
+ * @param out_of_memory Output: set when the buffers could not be allocated
+ * @return Direction matrix, or NULL on timeout or out of memory
+ */
+static uint8_t *dp_fill_unscored(const ISequence *seq1, const ISequence *seq2, int len1, int len2,
+                                 int timeout_ms, bool *out_of_memory) {
+  uint32_t *elems1 = (uint32_t *)diff_malloc_array((size_t)len1, sizeof(uint32_t));
+  uint32_t *elems2 = (uint32_t *)diff_malloc_array((size_t)len2, sizeof(uint32_t));
+  // rows[0..1]: score of previous/current row, rows[2..3]: diagonal run length
+  int *rows = (int *)diff_calloc(dp_cell_count(len2, 4), sizeof(int));
+  uint8_t *directions = (uint8_t *)diff_malloc_array(dp_cell_count(len1, len2), 1);
+  if (!elems1 || !elems2 || !rows || !directions) {
+    diff_free(elems1);
+    diff_free(elems2);
+    diff_free(rows);
+    diff_free(directions);
+    *out_of_memory = true;
+    return NULL;
   }
 
-  // Final diff if needed
-  if (0 != last_align_s1 || 0 != last_align_s2) {
-    diff_count++;
+  for (int i = 0; i < len1; i++) {
+    elems1[i] = seq1->getElement(seq1, i);
+  }
+  for (int i = 0; i < len2; i++) {
+    elems2[i] = seq2->getElement(seq2, i);
   }
 
-  // Second pass: build result
-  SequenceDiffArray *result = (SequenceDiffArray *)malloc(sizeof(SequenceDiffArray));
-  result->count = diff_count;
-  result->capacity = diff_count;
-  result->diffs = diff_count > 0 ? (SequenceDiff *)malloc((size_t)diff_count * sizeof(SequenceDiff)) : NULL;
+  int *prev_score = rows;
+  int *cur_score = rows + len2;
+  int *prev_run = rows + 2 * len2;
+  int *cur_run = rows + 3 * len2;
 
-  s1 = len1 - 1;
-  s2 = len2 - 1;
-  last_align_s1 = len1;
-  last_align_s2 = len2;
-  int idx = diff_count - 1;
+  clock_t start_time = clock();
+  int timeout_check_counter = 0;
 
-  while (s1 >= 0 && s2 >= 0) {
-    int dir = (int)array2d_get(directions, s1, s2);
-    if (dir == 3) {
-      // Diagonal - emit diff if there was a gap
-      if (s1 + 1 != last_align_s1 || s2 + 1 != last_align_s2) {
-        result->diffs[idx].seq1_start = s1 + 1;
-        result->diffs[idx].seq1_end = last_align_s1;
-        result->diffs[idx].seq2_start = s2 + 1;
-        result->diffs[idx].seq2_end = last_align_s2;
-        idx--;
+  for (int s1 = 0; s1 < len1; s1++) {
+    timeout_check_counter += len2;
+    if (timeout_check_counter >= DP_TIMEOUT_CHECK_INTERVAL) {
+      timeout_check_counter = 0;
+      if ((timeout_ms > 0 && dp_timed_out(start_time, timeout_ms)) ||
+          !diff_progress_nested((double)s1 / len1)) {
+        diff_free(elems1);
+        diff_free(elems2);
+        diff_free(rows);
+        diff_free(directions);
+        return NULL;
       }
-      last_align_s1 = s1;
-      last_align_s2 = s2;
-      s1--;
-      s2--;
-    } else if (dir == 1) {
-      s1--;
-    } else {
-      s2--;
     }
-  }
 
-  // Final diff
-  if (0 != last_align_s1 || 0 != last_align_s2) {
-    result->diffs[idx].seq1_start = 0;
-    result->diffs[idx].seq1_end = last_align_s1;
-    result->diffs[idx].seq2_start = 0;
-    result->diffs[idx].seq2_end = last_align_s2;
-  }
+    uint32_t e1 = elems1[s1];
+    uint8_t *dir_row = directions + (size_t)s1 * len2;
 
-  // Cleanup
-  array2d_free(lcs_lengths);
-  array2d_free(directions);
-  array2d_free(lengths);
+    for (int s2 = 0; s2 < len2; s2++) {
+      // Row 0 reads the zeroed prev rows, matching the s1 == 0 boundary
+      int horizontal_len = prev_score[s2];
+      int vertical_len = (s2 == 0) ? 0 : cur_score[s2 - 1];
+      int best = max_int(horizontal_len, vertical_len);
+
+      if (e1 == elems2[s2]) {
+        // Run length is 0 unless the previous cell was a diagonal
+        int prev_run_len = (s2 == 0) ? 0 : prev_run[s2 - 1];
+        int extended_seq_score = ((s2 == 0) ? 0 : prev_score[s2 - 1]) + prev_run_len + 1;
+        if (extended_seq_score >= best) {
+          cur_score[s2] = extended_seq_score;
+          cur_run[s2] = prev_run_len + 1;
+          dir_row[s2] = DP_DIR_DIAGONAL;
+          continue;
+        }
+      }
 
-  return result;
-}
+      cur_score[s2] = best;
+      cur_run[s2] = 0;
+      dir_row[s2] = (best == horizontal_len) ? DP_DIR_HORIZONTAL : DP_DIR_VERTICAL;
+    }
 
-//==============================================================================
-// O(ND) Myers Forward Algorithm
-// VSCode Reference: myersDiffAlgorithm.ts
-//==============================================================================
+    int *tmp = prev_score;
+    prev_score = cur_score;
+    cur_score = tmp;
+    tmp = prev_run;
+    prev_run = cur_run;
+    cur_run = tmp;
+  }
 
-// Simple dynamic array for storing integers (supports negative indices)
-typedef struct {
-  int *positive;
-  int *negative;
-  int pos_capacity;
-  int neg_capacity;
-} IntArray;
-
-static IntArray *intarray_create(void) {
-  IntArray *arr = (IntArray *)malloc(sizeof(IntArray));
-  arr->pos_capacity = 10;
-  arr->neg_capacity = 10;
-  arr->positive = (int *)calloc((size_t)arr->pos_capacity, sizeof(int));
-  arr->negative = (int *)calloc((size_t)arr->neg_capacity, sizeof(int));
-  return arr;
+  diff_free(elems1);
+  diff_free(elems2);
+  diff_free(rows);
+  return directions;
 }
 
-static void intarray_free(IntArray *arr) {
-  free(arr->positive);
-  free(arr->negative);
-  free(arr);
-}
+/**
+ * Myers O(MN) DP-based Diff Algorithm
+ * 
+ * A O(MN) diffing algorithm that supports a score function.
+ * Uses dynamic programming to find the longest common subsequence (LCS).
+ * 
+ * This implementation matches VSCode's DynamicProgrammingDiffing exactly:
+ * - Uses 3 matrices: lcsLengths, directions, lengths
+ * - Supports optional equality scoring
+ * - Prefers consecutive diagonals for better diff quality
+ * - Backtracks to build SequenceDiff array
+ * 
+ * Without score_fn (char-level refinement) an integer kernel with rolling
+ * rows is used instead; it produces identical directions.
+ * 
+ * VSCode uses this for small sequences:
+ * - Line-level: when total lines < 1700
+ * - Char-level: when total chars < 500
+ */
+SequenceDiffArray *myers_dp_diff_algorithm(const ISequence *seq1, const ISequence *seq2,
+                                           int timeout_ms, bool *hit_timeout,
+                                           EqualityScoreFn score_fn, void *user_data) {
+  if (hit_timeout)
+    *hit_timeout = false;
 
-static int intarray_get(IntArray *arr, int idx) {
-  if (idx < 0) {
-    int neg_idx = -idx - 1;
-    return (neg_idx < arr->neg_capacity) ? arr->negative[neg_idx] : 0;
-  } else {
-    return (idx < arr->pos_capacity) ? arr->positive[idx] : 0;
+  int len1 = seq1->getLength(seq1);
+  int len2 = seq2->getLength(seq2);
+
+  // Handle trivial cases
+  if (len1 == 0 || len2 == 0) {
+    return dp_full_diff(len1, len2);
   }
-}
 
-static void intarray_set(IntArray *arr, int idx, int value) {
-  if (idx < 0) {
-    int neg_idx = -idx - 1;
-    if (neg_idx >= arr->neg_capacity) {
-      int new_cap = arr->neg_capacity * 2;
-      while (neg_idx >= new_cap)
-        new_cap *= 2;
-      arr->negative = (int *)realloc(arr->negative, (size_t)new_cap * sizeof(int));
-      memset(arr->negative + arr->neg_capacity, 0, (size_t)(new_cap - arr->neg_capacity) * sizeof(int));
-      arr->neg_capacity = new_cap;
-    }
-    arr->negative[neg_idx] = value;
+  uint8_t *directions;
+  bool out_of_memory = false;
+  if (!score_fn && min_int(len1, len2) <= DP_UNSCORED_MAX_LEN) {
+    directions = dp_fill_unscored(seq1, seq2, len1, len2, timeout_ms, &out_of_memory);
   } else {
-    if (idx >= arr->pos_capacity) {
-      int new_cap = arr->pos_capacity * 2;
-      while (idx >= new_cap)
-        new_cap *= 2;
-      arr->positive = (int *)realloc(arr->positive, (size_t)new_cap * sizeof(int));
-      memset(arr->positive + arr->pos_capacity, 0, (size_t)(new_cap - arr->pos_capacity) * sizeof(int));
-      arr->pos_capacity = new_cap;
-    }
-    arr->positive[idx] = value;
+    directions =
+        dp_fill_scored(seq1, seq2, len1, len2, timeout_ms, score_fn, user_data, &out_of_memory);
   }
-}
 
-// Simple path structure to track snake paths
-typedef struct SnakePath {
-  struct SnakePath *prev;
-  int x;
-  int y;
-  int length;
-} SnakePath;
-
-static SnakePath *snakepath_create(SnakePath *prev, int x, int y, int length) {
-  SnakePath *path = (SnakePath *)malloc(sizeof(SnakePath));
-  path->prev = prev;
-  path->x = x;
-  path->y = y;
-  path->length = length;
-  return path;
+  if (out_of_memory) {
+    // The table did not fit: the O(ND) engine needs O(N + M) memory
+    return myers_nd_diff_algorithm(seq1, seq2, timeout_ms, hit_timeout);
+  }
+  if (!directions) {
+    // Timed out: fall back to a cost-capped greedy alignment rather than
+    // marking everything as changed (the DP table cannot be backtracked early)
+    if (hit_timeout)
+      *hit_timeout = true;
+    return myers_nd_run(seq1, seq2, len1, len2, 0, true, 0, NULL, NULL);
+  }
+
+  SequenceDiffArray *result = dp_backtrack(directions, len1, len2);
+  diff_free(directions);
+  return result;
 }
 
-static void snakepath_free_chain(SnakePath *path) {
-  while (path) {
-    SnakePath *prev = path->prev;
-    free(path);
-    path = prev;
+int64_t myers_dp_memory_bytes(int len1, int len2, bool scored) {
+  int64_t cells = (int64_t)len1 * len2;
+  if (!scored && min_int(len1, len2) <= DP_UNSCORED_MAX_LEN) {
+    // Direction bytes, cached elements and four score/run rows
+    return cells + ((int64_t)len1 + len2) * (int64_t)sizeof(uint32_t) +
+           (int64_t)len2 * 4 * (int64_t)sizeof(int);
   }
+  // Two double matrices (lcsLengths, lengths) and direction bytes
+  return cells * (int64_t)(2 * sizeof(double) + 1);
 }
 
-// Dynamic array for storing SnakePath pointers (supports negative indices)
-typedef struct {
-  SnakePath **positive;
-  SnakePath **negative;
-  int pos_capacity;
-  int neg_capacity;
-} PathArray;
-
-static PathArray *patharray_create(void) {
-  PathArray *arr = (PathArray *)malloc(sizeof(PathArray));
-  arr->pos_capacity = 10;
-  arr->neg_capacity = 10;
-  arr->positive = (SnakePath **)calloc((size_t)arr->pos_capacity, sizeof(SnakePath *));
-  arr->negative = (SnakePath **)calloc((size_t)arr->neg_capacity, sizeof(SnakePath *));
-  return arr;
-}
+//==============================================================================
+// O(ND) Myers Forward Algorithm
+// VSCode Reference: myersDiffAlgorithm.ts
+//==============================================================================
 
-static void patharray_free(PathArray *arr) {
-  // Note: We don't free individual paths here as they're freed later
-  free(arr->positive);
-  free(arr->negative);
-  free(arr);
-}
+// Snake record in the pool; prev links to the previous snake on the path
+typedef struct {
+  int32_t prev; // Pool index of previous snake, SNAKE_NONE for path start
+  int x;
+  int y;
+  int length;
+} SnakeRecord;
 
-static SnakePath *patharray_get(PathArray *arr, int idx) {
-  if (idx < 0) {
-    int neg_idx = -idx - 1;
-    return (neg_idx < arr->neg_capacity) ? arr->negative[neg_idx] : NULL;
-  } else {
-    return (idx < arr->pos_capacity) ? arr->positive[idx] : NULL;
-  }
-}
+#define SNAKE_NONE (-1)
 
-static void patharray_set(PathArray *arr, int idx, SnakePath *value) {
-  if (idx < 0) {
-    int neg_idx = -idx - 1;
-    if (neg_idx >= arr->neg_capacity) {
-      int new_cap = arr->neg_capacity * 2;
-      while (neg_idx >= new_cap)
-        new_cap *= 2;
-      arr->negative = (SnakePath **)realloc(arr->negative, (size_t)new_cap * sizeof(SnakePath *));
-      memset(arr->negative + arr->neg_capacity, 0,
-             (size_t)(new_cap - arr->neg_capacity) * sizeof(SnakePath *));
-      arr->neg_capacity = new_cap;
+// Growable pool of snake records, referenced by 32-bit index
+typedef struct {
+  SnakeRecord *items;
+  int count;
+  int capacity;
+  bool out_of_memory; // A snake could not be added; searches stop, results are void
+} SnakePool;
+
+static int32_t snakepool_add(SnakePool *pool, int32_t prev, int x, int y, int length) {
+  if (pool->count >= pool->capacity) {
+    // Indices are int32_t: stop doubling at the largest one
+    int capacity;
+    if (pool->capacity == 0) {
+      capacity = 64;
+    } else {
+      capacity = pool->capacity < INT32_MAX / 2 ? pool->capacity * 2 : INT32_MAX;
     }
-    arr->negative[neg_idx] = value;
-  } else {
-    if (idx >= arr->pos_capacity) {
-      int new_cap = arr->pos_capacity * 2;
-      while (idx >= new_cap)
-        new_cap *= 2;
-      arr->positive = (SnakePath **)realloc(arr->positive, (size_t)new_cap * sizeof(SnakePath *));
-      memset(arr->positive + arr->pos_capacity, 0,
-             (size_t)(new_cap - arr->pos_capacity) * sizeof(SnakePath *));
-      arr->pos_capacity = new_cap;
+    SnakeRecord *grown =
+        (SnakeRecord *)diff_realloc_array(pool->items, (size_t)capacity, sizeof(SnakeRecord));
+    if (!grown) {
+      pool->out_of_memory = true;
+      return SNAKE_NONE;
     }
-    arr->positive[idx] = value;
+    pool->items = grown;
+    pool->capacity = capacity;
   }
+  SnakeRecord *rec = &pool->items[pool->count];
+  rec->prev = prev;
+  rec->x = x;
+  rec->y = y;
+  rec->length = length;
+  return pool->count++;
 }
 
 // Helper: Get X position after following snake (diagonal matches)
@@ -444,6 +563,15 @@ static int myers_get_x_after_snake(const ISequence *seq_a, const ISequence *seq_
   int len_a = seq_a->getLength(seq_a);
   int len_b = seq_b->getLength(seq_b);
 
+  if (seq_a->elements && seq_b->elements) {
+    // Most snakes are empty; only pay for the kernel call on a match
+    if (x < len_a && y < len_b && seq_a->elements[x] == seq_b->elements[y]) {
+      x += simd_kernels()->match_length_u32(seq_a->elements + x, seq_b->elements + y,
+                                            min_int(len_a - x, len_b - y));
+    }
+    return x;
+  }
+
   while (x < len_a && y < len_b && seq_a->getElement(seq_a, x) == seq_b->getElement(seq_b, y)) {
     x++;
     y++;
@@ -451,152 +579,222 @@ static int myers_get_x_after_snake(const ISequence *seq_a, const ISequence *seq_
   return x;
 }
 
-// Main Myers O(ND) Forward Algorithm
-// (Renamed from myers_diff_algorithm to myers_nd_diff_algorithm)
-SequenceDiffArray *myers_nd_diff_algorithm(const ISequence *seq1, const ISequence *seq2,
-                                           int timeout_ms, bool *hit_timeout) {
-  if (hit_timeout)
-    *hit_timeout = false;
-
-  int len_a = seq1->getLength(seq1);
-  int len_b = seq2->getLength(seq2);
+/**
+ * Minimum edit budget per greedy step once the search is over time.
+ * Same floor as xdiff's XDL_MAX_COST_MIN ("too expensive" heuristic).
+ */
+#define MYERS_COST_CAP_MIN 256
 
-  // Handle trivial cases
-  if (len_a == 0 || len_b == 0) {
-    SequenceDiffArray *result = (SequenceDiffArray *)malloc(sizeof(SequenceDiffArray));
-    if (len_a == 0 && len_b == 0) {
-      result->diffs = NULL;
-      result->count = 0;
-      result->capacity = 0;
-    } else {
-      result->diffs = (SequenceDiff *)malloc(sizeof(SequenceDiff));
-      result->diffs[0].seq1_start = 0;
-      result->diffs[0].seq1_end = len_a;
-      result->diffs[0].seq2_start = 0;
-      result->diffs[0].seq2_end = len_b;
-      result->count = 1;
-      result->capacity = 1;
-    }
-    return result;
+/**
+ * Edit budget per greedy step: the smallest power of two whose square is at
+ * least N + M (sqrt(N + M) rounded up to a power of two), at least
+ * MYERS_COST_CAP_MIN.
+ *
+ * Each step explores at most this many edits before committing to the
+ * furthest-reaching point, so the continuation costs O((N + M) * cap).
+ */
+static int myers_cost_cap(int len_a, int len_b) {
+  int64_t total = (int64_t)len_a + len_b;
+  int cap = 1;
+  while ((long long)cap * cap < total) {
+    cap <<= 1;
   }
+  return max_int(cap, MYERS_COST_CAP_MIN);
+}
 
-  IntArray *V = intarray_create();
-  PathArray *paths = patharray_create();
+// Reusable state for forward searches over one pair of sequences
+typedef struct {
+  const ISequence *seq1;
+  const ISequence *seq2;
+  int len_a;
+  int len_b;
+  int *V;         // Furthest x (relative to search origin) per diagonal
+  int32_t *paths;       // Last snake on the path to V[k], or SNAKE_NONE
+  SnakePool pool;
+  int snake_limit;      // Stop once the pool holds more snakes (0 = none)
+  bool hit_snake_limit; // Set when a search stopped on snake_limit
+} MyersSearch;
+
+/**
+ * Forward Myers search from (x0, y0) towards (len_a, len_b).
+ *
+ * @param head Snake chain leading to (x0, y0) (SNAKE_NONE at the origin)
+ * @param max_d Edit budget (INT_MAX for none)
+ * @param timeout_ms Wall-clock budget measured from start_time (0 = none)
+ * @param tail Output: snake chain ending at the end point, or at the
+ *             furthest-reaching point when the budget ran out
+ * @param tail_x, tail_y Output: absolute position reached
+ * @return true if (len_a, len_b) was reached
+ */
+static bool myers_search(MyersSearch *s, int x0, int y0, int32_t head, int max_d,
+                         clock_t start_time, int timeout_ms, int32_t *tail, int *tail_x,
+                         int *tail_y) {
+  int n = s->len_a - x0;
+  int m = s->len_b - y0;
+  int *V = s->V;
+  int32_t *paths = s->paths;
+
+  // Reset only the diagonals this search can touch
+  int reset_lo = -(min_int(max_d, m) + 1);
+  int reset_hi = min_int(max_d, n) + 1;
+  for (int k = reset_lo; k <= reset_hi; k++) {
+    V[k] = 0;
+    paths[k] = SNAKE_NONE;
+  }
 
-  int initial_x = myers_get_x_after_snake(seq1, seq2, 0, 0);
-  intarray_set(V, 0, initial_x);
-  patharray_set(paths, 0, initial_x == 0 ? NULL : snakepath_create(NULL, 0, 0, initial_x));
+  int initial_x = myers_get_x_after_snake(s->seq1, s->seq2, x0, y0) - x0;
+  V[0] = initial_x;
+  paths[0] = initial_x == 0 ? head : snakepool_add(&s->pool, head, x0, y0, initial_x);
 
-  int d = 0;
-  int k = 0;
-  int found = 0;
+  if (initial_x == n && initial_x == m) {
+    *tail = paths[0];
+    *tail_x = s->len_a;
+    *tail_y = s->len_b;
+    return true;
+  }
 
-  // Timeout tracking
-  clock_t start_time = clock();
   double timeout_seconds = timeout_ms / 1000.0;
 
   // Main loop: increase edit distance until we reach the end
-  while (!found) {
-    d++;
-
-    // Check timeout (VSCode's timeout support)
+  for (int d = 1;; d++) {
+    bool out_of_time = false;
     if (timeout_ms > 0) {
-      clock_t current_time = clock();
-      double elapsed = (double)(current_time - start_time) / CLOCKS_PER_SEC;
-      if (elapsed > timeout_seconds) {
-        if (hit_timeout)
-          *hit_timeout = true;
+      double elapsed = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+      out_of_time = elapsed > timeout_seconds;
+    }
+    // D (after the start point of a capped step) against its upper bound N + M.
+    // Cancellation ends the main search like a timeout; capped steps must
+    // always advance, so they only report
+    bool keep_going = diff_progress_nested(((double)x0 + y0 + d) / ((double)s->len_a + s->len_b));
+    if (!keep_going && max_d == INT32_MAX) {
+      out_of_time = true;
+    }
+    if (s->snake_limit > 0 && s->pool.count > s->snake_limit) {
+      s->hit_snake_limit = true;
+      out_of_time = true;
+    }
+    if (s->pool.out_of_memory) {
+      out_of_time = true;
+    }
 
-        // Return trivial diff (entire range changed)
-        intarray_free(V);
-        patharray_free(paths);
-
-        SequenceDiffArray *result = (SequenceDiffArray *)malloc(sizeof(SequenceDiffArray));
-        result->diffs = (SequenceDiff *)malloc(sizeof(SequenceDiff));
-        result->diffs[0].seq1_start = 0;
-        result->diffs[0].seq1_end = len_a;
-        result->diffs[0].seq2_start = 0;
-        result->diffs[0].seq2_end = len_b;
-        result->count = 1;
-        result->capacity = 1;
-        return result;
+    if (d > max_d || out_of_time) {
+      // Commit to the furthest-reaching point of the last complete layer
+      int prev_d = d - 1;
+      int best_k = 0;
+      int best_progress = -1;
+      for (int k = -min_int(prev_d, m + (prev_d % 2)); k <= min_int(prev_d, n + (prev_d % 2));
+           k += 2) {
+        int x = V[k];
+        int y = x - k;
+        if (y < 0 || y > m || x + y <= best_progress) {
+          continue;
+        }
+        best_k = k;
+        best_progress = x + y;
       }
+      *tail = paths[best_k];
+      *tail_x = x0 + V[best_k];
+      *tail_y = y0 + V[best_k] - best_k;
+      return false;
     }
 
     // Bounds for diagonals we need to consider
-    int lower_bound = -min_int(d, len_b + (d % 2));
-    int upper_bound = min_int(d, len_a + (d % 2));
+    int lower_bound = -min_int(d, m + (d % 2));
+    int upper_bound = min_int(d, n + (d % 2));
 
-    for (k = lower_bound; k <= upper_bound; k += 2) {
+    for (int k = lower_bound; k <= upper_bound; k += 2) {
       // Determine whether to go down (insert) or right (delete)
-      int max_x_top = (k == upper_bound) ? -1 : intarray_get(V, k + 1);
-      int max_x_left = (k == lower_bound) ? -1 : intarray_get(V, k - 1) + 1;
+      int max_x_top = (k == upper_bound) ? -1 : V[k + 1];
+      int max_x_left = (k == lower_bound) ? -1 : V[k - 1] + 1;
 
-      int x = min_int(max_int(max_x_top, max_x_left), len_a);
+      int x = min_int(max_int(max_x_top, max_x_left), n);
       int y = x - k;
 
       // Skip invalid diagonals
-      if (x > len_a || y > len_b) {
+      if (x > n || y > m) {
         continue;
       }
 
       // Follow snake (diagonal matches)
-      int new_max_x = myers_get_x_after_snake(seq1, seq2, x, y);
-      intarray_set(V, k, new_max_x);
+      int new_max_x = myers_get_x_after_snake(s->seq1, s->seq2, x0 + x, y0 + y) - x0;
+      V[k] = new_max_x;
 
       // Track path
-      SnakePath *last_path =
-          (x == max_x_top) ? patharray_get(paths, k + 1) : patharray_get(paths, k - 1);
-      SnakePath *new_path =
-          (new_max_x != x) ? snakepath_create(last_path, x, y, new_max_x - x) : last_path;
-      patharray_set(paths, k, new_path);
+      int32_t last_path = (x == max_x_top) ? paths[k + 1] : paths[k - 1];
+      paths[k] = (new_max_x != x)
+                     ? snakepool_add(&s->pool, last_path, x0 + x, y0 + y, new_max_x - x)
+                     : last_path;
 
       // Check if we reached the end
-      if (intarray_get(V, k) == len_a && intarray_get(V, k) - k == len_b) {
-        found = 1;
-        break;
+      if (V[k] == n && V[k] - k == m) {
+        *tail = paths[k];
+        *tail_x = s->len_a;
+        *tail_y = s->len_b;
+        return true;
       }
     }
   }
+}
 
-  // Build result from path
-  SnakePath *path = patharray_get(paths, k);
+/**
+ * Cost-capped continuation from (x, y): repeated forward searches of at most
+ * myers_cost_cap() edits, each committing to its furthest-reaching point.
+ * Produces a valid, possibly non-minimal path in bounded time.
+ */
+static int32_t myers_search_capped(MyersSearch *s, int32_t head, int x, int y) {
+  int cap = myers_cost_cap(s->len_a, s->len_b);
+  s->snake_limit = 0; // Every step is bounded by cap already
+  int32_t tail = head;
+  while (!myers_search(s, x, y, tail, cap, 0, 0, &tail, &x, &y) && !s->pool.out_of_memory) {
+  }
+  return tail;
+}
 
+// Convert a snake chain ending at (len_a, len_b) into SequenceDiffs (NULL if out of memory)
+static SequenceDiffArray *myers_build_diffs(const SnakePool *pool, int32_t path, int len_a,
+                                            int len_b) {
   // Count diffs first
   int diff_count = 0;
   int last_pos_a = len_a;
   int last_pos_b = len_b;
-  SnakePath *temp_path = path;
 
-  while (1) {
-    int end_x = temp_path ? temp_path->x + temp_path->length : 0;
-    int end_y = temp_path ? temp_path->y + temp_path->length : 0;
+  for (int32_t p = path;; p = pool->items[p].prev) {
+    const SnakeRecord *snake = (p == SNAKE_NONE) ? NULL : &pool->items[p];
+    int end_x = snake ? snake->x + snake->length : 0;
+    int end_y = snake ? snake->y + snake->length : 0;
 
     if (end_x != last_pos_a || end_y != last_pos_b) {
       diff_count++;
     }
-    if (!temp_path)
+    if (!snake)
       break;
 
-    last_pos_a = temp_path->x;
-    last_pos_b = temp_path->y;
-    temp_path = temp_path->prev;
+    last_pos_a = snake->x;
+    last_pos_b = snake->y;
   }
 
   // Allocate result
-  SequenceDiffArray *result = (SequenceDiffArray *)malloc(sizeof(SequenceDiffArray));
+  SequenceDiffArray *result = (SequenceDiffArray *)diff_malloc(sizeof(SequenceDiffArray));
+  if (!result) {
+    return NULL;
+  }
   result->count = diff_count;
   result->capacity = diff_count;
-  result->diffs = diff_count > 0 ? (SequenceDiff *)malloc((size_t)diff_count * sizeof(SequenceDiff)) : NULL;
+  result->diffs = diff_count > 0 ? (SequenceDiff *)diff_malloc_array((size_t)diff_count, sizeof(SequenceDiff)) : NULL;
+  if (diff_count > 0 && !result->diffs) {
+    diff_free(result);
+    return NULL;
+  }
 
-  // Fill result (in reverse order, then we'll reverse)
+  // Fill result back to front
   int idx = diff_count - 1;
   last_pos_a = len_a;
   last_pos_b = len_b;
 
-  while (1) {
-    int end_x = path ? path->x + path->length : 0;
-    int end_y = path ? path->y + path->length : 0;
+  for (int32_t p = path;; p = pool->items[p].prev) {
+    const SnakeRecord *snake = (p == SNAKE_NONE) ? NULL : &pool->items[p];
+    int end_x = snake ? snake->x + snake->length : 0;
+    int end_y = snake ? snake->y + snake->length : 0;
 
     if (end_x != last_pos_a || end_y != last_pos_b) {
       result->diffs[idx].seq1_start = end_x;
@@ -606,24 +804,413 @@ SequenceDiffArray *myers_nd_diff_algorithm(const ISequence *seq1, const ISequenc
       idx--;
     }
 
-    if (!path)
+    if (!snake)
       break;
 
-    last_pos_a = path->x;
-    last_pos_b = path->y;
-    path = path->prev;
+    last_pos_a = snake->x;
+    last_pos_b = snake->y;
   }
 
-  // Clean up - free the entire path chain from final path
-  SnakePath *final_path = patharray_get(paths, k);
-  snakepath_free_chain(final_path);
+  return result;
+}
 
-  intarray_free(V);
-  patharray_free(paths);
+/**
+ * Run a forward search, switching to the cost-capped continuation if
+ * timeout_ms expires (reported through hit_timeout).
+ *
+ * With snake_limit > 0 the exact search also gives up once the snake pool
+ * outgrows it: hit_snake_limit is set and NULL returned, so the caller can
+ * switch to a linear-space engine.
+ */
+static SequenceDiffArray *myers_nd_run(const ISequence *seq1, const ISequence *seq2, int len_a,
+                                       int len_b, int timeout_ms, bool capped_only,
+                                       int snake_limit, bool *hit_timeout, bool *hit_snake_limit) {
+  // Diagonals k = x - y stay within [-(len_b + 1), len_a + 1], so one
+  // contiguous array offset by len_b + 1 covers them all (no bounds checks)
+  size_t diagonal_count = (size_t)len_a + (size_t)len_b + 3;
+  int *v_data = (int *)diff_malloc_array(diagonal_count, sizeof(int));
+  int32_t *path_data = (int32_t *)diff_malloc_array(diagonal_count, sizeof(int32_t));
+  if (!v_data || !path_data) {
+    diff_free(v_data);
+    diff_free(path_data);
+    return NULL;
+  }
+
+  MyersSearch search;
+  search.seq1 = seq1;
+  search.seq2 = seq2;
+  search.len_a = len_a;
+  search.len_b = len_b;
+  search.V = v_data + len_b + 1;
+  search.paths = path_data + len_b + 1;
+  search.pool.items = NULL;
+  search.pool.count = 0;
+  search.pool.capacity = 0;
+  search.pool.out_of_memory = false;
+  search.snake_limit = snake_limit;
+  search.hit_snake_limit = false;
+
+  int32_t path = SNAKE_NONE;
+  bool complete = true;
+  if (capped_only) {
+    path = myers_search_capped(&search, SNAKE_NONE, 0, 0);
+  } else {
+    int x = 0;
+    int y = 0;
+    if (!myers_search(&search, 0, 0, SNAKE_NONE, INT32_MAX, clock(), timeout_ms, &path, &x,
+                      &y)) {
+      if (search.hit_snake_limit) {
+        // Out of memory budget: give up, the caller picks a cheaper engine
+        if (hit_snake_limit)
+          *hit_snake_limit = true;
+        complete = false;
+      } else {
+        // Timed out: keep the progress so far instead of a trivial diff
+        if (hit_timeout)
+          *hit_timeout = true;
+        path = myers_search_capped(&search, path, x, y);
+      }
+    }
+  }
+
+  if (search.pool.out_of_memory) {
+    complete = false;
+  }
+  SequenceDiffArray *result =
+      complete ? myers_build_diffs(&search.pool, path, len_a, len_b) : NULL;
+
+  // Clean up - the pool owns every snake, including abandoned paths
+  diff_free(search.pool.items);
+  diff_free(v_data);
+  diff_free(path_data);
 
   return result;
 }
 
+// Main Myers O(ND) Forward Algorithm
+// (Renamed from myers_diff_algorithm to myers_nd_diff_algorithm)
+SequenceDiffArray *myers_nd_diff_algorithm(const ISequence *seq1, const ISequence *seq2,
+                                           int timeout_ms, bool *hit_timeout) {
+  if (hit_timeout)
+    *hit_timeout = false;
+
+  int len_a = seq1->getLength(seq1);
+  int len_b = seq2->getLength(seq2);
+
+  // Handle trivial cases
+  if (len_a == 0 || len_b == 0) {
+    return dp_full_diff(len_a, len_b);
+  }
+
+  return myers_nd_run(seq1, seq2, len_a, len_b, timeout_ms, false, 0, hit_timeout, NULL);
+}
+
+// Cost-capped O(ND) search from the start, for regions that cannot finish exactly
+SequenceDiffArray *myers_nd_capped_diff_algorithm(const ISequence *seq1, const ISequence *seq2) {
+  int len_a = seq1->getLength(seq1);
+  int len_b = seq2->getLength(seq2);
+
+  if (len_a == 0 || len_b == 0) {
+    return dp_full_diff(len_a, len_b);
+  }
+
+  return myers_nd_run(seq1, seq2, len_a, len_b, 0, true, 0, NULL, NULL);
+}
+
+//==============================================================================
+// O(ND) Myers Bidirectional Algorithm (middle snake, linear space)
+// Reference: Myers 1986, "An O(ND) Difference Algorithm and Its Variations", 4b
+//==============================================================================
+
+typedef struct {
+  uint32_t *a; // Cached elements of seq1
+  uint32_t *b; // Cached elements of seq2
+  int *vf;     // Forward furthest-reaching x per diagonal (-1 = unreached)
+  int *vr;     // Reverse furthest-reaching x' per diagonal (-1 = unreached)
+  int v_offset;
+  SequenceDiffArray *out;
+  clock_t start_time;
+  int timeout_ms;
+  bool timed_out;
+  bool out_of_memory;
+} BidirContext;
+
+typedef struct {
+  int x; // Snake start in seq1 (relative to subproblem)
+  int y; // Snake start in seq2
+  int u; // Snake end in seq1
+  int v; // Snake end in seq2
+} MiddleSnake;
+
+// Append a diff, merging it with the previous one if they touch
+static void bidir_emit(BidirContext *ctx, int s1, int e1, int s2, int e2) {
+  SequenceDiffArray *out = ctx->out;
+  if (out->count > 0) {
+    SequenceDiff *last = &out->diffs[out->count - 1];
+    if (last->seq1_end == s1 && last->seq2_end == s2) {
+      last->seq1_end = e1;
+      last->seq2_end = e2;
+      return;
+    }
+  }
+  if (!sequence_diff_array_append(out, (SequenceDiff){s1, e1, s2, e2})) {
+    ctx->out_of_memory = true;
+  }
+}
+
+/**
+ * Find the middle snake of a[a0, a0+n) vs b[b0, b0+m).
+ *
+ * Extends forward paths from (0, 0) and reverse paths from (n, m) one edit
+ * at a time and stops as soon as they overlap on a diagonal. Diagonal bounds
+ * and tie-breaking (prefer the insertion on ties) follow
+ * myers_nd_diff_algorithm().
+ *
+ * @return Edit distance D of the subproblem, or -1 on timeout
+ */
+static int bidir_middle_snake(BidirContext *ctx, int a0, int n, int b0, int m,
+                              MiddleSnake *snake) {
+  const uint32_t *a = ctx->a + a0;
+  const uint32_t *b = ctx->b + b0;
+  int *vf = ctx->vf + ctx->v_offset;
+  int *vr = ctx->vr + ctx->v_offset;
+  int delta = n - m;
+  bool odd = (delta & 1) != 0;
+
+  for (int k = -(m + 1); k <= n + 1; k++) {
+    vf[k] = -1;
+    vr[k] = -1;
+  }
+
+  for (int d = 0;; d++) {
+    if (ctx->timeout_ms > 0) {
+      double elapsed = (double)(clock() - ctx->start_time) / CLOCKS_PER_SEC;
+      if (elapsed > ctx->timeout_ms / 1000.0) {
+        ctx->timed_out = true;
+        return -1;
+      }
+    }
+    // Subproblems have no global D bound: only poll for cancellation
+    if (!diff_progress_nested(-1.0)) {
+      ctx->timed_out = true;
+      return -1;
+    }
+
+    int lower_bound = -min_int(d, m + (d % 2));
+    int upper_bound = min_int(d, n + (d % 2));
+
+    // Forward step on diagonal k = x - y
+    for (int k = lower_bound; k <= upper_bound; k += 2) {
+      int max_x_top = (k == upper_bound || vf[k + 1] < 0) ? -1 : vf[k + 1];
+      int max_x_left = (k == lower_bound || vf[k - 1] < 0) ? -1 : vf[k - 1] + 1;
+      int x = (d == 0) ? 0 : min_int(max_int(max_x_top, max_x_left), n);
+      int y = x - k;
+      if (x < 0 || y < 0 || y > m) {
+        continue;
+      }
+
+      int start_x = x;
+      if (x < n && y < m && a[x] == b[y]) {
+        int run = simd_kernels()->match_length_u32(a + x, b + y, min_int(n - x, m - y));
+        x += run;
+        y += run;
+      }
+      vf[k] = x;
+
+      // Odd delta: compare against reverse paths of d - 1 edits
+      int rk = delta - k;
+      if (odd && rk >= -(m + 1) && rk <= n + 1 && vr[rk] >= 0 && x + vr[rk] >= n) {
+        snake->x = start_x;
+        snake->y = start_x - k;
+        snake->u = x;
+        snake->v = y;
+        return 2 * d - 1;
+      }
+    }
+
+    // Reverse step on diagonal k' = x' - y', with x' = n - x and y' = m - y
+    for (int k = lower_bound; k <= upper_bound; k += 2) {
+      int max_x_top = (k == upper_bound || vr[k + 1] < 0) ? -1 : vr[k + 1];
+      int max_x_left = (k == lower_bound || vr[k - 1] < 0) ? -1 : vr[k - 1] + 1;
+      int x = (d == 0) ? 0 : min_int(max_int(max_x_top, max_x_left), n);
+      int y = x - k;
+      if (x < 0 || y < 0 || y > m) {
+        continue;
+      }
+
+      int start_x = x;
+      while (x < n && y < m && a[n - 1 - x] == b[m - 1 - y]) {
+        x++;
+        y++;
+      }
+      vr[k] = x;
+
+      // Even delta: compare against forward paths of d edits
+      int fk = delta - k;
+      if (!odd && fk >= -(m + 1) && fk <= n + 1 && vf[fk] >= 0 && vf[fk] + x >= n) {
+        snake->x = n - x;
+        snake->y = m - y;
+        snake->u = n - start_x;
+        snake->v = m - (start_x - k);
+        return 2 * d;
+      }
+    }
+  }
+}
+
+// Divide and conquer on the middle snake
+static void bidir_compare(BidirContext *ctx, int a0, int n, int b0, int m) {
+  if (ctx->timed_out || ctx->out_of_memory) {
+    return;
+  }
+  if (n == 0 || m == 0) {
+    if (n > 0 || m > 0) {
+      bidir_emit(ctx, a0, a0 + n, b0, b0 + m);
+    }
+    return;
+  }
+
+  MiddleSnake snake;
+  int d = bidir_middle_snake(ctx, a0, n, b0, m, &snake);
+  if (d <= 0) {
+    return;
+  }
+
+  if (d == 1) {
+    // Single insertion or deletion: the forward snake runs as far as it can first
+    int p = simd_kernels()->match_length_u32(ctx->a + a0, ctx->b + b0, min_int(n, m));
+    bidir_emit(ctx, a0 + p, a0 + p + (n > m ? 1 : 0), b0 + p, b0 + p + (m > n ? 1 : 0));
+    return;
+  }
+
+  bidir_compare(ctx, a0, snake.x, b0, snake.y);
+  bidir_compare(ctx, a0 + snake.u, n - snake.u, b0 + snake.v, m - snake.v);
+}
+
+/**
+ * Myers O(ND) Bidirectional Algorithm
+ *
+ * Runs forward and reverse searches at the same time and splits on the middle
+ * snake where they meet, then recurses into both halves. Each split explores
+ * about D/2 edits from each end instead of D from the start, so high-D inputs
+ * touch roughly half the diagonals of myers_nd_diff_algorithm() and only need
+ * O(N+M) memory.
+ *
+ * The result is a minimal diff (same edit distance as the forward engine), but
+ * when several minimal diffs exist the split may pick a different one. The
+ * VSCode parity pipeline therefore keeps using the forward engine.
+ */
+SequenceDiffArray *myers_bidir_diff_algorithm(const ISequence *seq1, const ISequence *seq2,
+                                              int timeout_ms, bool *hit_timeout) {
+  if (hit_timeout)
+    *hit_timeout = false;
+
+  int len_a = seq1->getLength(seq1);
+  int len_b = seq2->getLength(seq2);
+
+  if (len_a == 0 || len_b == 0) {
+    return dp_full_diff(len_a, len_b);
+  }
+
+  BidirContext ctx;
+  ctx.a = (uint32_t *)diff_malloc_array((size_t)len_a, sizeof(uint32_t));
+  ctx.b = (uint32_t *)diff_malloc_array((size_t)len_b, sizeof(uint32_t));
+  ctx.v_offset = len_b + 1;
+  ctx.vf = (int *)diff_malloc_array((size_t)len_a + len_b + 3, sizeof(int));
+  ctx.vr = (int *)diff_malloc_array((size_t)len_a + len_b + 3, sizeof(int));
+  ctx.out = (SequenceDiffArray *)diff_calloc(1, sizeof(SequenceDiffArray));
+  ctx.start_time = clock();
+  ctx.timeout_ms = timeout_ms;
+  ctx.timed_out = false;
+  ctx.out_of_memory = false;
+  if (!ctx.a || !ctx.b || !ctx.vf || !ctx.vr || !ctx.out) {
+    diff_free(ctx.a);
+    diff_free(ctx.b);
+    diff_free(ctx.vf);
+    diff_free(ctx.vr);
+    diff_free(ctx.out);
+    return NULL;
+  }
+
+  for (int i = 0; i < len_a; i++) {
+    ctx.a[i] = seq1->getElement(seq1, i);
+  }
+  for (int i = 0; i < len_b; i++) {
+    ctx.b[i] = seq2->getElement(seq2, i);
+  }
+
+  bidir_compare(&ctx, 0, len_a, 0, len_b);
+
+  diff_free(ctx.a);
+  diff_free(ctx.b);
+  diff_free(ctx.vf);
+  diff_free(ctx.vr);
+
+  if (ctx.out_of_memory) {
+    sequence_diff_array_free(ctx.out);
+    return NULL;
+  }
+  if (ctx.timed_out) {
+    if (hit_timeout)
+      *hit_timeout = true;
+    sequence_diff_array_free(ctx.out);
+    return dp_full_diff(len_a, len_b);
+  }
+
+  return ctx.out;
+}
+
+//==============================================================================
+// Memory-Bounded O(ND) Myers
+//==============================================================================
+
+SequenceDiffArray *myers_nd_bounded_diff_algorithm(const ISequence *seq1, const ISequence *seq2,
+                                                   int timeout_ms, int64_t max_memory_bytes,
+                                                   bool *hit_timeout, bool *hit_memory_limit) {
+  if (hit_timeout)
+    *hit_timeout = false;
+  if (hit_memory_limit)
+    *hit_memory_limit = false;
+
+  int len_a = seq1->getLength(seq1);
+  int len_b = seq2->getLength(seq2);
+
+  if (len_a == 0 || len_b == 0) {
+    return dp_full_diff(len_a, len_b);
+  }
+  if (max_memory_bytes <= 0) {
+    return myers_nd_run(seq1, seq2, len_a, len_b, timeout_ms, false, 0, hit_timeout, NULL);
+  }
+
+  // V and paths are needed regardless; the rest of the budget holds snakes.
+  // Halved because the pool grows by doubling.
+  int64_t diagonal_bytes = ((int64_t)len_a + len_b + 3) * (int64_t)(sizeof(int) + sizeof(int32_t));
+  int64_t snake_limit = (max_memory_bytes - diagonal_bytes) / (int64_t)sizeof(SnakeRecord) / 2;
+
+  clock_t start_time = clock();
+  if (snake_limit > 0) {
+    bool over_budget = false;
+    SequenceDiffArray *result =
+        myers_nd_run(seq1, seq2, len_a, len_b, timeout_ms, false,
+                     (int)(snake_limit < INT32_MAX ? snake_limit : INT32_MAX), hit_timeout,
+                     &over_budget);
+    if (!over_budget) {
+      return result;
+    }
+  }
+
+  if (hit_memory_limit)
+    *hit_memory_limit = true;
+
+  // Linear space for the rest of the timeout
+  int remaining_ms = timeout_ms;
+  if (timeout_ms > 0) {
+    int elapsed_ms = (int)((double)(clock() - start_time) * 1000.0 / CLOCKS_PER_SEC);
+    remaining_ms = max_int(timeout_ms - elapsed_ms, 1);
+  }
+  return myers_bidir_diff_algorithm(seq1, seq2, remaining_ms, hit_timeout);
+}
+
 //==============================================================================
 //==============================================================================
 // Legacy API for backward compatibility
@@ -645,6 +1232,14 @@ SequenceDiffArray *myers_diff_lines(const char **lines_a, int len_a, const char
   // Create LineSequence wrappers (no whitespace trimming for backward compat)
   ISequence *seq_a = line_sequence_create(lines_a, len_a, false, hash_map);
   ISequence *seq_b = line_sequence_create(lines_b, len_b, false, hash_map);
+  if (!hash_map || !seq_a || !seq_b) {
+    if (seq_a)
+      seq_a->destroy(seq_a);
+    if (seq_b)
+      seq_b->destroy(seq_b);
+    string_hash_map_destroy(hash_map);
+    return NULL;
+  }
 
   // Algorithm selection (simple version without equality scoring)
   int total = len_a + len_b;
@@ -13,6 +13,7 @@
  */
 
 #include "optimize.h"
+#include "allocator.h"
 #include "sequence.h"
 #include "string_hash_map.h"
 #include "types.h"
@@ -88,6 +89,28 @@ static uint32_t decode_utf8(const char **str_ptr) {
   return 0xFFFD; // Unicode replacement character
 }
 
+/**
+ * Count the characters of a line that are not Unicode whitespace
+ * (VSCode: line.replace(/\s/g, '').length).
+ */
+static int count_non_whitespace(const char *line) {
+  int count = 0;
+  if (!line) {
+    return 0;
+  }
+  const char *p = line;
+  while (*p) {
+    uint32_t ch = decode_utf8(&p);
+    if (ch == 0)
+      break; // End of string or invalid
+
+    if (!is_unicode_whitespace(ch)) {
+      count++;
+    }
+  }
+  return count;
+}
+
 /**
  * joinSequenceDiffsByShifting() - VSCode Parity
  * 
@@ -116,7 +139,11 @@ static SequenceDiffArray *join_sequence_diffs_by_shifting(const ISequence *seq1,
   int len2 = seq2->getLength(seq2);
 
   // Result array for first pass (move left)
-  SequenceDiff *result1 = (SequenceDiff *)malloc((size_t)diffs->count * sizeof(SequenceDiff));
+  SequenceDiff *result1 = (SequenceDiff *)diff_malloc_array((size_t)diffs->count,
+                                                            sizeof(SequenceDiff));
+  if (!result1) {
+    return NULL;
+  }
   int result1_count = 0;
 
   result1[result1_count++] = diffs->diffs[0];
@@ -177,7 +204,12 @@ static SequenceDiffArray *join_sequence_diffs_by_shifting(const ISequence *seq1,
   }
 
   // Second pass: Move all diffs right and join if possible
-  SequenceDiff *result2 = (SequenceDiff *)malloc((size_t)result1_count * sizeof(SequenceDiff));
+  SequenceDiff *result2 = (SequenceDiff *)diff_malloc_array((size_t)result1_count,
+                                                            sizeof(SequenceDiff));
+  if (!result2) {
+    diff_free(result1);
+    return NULL;
+  }
   int result2_count = 0;
 
   for (int i = 0; i < result1_count - 1; i++) {
@@ -232,11 +264,11 @@ static SequenceDiffArray *join_sequence_diffs_by_shifting(const ISequence *seq1,
   }
 
   // Update original array
-  free(diffs->diffs);
+  diff_free(diffs->diffs);
   diffs->diffs = result2;
   diffs->count = result2_count;
 
-  free(result1);
+  diff_free(result1);
 
   return diffs;
 }
@@ -381,8 +413,10 @@ SequenceDiffArray *optimize_sequence_diffs(const ISequence *seq1, const ISequenc
   }
 
   // Join by shifting (called twice per VSCode)
-  diffs = join_sequence_diffs_by_shifting(seq1, seq2, diffs);
-  diffs = join_sequence_diffs_by_shifting(seq1, seq2, diffs);
+  if (!join_sequence_diffs_by_shifting(seq1, seq2, diffs) ||
+      !join_sequence_diffs_by_shifting(seq1, seq2, diffs)) {
+    return NULL;
+  }
 
   // Shift to better boundaries
   diffs = shift_sequence_diffs(seq1, seq2, diffs);
@@ -413,7 +447,11 @@ SequenceDiffArray *remove_short_matches(const ISequence *seq1,
     return diffs;
   }
 
-  SequenceDiff *result = (SequenceDiff *)malloc((size_t)diffs->count * sizeof(SequenceDiff));
+  SequenceDiff *result = (SequenceDiff *)diff_malloc_array((size_t)diffs->count,
+                                                           sizeof(SequenceDiff));
+  if (!result) {
+    return NULL;
+  }
   int result_count = 0;
 
   for (int i = 0; i < diffs->count; i++) {
@@ -438,7 +476,7 @@ SequenceDiffArray *remove_short_matches(const ISequence *seq1,
   }
 
   // Update original array
-  free(diffs->diffs);
+  diff_free(diffs->diffs);
   diffs->diffs = result;
   diffs->count = result_count;
 
@@ -479,6 +517,28 @@ SequenceDiffArray *remove_very_short_matching_lines_between_diffs(const ISequenc
   // Cast to LineSequence to access line text
   LineSequence *line_seq = (LineSequence *)seq1->data;
 
+  // Every gap any pass looks at lies between two of the original diffs, so
+  // the non-whitespace counts of the gap lines are summed once up front and
+  // each gap becomes a prefix-sum lookup. Lines inside diffs count as 0.
+  int prefix_base = diffs->diffs[0].seq1_end;
+  int prefix_lines = diffs->diffs[diffs->count - 1].seq1_start - prefix_base;
+  int64_t *non_ws_prefix = NULL;
+  if (prefix_lines > 0) {
+    non_ws_prefix = diff_malloc_array((size_t)prefix_lines + 1, sizeof(int64_t));
+  }
+  if (non_ws_prefix) {
+    non_ws_prefix[0] = 0;
+    int next_diff = 1;
+    for (int idx = prefix_base; idx < prefix_base + prefix_lines; idx++) {
+      while (next_diff < diffs->count && diffs->diffs[next_diff].seq1_end <= idx) {
+        next_diff++;
+      }
+      bool in_diff = next_diff < diffs->count && diffs->diffs[next_diff].seq1_start <= idx;
+      int count = in_diff ? 0 : count_non_whitespace(line_seq->lines[idx]);
+      non_ws_prefix[idx - prefix_base + 1] = non_ws_prefix[idx - prefix_base] + count;
+    }
+  }
+
   int counter = 0;
   bool should_repeat;
 
@@ -486,7 +546,11 @@ SequenceDiffArray *remove_very_short_matching_lines_between_diffs(const ISequenc
     should_repeat = false;
 
     // Create result array
-    SequenceDiff *result = malloc(sizeof(SequenceDiff) * (size_t)diffs->capacity);
+    SequenceDiff *result = diff_malloc_array((size_t)diffs->capacity, sizeof(SequenceDiff));
+    if (!result) {
+      diff_free(non_ws_prefix);
+      return NULL;
+    }
     int result_count = 0;
 
     // Start with first diff
@@ -502,24 +566,13 @@ SequenceDiffArray *remove_very_short_matching_lines_between_diffs(const ISequenc
 
       // Count non-whitespace characters in unchanged region
       // VSCode: unchangedText.replace(/\s/g, '').length
-      // We must use UTF-8 decoding to properly handle Unicode whitespace
-      int non_ws_count = 0;
-      for (int idx = unchanged_start; idx < unchanged_end; idx++) {
-        const char *line = line_seq->lines[idx];
-        if (!line)
-          continue;
-
-        // Decode UTF-8 and check each character
-        const char *p = line;
-        while (*p) {
-          uint32_t ch = decode_utf8(&p);
-          if (ch == 0)
-            break; // End of string or invalid
-
-          // Check if this character is whitespace using Unicode-aware function
-          if (!is_unicode_whitespace(ch)) {
-            non_ws_count++;
-          }
+      int64_t non_ws_count = 0;
+      if (non_ws_prefix) {
+        non_ws_count = non_ws_prefix[unchanged_end - prefix_base] -
+                       non_ws_prefix[unchanged_start - prefix_base];
+      } else {
+        for (int idx = unchanged_start; idx < unchanged_end; idx++) {
+          non_ws_count += count_non_whitespace(line_seq->lines[idx]);
         }
       }
 
@@ -542,12 +595,13 @@ SequenceDiffArray *remove_very_short_matching_lines_between_diffs(const ISequenc
     }
 
     // Replace diffs with result
-    free(diffs->diffs);
+    diff_free(diffs->diffs);
     diffs->diffs = result;
     diffs->count = result_count;
 
   } while (counter++ < 10 && should_repeat);
 
+  diff_free(non_ws_prefix);
   return diffs;
 }
 
@@ -575,14 +629,22 @@ bool optimize_sequence_diffs_legacy(SequenceDiffArray *diffs, const char **lines
   // Create LineSequence wrappers
   ISequence *seq1 = line_sequence_create(lines_a, len_a, false, hash_map);
   ISequence *seq2 = line_sequence_create(lines_b, len_b, false, hash_map);
+  if (!hash_map || !seq1 || !seq2) {
+    if (seq1)
+      seq1->destroy(seq1);
+    if (seq2)
+      seq2->destroy(seq2);
+    string_hash_map_destroy(hash_map);
+    return false;
+  }
 
   // Call ISequence version
-  optimize_sequence_diffs(seq1, seq2, diffs);
+  bool ok = optimize_sequence_diffs(seq1, seq2, diffs) != NULL;
 
   // Cleanup
   seq1->destroy(seq1);
   seq2->destroy(seq2);
   string_hash_map_destroy(hash_map);
 
-  return true;
+  return ok;
 }
@@ -0,0 +1,147 @@
+/**
+ * Progress Reporting
+ *
+ * Each compute_diff_ex() call owns one DiffProgress. The calling thread
+ * attaches it as the reporter; refinement workers attach it poll-only. The
+ * callback therefore only ever runs on the calling thread, and the only
+ * state shared with the workers is the cancelled flag.
+ *
+ * Rate limiting reads the monotonic clock on every report attempt. The
+ * callers already check their timeouts at the same points (once per Myers D
+ * step, per DP check interval, per refinement region, per move candidate),
+ * so this adds one clock read to an existing one.
+ */
+
+#include "progress.h"
+#include "allocator.h"
+#include "utils.h"
+#include <stdint.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <windows.h>
+typedef volatile LONG progress_atomic_int;
+#define PROGRESS_THREAD_LOCAL __declspec(thread)
+#define progress_load(p) InterlockedCompareExchange((p), 0, 0)
+#define progress_store(p, v) InterlockedExchange((p), (LONG)(v))
+#else
+#include <stdatomic.h>
+typedef atomic_int progress_atomic_int;
+#define PROGRESS_THREAD_LOCAL _Thread_local
+#define progress_load(p) atomic_load(p)
+#define progress_store(p, v) atomic_store((p), (v))
+#endif
+
+#define DEFAULT_FIRST_REPORT_MS 100
+#define DEFAULT_REPORT_INTERVAL_MS 50
+
+struct DiffProgress {
+  DiffProgressCallback callback;
+  void *user_data;
+  progress_atomic_int cancelled;
+  // Reporting thread only
+  int64_t start_ms;
+  int64_t next_report_ms; // Earliest time for the next callback
+  const char *stage;
+  bool stage_nested;
+  double fraction; // Highest fraction reported for the current stage
+  bool reported;   // Callback invoked at least once
+};
+
+static int g_first_report_ms = DEFAULT_FIRST_REPORT_MS;
+static int g_report_interval_ms = DEFAULT_REPORT_INTERVAL_MS;
+
+static PROGRESS_THREAD_LOCAL DiffProgress *t_progress;
+static PROGRESS_THREAD_LOCAL bool t_reporter;
+
+DiffProgress *diff_progress_create(DiffProgressCallback callback, void *user_data) {
+  if (!callback)
+    return NULL;
+  DiffProgress *progress = (DiffProgress *)diff_malloc(sizeof(DiffProgress));
+  if (!progress)
+    return NULL;
+  progress->callback = callback;
+  progress->user_data = user_data;
+  progress_store(&progress->cancelled, 0);
+  progress->start_ms = get_current_time_ms();
+  progress->next_report_ms = progress->start_ms + g_first_report_ms;
+  progress->stage = NULL;
+  progress->stage_nested = false;
+  progress->fraction = 0.0;
+  progress->reported = false;
+  return progress;
+}
+
+void diff_progress_destroy(DiffProgress *progress) { diff_free(progress); }
+
+void diff_progress_attach(DiffProgress *progress, bool reporter) {
+  t_progress = progress;
+  t_reporter = progress && reporter;
+}
+
+void diff_progress_stage(const char *stage, bool nested) {
+  DiffProgress *progress = t_progress;
+  if (!progress || !t_reporter)
+    return;
+  progress->stage = stage;
+  progress->stage_nested = nested;
+  progress->fraction = 0.0;
+}
+
+/**
+ * Invoke the callback (reporting thread only). Returns false if cancelled.
+ */
+static bool report(DiffProgress *progress, const char *stage, double fraction, bool force) {
+  if (!force) {
+    int64_t now = get_current_time_ms();
+    if (now < progress->next_report_ms)
+      return true;
+    progress->next_report_ms = now + g_report_interval_ms;
+  }
+  progress->reported = true;
+  if (!progress->callback(stage, fraction, progress->user_data)) {
+    progress_store(&progress->cancelled, 1);
+    return false;
+  }
+  return true;
+}
+
+static bool update(DiffProgress *progress, double fraction) {
+  if (progress_load(&progress->cancelled))
+    return false;
+  if (!t_reporter || !progress->stage || fraction < 0.0)
+    return true;
+  // Engines may restart (e.g. the memory-bounded fallback); never go backwards
+  if (fraction > 1.0)
+    fraction = 1.0;
+  if (fraction > progress->fraction)
+    progress->fraction = fraction;
+  return report(progress, progress->stage, progress->fraction, false);
+}
+
+bool diff_progress_update(double fraction) {
+  DiffProgress *progress = t_progress;
+  return progress ? update(progress, fraction) : true;
+}
+
+bool diff_progress_nested(double fraction) {
+  DiffProgress *progress = t_progress;
+  if (!progress)
+    return true;
+  return update(progress, (t_reporter && progress->stage_nested) ? fraction : -1.0);
+}
+
+bool diff_progress_cancelled(void) {
+  DiffProgress *progress = t_progress;
+  return progress && progress_load(&progress->cancelled);
+}
+
+void diff_progress_finish(void) {
+  DiffProgress *progress = t_progress;
+  if (progress && t_reporter && progress->reported && !progress_load(&progress->cancelled))
+    report(progress, "done", 1.0, true);
+}
+
+void diff_progress_set_rate_limit(int first_ms, int interval_ms) {
+  g_first_report_ms = first_ms >= 0 ? first_ms : DEFAULT_FIRST_REPORT_MS;
+  g_report_interval_ms = interval_ms >= 0 ? interval_ms : DEFAULT_REPORT_INTERVAL_MS;
+}
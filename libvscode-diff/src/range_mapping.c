@@ -9,6 +9,7 @@
  */
 
 #include "range_mapping.h"
+#include "allocator.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -131,7 +132,7 @@ DetailedLineRangeMapping get_line_range_mapping(const RangeMapping *range_mappin
   result.modified.end_line = range_mapping->modified.end_line + 1 + line_end_delta;
 
   // Preserve inner character change
-  result.inner_changes = (RangeMapping *)malloc(sizeof(RangeMapping));
+  result.inner_changes = (RangeMapping *)diff_malloc(sizeof(RangeMapping));
   if (result.inner_changes) {
     result.inner_changes[0] = *range_mapping;
     result.inner_change_count = 1;
@@ -163,6 +164,27 @@ typedef struct {
   int capacity;
 } GroupArray;
 
+/**
+ * Free a GroupArray and its item arrays (the items' inner changes are not owned).
+ */
+static void free_group_array(GroupArray *groups) {
+  for (int i = 0; i < groups->count; i++) {
+    diff_free(groups->groups[i].items);
+  }
+  diff_free(groups->groups);
+  diff_free(groups);
+}
+
+/**
+ * Free the inner changes of count mappings and the array itself.
+ */
+static void free_mapped(DetailedLineRangeMapping *mapped, int count) {
+  for (int i = 0; i < count; i++) {
+    diff_free(mapped[i].inner_changes);
+  }
+  diff_free(mapped);
+}
+
 /**
  * Predicate for grouping adjacent DetailedLineRangeMappings.
  * 
@@ -195,16 +217,16 @@ static bool should_group_detailed_mappings(const DetailedLineRangeMapping *a,
  * VSCode Parity: 100%
  */
 static GroupArray *group_adjacent_detailed_mappings(DetailedLineRangeMapping *items, int count) {
-  GroupArray *result = (GroupArray *)malloc(sizeof(GroupArray));
+  GroupArray *result = (GroupArray *)diff_malloc(sizeof(GroupArray));
   if (!result)
     return NULL;
 
-  result->groups = (Group *)malloc(sizeof(Group) * 8);
+  result->groups = (Group *)diff_malloc(sizeof(Group) * 8);
   result->count = 0;
   result->capacity = 8;
 
   if (!result->groups) {
-    free(result);
+    diff_free(result);
     return NULL;
   }
 
@@ -219,13 +241,9 @@ static GroupArray *group_adjacent_detailed_mappings(DetailedLineRangeMapping *it
       // Start new group
       if (result->count >= result->capacity) {
         result->capacity *= 2;
-        Group *new_groups = (Group *)realloc(result->groups, sizeof(Group) * (size_t)result->capacity);
+        Group *new_groups = (Group *)diff_realloc(result->groups, sizeof(Group) * (size_t)result->capacity);
         if (!new_groups) {
-          for (int j = 0; j < result->count; j++) {
-            free(result->groups[j].items);
-          }
-          free(result->groups);
-          free(result);
+          free_group_array(result);
           return NULL;
         }
         result->groups = new_groups;
@@ -233,10 +251,11 @@ static GroupArray *group_adjacent_detailed_mappings(DetailedLineRangeMapping *it
 
       current_group = &result->groups[result->count++];
       current_group->items =
-          (DetailedLineRangeMapping *)malloc(sizeof(DetailedLineRangeMapping) * (size_t)(count - i));
+          (DetailedLineRangeMapping *)diff_malloc(sizeof(DetailedLineRangeMapping) * (size_t)(count - i));
       if (!current_group->items) {
         result->count--;
-        break;
+        free_group_array(result);
+        return NULL;
       }
       current_group->count = 0;
       current_group->items[current_group->count++] = items[i];
@@ -265,7 +284,8 @@ static GroupArray *group_adjacent_detailed_mappings(DetailedLineRangeMapping *it
  * @param modified_lines Modified file lines
  * @param modified_line_count Number of modified lines
  * @param dont_assert_start_line If true, skip start line assertions (not yet implemented)
- * @return Array of DetailedLineRangeMappings, caller must free with free_detailed_line_range_mapping_array()
+ * @return Array of DetailedLineRangeMappings, caller must free with free_detailed_line_range_mapping_array(),
+ *         or NULL if allocation failed
  * 
  * VSCode Reference: rangeMapping.ts lineRangeMappingFromRangeMappings()
  * VSCode Parity: 100% (assertions not yet implemented)
@@ -277,7 +297,7 @@ DetailedLineRangeMappingArray *line_range_mapping_from_range_mappings(
 
   if (!alignments || alignments->count == 0) {
     DetailedLineRangeMappingArray *result =
-        (DetailedLineRangeMappingArray *)malloc(sizeof(DetailedLineRangeMappingArray));
+        (DetailedLineRangeMappingArray *)diff_malloc(sizeof(DetailedLineRangeMappingArray));
     if (result) {
       result->mappings = NULL;
       result->count = 0;
@@ -287,49 +307,45 @@ DetailedLineRangeMappingArray *line_range_mapping_from_range_mappings(
   }
 
   // Step 1: Convert each RangeMapping to DetailedLineRangeMapping
-  DetailedLineRangeMapping *mapped =
-      (DetailedLineRangeMapping *)malloc(sizeof(DetailedLineRangeMapping) * (size_t)alignments->count);
+  DetailedLineRangeMapping *mapped = (DetailedLineRangeMapping *)diff_malloc_array(
+      (size_t)alignments->count, sizeof(DetailedLineRangeMapping));
   if (!mapped)
     return NULL;
 
   for (int i = 0; i < alignments->count; i++) {
     mapped[i] = get_line_range_mapping(&alignments->mappings[i], original_lines,
                                        original_line_count, modified_lines, modified_line_count);
+    if (!mapped[i].inner_changes) {
+      free_mapped(mapped, i);
+      return NULL;
+    }
   }
 
   // Step 2: Group adjacent mappings
   GroupArray *groups = group_adjacent_detailed_mappings(mapped, alignments->count);
   if (!groups) {
-    free(mapped);
+    free_mapped(mapped, alignments->count);
     return NULL;
   }
 
   // Step 3: Create result array
   DetailedLineRangeMappingArray *result =
-      (DetailedLineRangeMappingArray *)malloc(sizeof(DetailedLineRangeMappingArray));
+      (DetailedLineRangeMappingArray *)diff_malloc(sizeof(DetailedLineRangeMappingArray));
   if (!result) {
-    for (int i = 0; i < groups->count; i++) {
-      free(groups->groups[i].items);
-    }
-    free(groups->groups);
-    free(groups);
-    free(mapped);
+    free_group_array(groups);
+    free_mapped(mapped, alignments->count);
     return NULL;
   }
 
-  result->mappings =
-      (DetailedLineRangeMapping *)malloc(sizeof(DetailedLineRangeMapping) * (size_t)groups->count);
+  result->mappings = (DetailedLineRangeMapping *)diff_malloc_array((size_t)groups->count,
+                                                                    sizeof(DetailedLineRangeMapping));
   result->count = 0;
   result->capacity = groups->count;
 
   if (!result->mappings) {
-    free(result);
-    for (int i = 0; i < groups->count; i++) {
-      free(groups->groups[i].items);
-    }
-    free(groups->groups);
-    free(groups);
-    free(mapped);
+    diff_free(result);
+    free_group_array(groups);
+    free_mapped(mapped, alignments->count);
     return NULL;
   }
 
@@ -347,34 +363,23 @@ DetailedLineRangeMappingArray *line_range_mapping_from_range_mappings(
     change.modified = line_range_join(first->modified, last->modified);
 
     // Collect all inner changes from group
-    change.inner_changes = (RangeMapping *)malloc(sizeof(RangeMapping) * (size_t)g->count);
+    change.inner_changes = (RangeMapping *)diff_malloc_array((size_t)g->count, sizeof(RangeMapping));
     if (!change.inner_changes) {
-      change.inner_change_count = 0;
-    } else {
-      change.inner_change_count = g->count;
-      for (int j = 0; j < g->count; j++) {
-        if (g->items[j].inner_change_count > 0 && g->items[j].inner_changes) {
-          change.inner_changes[j] = g->items[j].inner_changes[0];
-        }
-      }
+      free_detailed_line_range_mapping_array(result);
+      result = NULL;
+      break;
+    }
+    change.inner_change_count = g->count;
+    for (int j = 0; j < g->count; j++) {
+      change.inner_changes[j] = g->items[j].inner_changes[0];
     }
 
     result->mappings[result->count++] = change;
   }
 
   // Cleanup temporary structures
-  for (int i = 0; i < groups->count; i++) {
-    Group *g = &groups->groups[i];
-    for (int j = 0; j < g->count; j++) {
-      if (g->items[j].inner_changes) {
-        free(g->items[j].inner_changes);
-      }
-    }
-    free(g->items);
-  }
-  free(groups->groups);
-  free(groups);
-  free(mapped);
+  free_group_array(groups);
+  free_mapped(mapped, alignments->count);
 
   return result;
 }
@@ -391,10 +396,10 @@ void free_detailed_line_range_mapping_array(DetailedLineRangeMappingArray *arr)
   if (arr->mappings) {
     for (int i = 0; i < arr->count; i++) {
       if (arr->mappings[i].inner_changes) {
-        free(arr->mappings[i].inner_changes);
+        diff_free(arr->mappings[i].inner_changes);
       }
     }
-    free(arr->mappings);
+    diff_free(arr->mappings);
   }
-  free(arr);
+  diff_free(arr);
 }
@@ -0,0 +1,375 @@
+/**
+ * Render Plan Generation
+ *
+ * Turns a LinesDiff into the flat list of extmarks the side-by-side view
+ * places: line highlights, per-line character highlight spans in byte
+ * columns, and filler lines.
+ *
+ * This is a direct port of the arithmetic that used to live in
+ * lua/codediff/ui/core.lua (render_diff, apply_char_highlight,
+ * calculate_fillers). Keeping it in C means the UI thread only loops over
+ * the plan instead of re-deriving every number per mapping.
+ *
+ * References:
+ * - docs/filler-line-algorithm.md
+ * - VSCode diffEditorViewZones.ts computeRangeAlignment()
+ */
+
+#include "render_plan.h"
+#include "allocator.h"
+#include "utf8_utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// RenderPlan Array Helpers
+// ============================================================================
+
+static bool render_plan_push(RenderPlan *plan, RenderItem item) {
+  if (plan->count >= plan->capacity) {
+    int new_capacity = plan->capacity == 0 ? 16 : plan->capacity * 2;
+    RenderItem *new_items =
+        (RenderItem *)diff_realloc(plan->items, sizeof(RenderItem) * (size_t)new_capacity);
+    if (!new_items)
+      return false;
+    plan->items = new_items;
+    plan->capacity = new_capacity;
+  }
+  plan->items[plan->count++] = item;
+  return true;
+}
+
+static int line_byte_length(const char **lines, int line_count, int line_number) {
+  if (line_number < 1 || line_number > line_count || !lines[line_number - 1])
+    return 0;
+  return (int)strlen(lines[line_number - 1]);
+}
+
+// ============================================================================
+// Line and Character Highlights
+// ============================================================================
+
+static bool emit_line_highlight(RenderPlan *plan, RenderSide side, LineRange range) {
+  if (range.end_line <= range.start_line)
+    return true;
+
+  RenderItem item = {.kind = RENDER_ITEM_LINE_HIGHLIGHT,
+                     .side = side,
+                     .start_line = range.start_line - 1,
+                     .start_col = 0,
+                     .end_line = range.end_line - 1,
+                     .end_col = 0,
+                     .count = 0};
+  return render_plan_push(plan, item);
+}
+
+/**
+ * Convert a 1-based UTF-16 column (diff core) to a 1-based byte column.
+ * ASCII lines map 1:1.
+ */
+static int utf16_col_to_byte_col(const char *line, int utf16_col) {
+  if (!line || utf16_col <= 1)
+    return utf16_col;
+  return utf16_pos_to_utf8_byte(line, utf16_col - 1) + 1;
+}
+
+/**
+ * Split a character range into per-line highlight spans.
+ *
+ * Mirrors apply_char_highlight(): empty ranges and ranges starting past the
+ * end of the line content are skipped, multi-line ranges become
+ * first-line-to-EOL, full middle lines and start-of-line-to-end_col spans.
+ */
+static bool emit_char_highlight(RenderPlan *plan, RenderSide side, const CharRange *range,
+                                const char **lines, int line_count) {
+  int start_line = range->start_line;
+  int start_col = range->start_col;
+  int end_line = range->end_line;
+  int end_col = range->end_col;
+
+  if (start_line == end_line && start_col == end_col)
+    return true;
+
+  if (start_line < 1 || start_line > line_count ||
+      start_col > line_byte_length(lines, line_count, start_line))
+    return true;
+
+  start_col = utf16_col_to_byte_col(lines[start_line - 1], start_col);
+
+  if (end_line >= 1 && end_line <= line_count) {
+    int end_line_len = line_byte_length(lines, line_count, end_line);
+    end_col = utf16_col_to_byte_col(lines[end_line - 1], end_col);
+    if (end_col > end_line_len + 1)
+      end_col = end_line_len + 1;
+  }
+
+  RenderItem item = {.kind = RENDER_ITEM_CHAR_HIGHLIGHT, .side = side, .count = 0};
+
+  if (start_line == end_line) {
+    item.start_line = start_line - 1;
+    item.start_col = start_col - 1;
+    item.end_line = start_line - 1;
+    item.end_col = end_col - 1;
+    return render_plan_push(plan, item);
+  }
+
+  // First line: from start column to end of line
+  item.start_line = start_line - 1;
+  item.start_col = start_col - 1;
+  item.end_line = start_line;
+  item.end_col = 0;
+  if (!render_plan_push(plan, item))
+    return false;
+
+  // Middle lines: whole line
+  for (int line = start_line + 1; line < end_line; line++) {
+    item.start_line = line - 1;
+    item.start_col = 0;
+    item.end_line = line;
+    item.end_col = 0;
+    if (!render_plan_push(plan, item))
+      return false;
+  }
+
+  // Last line: from line start to end column
+  item.start_line = end_line - 1;
+  item.start_col = 0;
+  item.end_line = end_line - 1;
+  item.end_col = end_col - 1;
+  return render_plan_push(plan, item);
+}
+
+// ============================================================================
+// Filler Lines (docs/filler-line-algorithm.md)
+// ============================================================================
+
+typedef struct {
+  int orig_end;
+  int mod_end;
+  int orig_len;
+  int mod_len;
+} Alignment;
+
+typedef struct {
+  Alignment *items;
+  int count;
+  int capacity;
+  int last_orig_line;
+  int last_mod_line;
+  bool first;
+} AlignmentState;
+
+static bool alignment_push(AlignmentState *state, int orig_end, int mod_end) {
+  if (state->count >= state->capacity) {
+    int new_capacity = state->capacity == 0 ? 8 : state->capacity * 2;
+    Alignment *new_items =
+        (Alignment *)diff_realloc(state->items, sizeof(Alignment) * (size_t)new_capacity);
+    if (!new_items)
+      return false;
+    state->items = new_items;
+    state->capacity = new_capacity;
+  }
+  Alignment *a = &state->items[state->count++];
+  a->orig_end = orig_end;
+  a->mod_end = mod_end;
+  a->orig_len = orig_end - state->last_orig_line;
+  a->mod_len = mod_end - state->last_mod_line;
+  return true;
+}
+
+static bool handle_gap_alignment(AlignmentState *state, int orig_line_exclusive,
+                                 int mod_line_exclusive) {
+  int orig_gap = orig_line_exclusive - state->last_orig_line;
+  int mod_gap = mod_line_exclusive - state->last_mod_line;
+
+  if (orig_gap > 0 || mod_gap > 0) {
+    if (!alignment_push(state, orig_line_exclusive, mod_line_exclusive))
+      return false;
+    state->last_orig_line = orig_line_exclusive;
+    state->last_mod_line = mod_line_exclusive;
+  }
+  return true;
+}
+
+static bool emit_alignment(AlignmentState *state, int orig_line_exclusive,
+                           int mod_line_exclusive) {
+  if (orig_line_exclusive < state->last_orig_line || mod_line_exclusive < state->last_mod_line)
+    return true;
+
+  if (state->first) {
+    state->first = false;
+  } else if (orig_line_exclusive == state->last_orig_line ||
+             mod_line_exclusive == state->last_mod_line) {
+    // OR check: see "Why the OR Redundancy Check is Critical"
+    return true;
+  }
+
+  if (orig_line_exclusive - state->last_orig_line > 0 ||
+      mod_line_exclusive - state->last_mod_line > 0) {
+    if (!alignment_push(state, orig_line_exclusive, mod_line_exclusive))
+      return false;
+  }
+
+  state->last_orig_line = orig_line_exclusive;
+  state->last_mod_line = mod_line_exclusive;
+  return true;
+}
+
+/**
+ * Queue `count` filler lines after 1-based line `after_line`.
+ * after_line == 0 means a deletion/insertion at the top of the file, which
+ * is rendered above the first line.
+ */
+static bool emit_filler(RenderPlan *plan, RenderSide side, int after_line, int count) {
+  if (count <= 0)
+    return true;
+
+  RenderItem item = {.kind = RENDER_ITEM_FILLER,
+                     .side = side,
+                     .start_line = after_line - 1,
+                     .start_col = 0,
+                     .end_line = after_line - 1,
+                     .end_col = 0,
+                     .count = count};
+  if (item.start_line < 0) {
+    item.kind = RENDER_ITEM_FILLER_ABOVE;
+    item.start_line = 0;
+    item.end_line = 0;
+  }
+
+  if (side == RENDER_SIDE_ORIGINAL) {
+    plan->original_filler_count += count;
+  } else {
+    plan->modified_filler_count += count;
+  }
+  return render_plan_push(plan, item);
+}
+
+/**
+ * Compute fillers for one mapping - port of calculate_fillers().
+ *
+ * @param last_orig_line In/out: end of the previous alignment (original side)
+ * @param last_mod_line In/out: end of the previous alignment (modified side)
+ */
+static bool emit_fillers(RenderPlan *plan, const DetailedLineRangeMapping *mapping,
+                         const char **original_lines, int original_count, int *last_orig_line,
+                         int *last_mod_line) {
+  if (!mapping->inner_changes || mapping->inner_change_count == 0) {
+    int orig_lines = mapping->original.end_line - mapping->original.start_line;
+    int mod_lines = mapping->modified.end_line - mapping->modified.start_line;
+    bool ok = true;
+
+    if (orig_lines > mod_lines) {
+      ok = emit_filler(plan, RENDER_SIDE_MODIFIED, mapping->modified.start_line - 1,
+                       orig_lines - mod_lines);
+    } else if (mod_lines > orig_lines) {
+      ok = emit_filler(plan, RENDER_SIDE_ORIGINAL, mapping->original.start_line - 1,
+                       mod_lines - orig_lines);
+    }
+    *last_orig_line = mapping->original.end_line;
+    *last_mod_line = mapping->modified.end_line;
+    return ok;
+  }
+
+  AlignmentState state = {.items = NULL,
+                          .count = 0,
+                          .capacity = 0,
+                          .last_orig_line = *last_orig_line,
+                          .last_mod_line = *last_mod_line,
+                          .first = true};
+  bool ok = handle_gap_alignment(&state, mapping->original.start_line,
+                                 mapping->modified.start_line);
+
+  for (int i = 0; ok && i < mapping->inner_change_count; i++) {
+    const RangeMapping *inner = &mapping->inner_changes[i];
+
+    if (inner->original.start_col > 1 && inner->modified.start_col > 1) {
+      ok = emit_alignment(&state, inner->original.start_line, inner->modified.start_line);
+    }
+
+    int orig_line_len = line_byte_length(original_lines, original_count, inner->original.end_line);
+    if (ok && inner->original.end_col <= orig_line_len) {
+      ok = emit_alignment(&state, inner->original.end_line, inner->modified.end_line);
+    }
+  }
+
+  if (ok) {
+    ok = emit_alignment(&state, mapping->original.end_line, mapping->modified.end_line);
+  }
+
+  for (int i = 0; ok && i < state.count; i++) {
+    const Alignment *align = &state.items[i];
+    int line_diff = align->mod_len - align->orig_len;
+
+    if (line_diff > 0) {
+      ok = emit_filler(plan, RENDER_SIDE_ORIGINAL, align->orig_end - 1, line_diff);
+    } else if (line_diff < 0) {
+      ok = emit_filler(plan, RENDER_SIDE_MODIFIED, align->mod_end - 1, -line_diff);
+    }
+  }
+
+  *last_orig_line = state.last_orig_line;
+  *last_mod_line = state.last_mod_line;
+  diff_free(state.items);
+  return ok;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+RenderPlan *compute_render_plan(const LinesDiff *diff, const char **original_lines,
+                                int original_count, const char **modified_lines,
+                                int modified_count) {
+  if (!diff || (original_count > 0 && !original_lines) ||
+      (modified_count > 0 && !modified_lines)) {
+    return NULL;
+  }
+
+  RenderPlan *plan = (RenderPlan *)diff_malloc(sizeof(RenderPlan));
+  if (!plan)
+    return NULL;
+  plan->items = NULL;
+  plan->count = 0;
+  plan->capacity = 0;
+  plan->original_filler_count = 0;
+  plan->modified_filler_count = 0;
+
+  int last_orig_line = 1;
+  int last_mod_line = 1;
+  bool ok = true;
+
+  for (int i = 0; ok && i < diff->changes.count; i++) {
+    const DetailedLineRangeMapping *mapping = &diff->changes.mappings[i];
+
+    ok = emit_line_highlight(plan, RENDER_SIDE_ORIGINAL, mapping->original) &&
+         emit_line_highlight(plan, RENDER_SIDE_MODIFIED, mapping->modified);
+
+    for (int j = 0; ok && mapping->inner_changes && j < mapping->inner_change_count; j++) {
+      const RangeMapping *inner = &mapping->inner_changes[j];
+      ok = emit_char_highlight(plan, RENDER_SIDE_ORIGINAL, &inner->original, original_lines,
+                               original_count) &&
+           emit_char_highlight(plan, RENDER_SIDE_MODIFIED, &inner->modified, modified_lines,
+                               modified_count);
+    }
+
+    if (ok) {
+      ok = emit_fillers(plan, mapping, original_lines, original_count, &last_orig_line,
+                        &last_mod_line);
+    }
+  }
+
+  if (!ok) {
+    free_render_plan(plan);
+    return NULL;
+  }
+
+  return plan;
+}
+
+void free_render_plan(RenderPlan *plan) {
+  if (!plan)
+    return;
+  diff_free(plan->items);
+  diff_free(plan);
+}
@@ -13,7 +13,9 @@
  */
 
 #include "sequence.h"
+#include "allocator.h"
 #include "platform.h"
+#include "simd_kernels.h"
 #include "string_hash_map.h"
 #include "utf8_utils.h"
 #include "utf8proc.h"
@@ -76,8 +78,21 @@ static int write_utf8_as_utf16_units(const char *src, int num_utf16_units, uint3
                                      int offset) {
   int byte_pos = 0;
   int utf16_units_written = 0;
+  const SimdKernels *simd = simd_kernels();
 
   while (utf16_units_written < num_utf16_units && src[byte_pos] != '\0') {
+    if ((unsigned char)src[byte_pos] < 0x80) {
+      // ASCII run: one byte per code unit. The remaining units never exceed
+      // the remaining bytes, so the kernel stays inside the string.
+      int ascii = simd->widen_ascii(src + byte_pos, num_utf16_units - utf16_units_written,
+                                    elements + offset);
+      byte_pos += ascii;
+      offset += ascii;
+      utf16_units_written += ascii;
+      if (utf16_units_written == num_utf16_units || src[byte_pos] == '\0')
+        break;
+    }
+
     uint32_t codepoint = utf8_decode_char(src, &byte_pos);
     if (codepoint == 0)
       break;
@@ -115,7 +130,7 @@ static int write_utf8_as_utf16_units(const char *src, int num_utf16_units, uint3
 // ============================================================================
 
 /**
- * Create a trimmed copy of string (caller must free)
+ * Create a trimmed copy of string (caller must free; NULL if allocation failed)
  */
 static char *trim_string(const char *str) {
   if (!str)
@@ -134,7 +149,9 @@ static char *trim_string(const char *str) {
 
   // Copy trimmed portion
   int len = (int)(end - str);
-  char *result = (char *)malloc((size_t)len + 1);
+  char *result = (char *)diff_malloc((size_t)len + 1);
+  if (!result)
+    return NULL;
   memcpy(result, str, (size_t)len);
   result[len] = '\0';
   return result;
@@ -166,7 +183,7 @@ static bool line_seq_is_strongly_equal(const ISequence *self, int offset1, int o
     return false;
   }
   // Strong equality checks original lines (including whitespace)
-  return strcmp(seq->lines[offset1], seq->lines[offset2]) == 0;
+  return seq->full_hash[offset1] == seq->full_hash[offset2];
 }
 
 /**
@@ -226,9 +243,11 @@ static int line_seq_get_boundary_score(const ISequence *self, int length) {
 
 static void line_seq_destroy(ISequence *self) {
   LineSequence *seq = (LineSequence *)self->data;
-  free(seq->trimmed_hash);
-  free(seq);
-  free(self);
+  diff_free(seq->trimmed_hash);
+  diff_free(seq->full_hash);
+  diff_free(seq->line_lengths);
+  diff_free(seq);
+  diff_free(self);
 }
 
 /**
@@ -240,7 +259,13 @@ static void line_seq_destroy(ISequence *self) {
  */
 ISequence *line_sequence_create(const char **lines, int length, bool ignore_whitespace,
                                 StringHashMap *hash_map) {
-  LineSequence *seq = (LineSequence *)malloc(sizeof(LineSequence));
+  LineSequence *seq = (LineSequence *)diff_calloc(1, sizeof(LineSequence));
+  ISequence *iseq = (ISequence *)diff_malloc(sizeof(ISequence));
+  if (!seq || !iseq) {
+    diff_free(seq);
+    diff_free(iseq);
+    return NULL;
+  }
   seq->lines = lines; // Just reference, not owned
   seq->length = length;
   seq->ignore_whitespace = ignore_whitespace;
@@ -252,16 +277,33 @@ ISequence *line_sequence_create(const char **lines, int length, bool ignore_whit
     owns_hash_map = true;
   }
 
-  // Pre-compute perfect hashes for all lines
-  seq->trimmed_hash = (uint32_t *)malloc(sizeof(uint32_t) * (size_t)length);
-  for (int i = 0; i < length; i++) {
+  // Pre-compute perfect hashes for all lines (trimmed and untrimmed in one pass)
+  size_t count = length > 0 ? (size_t)length : 1;
+  seq->trimmed_hash = (uint32_t *)diff_malloc_array(count, sizeof(uint32_t));
+  seq->full_hash = (uint32_t *)diff_malloc_array(count, sizeof(uint32_t));
+  seq->line_lengths = (size_t *)diff_malloc_array(count, sizeof(size_t));
+  bool ok = hash_map && seq->trimmed_hash && seq->full_hash && seq->line_lengths;
+  for (int i = 0; ok && i < length; i++) {
+    size_t line_len = strlen(lines[i]);
+    seq->line_lengths[i] = line_len;
     if (ignore_whitespace) {
       char *trimmed = trim_string(lines[i]);
+      if (!trimmed) {
+        ok = false;
+        break;
+      }
       seq->trimmed_hash[i] = string_hash_map_get_or_create(hash_map, trimmed);
-      free(trimmed);
+      // Lines without surrounding whitespace intern to the same ID
+      seq->full_hash[i] = strlen(trimmed) == line_len
+                              ? seq->trimmed_hash[i]
+                              : string_hash_map_get_or_create(hash_map, lines[i]);
+      diff_free(trimmed);
     } else {
       seq->trimmed_hash[i] = string_hash_map_get_or_create(hash_map, lines[i]);
+      seq->full_hash[i] = seq->trimmed_hash[i];
     }
+    ok = seq->trimmed_hash[i] != STRING_HASH_MAP_NO_MEMORY &&
+         seq->full_hash[i] != STRING_HASH_MAP_NO_MEMORY;
   }
 
   // Destroy internal hash map if we created it
@@ -270,17 +312,54 @@ ISequence *line_sequence_create(const char **lines, int length, bool ignore_whit
   }
 
   // Create ISequence wrapper
-  ISequence *iseq = (ISequence *)malloc(sizeof(ISequence));
   iseq->data = seq;
+  iseq->elements = seq->trimmed_hash;
   iseq->getElement = line_seq_get_element;
   iseq->getLength = line_seq_get_length;
   iseq->isStronglyEqual = line_seq_is_strongly_equal;
   iseq->getBoundaryScore = line_seq_get_boundary_score;
   iseq->destroy = line_seq_destroy;
 
+  if (!ok) {
+    line_seq_destroy(iseq);
+    return NULL;
+  }
   return iseq;
 }
 
+// ============================================================================
+// ArraySequence Implementation
+// ============================================================================
+
+static uint32_t array_seq_get_element(const ISequence *self, int offset) {
+  return ((const ArraySequence *)self->data)->elements[offset];
+}
+
+static int array_seq_get_length(const ISequence *self) {
+  return ((const ArraySequence *)self->data)->length;
+}
+
+static bool array_seq_is_strongly_equal(const ISequence *self, int offset1, int offset2) {
+  const ArraySequence *seq = (const ArraySequence *)self->data;
+  return seq->elements[offset1] == seq->elements[offset2];
+}
+
+static void array_seq_destroy(ISequence *self) {
+  (void)self; // Owned by the caller
+}
+
+void array_sequence_init(ArraySequence *seq, const uint32_t *elements, int length) {
+  seq->elements = elements;
+  seq->length = length;
+  seq->iface.data = seq;
+  seq->iface.elements = elements;
+  seq->iface.getElement = array_seq_get_element;
+  seq->iface.getLength = array_seq_get_length;
+  seq->iface.isStronglyEqual = array_seq_is_strongly_equal;
+  seq->iface.getBoundaryScore = NULL;
+  seq->iface.destroy = array_seq_destroy;
+}
+
 // ============================================================================
 // CharSequence Implementation
 // ============================================================================
@@ -404,12 +483,12 @@ static int char_seq_get_boundary_score(const ISequence *self, int length) {
 
 static void char_seq_destroy(ISequence *self) {
   CharSequence *seq = (CharSequence *)self->data;
-  free(seq->elements);
-  free(seq->line_start_offsets);
-  free(seq->trimmed_ws_lengths);
-  free(seq->original_line_start_cols);
-  free(seq);
-  free(self);
+  diff_free(seq->elements);
+  diff_free(seq->line_start_offsets);
+  diff_free(seq->trimmed_ws_lengths);
+  diff_free(seq->original_line_start_cols);
+  diff_free(seq);
+  diff_free(self);
 }
 
 /**
@@ -420,7 +499,7 @@ static void char_seq_destroy(ISequence *self) {
  * REUSED BY: Step 4 (char_level.c) for each line-level diff
  */
 static ISequence *char_sequence_create_empty(bool consider_whitespace) {
-  CharSequence *seq = (CharSequence *)malloc(sizeof(CharSequence));
+  CharSequence *seq = (CharSequence *)diff_malloc(sizeof(CharSequence));
   if (!seq) {
     return NULL;
   }
@@ -432,12 +511,13 @@ static ISequence *char_sequence_create_empty(bool consider_whitespace) {
   seq->line_count = 0;
   seq->consider_whitespace = consider_whitespace;
 
-  ISequence *iseq = (ISequence *)malloc(sizeof(ISequence));
+  ISequence *iseq = (ISequence *)diff_malloc(sizeof(ISequence));
   if (!iseq) {
-    free(seq);
+    diff_free(seq);
     return NULL;
   }
   iseq->data = seq;
+  iseq->elements = seq->elements;
   iseq->getElement = char_seq_get_element;
   iseq->getLength = char_seq_get_length;
   iseq->isStronglyEqual = char_seq_is_strongly_equal;
@@ -506,37 +586,38 @@ ISequence *char_sequence_create_from_range(const char **lines, int line_count,
     return char_sequence_create_empty(consider_whitespace);
   }
 
-  CharSequence *seq = (CharSequence *)malloc(sizeof(CharSequence));
+  CharSequence *seq = (CharSequence *)diff_malloc(sizeof(CharSequence));
   if (!seq) {
     return NULL;
   }
   seq->consider_whitespace = consider_whitespace;
   seq->line_count = line_span;
   seq->elements = NULL;
-  seq->line_start_offsets = (int *)malloc(sizeof(int) * (size_t)(line_span + 1));
-  seq->trimmed_ws_lengths = (int *)malloc(sizeof(int) * (size_t)line_span);
-  seq->original_line_start_cols = (int *)malloc(sizeof(int) * (size_t)line_span);
+  seq->line_start_offsets = (int *)diff_malloc_array((size_t)line_span + 1, sizeof(int));
+  seq->trimmed_ws_lengths = (int *)diff_malloc_array((size_t)line_span, sizeof(int));
+  seq->original_line_start_cols = (int *)diff_malloc_array((size_t)line_span, sizeof(int));
   if (!seq->line_start_offsets || !seq->trimmed_ws_lengths || !seq->original_line_start_cols) {
-    free(seq->line_start_offsets);
-    free(seq->trimmed_ws_lengths);
-    free(seq->original_line_start_cols);
-    free(seq);
+    diff_free(seq->line_start_offsets);
+    diff_free(seq->trimmed_ws_lengths);
+    diff_free(seq->original_line_start_cols);
+    diff_free(seq);
     return NULL;
   }
 
-  int *effective_lengths = (int *)malloc(sizeof(int) * (size_t)line_span);
+  int *effective_lengths = (int *)diff_malloc_array((size_t)line_span, sizeof(int));
   if (!effective_lengths) {
-    free(seq->line_start_offsets);
-    free(seq->trimmed_ws_lengths);
-    free(seq->original_line_start_cols);
-    free(seq);
+    diff_free(seq->line_start_offsets);
+    diff_free(seq->trimmed_ws_lengths);
+    diff_free(seq->original_line_start_cols);
+    diff_free(seq);
     return NULL;
   }
 
   // PASS 1: Count total UTF-16 code units
   // JavaScript Note: In JS, strings are indexed by UTF-16 code units (str[i], str.length)
   // C Note: We must convert UTF-8 to UTF-16 code units for algorithm compatibility
-  int total_len = 0;
+  // 64-bit so a huge range is detected instead of wrapping
+  int64_t total_len = 0;
   for (int idx = 0; idx < line_span; idx++) {
     int line_number = start_line_num + idx;
     const char *line =
@@ -625,16 +706,19 @@ ISequence *char_sequence_create_from_range(const char **lines, int line_count,
     }
   }
 
-  seq->elements = (uint32_t *)malloc(sizeof(uint32_t) * (size_t)(total_len + 1));
+  // Over the engines' int range: fail like an allocation failure
+  seq->elements = total_len <= SEQUENCE_MAX_COMBINED_LENGTH
+                      ? (uint32_t *)diff_malloc_array((size_t)total_len + 1, sizeof(uint32_t))
+                      : NULL;
   if (!seq->elements) {
-    free(effective_lengths);
-    free(seq->line_start_offsets);
-    free(seq->trimmed_ws_lengths);
-    free(seq->original_line_start_cols);
-    free(seq);
+    diff_free(effective_lengths);
+    diff_free(seq->line_start_offsets);
+    diff_free(seq->trimmed_ws_lengths);
+    diff_free(seq->original_line_start_cols);
+    diff_free(seq);
     return NULL;
   }
-  seq->length = total_len;
+  seq->length = (int)total_len;
 
   // PASS 2: Build elements array with UTF-16 code units
   // JavaScript Note: In JS, strings are UTF-16 arrays, so str[i] returns a UTF-16 code unit
@@ -681,18 +765,19 @@ ISequence *char_sequence_create_from_range(const char **lines, int line_count,
   }
   seq->line_start_offsets[line_span] = offset;
 
-  free(effective_lengths);
+  diff_free(effective_lengths);
 
-  ISequence *iseq = (ISequence *)malloc(sizeof(ISequence));
+  ISequence *iseq = (ISequence *)diff_malloc(sizeof(ISequence));
   if (!iseq) {
-    free(seq->elements);
-    free(seq->line_start_offsets);
-    free(seq->trimmed_ws_lengths);
-    free(seq->original_line_start_cols);
-    free(seq);
+    diff_free(seq->elements);
+    diff_free(seq->line_start_offsets);
+    diff_free(seq->trimmed_ws_lengths);
+    diff_free(seq->original_line_start_cols);
+    diff_free(seq);
     return NULL;
   }
   iseq->data = seq;
+  iseq->elements = seq->elements;
   iseq->getElement = char_seq_get_element;
   iseq->getLength = char_seq_get_length;
   iseq->isStronglyEqual = char_seq_is_strongly_equal;
@@ -910,7 +995,7 @@ char *char_sequence_get_text(const CharSequence *seq, int start_offset, int end_
   }
 
   int len = end_offset - start_offset;
-  char *result = (char *)malloc((size_t)len + 1);
+  char *result = (char *)diff_malloc((size_t)len + 1);
   if (!result)
     return NULL;
 
@@ -941,24 +1026,39 @@ void char_sequence_extend_to_full_lines(const CharSequence *seq, int start_offse
   }
 
   // VSCode: findLastMonotonous(firstElementOffsetByLineIdx, x => x <= range.start) ?? 0
-  // Find the last line start offset that is <= start_offset
+  // Find the last line start offset that is <= start_offset (binary search,
+  // line start offsets are non-decreasing)
   int extended_start = 0;
-  for (int i = seq->line_count - 1; i >= 0; i--) {
-    if (seq->line_start_offsets[i] <= start_offset) {
-      extended_start = seq->line_start_offsets[i];
-      break;
+  int left = 0;
+  int right = seq->line_count;
+  while (left < right) {
+    int mid = (left + right) / 2;
+    if (seq->line_start_offsets[mid] <= start_offset) {
+      left = mid + 1;
+    } else {
+      right = mid;
     }
   }
+  if (left > 0) {
+    extended_start = seq->line_start_offsets[left - 1];
+  }
 
   // VSCode: findFirstMonotonous(firstElementOffsetByLineIdx, x => range.endExclusive <= x) ?? elements.length
   // Find the first line start offset that is >= end_offset (or use seq->length)
   int extended_end = seq->length;
-  for (int i = 0; i < seq->line_count; i++) {
-    if (end_offset <= seq->line_start_offsets[i]) {
-      extended_end = seq->line_start_offsets[i];
-      break;
+  left = 0;
+  right = seq->line_count;
+  while (left < right) {
+    int mid = (left + right) / 2;
+    if (seq->line_start_offsets[mid] < end_offset) {
+      left = mid + 1;
+    } else {
+      right = mid;
     }
   }
+  if (left < seq->line_count) {
+    extended_end = seq->line_start_offsets[left];
+  }
 
   *out_start = extended_start;
   *out_end = extended_end;
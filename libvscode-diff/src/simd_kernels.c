@@ -0,0 +1,463 @@
+/**
+ * SIMD Kernels with Runtime CPU Dispatch
+ *
+ * Each kernel has a scalar reference implementation and, on x86, SSE2, AVX2
+ * and AVX-512 versions. The vector versions handle whole blocks and hand the
+ * remainder (and the block holding the first mismatch) to the scalar loop, so
+ * every variant returns exactly what the scalar one does.
+ *
+ * The vector functions are compiled with __attribute__((target(...))) rather
+ * than global -m flags, so they only run after simd_detect_variant() has
+ * confirmed the CPU (and OS, for the wider registers) supports them. MSVC
+ * allows the intrinsics without /arch, so it only needs the detection.
+ *
+ * The active table is a pointer to one of the static tables below, stored
+ * atomically: the first callers may race to detect, but they all store the
+ * same value.
+ */
+
+#include "simd_kernels.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__)) &&     \
+    !defined(__TINYC__)
+#define SIMD_X86 1
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#elif defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+#define SIMD_X86 1
+#define SIMD_TARGET(isa)
+#endif
+
+#ifdef SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+// x64 MSVC gives volatile accesses acquire/release semantics (/volatile:ms)
+typedef const SimdKernels *volatile simd_atomic_ptr;
+#define simd_load(p) (*(p))
+#define simd_store(p, v) (*(p) = (v))
+#else
+#include <stdatomic.h>
+typedef _Atomic(const SimdKernels *) simd_atomic_ptr;
+#define simd_load(p) atomic_load(p)
+#define simd_store(p, v) atomic_store((p), (v))
+#endif
+
+// ============================================================================
+// Scalar Reference
+// ============================================================================
+
+static size_t find_byte_scalar(const char *s, size_t n, char c) {
+  size_t i = 0;
+  while (i < n && s[i] != c)
+    i++;
+  return i;
+}
+
+static int match_length_u32_scalar(const uint32_t *a, const uint32_t *b, int n) {
+  int i = 0;
+  while (i < n && a[i] == b[i])
+    i++;
+  return i;
+}
+
+static int match_length_reverse_u32_scalar(const uint32_t *a, const uint32_t *b, int n) {
+  int i = 0;
+  while (i < n && a[n - 1 - i] == b[n - 1 - i])
+    i++;
+  return i;
+}
+
+static int widen_ascii_scalar(const char *src, int n, uint32_t *dst) {
+  int i = 0;
+  while (i < n) {
+    unsigned char ch = (unsigned char)src[i];
+    if (ch == 0 || ch >= 0x80)
+      break;
+    dst[i++] = ch;
+  }
+  return i;
+}
+
+static int sum_abs_diff_i32_scalar(const int *a, const int *b, int n) {
+  int sum = 0;
+  for (int i = 0; i < n; i++) {
+    int d = a[i] - b[i];
+    sum += d < 0 ? -d : d;
+  }
+  return sum;
+}
+
+static const SimdKernels SCALAR_KERNELS = {
+    find_byte_scalar,
+    match_length_u32_scalar,
+    match_length_reverse_u32_scalar,
+    widen_ascii_scalar,
+    sum_abs_diff_i32_scalar,
+};
+
+#ifdef SIMD_X86
+
+static inline int ctz32(uint32_t mask) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return (int)index;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+static inline int ctz64(uint64_t mask) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward64(&index, mask);
+  return (int)index;
+#else
+  return __builtin_ctzll(mask);
+#endif
+}
+
+// ============================================================================
+// SSE2
+// ============================================================================
+
+SIMD_TARGET("sse2")
+static size_t find_byte_sse2(const char *s, size_t n, char c) {
+  __m128i needle = _mm_set1_epi8(c);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, needle));
+    if (mask)
+      return i + (size_t)ctz32((uint32_t)mask);
+  }
+  return i + find_byte_scalar(s + i, n - i, c);
+}
+
+SIMD_TARGET("sse2")
+static int match_length_u32_sse2(const uint32_t *a, const uint32_t *b, int n) {
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+    __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+    int eq = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(va, vb)));
+    if (eq != 0xF)
+      return i + ctz32((uint32_t)~eq);
+  }
+  return i + match_length_u32_scalar(a + i, b + i, n - i);
+}
+
+SIMD_TARGET("sse2")
+static int match_length_reverse_u32_sse2(const uint32_t *a, const uint32_t *b, int n) {
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i va = _mm_loadu_si128((const __m128i *)(a + n - i - 4));
+    __m128i vb = _mm_loadu_si128((const __m128i *)(b + n - i - 4));
+    if (_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(va, vb))) != 0xF)
+      break;
+  }
+  return i + match_length_reverse_u32_scalar(a, b, n - i);
+}
+
+SIMD_TARGET("sse2")
+static int widen_ascii_sse2(const char *src, int n, uint32_t *dst) {
+  __m128i zero = _mm_setzero_si128();
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+    // High bit set (non-ASCII) or NUL ends the run
+    if (_mm_movemask_epi8(_mm_or_si128(v, _mm_cmpeq_epi8(v, zero))))
+      break;
+    __m128i lo = _mm_unpacklo_epi8(v, zero);
+    __m128i hi = _mm_unpackhi_epi8(v, zero);
+    _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi16(lo, zero));
+    _mm_storeu_si128((__m128i *)(dst + i + 4), _mm_unpackhi_epi16(lo, zero));
+    _mm_storeu_si128((__m128i *)(dst + i + 8), _mm_unpacklo_epi16(hi, zero));
+    _mm_storeu_si128((__m128i *)(dst + i + 12), _mm_unpackhi_epi16(hi, zero));
+  }
+  return i + widen_ascii_scalar(src + i, n - i, dst + i);
+}
+
+SIMD_TARGET("sse2")
+static int sum_abs_diff_i32_sse2(const int *a, const int *b, int n) {
+  __m128i acc = _mm_setzero_si128();
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i d = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)(a + i)),
+                              _mm_loadu_si128((const __m128i *)(b + i)));
+    // |d| = (d ^ sign) - sign; SSE2 has no abs instruction
+    __m128i sign = _mm_srai_epi32(d, 31);
+    acc = _mm_add_epi32(acc, _mm_sub_epi32(_mm_xor_si128(d, sign), sign));
+  }
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(acc) + sum_abs_diff_i32_scalar(a + i, b + i, n - i);
+}
+
+static const SimdKernels SSE2_KERNELS = {
+    find_byte_sse2,
+    match_length_u32_sse2,
+    match_length_reverse_u32_sse2,
+    widen_ascii_sse2,
+    sum_abs_diff_i32_sse2,
+};
+
+// ============================================================================
+// AVX2
+// ============================================================================
+
+SIMD_TARGET("avx2")
+static size_t find_byte_avx2(const char *s, size_t n, char c) {
+  __m256i needle = _mm256_set1_epi8(c);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(s + i));
+    uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle));
+    if (mask)
+      return i + (size_t)ctz32(mask);
+  }
+  return i + find_byte_scalar(s + i, n - i, c);
+}
+
+SIMD_TARGET("avx2")
+static int match_length_u32_avx2(const uint32_t *a, const uint32_t *b, int n) {
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i va = _mm256_loadu_si256((const __m256i *)(a + i));
+    __m256i vb = _mm256_loadu_si256((const __m256i *)(b + i));
+    int eq = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(va, vb)));
+    if (eq != 0xFF)
+      return i + ctz32((uint32_t)~eq);
+  }
+  return i + match_length_u32_scalar(a + i, b + i, n - i);
+}
+
+SIMD_TARGET("avx2")
+static int match_length_reverse_u32_avx2(const uint32_t *a, const uint32_t *b, int n) {
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i va = _mm256_loadu_si256((const __m256i *)(a + n - i - 8));
+    __m256i vb = _mm256_loadu_si256((const __m256i *)(b + n - i - 8));
+    if (_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(va, vb))) != 0xFF)
+      break;
+  }
+  return i + match_length_reverse_u32_scalar(a, b, n - i);
+}
+
+SIMD_TARGET("avx2")
+static int widen_ascii_avx2(const char *src, int n, uint32_t *dst) {
+  __m256i zero = _mm256_setzero_si256();
+  int i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+    if (_mm256_movemask_epi8(_mm256_or_si256(v, _mm256_cmpeq_epi8(v, zero))))
+      break;
+    __m128i lo = _mm256_castsi256_si128(v);
+    __m128i hi = _mm256_extracti128_si256(v, 1);
+    _mm256_storeu_si256((__m256i *)(dst + i), _mm256_cvtepu8_epi32(lo));
+    _mm256_storeu_si256((__m256i *)(dst + i + 8), _mm256_cvtepu8_epi32(_mm_srli_si128(lo, 8)));
+    _mm256_storeu_si256((__m256i *)(dst + i + 16), _mm256_cvtepu8_epi32(hi));
+    _mm256_storeu_si256((__m256i *)(dst + i + 24), _mm256_cvtepu8_epi32(_mm_srli_si128(hi, 8)));
+  }
+  return i + widen_ascii_scalar(src + i, n - i, dst + i);
+}
+
+SIMD_TARGET("avx2")
+static int sum_abs_diff_i32_avx2(const int *a, const int *b, int n) {
+  __m256i acc = _mm256_setzero_si256();
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i d = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *)(a + i)),
+                                 _mm256_loadu_si256((const __m256i *)(b + i)));
+    acc = _mm256_add_epi32(acc, _mm256_abs_epi32(d));
+  }
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum) + sum_abs_diff_i32_scalar(a + i, b + i, n - i);
+}
+
+static const SimdKernels AVX2_KERNELS = {
+    find_byte_avx2,
+    match_length_u32_avx2,
+    match_length_reverse_u32_avx2,
+    widen_ascii_avx2,
+    sum_abs_diff_i32_avx2,
+};
+
+// ============================================================================
+// AVX-512 (F + BW)
+// ============================================================================
+
+SIMD_TARGET("avx512f,avx512bw")
+static size_t find_byte_avx512(const char *s, size_t n, char c) {
+  __m512i needle = _mm512_set1_epi8(c);
+  size_t i = 0;
+  for (; i + 64 <= n; i += 64) {
+    __mmask64 mask = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512((const void *)(s + i)), needle);
+    if (mask)
+      return i + (size_t)ctz64((uint64_t)mask);
+  }
+  return i + find_byte_scalar(s + i, n - i, c);
+}
+
+SIMD_TARGET("avx512f,avx512bw")
+static int match_length_u32_avx512(const uint32_t *a, const uint32_t *b, int n) {
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __mmask16 ne = _mm512_cmpneq_epi32_mask(_mm512_loadu_si512((const void *)(a + i)),
+                                            _mm512_loadu_si512((const void *)(b + i)));
+    if (ne)
+      return i + ctz32((uint32_t)ne);
+  }
+  return i + match_length_u32_scalar(a + i, b + i, n - i);
+}
+
+SIMD_TARGET("avx512f,avx512bw")
+static int match_length_reverse_u32_avx512(const uint32_t *a, const uint32_t *b, int n) {
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    if (_mm512_cmpneq_epi32_mask(_mm512_loadu_si512((const void *)(a + n - i - 16)),
+                                 _mm512_loadu_si512((const void *)(b + n - i - 16))))
+      break;
+  }
+  return i + match_length_reverse_u32_scalar(a, b, n - i);
+}
+
+SIMD_TARGET("avx512f,avx512bw")
+static int widen_ascii_avx512(const char *src, int n, uint32_t *dst) {
+  __m512i zero = _mm512_setzero_si512();
+  int i = 0;
+  for (; i + 64 <= n; i += 64) {
+    __m512i v = _mm512_loadu_si512((const void *)(src + i));
+    if (_mm512_movepi8_mask(v) | _mm512_cmpeq_epi8_mask(v, zero))
+      break;
+    _mm512_storeu_si512((void *)(dst + i), _mm512_cvtepu8_epi32(_mm512_castsi512_si128(v)));
+    _mm512_storeu_si512((void *)(dst + i + 16),
+                        _mm512_cvtepu8_epi32(_mm512_extracti32x4_epi32(v, 1)));
+    _mm512_storeu_si512((void *)(dst + i + 32),
+                        _mm512_cvtepu8_epi32(_mm512_extracti32x4_epi32(v, 2)));
+    _mm512_storeu_si512((void *)(dst + i + 48),
+                        _mm512_cvtepu8_epi32(_mm512_extracti32x4_epi32(v, 3)));
+  }
+  return i + widen_ascii_scalar(src + i, n - i, dst + i);
+}
+
+SIMD_TARGET("avx512f,avx512bw")
+static int sum_abs_diff_i32_avx512(const int *a, const int *b, int n) {
+  __m512i acc = _mm512_setzero_si512();
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m512i d = _mm512_sub_epi32(_mm512_loadu_si512((const void *)(a + i)),
+                                 _mm512_loadu_si512((const void *)(b + i)));
+    acc = _mm512_add_epi32(acc, _mm512_abs_epi32(d));
+  }
+  return _mm512_reduce_add_epi32(acc) + sum_abs_diff_i32_scalar(a + i, b + i, n - i);
+}
+
+static const SimdKernels AVX512_KERNELS = {
+    find_byte_avx512,
+    match_length_u32_avx512,
+    match_length_reverse_u32_avx512,
+    widen_ascii_avx512,
+    sum_abs_diff_i32_avx512,
+};
+
+#endif // SIMD_X86
+
+// ============================================================================
+// Dispatch
+// ============================================================================
+
+static const SimdKernels *const KERNEL_TABLES[SIMD_VARIANT_COUNT] = {
+    &SCALAR_KERNELS,
+#ifdef SIMD_X86
+    &SSE2_KERNELS,
+    &AVX2_KERNELS,
+    &AVX512_KERNELS,
+#endif
+};
+
+static simd_atomic_ptr g_active;
+
+SimdVariant simd_detect_variant(void) {
+#if defined(SIMD_X86) && defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+  int max_leaf = info[0];
+  __cpuid(info, 1);
+  bool sse2 = (info[3] & (1 << 26)) != 0;
+  bool osxsave = (info[2] & (1 << 27)) != 0;
+  // The OS must save the YMM (and for AVX-512, opmask/ZMM) state
+  unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+  bool ymm = (xcr0 & 0x6) == 0x6;
+  bool zmm = (xcr0 & 0xE6) == 0xE6;
+  bool avx2 = false, avx512 = false;
+  if (max_leaf >= 7) {
+    __cpuidex(info, 7, 0);
+    avx2 = ymm && (info[1] & (1 << 5)) != 0;
+    avx512 = zmm && (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0;
+  }
+  if (avx512)
+    return SIMD_AVX512;
+  if (avx2)
+    return SIMD_AVX2;
+  return sse2 ? SIMD_SSE2 : SIMD_SCALAR;
+#elif defined(SIMD_X86)
+  // libgcc / compiler-rt also check that the OS enabled the register state
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+    return SIMD_AVX512;
+  if (__builtin_cpu_supports("avx2"))
+    return SIMD_AVX2;
+  if (__builtin_cpu_supports("sse2"))
+    return SIMD_SSE2;
+  return SIMD_SCALAR;
+#else
+  return SIMD_SCALAR;
+#endif
+}
+
+const SimdKernels *simd_kernels(void) {
+  const SimdKernels *kernels = simd_load(&g_active);
+  if (!kernels) {
+    kernels = KERNEL_TABLES[simd_detect_variant()];
+    simd_store(&g_active, kernels);
+  }
+  return kernels;
+}
+
+bool simd_force_variant(SimdVariant variant) {
+  if ((int)variant < 0 || variant >= SIMD_VARIANT_COUNT || variant > simd_detect_variant())
+    return false;
+  simd_store(&g_active, KERNEL_TABLES[variant]);
+  return true;
+}
+
+SimdVariant simd_active_variant(void) {
+  const SimdKernels *kernels = simd_kernels();
+  for (int v = 0; v < SIMD_VARIANT_COUNT; v++) {
+    if (KERNEL_TABLES[v] == kernels)
+      return (SimdVariant)v;
+  }
+  return SIMD_SCALAR;
+}
+
+const char *simd_variant_name(SimdVariant variant) {
+  switch (variant) {
+  case SIMD_SCALAR:
+    return "scalar";
+  case SIMD_SSE2:
+    return "sse2";
+  case SIMD_AVX2:
+    return "avx2";
+  case SIMD_AVX512:
+    return "avx512";
+  default:
+    return "unknown";
+  }
+}
@@ -15,6 +15,7 @@
  */
 
 #include "string_hash_map.h"
+#include "allocator.h"
 #include "platform.h"
 #include <stdlib.h>
 #include <string.h>
@@ -52,15 +53,23 @@ static uint32_t hash_for_bucket(const char *str) {
 }
 
 StringHashMap *string_hash_map_create(void) {
-  StringHashMap *map = (StringHashMap *)malloc(sizeof(StringHashMap));
+  StringHashMap *map = (StringHashMap *)diff_malloc(sizeof(StringHashMap));
+  if (!map) {
+    return NULL;
+  }
   map->capacity = INITIAL_CAPACITY;
   map->size = 0;
-  map->buckets = (HashEntry **)calloc((size_t)map->capacity, sizeof(HashEntry *));
+  map->buckets = (HashEntry **)diff_calloc((size_t)map->capacity, sizeof(HashEntry *));
+  if (!map->buckets) {
+    diff_free(map);
+    return NULL;
+  }
   return map;
 }
 
 /**
- * Resize the hash table when load factor exceeds threshold
+ * Resize the hash table when load factor exceeds threshold. If the larger
+ * bucket array cannot be allocated, the map keeps working with longer chains.
  */
 static void resize_if_needed(StringHashMap *map) {
   if ((double)map->size / map->capacity < LOAD_FACTOR) {
@@ -68,7 +77,10 @@ static void resize_if_needed(StringHashMap *map) {
   }
 
   int new_capacity = map->capacity * 2;
-  HashEntry **new_buckets = (HashEntry **)calloc((size_t)new_capacity, sizeof(HashEntry *));
+  HashEntry **new_buckets = (HashEntry **)diff_calloc((size_t)new_capacity, sizeof(HashEntry *));
+  if (!new_buckets) {
+    return;
+  }
 
   // Rehash all entries
   for (int i = 0; i < map->capacity; i++) {
@@ -85,7 +97,7 @@ static void resize_if_needed(StringHashMap *map) {
     }
   }
 
-  free(map->buckets);
+  diff_free(map->buckets);
   map->buckets = new_buckets;
   map->capacity = new_capacity;
 }
@@ -108,8 +120,13 @@ uint32_t string_hash_map_get_or_create(StringHashMap *map, const char *str) {
   // Recompute bucket after potential resize
   bucket = hash_for_bucket(str) % (uint32_t)map->capacity;
 
-  HashEntry *new_entry = (HashEntry *)malloc(sizeof(HashEntry));
-  new_entry->key = diff_strdup(str);
+  HashEntry *new_entry = (HashEntry *)diff_malloc(sizeof(HashEntry));
+  char *key = new_entry ? diff_strdup(str) : NULL;
+  if (!key) {
+    diff_free(new_entry);
+    return STRING_HASH_MAP_NO_MEMORY;
+  }
+  new_entry->key = key;
   new_entry->value = (uint32_t)map->size; // Sequential: 0, 1, 2, ...
   new_entry->next = map->buckets[bucket];
   map->buckets[bucket] = new_entry;
@@ -128,12 +145,12 @@ void string_hash_map_destroy(StringHashMap *map) {
     HashEntry *entry = map->buckets[i];
     while (entry) {
       HashEntry *next = entry->next;
-      free(entry->key);
-      free(entry);
+      diff_free(entry->key);
+      diff_free(entry);
       entry = next;
     }
   }
 
-  free(map->buckets);
-  free(map);
+  diff_free(map->buckets);
+  diff_free(map);
 }
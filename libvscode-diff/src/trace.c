@@ -0,0 +1,244 @@
+/**
+ * Timeline Tracing
+ *
+ * One ring buffer per recording thread, reached through a thread-local
+ * pointer. Buffers are pushed onto a global list with a compare-and-swap the
+ * first time a thread records and live for the rest of the process (threads
+ * in the OpenMP pool are reused, so there is one buffer per worker, not per
+ * diff). A new session bumps a generation counter; each thread resets its own
+ * buffer lazily the next time it records.
+ *
+ * Buffers use malloc directly rather than diff_malloc: they outlive any
+ * single diff and must not be returned to an allocator that was replaced by
+ * diff_set_allocator() in the meantime.
+ */
+
+#include "trace.h"
+
+#ifdef DIFF_TRACING
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// ============================================================================
+// Atomics
+// ============================================================================
+
+#if defined(_MSC_VER) && !defined(__clang__)
+// MSVC's C mode has no <stdatomic.h> without /experimental:c11atomics
+typedef volatile LONG trace_atomic_int;
+typedef PVOID volatile trace_atomic_ptr;
+#define TRACE_THREAD_LOCAL __declspec(thread)
+#define trace_load(p) InterlockedCompareExchange((p), 0, 0)
+#define trace_store(p, v) InterlockedExchange((p), (LONG)(v))
+#define trace_fetch_add(p, v) InterlockedExchangeAdd((p), (LONG)(v))
+#define trace_load_ptr(p) InterlockedCompareExchangePointer((p), NULL, NULL)
+#define trace_cas_ptr(p, expected, desired)                                                        \
+  (InterlockedCompareExchangePointer((p), (desired), (expected)) == (expected))
+#else
+#include <stdatomic.h>
+typedef atomic_int trace_atomic_int;
+typedef _Atomic(void *) trace_atomic_ptr;
+#define TRACE_THREAD_LOCAL _Thread_local
+#define trace_load(p) atomic_load(p)
+#define trace_store(p, v) atomic_store((p), (v))
+#define trace_fetch_add(p, v) atomic_fetch_add((p), (v))
+#define trace_load_ptr(p) atomic_load(p)
+#define trace_cas_ptr(p, expected, desired)                                                        \
+  atomic_compare_exchange_strong((p), &(void *){(expected)}, (desired))
+#endif
+
+// ============================================================================
+// State
+// ============================================================================
+
+#define DEFAULT_EVENTS_PER_THREAD 65536
+#define MAX_EVENTS_PER_THREAD (1 << 29) // count stays below 2 * capacity (see record)
+
+typedef struct {
+  const char *name;
+  int64_t ts_ns;
+  int arg;
+  char phase;
+} TraceEvent;
+
+typedef struct ThreadTrace {
+  TraceEvent *events;
+  int capacity;           // Power of two
+  trace_atomic_int count; // Events written; kept in [capacity, 2 * capacity) once full
+  int generation;         // Session the buffer contents belong to
+  int tid;
+  struct ThreadTrace *next;
+} ThreadTrace;
+
+static trace_atomic_int g_enabled;
+static trace_atomic_int g_generation;
+static trace_atomic_int g_capacity;
+static trace_atomic_int g_next_tid;
+static trace_atomic_ptr g_threads; // ThreadTrace list, push-only
+static int64_t g_start_ns;
+static TRACE_THREAD_LOCAL ThreadTrace *t_trace;
+
+static int64_t now_ns(void) {
+#ifdef _WIN32
+  LARGE_INTEGER freq, counter;
+  QueryPerformanceFrequency(&freq);
+  QueryPerformanceCounter(&counter);
+  return (int64_t)((double)counter.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+static ThreadTrace *register_thread(int generation) {
+  ThreadTrace *tt = (ThreadTrace *)malloc(sizeof(ThreadTrace));
+  if (!tt)
+    return NULL;
+  tt->capacity = trace_load(&g_capacity);
+  tt->events = (TraceEvent *)malloc((size_t)tt->capacity * sizeof(TraceEvent));
+  if (!tt->events) {
+    free(tt);
+    return NULL;
+  }
+  trace_store(&tt->count, 0);
+  tt->generation = generation;
+  tt->tid = trace_fetch_add(&g_next_tid, 1) + 1;
+
+  void *head;
+  do {
+    head = trace_load_ptr(&g_threads);
+    tt->next = (ThreadTrace *)head;
+  } while (!trace_cas_ptr(&g_threads, head, (void *)tt));
+
+  t_trace = tt;
+  return tt;
+}
+
+// ============================================================================
+// Recording
+// ============================================================================
+
+void diff_trace_event(const char *name, char phase, int arg) {
+  if (!trace_load(&g_enabled))
+    return;
+
+  int generation = trace_load(&g_generation);
+  ThreadTrace *tt = t_trace ? t_trace : register_thread(generation);
+  if (!tt)
+    return;
+
+  if (tt->generation != generation) {
+    // First event of a new session on this thread: drop the old contents
+    int capacity = trace_load(&g_capacity);
+    if (capacity != tt->capacity) {
+      TraceEvent *events = (TraceEvent *)malloc((size_t)capacity * sizeof(TraceEvent));
+      if (events) {
+        free(tt->events);
+        tt->events = events;
+        tt->capacity = capacity;
+      }
+    }
+    tt->generation = generation;
+    trace_store(&tt->count, 0);
+  }
+
+  int n = trace_load(&tt->count);
+  TraceEvent *ev = &tt->events[n & (tt->capacity - 1)];
+  ev->name = name;
+  ev->ts_ns = now_ns();
+  ev->arg = arg;
+  ev->phase = phase;
+  // Wrap by a whole capacity so the slot index (n & mask) is unchanged
+  n++;
+  trace_store(&tt->count, n == 2 * tt->capacity ? tt->capacity : n);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+bool diff_trace_start(size_t events_per_thread) {
+  size_t wanted = events_per_thread ? events_per_thread : DEFAULT_EVENTS_PER_THREAD;
+  if (wanted > MAX_EVENTS_PER_THREAD)
+    return false;
+  int capacity = 1;
+  while ((size_t)capacity < wanted)
+    capacity <<= 1;
+
+  trace_store(&g_enabled, 0);
+  trace_store(&g_capacity, capacity);
+  g_start_ns = now_ns();
+  trace_fetch_add(&g_generation, 1);
+  trace_store(&g_enabled, 1);
+  return true;
+}
+
+void diff_trace_stop(void) { trace_store(&g_enabled, 0); }
+
+bool diff_trace_write_json(const char *path) {
+  FILE *f = fopen(path, "w");
+  if (!f)
+    return false;
+
+  int generation = trace_load(&g_generation);
+  fprintf(f, "{\"traceEvents\":[\n");
+  fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+             "\"args\":{\"name\":\"vscode-diff\"}}");
+
+  for (ThreadTrace *tt = (ThreadTrace *)trace_load_ptr(&g_threads); tt; tt = tt->next) {
+    if (tt->generation != generation)
+      continue;
+    fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+               "\"args\":{\"name\":\"thread %d\"}}",
+            tt->tid, tt->tid);
+
+    int n = trace_load(&tt->count);
+    int first = n > tt->capacity ? n - tt->capacity : 0;
+    int depth = 0;
+    for (int i = first; i < n; i++) {
+      const TraceEvent *ev = &tt->events[i & (tt->capacity - 1)];
+      // The ring may have overwritten the begin of the oldest spans
+      if (ev->phase == 'E') {
+        if (depth == 0)
+          continue;
+        depth--;
+      } else {
+        depth++;
+      }
+      fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"pid\":1,\"tid\":%d,\"ts\":%.3f", ev->name,
+              ev->phase, tt->tid, (double)(ev->ts_ns - g_start_ns) / 1000.0);
+      if (ev->arg >= 0)
+        fprintf(f, ",\"args\":{\"index\":%d}", ev->arg);
+      fputc('}', f);
+    }
+  }
+
+  fprintf(f, "\n],\"displayTimeUnit\":\"ms\"}\n");
+  bool ok = !ferror(f);
+  return fclose(f) == 0 && ok;
+}
+
+#else // !DIFF_TRACING
+
+bool diff_trace_start(size_t events_per_thread) {
+  (void)events_per_thread;
+  return false;
+}
+
+void diff_trace_stop(void) {}
+
+bool diff_trace_write_json(const char *path) {
+  (void)path;
+  return false;
+}
+
+#endif // DIFF_TRACING
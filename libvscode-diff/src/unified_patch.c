@@ -0,0 +1,220 @@
+/**
+ * Unified Patch Builder
+ *
+ * Library API for embedders that stage, unstage or discard many hunks at
+ * once; the plugin builds its single-hunk patches in Lua (keymaps.lua). The
+ * same writer runs twice: once with no buffer to measure the patch, once to
+ * fill a single exact-size allocation.
+ */
+
+#include "unified_patch.h"
+#include "allocator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// Output
+// ============================================================================
+
+typedef struct {
+  char *buf; // NULL during the counting pass
+  size_t len;
+} PatchWriter;
+
+static void put_bytes(PatchWriter *w, const char *bytes, size_t n) {
+  if (w->buf)
+    memcpy(w->buf + w->len, bytes, n);
+  w->len += n;
+}
+
+static void put_line(PatchWriter *w, char prefix, const char *line) {
+  put_bytes(w, &prefix, 1);
+  put_bytes(w, line, strlen(line));
+  put_bytes(w, "\n", 1);
+}
+
+static void put_lines(PatchWriter *w, char prefix, const char **lines, int start, int end) {
+  for (int i = start; i < end; i++)
+    put_line(w, prefix, lines[i]);
+}
+
+// ============================================================================
+// Hunks
+// ============================================================================
+
+/**
+ * A selected change seen from the base side (the file the patch applies to).
+ * Line numbers are 1-based, end exclusive, as in LineRange.
+ */
+typedef struct {
+  int base_start, base_end;
+  int orig_start, orig_end;
+  int mod_start, mod_end;
+} SelectedChange;
+
+typedef struct {
+  const SelectedChange *changes;
+  int count;
+  const char **original_lines;
+  const char **modified_lines;
+  const char **base_lines;
+  int base_count;
+  int context;
+  bool reverse;
+} PatchInput;
+
+/**
+ * Header start for one side: git wants the line before the change when the
+ * side contributes no lines.
+ */
+static int header_start(int start, int count) {
+  if (count > 0)
+    return start;
+  return start > 0 ? start - 1 : 0;
+}
+
+static void write_patch(const PatchInput *in, const char *path, PatchWriter *w) {
+  put_bytes(w, "--- a/", 6);
+  put_bytes(w, path, strlen(path));
+  put_bytes(w, "\n+++ b/", 7);
+  put_bytes(w, path, strlen(path));
+  put_bytes(w, "\n", 1);
+
+  // Lines the other side is ahead of the base side before the current hunk
+  int shift = 0;
+  int first = 0;
+  while (first < in->count) {
+    // Grow the hunk while the next change's leading context touches it
+    int last = first;
+    int hunk_end = in->changes[first].base_end + in->context;
+    while (last + 1 < in->count &&
+           in->changes[last + 1].base_start - in->context <= hunk_end) {
+      last++;
+      hunk_end = in->changes[last].base_end + in->context;
+    }
+    int hunk_start = in->changes[first].base_start - in->context;
+    if (hunk_start < 1)
+      hunk_start = 1;
+    if (hunk_end > in->base_count + 1)
+      hunk_end = in->base_count + 1;
+
+    int context_count = hunk_end - hunk_start;
+    int removed = 0, added = 0;
+    for (int i = first; i <= last; i++) {
+      const SelectedChange *c = &in->changes[i];
+      context_count -= c->base_end - c->base_start;
+      removed += c->orig_end - c->orig_start;
+      added += c->mod_end - c->mod_start;
+    }
+    int old_count = context_count + removed;
+    int new_count = context_count + added;
+    int base_start = hunk_start;
+    int other_start = hunk_start + shift;
+    int old_start = in->reverse ? other_start : base_start;
+    int new_start = in->reverse ? base_start : other_start;
+
+    char header[96];
+    int header_len = snprintf(header, sizeof(header), "@@ -%d,%d +%d,%d @@\n",
+                              header_start(old_start, old_count), old_count,
+                              header_start(new_start, new_count), new_count);
+    put_bytes(w, header, (size_t)header_len);
+
+    int pos = hunk_start;
+    for (int i = first; i <= last; i++) {
+      const SelectedChange *c = &in->changes[i];
+      put_lines(w, ' ', in->base_lines, pos - 1, c->base_start - 1);
+      put_lines(w, '-', in->original_lines, c->orig_start - 1, c->orig_end - 1);
+      put_lines(w, '+', in->modified_lines, c->mod_start - 1, c->mod_end - 1);
+      pos = c->base_end;
+    }
+    put_lines(w, ' ', in->base_lines, pos - 1, hunk_end - 1);
+
+    shift += in->reverse ? removed - added : added - removed;
+    first = last + 1;
+  }
+}
+
+static int compare_ints(const void *a, const void *b) {
+  int x = *(const int *)a;
+  int y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+char *build_unified_patch(const LinesDiff *diff, const int *change_indices, int index_count,
+                          const char **original_lines, int original_count,
+                          const char **modified_lines, int modified_count,
+                          const UnifiedPatchOptions *options, size_t *out_length) {
+  if (out_length)
+    *out_length = 0;
+  if (!diff || !options || !options->path)
+    return NULL;
+
+  const DetailedLineRangeMappingArray *mappings = &diff->changes;
+  int count = change_indices ? index_count : mappings->count;
+  if (count <= 0)
+    return NULL;
+
+  // Changes are ordered by position, so sorted indices give hunk order
+  int *order = (int *)diff_malloc((size_t)count * sizeof(int));
+  SelectedChange *selected = (SelectedChange *)diff_malloc((size_t)count * sizeof(SelectedChange));
+  if (!order || !selected) {
+    diff_free(order);
+    diff_free(selected);
+    return NULL;
+  }
+  for (int i = 0; i < count; i++)
+    order[i] = change_indices ? change_indices[i] : i;
+  qsort(order, (size_t)count, sizeof(int), compare_ints);
+
+  int selected_count = 0;
+  bool valid = true;
+  for (int i = 0; i < count && valid; i++) {
+    int idx = order[i];
+    if (idx < 0 || idx >= mappings->count) {
+      valid = false;
+    } else if (selected_count == 0 || order[i - 1] != idx) {
+      const DetailedLineRangeMapping *m = &mappings->mappings[idx];
+      const LineRange *base = options->reverse ? &m->modified : &m->original;
+      valid = m->original.start_line >= 1 && m->original.end_line <= original_count + 1 &&
+              m->modified.start_line >= 1 && m->modified.end_line <= modified_count + 1;
+      selected[selected_count++] = (SelectedChange){base->start_line,      base->end_line,
+                                                    m->original.start_line, m->original.end_line,
+                                                    m->modified.start_line, m->modified.end_line};
+    }
+  }
+  diff_free(order);
+  if (!valid) {
+    diff_free(selected);
+    return NULL;
+  }
+
+  PatchInput input = {selected,
+                      selected_count,
+                      original_lines,
+                      modified_lines,
+                      options->reverse ? modified_lines : original_lines,
+                      options->reverse ? modified_count : original_count,
+                      options->context_lines > 0 ? options->context_lines : 0,
+                      options->reverse};
+
+  PatchWriter counter = {NULL, 0};
+  write_patch(&input, options->path, &counter);
+
+  char *patch = (char *)diff_malloc(counter.len + 1);
+  if (patch) {
+    PatchWriter writer = {patch, 0};
+    write_patch(&input, options->path, &writer);
+    patch[writer.len] = '\0';
+    if (out_length)
+      *out_length = writer.len;
+  }
+  diff_free(selected);
+  return patch;
+}
+
+void free_unified_patch(char *patch) { diff_free(patch); }
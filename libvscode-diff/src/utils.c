@@ -1,4 +1,5 @@
 #include "types.h"
+#include "allocator.h"
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -76,36 +77,6 @@ bool is_unicode_whitespace(uint32_t ch) {
 // Utility Functions
 // ============================================================================
 
-// Safe memory allocation with error checking
-void *mem_alloc(size_t size) {
-  void *ptr = malloc(size);
-  if (!ptr && size > 0) {
-    fprintf(stderr, "Memory allocation failed: %zu bytes\n", size);
-    exit(1);
-  }
-  return ptr;
-}
-
-// Safe memory reallocation
-void *mem_realloc(void *ptr, size_t size) {
-  void *new_ptr = realloc(ptr, size);
-  if (!new_ptr && size > 0) {
-    fprintf(stderr, "Memory reallocation failed: %zu bytes\n", size);
-    exit(1);
-  }
-  return new_ptr;
-}
-
-// Safe string duplication
-char *str_dup_safe(const char *str) {
-  if (!str)
-    return NULL;
-  size_t len = strlen(str);
-  char *dup = (char *)mem_alloc(len + 1);
-  memcpy(dup, str, len + 1);
-  return dup;
-}
-
 // Trim whitespace from both ends of a string (in-place, returns new length)
 size_t line_trim(char *str) {
   if (!str)
@@ -166,7 +137,7 @@ char *trim_string(const char *str) {
 
   // All whitespace?
   if (*start == '\0') {
-    char *result = (char *)malloc(1);
+    char *result = (char *)diff_malloc(1);
     if (result)
       result[0] = '\0';
     return result;
@@ -180,7 +151,7 @@ char *trim_string(const char *str) {
 
   // Allocate and copy
   size_t len = (size_t)(end - start + 1);
-  char *result = (char *)malloc(len + 1);
+  char *result = (char *)diff_malloc(len + 1);
   if (result) {
     memcpy(result, start, len);
     result[len] = '\0';
@@ -209,28 +180,45 @@ int64_t get_current_time_ms(void) {
 // SequenceDiffArray Functions
 // ============================================================================
 
+/**
+ * Create an empty SequenceDiffArray.
+ *
+ * @return New array, or NULL if allocation failed
+ */
 SequenceDiffArray *sequence_diff_array_create(void) {
-  SequenceDiffArray *arr = (SequenceDiffArray *)mem_alloc(sizeof(SequenceDiffArray));
+  SequenceDiffArray *arr = (SequenceDiffArray *)diff_malloc(sizeof(SequenceDiffArray));
+  if (!arr)
+    return NULL;
   arr->diffs = NULL;
   arr->count = 0;
   arr->capacity = 0;
   return arr;
 }
 
-void sequence_diff_array_append(SequenceDiffArray *arr, SequenceDiff diff) {
+/**
+ * Append a diff, growing the array geometrically.
+ *
+ * @return false if allocation failed (the array is then unchanged)
+ */
+bool sequence_diff_array_append(SequenceDiffArray *arr, SequenceDiff diff) {
   if (arr->count >= arr->capacity) {
-    size_t new_capacity = (size_t)(arr->capacity == 0 ? 8 : arr->capacity * 2);
-    arr->diffs = (SequenceDiff *)mem_realloc(arr->diffs, new_capacity * sizeof(SequenceDiff));
-    arr->capacity = (int)new_capacity;
+    int capacity = arr->capacity == 0 ? 16 : arr->capacity * 2;
+    SequenceDiff *grown =
+        (SequenceDiff *)diff_realloc_array(arr->diffs, (size_t)capacity, sizeof(SequenceDiff));
+    if (!grown)
+      return false;
+    arr->diffs = grown;
+    arr->capacity = capacity;
   }
   arr->diffs[arr->count++] = diff;
+  return true;
 }
 
 void sequence_diff_array_free(SequenceDiffArray *arr) {
   if (!arr)
     return;
-  free(arr->diffs);
-  free(arr);
+  diff_free(arr->diffs);
+  diff_free(arr);
 }
 
 // ============================================================================
@@ -238,7 +226,9 @@ void sequence_diff_array_free(SequenceDiffArray *arr) {
 // ============================================================================
 
 RangeMappingArray *range_mapping_array_create(void) {
-  RangeMappingArray *arr = (RangeMappingArray *)mem_alloc(sizeof(RangeMappingArray));
+  RangeMappingArray *arr = (RangeMappingArray *)diff_malloc(sizeof(RangeMappingArray));
+  if (!arr)
+    return NULL;
   arr->mappings = NULL;
   arr->count = 0;
   arr->capacity = 0;
@@ -248,8 +238,8 @@ RangeMappingArray *range_mapping_array_create(void) {
 void range_mapping_array_free(RangeMappingArray *arr) {
   if (!arr)
     return;
-  free(arr->mappings);
-  free(arr);
+  diff_free(arr->mappings);
+  diff_free(arr);
 }
 
 // ============================================================================
@@ -258,7 +248,9 @@ void range_mapping_array_free(RangeMappingArray *arr) {
 
 DetailedLineRangeMappingArray *detailed_line_range_mapping_array_create(void) {
   DetailedLineRangeMappingArray *arr =
-      (DetailedLineRangeMappingArray *)mem_alloc(sizeof(DetailedLineRangeMappingArray));
+      (DetailedLineRangeMappingArray *)diff_malloc(sizeof(DetailedLineRangeMappingArray));
+  if (!arr)
+    return NULL;
   arr->mappings = NULL;
   arr->count = 0;
   arr->capacity = 0;
@@ -269,8 +261,8 @@ void detailed_line_range_mapping_array_free(DetailedLineRangeMappingArray *arr)
   if (!arr)
     return;
   for (int i = 0; i < arr->count; i++) {
-    free(arr->mappings[i].inner_changes);
+    diff_free(arr->mappings[i].inner_changes);
   }
-  free(arr->mappings);
-  free(arr);
+  diff_free(arr->mappings);
+  diff_free(arr);
 }
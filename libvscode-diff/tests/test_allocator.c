@@ -0,0 +1,248 @@
+/**
+ * Test Suite for diff_set_allocator()
+ *
+ * Installs a counting allocator and checks that the library routes all of its
+ * memory through it: every allocation made while computing and freeing a diff
+ * (and its render plan) is released again through the same allocator, and
+ * that a failing allocation anywhere in the pipeline yields a NULL result
+ * without crashing or leaking.
+ */
+
+#include "allocator.h"
+#include "default_lines_diff_computer.h"
+#include "render_plan.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// Test Infrastructure
+// ============================================================================
+
+#define ASSERT(cond, msg)                                                                          \
+  do {                                                                                             \
+    if (!(cond)) {                                                                                 \
+      printf("  ✗ ASSERTION FAILED: %s\n", msg);                                                   \
+      return false;                                                                                \
+    }                                                                                              \
+  } while (0)
+
+/**
+ * Counting allocator: prefixes each block with its size so realloc/free can
+ * keep exact live-byte accounting. With fail_at >= 0, the malloc/realloc call
+ * with that index returns NULL.
+ */
+typedef struct {
+  long allocations;
+  long frees;
+  size_t live_bytes;
+  size_t peak_bytes;
+  long calls;
+  long fail_at;
+  bool failed;
+} AllocStats;
+
+static bool inject_failure(AllocStats *stats) {
+  if (stats->calls++ == stats->fail_at) {
+    stats->failed = true;
+    return true;
+  }
+  return false;
+}
+
+typedef union {
+  size_t size;
+  max_align_t align;
+} BlockHeader;
+
+static void track(AllocStats *stats, size_t added, size_t removed) {
+  stats->live_bytes += added;
+  stats->live_bytes -= removed;
+  if (stats->live_bytes > stats->peak_bytes) {
+    stats->peak_bytes = stats->live_bytes;
+  }
+}
+
+static void *counting_malloc(size_t size, void *user_data) {
+  AllocStats *stats = (AllocStats *)user_data;
+  if (inject_failure(stats)) {
+    return NULL;
+  }
+  BlockHeader *block = (BlockHeader *)malloc(sizeof(BlockHeader) + size);
+  if (!block) {
+    return NULL;
+  }
+  block->size = size;
+  stats->allocations++;
+  track(stats, size, 0);
+  return block + 1;
+}
+
+static void *counting_realloc(void *ptr, size_t size, void *user_data) {
+  if (!ptr) {
+    return counting_malloc(size, user_data);
+  }
+  AllocStats *stats = (AllocStats *)user_data;
+  if (inject_failure(stats)) {
+    return NULL;
+  }
+  BlockHeader *block = (BlockHeader *)ptr - 1;
+  size_t old_size = block->size;
+  BlockHeader *grown = (BlockHeader *)realloc(block, sizeof(BlockHeader) + size);
+  if (!grown) {
+    return NULL;
+  }
+  grown->size = size;
+  track(stats, size, old_size);
+  return grown + 1;
+}
+
+static void counting_free(void *ptr, void *user_data) {
+  AllocStats *stats = (AllocStats *)user_data;
+  BlockHeader *block = (BlockHeader *)ptr - 1;
+  stats->frees++;
+  track(stats, 0, block->size);
+  free(block);
+}
+
+static const DiffOptions default_options = {.ignore_trim_whitespace = false,
+                                            .max_computation_time_ms = 0,
+                                            .compute_moves = true,
+                                            .extend_to_subwords = false,
+                                            .max_threads = 1}; // Counters aren't atomic
+
+// ============================================================================
+// Test Cases
+// ============================================================================
+
+bool test_all_memory_routed_through_allocator() {
+  printf("Running test_all_memory_routed_through_allocator...\n");
+
+  const char *original[] = {"int main() {", "  int x = 1;", "  return x;", "}",
+                            "void moved() {", "  a();", "  b();", "  c();", "}"};
+  const char *modified[] = {"void moved() {", "  a();", "  b();", "  c();", "}",
+                            "int main() {", "  int y = 2;", "  return y;", "}"};
+
+  AllocStats stats = {.fail_at = -1};
+  DiffAllocator allocator = {counting_malloc, counting_realloc, counting_free, &stats};
+  diff_set_allocator(&allocator);
+
+  LinesDiff *diff = compute_diff(original, 9, modified, 9, &default_options);
+  RenderPlan *plan = diff ? compute_render_plan(diff, original, 9, modified, 9) : NULL;
+  long allocations_during_diff = stats.allocations;
+
+  free_render_plan(plan);
+  free_lines_diff(diff);
+  diff_set_allocator(NULL);
+
+  printf("  %ld allocations, peak %zu bytes\n", allocations_during_diff, stats.peak_bytes);
+  ASSERT(diff != NULL && plan != NULL, "Diff and render plan computed");
+  ASSERT(allocations_during_diff > 0, "Library allocated through the custom allocator");
+  ASSERT(stats.frees == stats.allocations, "Every allocation freed through the allocator");
+  ASSERT(stats.live_bytes == 0, "No bytes left live after freeing the results");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_reset_restores_default() {
+  printf("Running test_reset_restores_default...\n");
+
+  AllocStats stats = {.fail_at = -1};
+  DiffAllocator allocator = {counting_malloc, counting_realloc, counting_free, &stats};
+  diff_set_allocator(&allocator);
+  diff_set_allocator(NULL);
+
+  const char *original[] = {"a", "b"};
+  const char *modified[] = {"a", "c"};
+  LinesDiff *diff = compute_diff(original, 2, modified, 2, &default_options);
+  free_lines_diff(diff);
+
+  ASSERT(diff != NULL, "Diff computed with default allocator");
+  ASSERT(stats.allocations == 0, "Uninstalled allocator no longer used");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_allocation_failure_anywhere() {
+  printf("Running test_allocation_failure_anywhere...\n");
+
+  const char *original[] = {"int main() {", "  int x = 1;", "  return x;", "}",
+                            "void moved() {", "  a();", "  b();", "  c();", "}"};
+  const char *modified[] = {"void moved() {", "  a();", "  b();", "  c();", "}",
+                            "int main() {", "  int yy = 2; // changed",
+                            "  return yy;", "}", "", "extra()"};
+  DiffOptions options = default_options;
+  options.extend_to_subwords = true;
+
+  // Fail each allocation in turn until a run completes without hitting one
+  long failure_points = 0;
+  for (long fail_at = 0;; fail_at++) {
+    AllocStats stats = {.fail_at = fail_at};
+    DiffAllocator allocator = {counting_malloc, counting_realloc, counting_free, &stats};
+    diff_set_allocator(&allocator);
+
+    LinesDiff *diff = compute_diff(original, 9, modified, 11, &options);
+    RenderPlan *plan = diff ? compute_render_plan(diff, original, 9, modified, 11) : NULL;
+    bool complete = diff != NULL && plan != NULL;
+
+    free_render_plan(plan);
+    free_lines_diff(diff);
+    diff_set_allocator(NULL);
+
+    if (!stats.failed) {
+      ASSERT(complete, "Run without injected failure succeeds");
+      break;
+    }
+    failure_points++;
+    if (stats.live_bytes != 0) {
+      printf("  Allocation %ld: %zu bytes leaked\n", fail_at, stats.live_bytes);
+    }
+    ASSERT(stats.live_bytes == 0, "Failed run leaks nothing");
+  }
+
+  printf("  Survived %ld failure points\n", failure_points);
+  ASSERT(failure_points > 0, "Pipeline allocates");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+int main(void) {
+  printf("\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("  diff_set_allocator() Test Suite\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  int passed = 0;
+  int total = 0;
+
+#define RUN_TEST(test)                                                                             \
+  do {                                                                                             \
+    total++;                                                                                       \
+    if (test())                                                                                    \
+      passed++;                                                                                    \
+    printf("\n");                                                                                  \
+  } while (0)
+
+  RUN_TEST(test_all_memory_routed_through_allocator);
+  RUN_TEST(test_reset_restores_default);
+  RUN_TEST(test_allocation_failure_anywhere);
+
+  printf("═══════════════════════════════════════════════════════════\n");
+  if (passed == total) {
+    printf("  ✅ ALL TESTS PASSED (%d/%d)\n", passed, total);
+  } else {
+    printf("  ❌ SOME TESTS FAILED (%d/%d passed)\n", passed, total);
+  }
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  return (passed == total) ? 0 : 1;
+}
@@ -0,0 +1,177 @@
+/**
+ * Test Suite for binary content detection and the binary block diff
+ */
+
+#include "binary_content.h"
+#include "default_lines_diff_computer.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// Test Infrastructure
+// ============================================================================
+
+#define ASSERT(cond, msg)                                                                          \
+  do {                                                                                             \
+    if (!(cond)) {                                                                                 \
+      printf("  ✗ ASSERTION FAILED: %s\n", msg);                                                   \
+      return false;                                                                                \
+    }                                                                                              \
+  } while (0)
+
+/**
+ * Random bytes split into lines at 0x0A, with NULs as '\n' inside lines the
+ * way the CLI reads them.
+ */
+static char **make_binary_lines(int count, uint32_t seed) {
+  char **lines = (char **)malloc((size_t)count * sizeof(char *));
+  for (int i = 0; i < count; i++) {
+    lines[i] = (char *)malloc(65);
+    for (int j = 0; j < 64; j++) {
+      seed = seed * 1664525u + 1013904223u;
+      char c = (char)(seed >> 24);
+      lines[i][j] = c == '\0' ? '\n' : c;
+    }
+    lines[i][64] = '\0';
+  }
+  return lines;
+}
+
+static void free_binary_lines(char **lines, int count) {
+  for (int i = 0; i < count; i++) {
+    free(lines[i]);
+  }
+  free(lines);
+}
+
+// ============================================================================
+// Test Cases
+// ============================================================================
+
+bool test_binary_detection() {
+  printf("Running test_binary_detection...\n");
+
+  const char *ascii[] = {"int main(void) {", "\treturn 0;\r", "}"};
+  const char *utf8[] = {"// 日本語のコメント", "const s = \"héllo wörld\";", "\x1b[31mred\x1b[0m"};
+  // Latin-1: one invalid byte in a line of text
+  const char *latin1[] = {"caf\xe9 au lait, s'il vous pla\xeet, merci beaucoup"};
+  const char *with_nul[] = {"PK\x03\x04", "abc\ndef"};
+  const char *controls[] = {"\x01\x02\x03\x04\x05\x06\x07\x0e\x0f\x10"};
+
+  ASSERT(!diff_lines_look_binary(ascii, 3), "ASCII source is text");
+  ASSERT(!diff_lines_look_binary(utf8, 3), "UTF-8 with escapes is text");
+  ASSERT(!diff_lines_look_binary(latin1, 1), "A few invalid bytes are still text");
+  ASSERT(diff_lines_look_binary(with_nul, 2), "A NUL byte means binary");
+  ASSERT(diff_lines_look_binary(controls, 1), "Control characters mean binary");
+
+  char **random = make_binary_lines(4, 1);
+  bool random_binary = diff_lines_look_binary((const char **)random, 4);
+  free_binary_lines(random, 4);
+  ASSERT(random_binary, "Random bytes are binary");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_binary_diff_blocks() {
+  printf("Running test_binary_diff_blocks...\n");
+
+  const int count = 2000;
+  char **a = make_binary_lines(count, 2);
+  char **b = make_binary_lines(count, 2);
+  b[700][10] ^= 0x55;
+  b[1500][0] ^= 0x55;
+
+  DiffOptions options = {.max_computation_time_ms = 0, .compute_moves = true, .max_threads = 1};
+  LinesDiff *diff = compute_diff((const char **)a, count, (const char **)b, count, &options);
+  bool ok = diff && diff->is_binary;
+  int changes = diff ? diff->changes.count : -1;
+  bool localized = ok && changes == 2;
+  for (int i = 0; localized && i < changes; i++) {
+    const DetailedLineRangeMapping *m = &diff->changes.mappings[i];
+    // Each block is at most one chunk wide and has no character detail
+    localized = m->original.end_line - m->original.start_line <= 128 &&
+                m->inner_change_count == 0 && m->inner_changes == NULL;
+  }
+  bool covers = localized && diff->changes.mappings[0].original.start_line <= 701 &&
+                diff->changes.mappings[0].original.end_line > 701 &&
+                diff->changes.mappings[1].original.start_line <= 1501 &&
+                diff->changes.mappings[1].original.end_line > 1501;
+  bool no_moves = diff && diff->moves.count == 0;
+  printf("  %d changes\n", changes);
+  free_lines_diff(diff);
+
+  // Identical binary content: no changes, still reported as binary
+  LinesDiff *same = compute_diff((const char **)a, count, (const char **)a, count, &options);
+  bool same_ok = same && same->is_binary && same->changes.count == 0;
+  free_lines_diff(same);
+
+  free_binary_lines(a, count);
+  free_binary_lines(b, count);
+
+  ASSERT(ok, "Content should be reported as binary");
+  ASSERT(localized, "Each edit should be one small block without inner changes");
+  ASSERT(covers, "Blocks should cover the edited lines");
+  ASSERT(no_moves, "Binary content has no moves");
+  ASSERT(same_ok, "Identical binary content has no changes");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_text_not_binary() {
+  printf("Running test_text_not_binary...\n");
+
+  const char *a[] = {"line one", "line two", "line three"};
+  const char *b[] = {"line one", "line 2", "line three"};
+  DiffOptions options = {.max_computation_time_ms = 0, .max_threads = 1};
+  LinesDiff *diff = compute_diff(a, 3, b, 3, &options);
+  bool ok = diff && !diff->is_binary && diff->changes.count == 1 &&
+            diff->changes.mappings[0].inner_change_count > 0;
+  free_lines_diff(diff);
+
+  ASSERT(ok, "Text should get the normal diff");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+int main(void) {
+  printf("\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("  Binary Content Test Suite\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  int passed = 0;
+  int total = 0;
+
+#define RUN_TEST(test)                                                                             \
+  do {                                                                                             \
+    total++;                                                                                       \
+    if (test())                                                                                    \
+      passed++;                                                                                    \
+    printf("\n");                                                                                  \
+  } while (0)
+
+  RUN_TEST(test_binary_detection);
+  RUN_TEST(test_binary_diff_blocks);
+  RUN_TEST(test_text_not_binary);
+
+  printf("═══════════════════════════════════════════════════════════\n");
+  if (passed == total) {
+    printf("  ✅ ALL TESTS PASSED (%d/%d)\n", passed, total);
+  } else {
+    printf("  ❌ SOME TESTS FAILED (%d/%d passed)\n", passed, total);
+  }
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  return (passed == total) ? 0 : 1;
+}
@@ -518,6 +518,54 @@ TEST(delete_and_add) {
   free_range_mapping_array(result2);
 }
 
+/**
+ * Test 13: Common prefix/suffix stripping (CharLevelOptions.strip_affixes)
+ *
+ * Input:
+ *   Line A1: "    result = compute_total(orders, customers, discounts);"
+ *   Line A2: "    return result;"
+ *   Line B1: "    result = compute_total(orders, clients, discounts);"
+ *   Line B2: "    return result;"
+ *
+ * Expected: the engine only sees "ustomer" -> "lient", and the mapping is
+ * offset back to "customers" -> "clients" on line 1, same as without stripping
+ */
+TEST(strip_affixes) {
+  const char *lines_a[] = {"    result = compute_total(orders, customers, discounts);",
+                           "    return result;"};
+  const char *lines_b[] = {"    result = compute_total(orders, clients, discounts);",
+                           "    return result;"};
+
+  SequenceDiff line_diff = {0, 2, 0, 2};
+
+  CharLevelOptions opts = {.consider_whitespace_changes = true, .extend_to_subwords = false};
+  RangeMappingArray *expected =
+      refine_diff_char_level(&line_diff, lines_a, 2, lines_b, 2, &opts, NULL);
+  opts.strip_affixes = true;
+  RangeMappingArray *result =
+      refine_diff_char_level(&line_diff, lines_a, 2, lines_b, 2, &opts, NULL);
+
+  ASSERT(result != NULL && expected != NULL, "Result should not be NULL");
+  ASSERT_EQ(result->count, 1, "Should have one mapping");
+  ASSERT_EQ(expected->count, 1, "Should have one mapping without stripping");
+
+  RangeMapping *m = &result->mappings[0];
+  RangeMapping *e = &expected->mappings[0];
+  printf("  Char mapping: (%d,%d)-(%d,%d) → (%d,%d)-(%d,%d)\n", m->original.start_line,
+         m->original.start_col, m->original.end_line, m->original.end_col, m->modified.start_line,
+         m->modified.start_col, m->modified.end_line, m->modified.end_col);
+
+  // "customers" is at cols 36-45 (1-based), "clients" at 36-43
+  ASSERT_EQ(m->original.start_line, 1, "Original start line");
+  ASSERT_EQ(m->original.start_col, 36, "Original start col");
+  ASSERT_EQ(m->original.end_col, 45, "Original end col");
+  ASSERT_EQ(m->modified.end_col, 43, "Modified end col");
+  ASSERT(memcmp(m, e, sizeof(*m)) == 0, "Same mapping as without stripping");
+
+  free_range_mapping_array(result);
+  free_range_mapping_array(expected);
+}
+
 // =============================================================================
 // Main Test Runner
 // =============================================================================
@@ -537,6 +585,7 @@ int main(void) {
   RUN_TEST(real_code_function_rename);
   RUN_TEST(cross_line_range_mapping);
   RUN_TEST(delete_and_add);
+  RUN_TEST(strip_affixes);
 
   printf("\n");
   printf("=======================================================\n");
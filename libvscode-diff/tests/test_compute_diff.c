@@ -12,7 +12,9 @@
 
 #include "default_lines_diff_computer.h"
 #include "print_utils.h"
+#include "test_utils.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 // ============================================================================
@@ -179,6 +181,232 @@ bool test_ignore_whitespace() {
   return true;
 }
 
+// ============================================================================
+// Memory Budget (DiffOptions.max_memory_bytes)
+// ============================================================================
+
+static bool mappings_are_ordered(const LinesDiff *diff, int original_count, int modified_count) {
+  int prev_orig = 1, prev_mod = 1;
+  for (int i = 0; i < diff->changes.count; i++) {
+    const DetailedLineRangeMapping *m = &diff->changes.mappings[i];
+    if (m->original.start_line < prev_orig || m->modified.start_line < prev_mod)
+      return false;
+    if (m->original.end_line > original_count + 1 || m->modified.end_line > modified_count + 1)
+      return false;
+    prev_orig = m->original.end_line;
+    prev_mod = m->modified.end_line;
+  }
+  return true;
+}
+
+bool test_memory_budget_unlimited() {
+  printf("Running test_memory_budget_unlimited...\n");
+
+  const int n = 300;
+  char **original = make_lines(n, 3, "");
+  char **modified = make_lines(n, 3, " changed");
+
+  DiffOptions options = {.max_computation_time_ms = 0, .compute_moves = true};
+  LinesDiff *result =
+      compute_diff((const char **)original, n, (const char **)modified, n, &options);
+
+  ASSERT(result != NULL, "Result should not be NULL");
+  ASSERT_EQ(result->degradations, DIFF_DEGRADED_NONE, "No budget should never degrade");
+  ASSERT_EQ(result->changes.count, n / 3, "Every third line changed");
+
+  free_lines_diff(result);
+  free_made_lines(original, n);
+  free_made_lines(modified, n);
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_memory_budget_degrades_engines() {
+  printf("Running test_memory_budget_degrades_engines...\n");
+
+  const int n = 300;
+  char **original = make_lines(n, 3, "");
+  char **modified = make_lines(n, 3, " changed");
+
+  // Far below the 300x300 DP tables and the ND snake pool
+  DiffOptions options = {.max_computation_time_ms = 0, .max_memory_bytes = 4096};
+  LinesDiff *result =
+      compute_diff((const char **)original, n, (const char **)modified, n, &options);
+
+  ASSERT(result != NULL, "Result should not be NULL");
+  printf("  degradations = 0x%x\n", result->degradations);
+  ASSERT(result->degradations & DIFF_DEGRADED_DP_TO_ND, "Line DP should fall back to Myers ND");
+  ASSERT(result->degradations & DIFF_DEGRADED_LINEAR_SPACE,
+         "Myers ND should fall back to linear space");
+  ASSERT(!result->hit_timeout, "Degradation is not a timeout");
+  ASSERT_EQ(result->changes.count, n / 3, "Linear-space alignment is still minimal");
+  ASSERT(mappings_are_ordered(result, n, n), "Mappings must stay ordered and in range");
+
+  free_lines_diff(result);
+  free_made_lines(original, n);
+  free_made_lines(modified, n);
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_memory_budget_skips_moves() {
+  printf("Running test_memory_budget_skips_moves...\n");
+
+  // A five-line block moved from the top to the bottom
+  const char *original[] = {"alpha block one",   "alpha block two", "alpha block three",
+                            "alpha block four",  "alpha block five", "keep a",
+                            "keep b",            "keep c",           "keep d"};
+  const char *modified[] = {"keep a",           "keep b",           "keep c",
+                            "keep d",           "alpha block one",  "alpha block two",
+                            "alpha block three", "alpha block four", "alpha block five"};
+
+  DiffOptions options = {.max_computation_time_ms = 0, .compute_moves = true};
+  LinesDiff *unbounded = compute_diff(original, 9, modified, 9, &options);
+  ASSERT(unbounded != NULL, "Result should not be NULL");
+  ASSERT(unbounded->moves.count > 0, "Unbounded run should detect the move");
+  free_lines_diff(unbounded);
+
+  // Enough for the tiny alignment, not for two 256 KiB similarity histograms
+  options.max_memory_bytes = 256 * 1024;
+  LinesDiff *result = compute_diff(original, 9, modified, 9, &options);
+
+  ASSERT(result != NULL, "Result should not be NULL");
+  ASSERT(result->degradations & DIFF_DEGRADED_NO_MOVES, "Move detection should be skipped");
+  ASSERT_EQ(result->moves.count, 0, "No moves when move detection is skipped");
+  ASSERT(result->changes.count > 0, "Changes are still reported");
+
+  free_lines_diff(result);
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+// ============================================================================
+// One-Sided Lines (discarded before Myers O(ND))
+// ============================================================================
+
+bool test_one_sided_lines() {
+  printf("Running test_one_sided_lines...\n");
+
+  // Above the DP threshold: unique insertions and deletions, none adjacent
+  const int n = 2000;
+  char **original = make_lines(n, n, "");
+  char **modified = (char **)malloc((size_t)n * 2 * sizeof(char *));
+  int m = 0;
+  int inserted = 0;
+  int deleted = 0;
+  for (int i = 0; i < n; i++) {
+    if (i % 50 == 0) {
+      deleted++;
+    } else {
+      modified[m++] = original[i];
+    }
+    if (i % 40 == 25) {
+      modified[m] = (char *)malloc(32);
+      snprintf(modified[m++], 32, "inserted %d", i);
+      inserted++;
+    }
+  }
+
+  DiffOptions options = {.max_computation_time_ms = 0};
+  LinesDiff *result = compute_diff((const char **)original, n, (const char **)modified, m, &options);
+
+  ASSERT(result != NULL, "Result should not be NULL");
+  ASSERT_EQ(result->changes.count, inserted + deleted, "One hunk per inserted or deleted line");
+  for (int i = 0; i < result->changes.count; i++) {
+    const DetailedLineRangeMapping *c = &result->changes.mappings[i];
+    int original_lines = c->original.end_line - c->original.start_line;
+    int modified_lines = c->modified.end_line - c->modified.start_line;
+    ASSERT(original_lines + modified_lines == 1, "Each hunk is a single line");
+    if (original_lines == 1) {
+      ASSERT_EQ((c->original.start_line - 1) % 50, 0, "Deleted line");
+    } else {
+      ASSERT(strncmp(modified[c->modified.start_line - 1], "inserted", 8) == 0, "Inserted line");
+    }
+  }
+
+  free_lines_diff(result);
+  for (int i = 0; i < m; i++) {
+    if (strncmp(modified[i], "inserted", 8) == 0)
+      free(modified[i]);
+  }
+  free(modified);
+  free_made_lines(original, n);
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+// ============================================================================
+// Line-Level-Only Mode (refined later with refine_lines_diff())
+// ============================================================================
+
+static bool lines_diffs_equal(const LinesDiff *a, const LinesDiff *b) {
+  if (a->changes.count != b->changes.count || a->moves.count != b->moves.count)
+    return false;
+  for (int i = 0; i < a->changes.count; i++) {
+    const DetailedLineRangeMapping *x = &a->changes.mappings[i];
+    const DetailedLineRangeMapping *y = &b->changes.mappings[i];
+    if (memcmp(&x->original, &y->original, sizeof(LineRange)) != 0 ||
+        memcmp(&x->modified, &y->modified, sizeof(LineRange)) != 0 ||
+        x->inner_change_count != y->inner_change_count ||
+        memcmp(x->inner_changes, y->inner_changes,
+               (size_t)x->inner_change_count * sizeof(RangeMapping)) != 0)
+      return false;
+  }
+  return a->moves.count == 0 ||
+         memcmp(a->moves.moves, b->moves.moves, (size_t)a->moves.count * sizeof(MovedText)) == 0;
+}
+
+bool test_line_level_only() {
+  printf("Running test_line_level_only...\n");
+
+  // Word edits, a whitespace-only change, a deleted block moved further down
+  const int n = 300;
+  char **original = make_lines(n, 7, "");
+  char **modified = make_lines(n, 7, " edited");
+  snprintf(modified[100], 64, "    line 100 value 700");
+  for (int i = 0; i < 6; i++) {
+    snprintf(original[40 + i], 64, "moved block line %d of a longer text", i);
+    snprintf(modified[250 + i], 64, "moved block line %d of a longer text", i);
+  }
+
+  DiffOptions options = {.max_computation_time_ms = 0, .compute_moves = true, .max_threads = 1};
+  LinesDiff *full = compute_diff((const char **)original, n, (const char **)modified, n, &options);
+  options.line_level_only = true;
+  LinesDiff *lines = compute_diff((const char **)original, n, (const char **)modified, n, &options);
+
+  ASSERT(full != NULL && lines != NULL, "Results should not be NULL");
+  ASSERT(full->deferred_alignments == NULL, "A full diff keeps no alignments");
+  ASSERT(lines->deferred_alignments != NULL, "Line-level diff keeps its alignments");
+  ASSERT_EQ(lines->moves.count, 0, "No moves before refinement");
+  ASSERT(full->moves.count > 0, "The block should be detected as moved");
+  bool whole_lines = true;
+  for (int i = 0; i < lines->changes.count; i++) {
+    const RangeMapping *inner = lines->changes.mappings[i].inner_changes;
+    whole_lines = whole_lines && inner->original.start_col == 1 && inner->modified.start_col == 1;
+  }
+  ASSERT(whole_lines, "Inner changes cover whole lines");
+
+  LinesDiff *before = lines;
+  ASSERT(refine_lines_diff(lines, (const char **)original, n, (const char **)modified, n, &options),
+         "Refinement should succeed");
+  ASSERT(lines == before && lines->deferred_alignments == NULL, "Upgraded in place");
+  ASSERT(lines_diffs_equal(lines, full), "Upgraded result equals the full diff");
+  ASSERT(refine_lines_diff(lines, (const char **)original, n, (const char **)modified, n, &options),
+         "Refining twice is a no-op");
+
+  free_lines_diff(full);
+  free_lines_diff(lines);
+  free_made_lines(original, n);
+  free_made_lines(modified, n);
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
 // ============================================================================
 // Test Runner
 // ============================================================================
@@ -193,6 +421,7 @@ int main(void) {
   int passed = 0;
   int total = 0;
 
+#undef RUN_TEST // test_utils.h runs void tests; these return bool
 #define RUN_TEST(test)                                                                             \
   do {                                                                                             \
     total++;                                                                                       \
@@ -206,6 +435,11 @@ int main(void) {
   RUN_TEST(test_multiline_diff);
   RUN_TEST(test_whitespace_changes);
   RUN_TEST(test_ignore_whitespace);
+  RUN_TEST(test_memory_budget_unlimited);
+  RUN_TEST(test_memory_budget_degrades_engines);
+  RUN_TEST(test_memory_budget_skips_moves);
+  RUN_TEST(test_one_sided_lines);
+  RUN_TEST(test_line_level_only);
 
   printf("═══════════════════════════════════════════════════════════\n");
   if (passed == total) {
@@ -0,0 +1,200 @@
+/**
+ * Concurrency Stress Test for compute_diff()
+ *
+ * Runs many diffs at once from separate host threads, with different
+ * max_threads settings per call, and checks every result against a serial
+ * run of the same input. compute_diff() keeps no global mutable state, so
+ * concurrent callers must neither crash nor change each other's output.
+ *
+ * Also built as test_concurrent_diff_tsan under ThreadSanitizer when the
+ * compiler supports it (see CMakeLists.txt).
+ */
+
+#include "default_lines_diff_computer.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_INPUTS 6
+#define NUM_WORKERS 8
+#define ROUNDS_PER_WORKER 4
+#define LINES_PER_INPUT 400
+
+typedef struct {
+  char **original;
+  char **modified;
+  int original_count;
+  int modified_count;
+  LinesDiff *expected; // Serial result
+} TestInput;
+
+typedef struct {
+  int worker_id;
+  TestInput *inputs;
+  int failures;
+} WorkerArgs;
+
+/**
+ * Build an input with many separated change regions (so character refinement
+ * has work for several threads), a moved block and whitespace-only changes.
+ */
+static void make_input(TestInput *input, int seed) {
+  input->original = (char **)malloc(LINES_PER_INPUT * sizeof(char *));
+  input->modified = (char **)malloc((LINES_PER_INPUT + 8) * sizeof(char *));
+  input->original_count = LINES_PER_INPUT;
+  input->modified_count = 0;
+
+  char buf[128];
+  for (int i = 0; i < LINES_PER_INPUT; i++) {
+    snprintf(buf, sizeof(buf), "    value_%d = compute(%d, seed_%d);", i, i * 7, seed);
+    input->original[i] = strdup(buf);
+  }
+
+  for (int i = 0; i < LINES_PER_INPUT; i++) {
+    if ((i + seed) % 23 == 0) {
+      snprintf(buf, sizeof(buf), "    value_%d = recompute(%d, seed_%d) + %d;", i, i * 7, seed, i);
+    } else if ((i + seed) % 31 == 0) {
+      snprintf(buf, sizeof(buf), "  value_%d = compute(%d, seed_%d);  ", i, i * 7, seed);
+    } else if ((i + seed) % 37 == 0) {
+      continue; // Deleted line
+    } else {
+      snprintf(buf, sizeof(buf), "%s", input->original[i]);
+    }
+    input->modified[input->modified_count++] = strdup(buf);
+    if ((i + seed) % 53 == 0) {
+      snprintf(buf, sizeof(buf), "    inserted_%d();", i);
+      input->modified[input->modified_count++] = strdup(buf);
+    }
+  }
+}
+
+static void free_input(TestInput *input) {
+  for (int i = 0; i < input->original_count; i++) {
+    free(input->original[i]);
+  }
+  for (int i = 0; i < input->modified_count; i++) {
+    free(input->modified[i]);
+  }
+  free(input->original);
+  free(input->modified);
+  free_lines_diff(input->expected);
+}
+
+static bool char_range_equal(const CharRange *a, const CharRange *b) {
+  return a->start_line == b->start_line && a->start_col == b->start_col &&
+         a->end_line == b->end_line && a->end_col == b->end_col;
+}
+
+static bool line_range_equal(const LineRange *a, const LineRange *b) {
+  return a->start_line == b->start_line && a->end_line == b->end_line;
+}
+
+static bool lines_diff_equal(const LinesDiff *a, const LinesDiff *b) {
+  if (a->hit_timeout != b->hit_timeout || a->changes.count != b->changes.count ||
+      a->moves.count != b->moves.count) {
+    return false;
+  }
+  for (int i = 0; i < a->changes.count; i++) {
+    const DetailedLineRangeMapping *ma = &a->changes.mappings[i];
+    const DetailedLineRangeMapping *mb = &b->changes.mappings[i];
+    if (!line_range_equal(&ma->original, &mb->original) ||
+        !line_range_equal(&ma->modified, &mb->modified) ||
+        ma->inner_change_count != mb->inner_change_count) {
+      return false;
+    }
+    for (int j = 0; j < ma->inner_change_count; j++) {
+      if (!char_range_equal(&ma->inner_changes[j].original, &mb->inner_changes[j].original) ||
+          !char_range_equal(&ma->inner_changes[j].modified, &mb->inner_changes[j].modified)) {
+        return false;
+      }
+    }
+  }
+  for (int i = 0; i < a->moves.count; i++) {
+    if (!line_range_equal(&a->moves.moves[i].original, &b->moves.moves[i].original) ||
+        !line_range_equal(&a->moves.moves[i].modified, &b->moves.moves[i].modified)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static LinesDiff *run_diff(const TestInput *input, int max_threads) {
+  DiffOptions options = {.ignore_trim_whitespace = false,
+                         .max_computation_time_ms = 0,
+                         .compute_moves = true,
+                         .extend_to_subwords = false,
+                         .max_threads = max_threads};
+  return compute_diff((const char **)input->original, input->original_count,
+                      (const char **)input->modified, input->modified_count, &options);
+}
+
+static void *worker(void *arg) {
+  WorkerArgs *args = (WorkerArgs *)arg;
+  for (int round = 0; round < ROUNDS_PER_WORKER; round++) {
+    for (int i = 0; i < NUM_INPUTS; i++) {
+      // Every worker walks the inputs in a different order and thread count
+      int index = (i + args->worker_id) % NUM_INPUTS;
+      int max_threads = (args->worker_id + round) % 4; // 0 (default), 1 (serial), 2, 3
+      LinesDiff *diff = run_diff(&args->inputs[index], max_threads);
+      if (!diff || !lines_diff_equal(diff, args->inputs[index].expected)) {
+        args->failures++;
+      }
+      free_lines_diff(diff);
+    }
+  }
+  return NULL;
+}
+
+int main(void) {
+  printf("\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("  compute_diff() Concurrency Stress Test\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  TestInput inputs[NUM_INPUTS];
+  for (int i = 0; i < NUM_INPUTS; i++) {
+    make_input(&inputs[i], i);
+    inputs[i].expected = run_diff(&inputs[i], 1);
+    if (!inputs[i].expected || inputs[i].expected->changes.count == 0) {
+      printf("  ✗ Serial diff of input %d failed\n", i);
+      return 1;
+    }
+  }
+  printf("  Serial baselines computed for %d inputs\n", NUM_INPUTS);
+
+  pthread_t threads[NUM_WORKERS];
+  WorkerArgs args[NUM_WORKERS];
+  for (int i = 0; i < NUM_WORKERS; i++) {
+    args[i].worker_id = i;
+    args[i].inputs = inputs;
+    args[i].failures = 0;
+    if (pthread_create(&threads[i], NULL, worker, &args[i]) != 0) {
+      printf("  ✗ pthread_create failed\n");
+      return 1;
+    }
+  }
+
+  int failures = 0;
+  for (int i = 0; i < NUM_WORKERS; i++) {
+    pthread_join(threads[i], NULL);
+    failures += args[i].failures;
+  }
+
+  for (int i = 0; i < NUM_INPUTS; i++) {
+    free_input(&inputs[i]);
+  }
+
+  int total = NUM_WORKERS * ROUNDS_PER_WORKER * NUM_INPUTS;
+  printf("═══════════════════════════════════════════════════════════\n");
+  if (failures == 0) {
+    printf("  ✅ ALL %d CONCURRENT DIFFS MATCH SERIAL RESULTS\n", total);
+  } else {
+    printf("  ❌ %d/%d CONCURRENT DIFFS DIFFER FROM SERIAL RESULTS\n", failures, total);
+  }
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  return failures == 0 ? 0 : 1;
+}
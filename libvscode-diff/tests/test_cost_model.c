@@ -0,0 +1,182 @@
+/**
+ * Test Suite for diff_select_engine()
+ *
+ * Verifies the engine choice of the cost model (include/cost_model.h):
+ * - VSCode's size threshold always selects DP
+ * - Cheap or untimed regions run the exact O(ND) search
+ * - Regions whose lower-bound cost exceeds the timeout go to the capped search
+ */
+
+#include "cost_model.h"
+#include "sequence.h"
+#include "string_hash_map.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// Test Infrastructure
+// ============================================================================
+
+#define ASSERT(cond, msg)                                                                          \
+  do {                                                                                             \
+    if (!(cond)) {                                                                                 \
+      printf("  ✗ ASSERTION FAILED: %s\n", msg);                                                   \
+      return false;                                                                                \
+    }                                                                                              \
+  } while (0)
+
+#define ASSERT_EQ(a, b, msg)                                                                       \
+  do {                                                                                             \
+    if ((a) != (b)) {                                                                              \
+      printf("  ✗ ASSERTION FAILED: %s (expected %d, got %d)\n", msg, (int)(b), (int)(a));         \
+      return false;                                                                                \
+    }                                                                                              \
+  } while (0)
+
+typedef struct {
+  char **lines;
+  int count;
+} Lines;
+
+/**
+ * Build `count` lines "<prefix><i>", except that indices in [change_from,
+ * change_to) get the prefix "changed".
+ */
+static Lines make_lines(const char *prefix, int count, int change_from, int change_to) {
+  Lines result = {(char **)malloc((size_t)count * sizeof(char *)), count};
+  for (int i = 0; i < count; i++) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%s%d", (i >= change_from && i < change_to) ? "changed" : prefix,
+             i);
+    result.lines[i] = strdup(buf);
+  }
+  return result;
+}
+
+static void free_lines(Lines *lines) {
+  for (int i = 0; i < lines->count; i++) {
+    free(lines->lines[i]);
+  }
+  free(lines->lines);
+}
+
+static DiffEngine select_for(const Lines *a, const Lines *b, int dp_threshold, int timeout_ms,
+                             DiffCostEstimate *estimate) {
+  StringHashMap *map = string_hash_map_create();
+  ISequence *seq1 = line_sequence_create((const char **)a->lines, a->count, false, map);
+  ISequence *seq2 = line_sequence_create((const char **)b->lines, b->count, false, map);
+  DiffEngine engine = diff_select_engine(seq1, seq2, dp_threshold, timeout_ms, estimate);
+  seq1->destroy(seq1);
+  seq2->destroy(seq2);
+  string_hash_map_destroy(map);
+  return engine;
+}
+
+// ============================================================================
+// Test Cases
+// ============================================================================
+
+bool test_small_input_uses_dp() {
+  printf("Running test_small_input_uses_dp...\n");
+
+  Lines a = make_lines("a", 100, 0, 0);
+  Lines b = make_lines("b", 100, 0, 0);
+  DiffEngine engine = select_for(&a, &b, 1700, 1, NULL);
+  free_lines(&a);
+  free_lines(&b);
+
+  ASSERT_EQ(engine, DIFF_ENGINE_DP, "Below the VSCode threshold DP is always used");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_no_timeout_uses_exact_nd() {
+  printf("Running test_no_timeout_uses_exact_nd...\n");
+
+  Lines a = make_lines("a", 5000, 0, 0);
+  Lines b = make_lines("b", 5000, 0, 0);
+  DiffEngine engine = select_for(&a, &b, 1700, 0, NULL);
+  free_lines(&a);
+  free_lines(&b);
+
+  ASSERT_EQ(engine, DIFF_ENGINE_ND, "Without a timeout the search is never capped");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_similar_input_uses_exact_nd() {
+  printf("Running test_similar_input_uses_exact_nd...\n");
+
+  Lines a = make_lines("line", 5000, 0, 0);
+  Lines b = make_lines("line", 5000, 2000, 2010);
+  DiffCostEstimate estimate;
+  DiffEngine engine = select_for(&a, &b, 1700, 1, &estimate);
+  free_lines(&a);
+  free_lines(&b);
+
+  ASSERT_EQ(engine, DIFF_ENGINE_ND, "Few edits keep the exact search");
+  ASSERT(estimate.min_edit_distance <= 20, "Estimate must not exceed the true edit distance");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_disjoint_input_uses_capped() {
+  printf("Running test_disjoint_input_uses_capped...\n");
+
+  Lines a = make_lines("a", 5000, 0, 0);
+  Lines b = make_lines("b", 5000, 0, 0);
+  DiffCostEstimate estimate;
+  DiffEngine engine = select_for(&a, &b, 1700, 1, &estimate);
+  free_lines(&a);
+  free_lines(&b);
+
+  ASSERT_EQ(estimate.min_edit_distance, 10000, "No common lines: every line is an edit");
+  ASSERT(estimate.nd_min_ms > 0, "Lower-bound cost must be positive");
+  ASSERT_EQ(engine, DIFF_ENGINE_ND_CAPPED, "Hopeless exact search goes straight to capped");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+int main(void) {
+  printf("\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("  diff_select_engine() Test Suite\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  int passed = 0;
+  int total = 0;
+
+#define RUN_TEST(test)                                                                             \
+  do {                                                                                             \
+    total++;                                                                                       \
+    if (test())                                                                                    \
+      passed++;                                                                                    \
+    printf("\n");                                                                                  \
+  } while (0)
+
+  RUN_TEST(test_small_input_uses_dp);
+  RUN_TEST(test_no_timeout_uses_exact_nd);
+  RUN_TEST(test_similar_input_uses_exact_nd);
+  RUN_TEST(test_disjoint_input_uses_capped);
+
+  printf("═══════════════════════════════════════════════════════════\n");
+  if (passed == total) {
+    printf("  ✅ ALL TESTS PASSED (%d/%d)\n", passed, total);
+  } else {
+    printf("  ❌ SOME TESTS FAILED (%d/%d passed)\n", passed, total);
+  }
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  return (passed == total) ? 0 : 1;
+}
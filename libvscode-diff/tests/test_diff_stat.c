@@ -0,0 +1,198 @@
+/**
+ * Test Suite for diff_stat() and diff_stat_bounded()
+ */
+
+#include "diff_stat.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// Test Infrastructure
+// ============================================================================
+
+#define ASSERT(cond, msg)                                                                          \
+  do {                                                                                             \
+    if (!(cond)) {                                                                                 \
+      printf("  ✗ ASSERTION FAILED: %s\n", msg);                                                   \
+      return false;                                                                                \
+    }                                                                                              \
+  } while (0)
+
+static const char *ALPHABET[] = {"a", "b", "c", "d", "e", "f"};
+
+/**
+ * Random lines from a small alphabet, so that most lines repeat.
+ */
+static const char **make_lines(int count, uint32_t *seed) {
+  const char **lines = (const char **)malloc((size_t)(count + 1) * sizeof(char *));
+  for (int i = 0; i < count; i++) {
+    *seed = *seed * 1664525u + 1013904223u;
+    lines[i] = ALPHABET[(*seed >> 24) % 6];
+  }
+  return lines;
+}
+
+/**
+ * Reference edit distance: N + M - 2 * LCS by dynamic programming.
+ */
+static int reference_edit_distance(const char **a, int n, const char **b, int m) {
+  int *row = (int *)calloc((size_t)m + 1, sizeof(int));
+  for (int i = 1; i <= n; i++) {
+    int diag = 0;
+    for (int j = 1; j <= m; j++) {
+      int up = row[j];
+      row[j] = strcmp(a[i - 1], b[j - 1]) == 0 ? diag + 1 : (up > row[j - 1] ? up : row[j - 1]);
+      diag = up;
+    }
+  }
+  int lcs = row[m];
+  free(row);
+  return n + m - 2 * lcs;
+}
+
+// ============================================================================
+// Test Cases
+// ============================================================================
+
+bool test_stat_basic() {
+  printf("Running test_stat_basic...\n");
+
+  const char *a[] = {"one", "two", "three", "four", "five"};
+  const char *b[] = {"one", "2", "three", "four", "five", "six", "seven"};
+  DiffStat stat;
+  ASSERT(diff_stat(a, 5, b, 7, &stat), "diff_stat should succeed");
+  ASSERT(stat.insertions == 3 && stat.deletions == 1, "One changed line and two added lines");
+  ASSERT(stat.edit_distance == 4 && !stat.exceeded, "Edit distance is the sum");
+
+  ASSERT(diff_stat(a, 5, a, 5, &stat), "diff_stat should succeed");
+  ASSERT(stat.edit_distance == 0, "Identical input has no edits");
+
+  ASSERT(diff_stat(a, 0, b, 7, &stat), "diff_stat should succeed");
+  ASSERT(stat.insertions == 7 && stat.deletions == 0, "Empty original: all lines inserted");
+
+  ASSERT(diff_stat(a, 5, b, 0, &stat), "diff_stat should succeed");
+  ASSERT(stat.insertions == 0 && stat.deletions == 5, "Empty modified: all lines deleted");
+
+  // Whitespace is significant, as in git
+  const char *c[] = {"one", "  two", "three", "four", "five"};
+  ASSERT(diff_stat(a, 5, c, 5, &stat), "diff_stat should succeed");
+  ASSERT(stat.insertions == 1 && stat.deletions == 1, "Indentation change counts");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_stat_matches_reference() {
+  printf("Running test_stat_matches_reference...\n");
+
+  uint32_t seed = 7;
+  for (int round = 0; round < 200; round++) {
+    int n = (int)((seed >> 8) % 60);
+    const char **a = make_lines(n, &seed);
+    int m = (int)((seed >> 8) % 60);
+    const char **b = make_lines(m, &seed);
+    // Some lines only on one side
+    if (n > 3) {
+      a[n / 2] = "only in a";
+    }
+    if (m > 5) {
+      b[1] = "only in b";
+    }
+
+    DiffStat stat;
+    bool ok = diff_stat(a, n, b, m, &stat);
+    int expected = reference_edit_distance(a, n, b, m);
+    free(a);
+    free(b);
+    ASSERT(ok, "diff_stat should succeed");
+    ASSERT(stat.edit_distance == expected, "Edit distance should be minimal");
+    ASSERT(stat.insertions - stat.deletions == m - n, "Counts should account for the length change");
+  }
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_stat_bounded() {
+  printf("Running test_stat_bounded...\n");
+
+  uint32_t seed = 11;
+  const char **a = make_lines(2000, &seed);
+  const char **b = make_lines(2000, &seed);
+
+  DiffStat full;
+  DiffStat within;
+  DiffStat over;
+  bool ok = diff_stat(a, 2000, b, 2000, &full) &&
+            diff_stat_bounded(a, 2000, b, 2000, full.edit_distance, &within) &&
+            diff_stat_bounded(a, 2000, b, 2000, full.edit_distance - 1, &over);
+  printf("  Edit distance %d\n", full.edit_distance);
+
+  DiffStat none;
+  bool zero_ok = diff_stat_bounded(a, 2000, a, 2000, 0, &none);
+
+  // One-sided lines alone exceed the limit without running Myers
+  const char *c[] = {"x", "y", "z"};
+  const char *d[] = {"p", "q"};
+  DiffStat disjoint;
+  bool disjoint_ok = diff_stat_bounded(c, 3, d, 2, 4, &disjoint);
+
+  free(a);
+  free(b);
+
+  ASSERT(ok, "diff_stat should succeed");
+  ASSERT(!within.exceeded && within.edit_distance == full.edit_distance,
+         "A limit equal to the distance should give the full result");
+  ASSERT(within.insertions == full.insertions && within.deletions == full.deletions,
+         "Bounded counts should match");
+  ASSERT(over.exceeded && over.edit_distance == full.edit_distance,
+         "A smaller limit should report limit + 1");
+  ASSERT(over.insertions <= full.insertions && over.deletions <= full.deletions,
+         "Counts of an exceeded run are lower bounds");
+  ASSERT(zero_ok && !none.exceeded && none.edit_distance == 0, "Identical input fits limit 0");
+  ASSERT(disjoint_ok && disjoint.exceeded && disjoint.insertions == 2 && disjoint.deletions == 3,
+         "Disjoint lines should exceed with exact lower bounds");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+int main(void) {
+  printf("\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("  Diff Stat Test Suite\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  int passed = 0;
+  int total = 0;
+
+#define RUN_TEST(test)                                                                             \
+  do {                                                                                             \
+    total++;                                                                                       \
+    if (test())                                                                                    \
+      passed++;                                                                                    \
+    printf("\n");                                                                                  \
+  } while (0)
+
+  RUN_TEST(test_stat_basic);
+  RUN_TEST(test_stat_matches_reference);
+  RUN_TEST(test_stat_bounded);
+
+  printf("═══════════════════════════════════════════════════════════\n");
+  if (passed == total) {
+    printf("  ✅ ALL TESTS PASSED (%d/%d)\n", passed, total);
+  } else {
+    printf("  ❌ SOME TESTS FAILED (%d/%d passed)\n", passed, total);
+  }
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  return (passed == total) ? 0 : 1;
+}
@@ -146,6 +146,76 @@ void test_dp_with_equality_scoring() {
   printf("✓ PASSED\n");
 }
 
+// Constant score: forces the double-precision DP path with default weights
+static double unit_score(const ISequence *seq1, const ISequence *seq2, int offset1, int offset2,
+                         void *user_data) {
+  (void)seq1;
+  (void)seq2;
+  (void)offset1;
+  (void)offset2;
+  (void)user_data;
+  return 1.0;
+}
+
+void test_unscored_kernel_matches_scored_dp() {
+  printf("\n=== Test: Unscored DP Kernel Matches Scored DP ===\n");
+
+  // Small alphabet to produce many ambiguous alignments and diagonal runs
+  srand(42);
+  char buf_a[256];
+  char buf_b[256];
+  int cases = 0;
+
+  for (int iter = 0; iter < 300; iter++) {
+    int len_a = rand() % 200;
+    int len_b = rand() % 200;
+    for (int i = 0; i < len_a; i++)
+      buf_a[i] = "abc d"[rand() % 5];
+    buf_a[len_a] = '\0';
+    // Derive b from a with random edits so the sequences share long runs
+    int j = 0;
+    for (int i = 0; i < len_a && j < len_b; i++) {
+      int op = rand() % 10;
+      if (op == 0)
+        continue;
+      if (op == 1)
+        buf_b[j++] = "xyz"[rand() % 3];
+      if (j < len_b)
+        buf_b[j++] = buf_a[i];
+    }
+    while (j < len_b)
+      buf_b[j++] = "abxy"[rand() % 4];
+    buf_b[len_b] = '\0';
+
+    const char *lines_a[] = {buf_a};
+    const char *lines_b[] = {buf_b};
+    ISequence *seq_a = char_sequence_create(lines_a, 0, 1, false);
+    ISequence *seq_b = char_sequence_create(lines_b, 0, 1, false);
+
+    bool hit_timeout = false;
+    SequenceDiffArray *fast = myers_dp_diff_algorithm(seq_a, seq_b, 0, &hit_timeout, NULL, NULL);
+    SequenceDiffArray *ref =
+        myers_dp_diff_algorithm(seq_a, seq_b, 0, &hit_timeout, unit_score, NULL);
+
+    if (!diffs_equal(fast, ref)) {
+      // Fail explicitly: assert() is compiled out in Release builds
+      printf("  ✗ Mismatch for:\n    a=\"%s\"\n    b=\"%s\"\n", buf_a, buf_b);
+      exit(1);
+    }
+    cases++;
+
+    free(fast->diffs);
+    free(fast);
+    free(ref->diffs);
+    free(ref);
+    seq_a->destroy(seq_a);
+    seq_b->destroy(seq_b);
+  }
+
+  printf("✓ %d random char sequences produce identical diffs\n", cases);
+  printf("✓ PASSED\n");
+}
+
 void test_large_sequence_uses_myers() {
   printf("\n=== Test: Large Sequence Uses Myers O(ND) ===\n");
 
@@ -199,6 +269,7 @@ int main(void) {
   test_small_sequence_uses_dp();
   test_char_sequence_threshold();
   test_dp_with_equality_scoring();
+  test_unscored_kernel_matches_scored_dp();
   test_large_sequence_uses_myers();
 
   printf("\n=======================================================\n");
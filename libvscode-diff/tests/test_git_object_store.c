@@ -0,0 +1,329 @@
+/**
+ * Test Suite for the native git object store reader
+ *
+ * Builds a fixture repository with the git CLI and checks that
+ * git_store_read_blob() returns exactly what `git cat-file blob` does for
+ * every file of every commit - first from loose objects, then after an
+ * aggressive repack into a single deltified packfile.
+ */
+
+#include "git_object_store.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// Test Infrastructure
+// ============================================================================
+
+#define ASSERT(cond, msg)                                                                          \
+  do {                                                                                             \
+    if (!(cond)) {                                                                                 \
+      printf("  ✗ ASSERTION FAILED: %s\n", msg);                                                   \
+      return false;                                                                                \
+    }                                                                                              \
+  } while (0)
+
+static char g_repo[256];
+
+/**
+ * Run a shell command inside the fixture repository.
+ */
+static bool run_in_repo(const char *fmt, ...) {
+  char inner[1024], command[1400];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(inner, sizeof(inner), fmt, args);
+  va_end(args);
+  snprintf(command, sizeof(command), "cd '%s' && (%s) >/dev/null 2>&1", g_repo, inner);
+  return system(command) == 0;
+}
+
+/**
+ * Capture the stdout of a command run inside the fixture repository.
+ */
+static char *capture_in_repo(const char *inner, size_t *out_len) {
+  char command[1400];
+  snprintf(command, sizeof(command), "cd '%s' && %s 2>/dev/null", g_repo, inner);
+  FILE *pipe = popen(command, "r");
+  if (!pipe)
+    return NULL;
+  size_t cap = 4096, len = 0;
+  char *buf = (char *)malloc(cap);
+  size_t n;
+  while ((n = fread(buf + len, 1, cap - len, pipe)) > 0) {
+    len += n;
+    if (len == cap) {
+      cap *= 2;
+      buf = (char *)realloc(buf, cap);
+    }
+  }
+  pclose(pipe);
+  *out_len = len;
+  return buf;
+}
+
+/**
+ * Split captured output into NUL-terminated lines (in place).
+ */
+static int split_lines(char *text, size_t len, char **lines, int max_lines) {
+  int count = 0;
+  char *start = text;
+  for (size_t i = 0; i < len && count < max_lines; i++) {
+    if (text[i] == '\n') {
+      text[i] = '\0';
+      lines[count++] = start;
+      start = text + i + 1;
+    }
+  }
+  return count;
+}
+
+/**
+ * Compare the native read of every file in every commit against git itself.
+ * Returns the number of blobs checked, or -1 on the first mismatch.
+ */
+static int verify_all_blobs(GitObjectStore *store) {
+  size_t commits_len;
+  char *commits_text = capture_in_repo("git rev-list --all", &commits_len);
+  char *commits[64];
+  int commit_count = commits_text ? split_lines(commits_text, commits_len, commits, 64) : 0;
+  int checked = 0;
+
+  for (int c = 0; c < commit_count && checked >= 0; c++) {
+    char command[256];
+    snprintf(command, sizeof(command), "git ls-tree -r --name-only %s", commits[c]);
+    size_t files_len;
+    char *files_text = capture_in_repo(command, &files_len);
+    char *files[64];
+    int file_count = files_text ? split_lines(files_text, files_len, files, 64) : 0;
+
+    for (int f = 0; f < file_count && checked >= 0; f++) {
+      snprintf(command, sizeof(command), "git cat-file blob '%s:%s'", commits[c], files[f]);
+      size_t expected_len;
+      char *expected = capture_in_repo(command, &expected_len);
+
+      char *actual = NULL;
+      size_t actual_len = 0;
+      int status = git_store_read_blob(store, commits[c], files[f], &actual, &actual_len);
+      if (status != GIT_STORE_OK || actual_len != expected_len ||
+          memcmp(actual, expected, expected_len) != 0) {
+        printf("  mismatch: %s:%s (status %d, %zu vs %zu bytes)\n", commits[c], files[f], status,
+               actual_len, expected_len);
+        checked = -1;
+      } else {
+        checked++;
+      }
+      git_store_free_blob(actual);
+      free(expected);
+    }
+    free(files_text);
+  }
+  free(commits_text);
+  return checked;
+}
+
+// ============================================================================
+// Fixture
+// ============================================================================
+
+static bool create_fixture(void) {
+  snprintf(g_repo, sizeof(g_repo), "/tmp/vscode_diff_git_XXXXXX");
+  if (!mkdtemp(g_repo))
+    return false;
+
+  // Uncompressed loose objects exercise stored DEFLATE blocks; the later
+  // repack uses the default level (fixed and dynamic Huffman blocks)
+  bool ok = run_in_repo("git init -q . && git config user.name t && git config user.email t@t"
+                        " && git config core.looseCompression 0 && git config gc.auto 0");
+  ok = ok && run_in_repo("seq 1 3000 > big.txt && mkdir -p src/nested"
+                         " && printf 'hello\\r\\nworld\\r\\n' > crlf.txt"
+                         " && printf 'a\\000b\\000c' > binary.bin && : > empty.txt"
+                         " && echo top > src/nested/deep.c"
+                         " && git add -A && git commit -q -m one");
+  ok = ok && run_in_repo("git config core.looseCompression 9");
+  // Small edits to a large file so the repack stores deltas
+  for (int i = 2; ok && i <= 6; i++) {
+    ok = run_in_repo("sed -i.bak '%ds/.*/edit %d/' big.txt && rm big.txt.bak"
+                     " && echo v%d >> src/nested/deep.c && git add -A && git commit -q -m c%d",
+                     i * 400, i, i, i);
+  }
+  ok = ok && run_in_repo("git tag -a v1 -m tag HEAD~2");
+  return ok;
+}
+
+// ============================================================================
+// Test Cases
+// ============================================================================
+
+bool test_loose_objects() {
+  printf("Running test_loose_objects...\n");
+
+  GitObjectStore *store = git_store_open(g_repo);
+  ASSERT(store != NULL, "Store should open on a work tree root");
+  int checked = verify_all_blobs(store);
+  git_store_close(store);
+
+  printf("  %d blobs match git cat-file\n", checked);
+  ASSERT(checked > 20, "Every blob of every commit should match");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_packed_objects() {
+  printf("Running test_packed_objects...\n");
+
+  // Open before repacking: the store must notice the new pack on its own
+  GitObjectStore *store = git_store_open(g_repo);
+  ASSERT(store != NULL, "Store should open");
+
+  ASSERT(run_in_repo("git repack -adf -q --depth=50 && git prune-packed"),
+         "Fixture repack should succeed");
+  size_t loose_len;
+  char *loose = capture_in_repo("find .git/objects -path '*/pack' -prune -o -type f -print"
+                                " | grep -v info",
+                                &loose_len);
+  free(loose);
+  ASSERT(loose_len == 0, "All objects should be packed");
+  size_t deltas_len;
+  char *deltas = capture_in_repo("git verify-pack -v .git/objects/pack/*.idx"
+                                 " | awk 'NF == 7 && $2 == \"blob\"'",
+                                 &deltas_len);
+  free(deltas);
+  ASSERT(deltas_len > 0, "The pack should contain deltified blobs");
+
+  int checked = verify_all_blobs(store);
+  git_store_close(store);
+
+  printf("  %d blobs match git cat-file\n", checked);
+  ASSERT(checked > 20, "Every blob of every commit should match");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_revisions_and_paths() {
+  printf("Running test_revisions_and_paths...\n");
+
+  GitObjectStore *store = git_store_open(g_repo);
+  ASSERT(store != NULL, "Store should open");
+
+  size_t len;
+  char *tag = capture_in_repo("git rev-parse v1", &len);
+  ASSERT(tag && len > 40, "Fixture tag should resolve");
+  tag[40] = '\0';
+  char *head = capture_in_repo("git rev-parse HEAD", &len);
+  ASSERT(head && len > 40, "HEAD should resolve");
+  head[40] = '\0';
+
+  char *data = NULL;
+  size_t data_len = 0;
+  ASSERT(git_store_read_blob(store, tag, "src/nested/deep.c", &data, &data_len) == GIT_STORE_OK,
+         "Annotated tags should peel to their commit");
+  ASSERT(data_len == strlen("top\nv2\nv3\nv4\n") && memcmp(data, "top\nv2\nv3\nv4\n", data_len) == 0,
+         "Tag content should be the tagged commit's");
+  git_store_free_blob(data);
+
+  ASSERT(git_store_read_blob(store, head, "missing.txt", &data, &data_len) == GIT_STORE_NOT_FOUND,
+         "Missing file should be NOT_FOUND");
+  ASSERT(data == NULL, "No data for a missing file");
+  ASSERT(git_store_read_blob(store, head, "big.txt/child", &data, &data_len) ==
+             GIT_STORE_NOT_FOUND,
+         "A file used as a directory should be NOT_FOUND");
+  ASSERT(git_store_read_blob(store, head, "src", &data, &data_len) == GIT_STORE_ERROR,
+         "Directories are left to git show");
+  ASSERT(git_store_read_blob(store, "0123456789012345678901234567890123456789", "big.txt", &data,
+                             &data_len) == GIT_STORE_ERROR,
+         "Unknown revision should be an ERROR (caller falls back)");
+  ASSERT(git_store_read_blob(store, "HEAD", "big.txt", &data, &data_len) == GIT_STORE_ERROR,
+         "Symbolic revisions are not resolved natively");
+
+  free(tag);
+  free(head);
+  git_store_close(store);
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_linked_worktree() {
+  printf("Running test_linked_worktree...\n");
+
+  ASSERT(run_in_repo("git worktree add -q wt HEAD~1"), "Fixture worktree should be created");
+  char worktree[300];
+  snprintf(worktree, sizeof(worktree), "%s/wt", g_repo);
+
+  // wt/.git is a "gitdir:" file; objects come from the main repository
+  GitObjectStore *store = git_store_open(worktree);
+  ASSERT(store != NULL, "Store should open through a gitdir file");
+
+  size_t len;
+  char *head = capture_in_repo("git -C wt rev-parse HEAD", &len);
+  ASSERT(head && len > 40, "Worktree HEAD should resolve");
+  head[40] = '\0';
+
+  char *data = NULL;
+  size_t data_len = 0;
+  int status = git_store_read_blob(store, head, "crlf.txt", &data, &data_len);
+  bool matches = status == GIT_STORE_OK && data_len == 14 && memcmp(data, "hello\r\nworld\r\n", 14) == 0;
+  git_store_free_blob(data);
+  free(head);
+  git_store_close(store);
+  ASSERT(matches, "Blob bytes (including CR) should be returned unchanged");
+
+  ASSERT(git_store_open("/nonexistent/path") == NULL, "No store outside a repository");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+int main(void) {
+  printf("\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("  Git Object Store Test Suite\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  if (!create_fixture()) {
+    printf("  ❌ Could not create the fixture repository (is git installed?)\n");
+    return 1;
+  }
+
+  int passed = 0;
+  int total = 0;
+
+#define RUN_TEST(test)                                                                             \
+  do {                                                                                             \
+    total++;                                                                                       \
+    if (test())                                                                                    \
+      passed++;                                                                                    \
+    printf("\n");                                                                                  \
+  } while (0)
+
+  RUN_TEST(test_loose_objects);
+  RUN_TEST(test_packed_objects);
+  RUN_TEST(test_revisions_and_paths);
+  RUN_TEST(test_linked_worktree);
+
+  char cleanup[300];
+  snprintf(cleanup, sizeof(cleanup), "rm -rf '%s'", g_repo);
+  if (system(cleanup) != 0)
+    printf("  (could not remove %s)\n", g_repo);
+
+  printf("═══════════════════════════════════════════════════════════\n");
+  if (passed == total) {
+    printf("  ✅ ALL TESTS PASSED (%d/%d)\n", passed, total);
+  } else {
+    printf("  ❌ SOME TESTS FAILED (%d/%d passed)\n", passed, total);
+  }
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  return (passed == total) ? 0 : 1;
+}
@@ -0,0 +1,253 @@
+/**
+ * Test Suite for inputs beyond the 32-bit sequence range
+ *
+ * Checks that allocation sizes are overflow-checked, that a DP table which
+ * cannot be allocated falls back to the O(ND) engine, and that a multi-GB
+ * region degrades to its line-level change instead of overflowing the int
+ * CharSequence offsets. The multi-GB input is synthetic: every line points at
+ * the same 1 MiB string, so the test needs a few MiB of memory.
+ */
+
+#include "allocator.h"
+#include "default_lines_diff_computer.h"
+#include "myers.h"
+#include "sequence.h"
+#include "string_hash_map.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// Test Infrastructure
+// ============================================================================
+
+#define ASSERT(cond, msg)                                                                          \
+  do {                                                                                             \
+    if (!(cond)) {                                                                                 \
+      printf("  ✗ ASSERTION FAILED: %s\n", msg);                                                   \
+      return false;                                                                                \
+    }                                                                                              \
+  } while (0)
+
+/**
+ * Allocator that refuses single blocks over a size limit, like a process
+ * hitting its address-space limit on one large table.
+ */
+typedef struct {
+  size_t max_block;
+  long calls;
+  long refused;
+} CappedAllocator;
+
+static void *capped_malloc(size_t size, void *user_data) {
+  CappedAllocator *cap = (CappedAllocator *)user_data;
+  cap->calls++;
+  if (size > cap->max_block) {
+    cap->refused++;
+    return NULL;
+  }
+  return malloc(size);
+}
+
+static void *capped_realloc(void *ptr, size_t size, void *user_data) {
+  CappedAllocator *cap = (CappedAllocator *)user_data;
+  cap->calls++;
+  if (size > cap->max_block) {
+    cap->refused++;
+    return NULL;
+  }
+  return realloc(ptr, size);
+}
+
+static void capped_free(void *ptr, void *user_data) {
+  (void)user_data;
+  free(ptr);
+}
+
+static void install_capped_allocator(CappedAllocator *cap, size_t max_block) {
+  cap->max_block = max_block;
+  cap->calls = 0;
+  cap->refused = 0;
+  DiffAllocator allocator = {capped_malloc, capped_realloc, capped_free, cap};
+  diff_set_allocator(&allocator);
+}
+
+static bool same_diff_arrays(const SequenceDiffArray *x, const SequenceDiffArray *y) {
+  if (x->count != y->count)
+    return false;
+  return x->count == 0 || memcmp(x->diffs, y->diffs, (size_t)x->count * sizeof(SequenceDiff)) == 0;
+}
+
+static void free_sequence_diffs(SequenceDiffArray *diffs) {
+  diff_free(diffs->diffs);
+  diff_free(diffs);
+}
+
+// ============================================================================
+// Test Cases
+// ============================================================================
+
+bool test_array_allocation_overflow() {
+  printf("Running test_array_allocation_overflow...\n");
+
+  CappedAllocator cap;
+  install_capped_allocator(&cap, SIZE_MAX);
+
+  ASSERT(diff_malloc_array(SIZE_MAX / 2 + 1, 2) == NULL, "count * size overflow should fail");
+  ASSERT(diff_calloc(SIZE_MAX / 4 + 1, 4) == NULL, "calloc overflow should fail");
+  ASSERT(cap.calls == 0, "An overflowing size should never reach the allocator");
+
+  uint32_t *block = (uint32_t *)diff_malloc_array(16, sizeof(uint32_t));
+  ASSERT(block != NULL, "A small array should allocate");
+  block[15] = 42;
+  ASSERT(diff_realloc_array(block, SIZE_MAX / 2, sizeof(uint32_t)) == NULL,
+         "realloc overflow should fail");
+  ASSERT(block[15] == 42, "A failed realloc should keep the block");
+  block = (uint32_t *)diff_realloc_array(block, 32, sizeof(uint32_t));
+  ASSERT(block != NULL && block[15] == 42, "A valid realloc should keep the contents");
+  diff_free(block);
+
+  diff_set_allocator(NULL);
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_dp_out_of_memory_falls_back() {
+  printf("Running test_dp_out_of_memory_falls_back...\n");
+
+  // 1200 x 1200 DP needs a 1.4 MB direction table
+  const int count = 1200;
+  char **lines_a = (char **)malloc((size_t)count * sizeof(char *));
+  char **lines_b = (char **)malloc((size_t)count * sizeof(char *));
+  for (int i = 0; i < count; i++) {
+    lines_a[i] = (char *)malloc(32);
+    lines_b[i] = (char *)malloc(32);
+    snprintf(lines_a[i], 32, "line %d", i);
+    snprintf(lines_b[i], 32, "line %d", i % 13 == 0 ? -i : i);
+  }
+
+  StringHashMap *map = string_hash_map_create();
+  ISequence *seq1 = line_sequence_create((const char **)lines_a, count, false, map);
+  ISequence *seq2 = line_sequence_create((const char **)lines_b, count, false, map);
+  bool hit_timeout = false;
+  SequenceDiffArray *expected = myers_nd_diff_algorithm(seq1, seq2, 0, &hit_timeout);
+
+  CappedAllocator cap;
+  install_capped_allocator(&cap, 1 << 20);
+  SequenceDiffArray *dp = myers_dp_diff_algorithm(seq1, seq2, 0, &hit_timeout, NULL, NULL);
+  long refused = cap.refused;
+  diff_set_allocator(NULL);
+
+  printf("  %d diffs, %ld allocations refused\n", dp ? dp->count : -1, refused);
+  bool ok = dp && expected && same_diff_arrays(dp, expected);
+  if (dp)
+    free_sequence_diffs(dp);
+  free_sequence_diffs(expected);
+  seq1->destroy(seq1);
+  seq2->destroy(seq2);
+  string_hash_map_destroy(map);
+  for (int i = 0; i < count; i++) {
+    free(lines_a[i]);
+    free(lines_b[i]);
+  }
+  free(lines_a);
+  free(lines_b);
+
+  ASSERT(refused > 0, "The DP table should not fit under the cap");
+  ASSERT(ok, "Out of memory should fall back to the O(ND) result");
+  ASSERT(!hit_timeout, "Out of memory is not a timeout");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_multi_gb_region_degrades() {
+  printf("Running test_multi_gb_region_degrades...\n");
+
+  // 2 x 1100 lines of 1 MiB: 2.3G characters in one region, over the int
+  // range of a CharSequence pair
+  const size_t line_bytes = (size_t)1 << 20;
+  const int count = 1100;
+  char *text_a = (char *)malloc(line_bytes + 1);
+  char *text_b = (char *)malloc(line_bytes + 1);
+  memset(text_a, 'a', line_bytes);
+  memset(text_b, 'b', line_bytes);
+  text_a[line_bytes] = '\0';
+  text_b[line_bytes] = '\0';
+  const char **lines_a = (const char **)malloc((size_t)count * sizeof(char *));
+  const char **lines_b = (const char **)malloc((size_t)count * sizeof(char *));
+  for (int i = 0; i < count; i++) {
+    lines_a[i] = text_a;
+    lines_b[i] = text_b;
+  }
+
+  DiffOptions options = {.max_computation_time_ms = 0, .compute_moves = false, .max_threads = 1};
+  LinesDiff *diff = compute_diff(lines_a, count, lines_b, count, &options);
+
+  bool ok = diff && diff->changes.count == 1;
+  const DetailedLineRangeMapping *m = ok ? &diff->changes.mappings[0] : NULL;
+  if (m) {
+    printf("  lines [%d,%d) -> [%d,%d), %d inner changes, degradations 0x%x\n",
+           m->original.start_line, m->original.end_line, m->modified.start_line,
+           m->modified.end_line, m->inner_change_count, diff->degradations);
+  }
+  bool whole = m && m->original.start_line == 1 && m->original.end_line == count + 1 &&
+               m->modified.start_line == 1 && m->modified.end_line == count + 1;
+  bool line_level = m && m->inner_change_count == 1 &&
+                    m->inner_changes[0].original.start_line == 1 &&
+                    m->inner_changes[0].original.start_col == 1 &&
+                    m->inner_changes[0].original.end_line == count;
+  bool flagged = diff && (diff->degradations & DIFF_DEGRADED_LINE_LEVEL_ONLY);
+  free_lines_diff(diff);
+  free(lines_a);
+  free(lines_b);
+  free(text_a);
+  free(text_b);
+
+  ASSERT(ok && whole, "The region should be one change covering both files");
+  ASSERT(line_level, "The region should keep its line-level change");
+  ASSERT(flagged, "Skipped refinement should be reported");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+int main(void) {
+  printf("\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("  Large Input Test Suite\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  int passed = 0;
+  int total = 0;
+
+#define RUN_TEST(test)                                                                             \
+  do {                                                                                             \
+    total++;                                                                                       \
+    if (test())                                                                                    \
+      passed++;                                                                                    \
+    printf("\n");                                                                                  \
+  } while (0)
+
+  RUN_TEST(test_array_allocation_overflow);
+  RUN_TEST(test_dp_out_of_memory_falls_back);
+  RUN_TEST(test_multi_gb_region_degrades);
+
+  printf("═══════════════════════════════════════════════════════════\n");
+  if (passed == total) {
+    printf("  ✅ ALL TESTS PASSED (%d/%d)\n", passed, total);
+  } else {
+    printf("  ❌ SOME TESTS FAILED (%d/%d passed)\n", passed, total);
+  }
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  return (passed == total) ? 0 : 1;
+}
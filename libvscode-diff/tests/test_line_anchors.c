@@ -0,0 +1,203 @@
+/**
+ * Test Suite for the chunk anchor pre-stage (line_anchors.h)
+ *
+ * Near-identical inputs must give the same line alignment as the plain
+ * pipeline, line IDs must still expose whitespace-only changes, and inputs
+ * without anchors must fall back to compute_line_alignments() unchanged.
+ */
+
+#include "default_lines_diff_computer.h"
+#include "line_anchors.h"
+#include "line_level.h"
+#include "utils.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// Test Infrastructure
+// ============================================================================
+
+#define ASSERT(cond, msg)                                                                          \
+  do {                                                                                             \
+    if (!(cond)) {                                                                                 \
+      printf("  ✗ ASSERTION FAILED: %s\n", msg);                                                   \
+      return false;                                                                                \
+    }                                                                                              \
+  } while (0)
+
+typedef struct {
+  char **lines;
+  int count;
+} TestLines;
+
+/**
+ * Dump-like lines, unique per (seed, index).
+ */
+static TestLines make_dump(int count, uint32_t seed) {
+  TestLines t = {(char **)malloc((size_t)count * sizeof(char *)), count};
+  for (int i = 0; i < count; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    t.lines[i] = (char *)malloc(64);
+    snprintf(t.lines[i], 64, "INSERT INTO t VALUES (%d, 'row%u');", i, seed >> 8);
+  }
+  return t;
+}
+
+static TestLines copy_lines(const TestLines *src) {
+  TestLines t = {(char **)malloc((size_t)src->count * sizeof(char *)), src->count};
+  for (int i = 0; i < src->count; i++) {
+    t.lines[i] = strdup(src->lines[i]);
+  }
+  return t;
+}
+
+static void replace_line(TestLines *t, int index, const char *text) {
+  free(t->lines[index]);
+  t->lines[index] = strdup(text);
+}
+
+static void free_test_lines(TestLines *t) {
+  for (int i = 0; i < t->count; i++) {
+    free(t->lines[i]);
+  }
+  free(t->lines);
+}
+
+static bool same_alignments(const TestLines *a, const TestLines *b) {
+  bool timeout_plain = false;
+  bool timeout_anchored = false;
+  SequenceDiffArray *plain =
+      compute_line_alignments((const char **)a->lines, a->count, (const char **)b->lines,
+                              b->count, 0, &timeout_plain, NULL, 0, NULL);
+  SequenceDiffArray *anchored =
+      compute_anchored_line_alignments((const char **)a->lines, a->count, (const char **)b->lines,
+                                       b->count, 0, &timeout_anchored, NULL, 0, NULL);
+  bool same = plain && anchored && plain->count == anchored->count &&
+              memcmp(plain->diffs, anchored->diffs, (size_t)plain->count * sizeof(SequenceDiff)) ==
+                  0;
+  if (plain && anchored) {
+    printf("  %d line diffs plain, %d anchored\n", plain->count, anchored->count);
+  }
+  sequence_diff_array_free(plain);
+  sequence_diff_array_free(anchored);
+  return same;
+}
+
+// ============================================================================
+// Test Cases
+// ============================================================================
+
+bool test_anchors_match_plain_alignment() {
+  printf("Running test_anchors_match_plain_alignment...\n");
+
+  TestLines a = make_dump(20000, 1);
+  TestLines b = copy_lines(&a);
+  replace_line(&b, 100, "UPDATE t SET x = 1;");
+  replace_line(&b, 7000, "DELETE FROM t WHERE id = 7000;");
+  replace_line(&b, 7001, "DELETE FROM t WHERE id = 7001;");
+  replace_line(&b, 19999, "COMMIT;");
+
+  bool same = same_alignments(&a, &b);
+  free_test_lines(&a);
+  free_test_lines(&b);
+
+  ASSERT(same, "Anchored alignment should match the plain alignment");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_anchors_keep_whitespace_changes() {
+  printf("Running test_anchors_keep_whitespace_changes...\n");
+
+  TestLines a = make_dump(20000, 2);
+  TestLines b = copy_lines(&a);
+  char indented[80];
+  snprintf(indented, sizeof(indented), "  %s", a.lines[12345]);
+  replace_line(&b, 12345, indented);
+  replace_line(&b, 500, "-- changed");
+
+  DiffOptions options = {.max_computation_time_ms = 0, .max_threads = 1, .chunk_anchors = true};
+  LinesDiff *diff = compute_diff((const char **)a.lines, a.count, (const char **)b.lines, b.count,
+                                 &options);
+  bool ok = diff && diff->changes.count == 2;
+  bool whitespace_found = ok && diff->changes.mappings[1].original.start_line == 12346 &&
+                          diff->changes.mappings[1].modified.start_line == 12346;
+  if (diff) {
+    printf("  %d changes\n", diff->changes.count);
+  }
+  free_lines_diff(diff);
+  free_test_lines(&a);
+  free_test_lines(&b);
+
+  ASSERT(ok, "Two changes expected");
+  ASSERT(whitespace_found, "The indentation-only change should be reported");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_anchors_fall_back_without_matches() {
+  printf("Running test_anchors_fall_back_without_matches...\n");
+
+  // Nothing in common: no anchors, so the plain alignment is used
+  TestLines a = make_dump(6000, 3);
+  TestLines b = make_dump(6000, 4);
+  bool same_unrelated = same_alignments(&a, &b);
+  free_test_lines(&a);
+  free_test_lines(&b);
+
+  // Below LINE_ANCHORS_MIN_LINES the pre-stage is skipped
+  TestLines c = make_dump(1000, 5);
+  TestLines d = copy_lines(&c);
+  replace_line(&d, 10, "changed");
+  bool same_small = same_alignments(&c, &d);
+  free_test_lines(&c);
+  free_test_lines(&d);
+
+  ASSERT(same_unrelated, "Unrelated files should get the plain alignment");
+  ASSERT(same_small, "Small files should get the plain alignment");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+int main(void) {
+  printf("\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("  Chunk Anchor Test Suite\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  int passed = 0;
+  int total = 0;
+
+#define RUN_TEST(test)                                                                             \
+  do {                                                                                             \
+    total++;                                                                                       \
+    if (test())                                                                                    \
+      passed++;                                                                                    \
+    printf("\n");                                                                                  \
+  } while (0)
+
+  RUN_TEST(test_anchors_match_plain_alignment);
+  RUN_TEST(test_anchors_keep_whitespace_changes);
+  RUN_TEST(test_anchors_fall_back_without_matches);
+
+  printf("═══════════════════════════════════════════════════════════\n");
+  if (passed == total) {
+    printf("  ✅ ALL TESTS PASSED (%d/%d)\n", passed, total);
+  } else {
+    printf("  ❌ SOME TESTS FAILED (%d/%d passed)\n", passed, total);
+  }
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  return (passed == total) ? 0 : 1;
+}
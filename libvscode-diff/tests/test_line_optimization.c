@@ -755,6 +755,57 @@ TEST(line_opt_delete_and_add) {
   free_diff_array(expected_final);
 }
 
+// ============================================================================
+// TEST 12: Join Found in a Later Pass
+// ============================================================================
+
+TEST(line_opt_join_in_later_pass) {
+  printf("=== Test 12: Join Found in a Later Pass ===\n");
+
+  // 1. SETUP
+  // Gap "x" sits between two small diffs and is only joined once the diff
+  // after it has absorbed the large block behind "}" (second pass).
+  const char *lines_a[] = {"a0", "x", "a2", "}", "a4", "a5", "a6",
+                           "a7", "a8", "a9", "this gap has plenty of text", "a11"};
+  const char *lines_b[] = {"b0", "x", "b2", "}", "b4", "b5", "b6",
+                           "b7", "b8", "b9", "this gap has plenty of text", "b11"};
+
+  StringHashMap *hash_map = string_hash_map_create();
+  ISequence *seq1 = line_sequence_create(lines_a, 12, false, hash_map);
+  ISequence *seq2 = line_sequence_create(lines_b, 12, false, hash_map);
+
+  // 2-3. STEPS 1+2 (given directly)
+  SequenceDiffArray *step2 = create_diff_array(10);
+  add_diff(step2, 0, 1, 0, 1);
+  add_diff(step2, 2, 3, 2, 3);
+  add_diff(step2, 4, 10, 4, 10);
+  add_diff(step2, 11, 12, 11, 12);
+
+  // 4. AFTER STEP 3 (removeVeryShort)
+  // Pass 1 joins "}" (after diff has 12 lines), pass 2 joins "x"; the long
+  // gap keeps the last diff separate.
+  SequenceDiffArray *expected_final = create_diff_array(10);
+  add_diff(expected_final, 0, 10, 0, 10);
+  add_diff(expected_final, 11, 12, 11, 12);
+
+  SequenceDiffArray *actual_final = copy_diff_array(step2);
+  remove_very_short_matching_lines_between_diffs(seq1, seq2, actual_final);
+  print_sequence_diff_array("After Step 3 (removeVeryShort)", actual_final);
+  printf("  Step 3 (removeVeryShort): ");
+  assert_diffs_equal(actual_final, expected_final);
+  printf("verified\n");
+
+  printf("  ✓ Line optimization pipeline complete\n");
+
+  // 5. CLEANUP
+  seq1->destroy(seq1);
+  seq2->destroy(seq2);
+  string_hash_map_destroy(hash_map);
+  free_diff_array(step2);
+  free_diff_array(actual_final);
+  free_diff_array(expected_final);
+}
+
 // ============================================================================
 // Main Test Runner
 // ============================================================================
@@ -777,6 +828,7 @@ int main(void) {
   RUN_TEST(line_opt_mixed_changes);
   RUN_TEST(line_opt_multiline_string);
   RUN_TEST(line_opt_delete_and_add);
+  RUN_TEST(line_opt_join_in_later_pass);
 
   printf("\n");
   printf("=======================================================\n");
@@ -0,0 +1,215 @@
+/**
+ * Test Suite for long-line mode (content-defined chunking)
+ *
+ * Minified single-line files: point edits must keep exact inner changes, a
+ * moved block must finish without a timeout, and ordinary source files must
+ * not enter the mode at all.
+ */
+
+#include "default_lines_diff_computer.h"
+#include "long_line.h"
+#include "sequence.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// Test Infrastructure
+// ============================================================================
+
+#define ASSERT(cond, msg)                                                                          \
+  do {                                                                                             \
+    if (!(cond)) {                                                                                 \
+      printf("  ✗ ASSERTION FAILED: %s\n", msg);                                                   \
+      return false;                                                                                \
+    }                                                                                              \
+  } while (0)
+
+/**
+ * Minified-JSON-like text of the given length, deterministic per seed.
+ * Never contains '@' or '#', so edits using them are unambiguous.
+ */
+static char *make_minified(int length, uint32_t seed) {
+  static const char *const keys[] = {"id", "name", "value", "items", "type", "enabled"};
+  char *text = (char *)malloc((size_t)length + 1);
+  int pos = 0;
+  while (pos < length) {
+    seed = seed * 1664525u + 1013904223u;
+    char token[64];
+    int n = snprintf(token, sizeof(token), "\"%s\":%u,", keys[(seed >> 8) % 6], seed >> 16);
+    for (int i = 0; i < n && pos < length; i++) {
+      text[pos++] = token[i];
+    }
+  }
+  text[length] = '\0';
+  return text;
+}
+
+static LinesDiff *diff_single_lines(const char *a, const char *b, int timeout_ms) {
+  const char *lines_a[] = {a};
+  const char *lines_b[] = {b};
+  DiffOptions options = {.max_computation_time_ms = timeout_ms, .max_threads = 1};
+  return compute_diff(lines_a, 1, lines_b, 1, &options);
+}
+
+// ============================================================================
+// Test Cases
+// ============================================================================
+
+bool test_long_line_point_edits() {
+  printf("Running test_long_line_point_edits...\n");
+
+  const int length = 200000;
+  const int edits = 50;
+  char *a = make_minified(length, 1);
+  char *b = strdup(a);
+  for (int i = 0; i < edits; i++) {
+    b[1000 + i * 3900] = '@';
+  }
+
+  LinesDiff *diff = diff_single_lines(a, b, 5000);
+  bool ok = diff && diff->changes.count == 1 && !diff->hit_timeout;
+  const DetailedLineRangeMapping *m = ok ? &diff->changes.mappings[0] : NULL;
+  bool exact = m && m->inner_change_count == edits;
+  for (int i = 0; exact && i < edits; i++) {
+    const RangeMapping *inner = &m->inner_changes[i];
+    int col = 1000 + i * 3900 + 1;
+    exact = inner->original.start_col <= col && inner->original.end_col > col &&
+            inner->original.end_col - inner->original.start_col < 16;
+  }
+  if (m) {
+    printf("  %d inner changes\n", m->inner_change_count);
+  }
+  free_lines_diff(diff);
+  free(a);
+  free(b);
+
+  ASSERT(ok, "One change without a timeout expected");
+  ASSERT(exact, "Every point edit should get its own short inner change");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_long_line_moved_block() {
+  printf("Running test_long_line_moved_block...\n");
+
+  // Move 20000 characters from the start to the end of a 300000-char line
+  const int length = 300000;
+  const int block = 20000;
+  char *a = make_minified(length, 2);
+  char *b = (char *)malloc((size_t)length + 1);
+  memcpy(b, a + block, (size_t)(length - block));
+  memcpy(b + length - block, a, (size_t)block);
+  b[length] = '\0';
+
+  LinesDiff *diff = diff_single_lines(a, b, 5000);
+  bool ok = diff && diff->changes.count == 1;
+  const DetailedLineRangeMapping *m = ok ? &diff->changes.mappings[0] : NULL;
+  if (m) {
+    printf("  %d inner changes, hit_timeout=%d\n", m->inner_change_count, diff->hit_timeout);
+  }
+  bool timed_out = diff && diff->hit_timeout;
+  // A deletion at the start and an insertion at the end, give or take a chunk
+  bool coarse = m && m->inner_change_count == 2 &&
+                m->inner_changes[0].original.end_col - m->inner_changes[0].original.start_col >=
+                    block &&
+                m->inner_changes[1].modified.end_col - m->inner_changes[1].modified.start_col >=
+                    block;
+  free_lines_diff(diff);
+  free(a);
+  free(b);
+
+  ASSERT(ok, "One change expected");
+  ASSERT(!timed_out, "A moved block should not time out");
+  ASSERT(coarse, "The block should show as one deletion and one insertion");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_long_line_mode_thresholds() {
+  printf("Running test_long_line_mode_thresholds...\n");
+
+  // 2000 lines of 40 characters: large, but ordinary source
+  const int count = 2000;
+  char *line = make_minified(40, 3);
+  const char **lines = (const char **)malloc((size_t)count * sizeof(char *));
+  for (int i = 0; i < count; i++) {
+    lines[i] = line;
+  }
+  ISequence *seqs[6];
+  seqs[0] = char_sequence_create(lines, 0, count, false);
+  seqs[1] = char_sequence_create(lines, 0, count, false);
+
+  // One line of 100000 characters: minified
+  char *text = make_minified(100000, 4);
+  const char *one[] = {text};
+  seqs[2] = char_sequence_create(one, 0, 1, false);
+  seqs[3] = char_sequence_create(one, 0, 1, false);
+
+  // One line of 1000 characters: long, but small enough for the plain engines
+  char *small = make_minified(1000, 5);
+  const char *one_small[] = {small};
+  seqs[4] = char_sequence_create(one_small, 0, 1, false);
+  seqs[5] = char_sequence_create(one_small, 0, 1, false);
+
+  bool applies[3];
+  for (int i = 0; i < 3; i++) {
+    applies[i] = long_line_mode_applies((const CharSequence *)seqs[2 * i]->data,
+                                        (const CharSequence *)seqs[2 * i + 1]->data);
+  }
+  for (int i = 0; i < 6; i++) {
+    seqs[i]->destroy(seqs[i]);
+  }
+  free(lines);
+  free(line);
+  free(text);
+  free(small);
+
+  ASSERT(!applies[0], "Short-line regions should use the plain engines");
+  ASSERT(applies[1], "A minified line should use long-line mode");
+  ASSERT(!applies[2], "Small regions should use the plain engines");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+int main(void) {
+  printf("\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("  Long-Line Mode Test Suite\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  int passed = 0;
+  int total = 0;
+
+#define RUN_TEST(test)                                                                             \
+  do {                                                                                             \
+    total++;                                                                                       \
+    if (test())                                                                                    \
+      passed++;                                                                                    \
+    printf("\n");                                                                                  \
+  } while (0)
+
+  RUN_TEST(test_long_line_point_edits);
+  RUN_TEST(test_long_line_moved_block);
+  RUN_TEST(test_long_line_mode_thresholds);
+
+  printf("═══════════════════════════════════════════════════════════\n");
+  if (passed == total) {
+    printf("  ✅ ALL TESTS PASSED (%d/%d)\n", passed, total);
+  } else {
+    printf("  ❌ SOME TESTS FAILED (%d/%d passed)\n", passed, total);
+  }
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  return (passed == total) ? 0 : 1;
+}
@@ -256,6 +256,146 @@ void test_delete_and_add() {
   free(result);
 }
 
+// Hard check that stays active in Release builds (assert() is compiled out by NDEBUG)
+#define CHECK(cond, msg)                                                                           \
+  do {                                                                                             \
+    if (!(cond)) {                                                                                 \
+      printf("  ✗ FAIL: %s\n", msg);                                                               \
+      exit(1);                                                                                     \
+    }                                                                                              \
+  } while (0)
+
+// Check that diffs describe a valid alignment: everything between them matches
+static bool diffs_align(const SequenceDiffArray *diffs, const char *a, const char *b) {
+  int pos_a = 0;
+  int pos_b = 0;
+  for (int i = 0; i <= diffs->count; i++) {
+    int end_a = (i < diffs->count) ? diffs->diffs[i].seq1_start : (int)strlen(a);
+    int end_b = (i < diffs->count) ? diffs->diffs[i].seq2_start : (int)strlen(b);
+    if (end_a - pos_a != end_b - pos_b || strncmp(a + pos_a, b + pos_b, (size_t)(end_a - pos_a)))
+      return false;
+    if (i < diffs->count) {
+      pos_a = diffs->diffs[i].seq1_end;
+      pos_b = diffs->diffs[i].seq2_end;
+    }
+  }
+  return true;
+}
+
+static int edit_count(const SequenceDiffArray *diffs) {
+  int total = 0;
+  for (int i = 0; i < diffs->count; i++) {
+    total += diffs->diffs[i].seq1_end - diffs->diffs[i].seq1_start;
+    total += diffs->diffs[i].seq2_end - diffs->diffs[i].seq2_start;
+  }
+  return total;
+}
+
+void test_bidirectional_minimal() {
+  printf("\n=== Test: Bidirectional Myers Finds Minimal Diffs ===\n");
+
+  srand(7);
+  char buf_a[512];
+  char buf_b[512];
+  int identical = 0;
+  const int runs = 500;
+
+  for (int iter = 0; iter < runs; iter++) {
+    int len_a = rand() % 400;
+    int len_b = rand() % 400;
+    for (int i = 0; i < len_a; i++)
+      buf_a[i] = "abcde"[rand() % 5];
+    buf_a[len_a] = '\0';
+    // Derive b from a so both high-D and low-D inputs are covered
+    int j = 0;
+    for (int i = 0; i < len_a && j < len_b; i++) {
+      if (rand() % 8 != 0)
+        buf_b[j++] = buf_a[i];
+      if (rand() % 8 == 0 && j < len_b)
+        buf_b[j++] = "xy"[rand() % 2];
+    }
+    while (j < len_b)
+      buf_b[j++] = "abxy"[rand() % 4];
+    buf_b[len_b] = '\0';
+
+    const char *lines_a[] = {buf_a};
+    const char *lines_b[] = {buf_b};
+    ISequence *seq_a = char_sequence_create(lines_a, 0, 1, false);
+    ISequence *seq_b = char_sequence_create(lines_b, 0, 1, false);
+
+    bool hit_timeout = false;
+    SequenceDiffArray *fwd = myers_nd_diff_algorithm(seq_a, seq_b, 0, &hit_timeout);
+    SequenceDiffArray *bidir = myers_bidir_diff_algorithm(seq_a, seq_b, 0, &hit_timeout);
+
+    CHECK(!hit_timeout, "Unexpected timeout");
+    CHECK(diffs_align(bidir, buf_a, buf_b), "Bidirectional diffs do not align the inputs");
+    CHECK(edit_count(bidir) == edit_count(fwd), "Bidirectional diff is not minimal");
+    for (int i = 1; i < bidir->count; i++) {
+      // Touching diffs must be merged, as in the forward engine
+      CHECK(bidir->diffs[i].seq1_start > bidir->diffs[i - 1].seq1_end ||
+                bidir->diffs[i].seq2_start > bidir->diffs[i - 1].seq2_end,
+            "Touching diffs were not merged");
+    }
+
+    bool same = fwd->count == bidir->count;
+    for (int i = 0; same && i < fwd->count; i++) {
+      same = fwd->diffs[i].seq1_start == bidir->diffs[i].seq1_start &&
+             fwd->diffs[i].seq1_end == bidir->diffs[i].seq1_end &&
+             fwd->diffs[i].seq2_start == bidir->diffs[i].seq2_start &&
+             fwd->diffs[i].seq2_end == bidir->diffs[i].seq2_end;
+    }
+    identical += same;
+
+    free(fwd->diffs);
+    free(fwd);
+    free(bidir->diffs);
+    free(bidir);
+    seq_a->destroy(seq_a);
+    seq_b->destroy(seq_b);
+  }
+
+  printf("  %d/%d random inputs produce the exact forward-engine diffs\n", identical, runs);
+  printf("✓ PASSED (all %d diffs valid and minimal)\n", runs);
+}
+
+void test_timeout_partial_alignment() {
+  printf("\n=== Test: Timeout Keeps Partial Alignment ===\n");
+
+  // High edit distance: forward search takes far longer than the timeout
+  const int len = 20000;
+  char *buf_a = malloc((size_t)len + 1);
+  char *buf_b = malloc((size_t)len + 1);
+  srand(11);
+  for (int i = 0; i < len; i++) {
+    buf_a[i] = "abcd"[rand() % 4];
+    buf_b[i] = (rand() % 3) ? buf_a[i] : "abcd"[rand() % 4];
+  }
+  buf_a[len] = '\0';
+  buf_b[len] = '\0';
+
+  const char *lines_a[] = {buf_a};
+  const char *lines_b[] = {buf_b};
+  ISequence *seq_a = char_sequence_create(lines_a, 0, 1, false);
+  ISequence *seq_b = char_sequence_create(lines_b, 0, 1, false);
+
+  bool hit_timeout = false;
+  SequenceDiffArray *result = myers_nd_diff_algorithm(seq_a, seq_b, 1, &hit_timeout);
+
+  printf("  %d diff(s), edit count %d\n", result->count, edit_count(result));
+  CHECK(hit_timeout, "Timeout should still be reported");
+  CHECK(result->count > 1, "Progress before the timeout should be kept");
+  CHECK(diffs_align(result, buf_a, buf_b), "Partial alignment must be valid");
+
+  printf("✓ PASSED\n");
+
+  free(result->diffs);
+  free(result);
+  seq_a->destroy(seq_a);
+  seq_b->destroy(seq_b);
+  free(buf_a);
+  free(buf_b);
+}
+
 int main() {
   printf("Running Myers Algorithm Tests\n");
   printf("==============================\n");
@@ -272,6 +412,8 @@ int main() {
   test_large_file();
   test_worst_case();
   test_delete_and_add();
+  test_bidirectional_minimal();
+  test_timeout_partial_alignment();
 
   printf("\n==============================\n");
   printf("All tests passed! ✓\n");
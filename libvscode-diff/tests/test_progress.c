@@ -0,0 +1,242 @@
+/**
+ * Test Suite for compute_diff_ex() progress reporting
+ *
+ * Checks that small diffs never see a callback, that large diffs report every
+ * stage with non-decreasing fractions from the calling thread only, that the
+ * result is the same as compute_diff(), and that returning false cancels.
+ */
+
+#include "default_lines_diff_computer.h"
+#include "progress.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define TEST_THREAD_LOCAL __declspec(thread)
+#else
+#define TEST_THREAD_LOCAL _Thread_local
+#endif
+
+// ============================================================================
+// Test Infrastructure
+// ============================================================================
+
+#define ASSERT(cond, msg)                                                                          \
+  do {                                                                                             \
+    if (!(cond)) {                                                                                 \
+      printf("  ✗ ASSERTION FAILED: %s\n", msg);                                                   \
+      return false;                                                                                \
+    }                                                                                              \
+  } while (0)
+
+// Every 9th line changed; lines [100, 130) move down to before line count / 2
+static char **make_modified_lines(int count) {
+  char **lines = make_lines(count, 9, " // changed");
+  if (count / 2 > 130)
+    move_line_block(lines, 100, 30, count / 2);
+  return lines;
+}
+
+typedef struct {
+  int calls;
+  int stage_counts[4]; // line_alignments, refine, moves, done
+  const char *last_stage;
+  double last_fraction;
+  bool ordered;         // Fractions never decrease within a stage, all in [0, 1]
+  bool off_thread;      // Called from a thread other than the caller
+  const char *cancel_at; // Stage to cancel in (NULL = never)
+} ProgressLog;
+
+static TEST_THREAD_LOCAL bool t_is_caller;
+
+static bool on_progress(const char *stage, double fraction, void *user_data) {
+  ProgressLog *log = (ProgressLog *)user_data;
+  static const char *stages[] = {"line_alignments", "refine", "moves", "done"};
+  log->calls++;
+  if (!t_is_caller)
+    log->off_thread = true;
+  for (int i = 0; i < 4; i++) {
+    if (strcmp(stage, stages[i]) == 0)
+      log->stage_counts[i]++;
+  }
+  if (fraction < 0.0 || fraction > 1.0 ||
+      (log->last_stage && strcmp(stage, log->last_stage) == 0 && fraction < log->last_fraction))
+    log->ordered = false;
+  log->last_stage = stage;
+  log->last_fraction = fraction;
+  return !(log->cancel_at && strcmp(stage, log->cancel_at) == 0);
+}
+
+static bool same_diff(const LinesDiff *x, const LinesDiff *y) {
+  if (x->changes.count != y->changes.count || x->moves.count != y->moves.count)
+    return false;
+  for (int i = 0; i < x->changes.count; i++) {
+    const DetailedLineRangeMapping *mx = &x->changes.mappings[i];
+    const DetailedLineRangeMapping *my = &y->changes.mappings[i];
+    if (memcmp(&mx->original, &my->original, sizeof(LineRange)) != 0 ||
+        memcmp(&mx->modified, &my->modified, sizeof(LineRange)) != 0 ||
+        mx->inner_change_count != my->inner_change_count ||
+        (mx->inner_change_count > 0 &&
+         memcmp(mx->inner_changes, my->inner_changes,
+                (size_t)mx->inner_change_count * sizeof(RangeMapping)) != 0))
+      return false;
+  }
+  return x->moves.count == 0 ||
+         memcmp(x->moves.moves, y->moves.moves, (size_t)x->moves.count * sizeof(MovedText)) == 0;
+}
+
+static ProgressLog new_log(const char *cancel_at) {
+  ProgressLog log;
+  memset(&log, 0, sizeof(log));
+  log.ordered = true;
+  log.cancel_at = cancel_at;
+  return log;
+}
+
+// ============================================================================
+// Test Cases
+// ============================================================================
+
+bool test_progress_small_diff_silent() {
+  printf("Running test_progress_small_diff_silent...\n");
+
+  const int count = 200;
+  char **original = make_lines(count, 9, "");
+  char **modified = make_modified_lines(count);
+  DiffOptions options = {.max_computation_time_ms = 0, .compute_moves = true, .max_threads = 4};
+
+  ProgressLog log = new_log(NULL);
+  LinesDiff *with = compute_diff_ex((const char **)original, count, (const char **)modified,
+                                    count, &options, on_progress, &log);
+  LinesDiff *without = compute_diff((const char **)original, count, (const char **)modified,
+                                    count, &options);
+  bool same = with && without && same_diff(with, without);
+  free_lines_diff(with);
+  free_lines_diff(without);
+  free_made_lines(original, count);
+  free_made_lines(modified, count);
+
+  ASSERT(log.calls == 0, "A diff under the first-report delay should not call back");
+  ASSERT(same, "Progress reporting should not change the result");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_progress_reports_stages() {
+  printf("Running test_progress_reports_stages...\n");
+
+  // Above the DP limit, so line alignment runs the O(ND) search
+  const int count = 4000;
+  char **original = make_lines(count, 9, "");
+  char **modified = make_modified_lines(count);
+  DiffOptions options = {.max_computation_time_ms = 0, .compute_moves = true, .max_threads = 4};
+
+  diff_progress_set_rate_limit(0, 0); // Report every step
+  ProgressLog log = new_log(NULL);
+  LinesDiff *with = compute_diff_ex((const char **)original, count, (const char **)modified,
+                                    count, &options, on_progress, &log);
+  diff_progress_set_rate_limit(-1, -1);
+  LinesDiff *without = compute_diff((const char **)original, count, (const char **)modified,
+                                    count, &options);
+  bool same = with && without && same_diff(with, without);
+  int moves = with ? with->moves.count : 0;
+  free_lines_diff(with);
+  free_lines_diff(without);
+  free_made_lines(original, count);
+  free_made_lines(modified, count);
+
+  printf("  %d reports: %d line_alignments, %d refine, %d moves, %d done\n", log.calls,
+         log.stage_counts[0], log.stage_counts[1], log.stage_counts[2], log.stage_counts[3]);
+  ASSERT(same && moves > 0, "Progress reporting should not change the result");
+  ASSERT(log.stage_counts[0] > 0, "Myers D progress should be reported");
+  ASSERT(log.stage_counts[1] > 0, "Refinement progress should be reported");
+  ASSERT(log.stage_counts[2] > 0, "Move detection progress should be reported");
+  ASSERT(log.stage_counts[3] == 1 && strcmp(log.last_stage, "done") == 0 &&
+             log.last_fraction == 1.0,
+         "The last report should be done at 1.0");
+  ASSERT(log.ordered, "Fractions should stay in [0, 1] and never decrease within a stage");
+  ASSERT(!log.off_thread, "The callback should only run on the calling thread");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_progress_cancel() {
+  printf("Running test_progress_cancel...\n");
+
+  const int count = 4000;
+  char **original = make_lines(count, 9, "");
+  char **modified = make_modified_lines(count);
+  DiffOptions options = {.max_computation_time_ms = 0, .compute_moves = true, .max_threads = 4};
+  static const char *stages[] = {"line_alignments", "refine", "moves"};
+
+  diff_progress_set_rate_limit(0, 0);
+  bool all_cancelled = true;
+  for (int i = 0; i < 3; i++) {
+    ProgressLog log = new_log(stages[i]);
+    LinesDiff *diff = compute_diff_ex((const char **)original, count, (const char **)modified,
+                                      count, &options, on_progress, &log);
+    printf("  cancel in %s: %s after %d reports\n", stages[i], diff ? "completed" : "NULL",
+           log.calls);
+    all_cancelled = all_cancelled && diff == NULL && log.stage_counts[3] == 0;
+    free_lines_diff(diff);
+  }
+  diff_progress_set_rate_limit(-1, -1);
+
+  // No progress state may leak into later diffs on this thread
+  LinesDiff *after = compute_diff((const char **)original, count, (const char **)modified, count,
+                                  &options);
+  bool after_ok = after && !after->hit_timeout && after->changes.count > 0;
+  free_lines_diff(after);
+  free_made_lines(original, count);
+  free_made_lines(modified, count);
+
+  ASSERT(all_cancelled, "Returning false should cancel the diff in every stage");
+  ASSERT(after_ok, "A later compute_diff() should run normally");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+int main(void) {
+  printf("\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("  Progress Callback Test Suite\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  t_is_caller = true;
+  int passed = 0;
+  int total = 0;
+
+#undef RUN_TEST // test_utils.h runs void tests; these return bool
+#define RUN_TEST(test)                                                                             \
+  do {                                                                                             \
+    total++;                                                                                       \
+    if (test())                                                                                    \
+      passed++;                                                                                    \
+    printf("\n");                                                                                  \
+  } while (0)
+
+  RUN_TEST(test_progress_small_diff_silent);
+  RUN_TEST(test_progress_reports_stages);
+  RUN_TEST(test_progress_cancel);
+
+  printf("═══════════════════════════════════════════════════════════\n");
+  if (passed == total) {
+    printf("  ✅ ALL TESTS PASSED (%d/%d)\n", passed, total);
+  } else {
+    printf("  ❌ SOME TESTS FAILED (%d/%d passed)\n", passed, total);
+  }
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  return (passed == total) ? 0 : 1;
+}
@@ -0,0 +1,246 @@
+/**
+ * Test Suite for compute_render_plan()
+ *
+ * Verifies that the flattened render plan matches what the Lua renderer
+ * (lua/codediff/ui/core.lua) used to compute:
+ * - Line highlights per changed line range
+ * - Character highlights split per line, in UTF-8 byte columns
+ * - Filler line placement (docs/filler-line-algorithm.md)
+ */
+
+#include "default_lines_diff_computer.h"
+#include "render_plan.h"
+#include <stdio.h>
+#include <string.h>
+
+// ============================================================================
+// Test Infrastructure
+// ============================================================================
+
+#define ASSERT(cond, msg)                                                                          \
+  do {                                                                                             \
+    if (!(cond)) {                                                                                 \
+      printf("  ✗ ASSERTION FAILED: %s\n", msg);                                                   \
+      return false;                                                                                \
+    }                                                                                              \
+  } while (0)
+
+#define ASSERT_EQ(a, b, msg)                                                                       \
+  do {                                                                                             \
+    if ((a) != (b)) {                                                                              \
+      printf("  ✗ ASSERTION FAILED: %s (expected %d, got %d)\n", msg, (int)(b), (int)(a));         \
+      return false;                                                                                \
+    }                                                                                              \
+  } while (0)
+
+static const DiffOptions default_options = {.ignore_trim_whitespace = false,
+                                            .max_computation_time_ms = 0,
+                                            .compute_moves = false,
+                                            .extend_to_subwords = false};
+
+static const RenderItem *find_item(const RenderPlan *plan, RenderItemKind kind, RenderSide side,
+                                   int nth) {
+  for (int i = 0; i < plan->count; i++) {
+    if (plan->items[i].kind == (int)kind && plan->items[i].side == (int)side && nth-- == 0) {
+      return &plan->items[i];
+    }
+  }
+  return NULL;
+}
+
+// ============================================================================
+// Test Cases
+// ============================================================================
+
+bool test_added_line_filler() {
+  printf("Running test_added_line_filler...\n");
+
+  const char *original[] = {"line 1", "line 2"};
+  const char *modified[] = {"line 1", "line 2", "line 3"};
+
+  LinesDiff *diff = compute_diff(original, 2, modified, 3, &default_options);
+  RenderPlan *plan = compute_render_plan(diff, original, 2, modified, 3);
+
+  ASSERT(plan != NULL, "Plan should not be NULL");
+  ASSERT_EQ(plan->original_filler_count, 1, "One filler on original side");
+  ASSERT_EQ(plan->modified_filler_count, 0, "No fillers on modified side");
+
+  const RenderItem *hl = find_item(plan, RENDER_ITEM_LINE_HIGHLIGHT, RENDER_SIDE_MODIFIED, 0);
+  ASSERT(hl != NULL, "Inserted line should be highlighted");
+  ASSERT_EQ(hl->start_line, 2, "Highlight starts at 0-based line 2");
+  ASSERT_EQ(hl->end_line, 3, "Highlight ends before line 3");
+  ASSERT(find_item(plan, RENDER_ITEM_LINE_HIGHLIGHT, RENDER_SIDE_ORIGINAL, 0) == NULL,
+         "Nothing deleted on original side");
+
+  const RenderItem *filler = find_item(plan, RENDER_ITEM_FILLER, RENDER_SIDE_ORIGINAL, 0);
+  ASSERT(filler != NULL, "Filler should be placed on original side");
+  ASSERT_EQ(filler->start_line, 1, "Filler goes below last original line");
+  ASSERT_EQ(filler->count, 1, "One filler line");
+
+  free_render_plan(plan);
+  free_lines_diff(diff);
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_deletion_at_top_fills_above() {
+  printf("Running test_deletion_at_top_fills_above...\n");
+
+  const char *original[] = {"removed", "kept 1", "kept 2"};
+  const char *modified[] = {"kept 1", "kept 2"};
+
+  LinesDiff *diff = compute_diff(original, 3, modified, 2, &default_options);
+  RenderPlan *plan = compute_render_plan(diff, original, 3, modified, 2);
+
+  ASSERT(plan != NULL, "Plan should not be NULL");
+  ASSERT_EQ(plan->modified_filler_count, 1, "One filler on modified side");
+
+  const RenderItem *filler = find_item(plan, RENDER_ITEM_FILLER_ABOVE, RENDER_SIDE_MODIFIED, 0);
+  ASSERT(filler != NULL, "Filler for top-of-file deletion goes above line 0");
+  ASSERT_EQ(filler->start_line, 0, "Anchored on first line");
+  ASSERT_EQ(filler->count, 1, "One filler line");
+
+  free_render_plan(plan);
+  free_lines_diff(diff);
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_char_highlight_byte_columns() {
+  printf("Running test_char_highlight_byte_columns...\n");
+
+  // "é" is 1 UTF-16 code unit but 2 UTF-8 bytes
+  const char *original[] = {"caf\xc3\xa9 world"};
+  const char *modified[] = {"caf\xc3\xa9 there"};
+
+  LinesDiff *diff = compute_diff(original, 1, modified, 1, &default_options);
+  ASSERT(diff->changes.count == 1 && diff->changes.mappings[0].inner_change_count == 1,
+         "Expected a single inner change");
+  ASSERT_EQ(diff->changes.mappings[0].inner_changes[0].original.start_col, 6,
+            "Diff core reports UTF-16 column");
+
+  RenderPlan *plan = compute_render_plan(diff, original, 1, modified, 1);
+  ASSERT(plan != NULL, "Plan should not be NULL");
+
+  const RenderItem *del = find_item(plan, RENDER_ITEM_CHAR_HIGHLIGHT, RENDER_SIDE_ORIGINAL, 0);
+  const RenderItem *ins = find_item(plan, RENDER_ITEM_CHAR_HIGHLIGHT, RENDER_SIDE_MODIFIED, 0);
+  ASSERT(del != NULL && ins != NULL, "Both sides get a char highlight");
+  ASSERT_EQ(del->start_line, 0, "Same line");
+  ASSERT_EQ(del->end_line, 0, "Single-line span");
+  ASSERT_EQ(del->start_col, 6, "Byte column after 'café '");
+  ASSERT_EQ(del->end_col, 11, "End clamped to line byte length");
+  ASSERT_EQ(ins->start_col, 6, "Byte column after 'café '");
+  ASSERT_EQ(ins->end_col, 11, "End clamped to line byte length");
+  ASSERT_EQ(plan->original_filler_count + plan->modified_filler_count, 0, "No fillers");
+
+  free_render_plan(plan);
+  free_lines_diff(diff);
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_multiline_char_highlight_split() {
+  printf("Running test_multiline_char_highlight_split...\n");
+
+  const char *original[] = {"aaaa", "bbbb", "cccc", "dddd"};
+  const char *modified[] = {"aaaa", "dddd"};
+
+  // L1:C3 -> L3:C3 on original, empty on modified
+  RangeMapping inner = {.original = {1, 3, 3, 3}, .modified = {1, 3, 1, 3}};
+  DetailedLineRangeMapping mapping = {.original = {1, 4},
+                                      .modified = {1, 2},
+                                      .inner_changes = &inner,
+                                      .inner_change_count = 1};
+  LinesDiff diff = {.changes = {&mapping, 1, 1}, .moves = {NULL, 0, 0}, .hit_timeout = false};
+
+  RenderPlan *plan = compute_render_plan(&diff, original, 4, modified, 2);
+  ASSERT(plan != NULL, "Plan should not be NULL");
+
+  const RenderItem *first = find_item(plan, RENDER_ITEM_CHAR_HIGHLIGHT, RENDER_SIDE_ORIGINAL, 0);
+  const RenderItem *middle = find_item(plan, RENDER_ITEM_CHAR_HIGHLIGHT, RENDER_SIDE_ORIGINAL, 1);
+  const RenderItem *last = find_item(plan, RENDER_ITEM_CHAR_HIGHLIGHT, RENDER_SIDE_ORIGINAL, 2);
+  ASSERT(first && middle && last, "Multi-line span is split into three items");
+  ASSERT(find_item(plan, RENDER_ITEM_CHAR_HIGHLIGHT, RENDER_SIDE_ORIGINAL, 3) == NULL,
+         "No extra spans");
+  ASSERT(find_item(plan, RENDER_ITEM_CHAR_HIGHLIGHT, RENDER_SIDE_MODIFIED, 0) == NULL,
+         "Empty modified range is skipped");
+
+  ASSERT_EQ(first->start_line, 0, "First span line");
+  ASSERT_EQ(first->start_col, 2, "First span starts at column");
+  ASSERT_EQ(first->end_line, 1, "First span runs to end of line");
+  ASSERT_EQ(first->end_col, 0, "First span ends at next line start");
+  ASSERT_EQ(middle->start_line, 1, "Middle span covers whole line");
+  ASSERT_EQ(middle->end_line, 2, "Middle span covers whole line");
+  ASSERT_EQ(last->start_line, 2, "Last span line");
+  ASSERT_EQ(last->start_col, 0, "Last span starts at line start");
+  ASSERT_EQ(last->end_col, 2, "Last span ends at column");
+
+  // Two original lines removed: fillers on modified side
+  ASSERT_EQ(plan->modified_filler_count, 2, "Two fillers on modified side");
+
+  free_render_plan(plan);
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_empty_diff_plan() {
+  printf("Running test_empty_diff_plan...\n");
+
+  const char *lines[] = {"same"};
+  LinesDiff *diff = compute_diff(lines, 1, lines, 1, &default_options);
+  RenderPlan *plan = compute_render_plan(diff, lines, 1, lines, 1);
+
+  ASSERT(plan != NULL, "Plan should not be NULL");
+  ASSERT_EQ(plan->count, 0, "No render items");
+  ASSERT(compute_render_plan(NULL, lines, 1, lines, 1) == NULL, "NULL diff is rejected");
+
+  free_render_plan(plan);
+  free_lines_diff(diff);
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+int main(void) {
+  printf("\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("  compute_render_plan() Test Suite\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  int passed = 0;
+  int total = 0;
+
+#define RUN_TEST(test)                                                                             \
+  do {                                                                                             \
+    total++;                                                                                       \
+    if (test())                                                                                    \
+      passed++;                                                                                    \
+    printf("\n");                                                                                  \
+  } while (0)
+
+  RUN_TEST(test_added_line_filler);
+  RUN_TEST(test_deletion_at_top_fills_above);
+  RUN_TEST(test_char_highlight_byte_columns);
+  RUN_TEST(test_multiline_char_highlight_split);
+  RUN_TEST(test_empty_diff_plan);
+
+  printf("═══════════════════════════════════════════════════════════\n");
+  if (passed == total) {
+    printf("  ✅ ALL TESTS PASSED (%d/%d)\n", passed, total);
+  } else {
+    printf("  ❌ SOME TESTS FAILED (%d/%d passed)\n", passed, total);
+  }
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  return (passed == total) ? 0 : 1;
+}
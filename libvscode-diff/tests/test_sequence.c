@@ -65,6 +65,47 @@ void test_whitespace_handling() {
   printf("✓ PASSED\n");
 }
 
+#define CHECK(cond, msg)                                                                           \
+  do {                                                                                             \
+    if (!(cond)) {                                                                                 \
+      printf("  ✗ FAIL: %s\n", msg);                                                               \
+      exit(1);                                                                                     \
+    }                                                                                              \
+  } while (0)
+
+void test_full_line_identity() {
+  printf("\n=== Test: Full-Line Identity ===\n");
+
+  const char *lines_a[] = {"  world  ", "world", "", "x"};
+  const char *lines_b[] = {"world", "  world  ", "x"};
+
+  StringHashMap *shared_map = string_hash_map_create();
+  ISequence *seq_a = line_sequence_create(lines_a, 4, true, shared_map);
+  ISequence *seq_b = line_sequence_create(lines_b, 3, true, shared_map);
+  LineSequence *line_a = (LineSequence *)seq_a->data;
+  LineSequence *line_b = (LineSequence *)seq_b->data;
+
+  // Trimmed IDs ignore whitespace, full IDs do not
+  CHECK(seq_a->getElement(seq_a, 0) == seq_a->getElement(seq_a, 1), "trimmed IDs equal");
+  CHECK(!seq_a->isStronglyEqual(seq_a, 0, 1), "untrimmed lines differ");
+  CHECK(seq_a->isStronglyEqual(seq_a, 1, 1), "line strongly equals itself");
+
+  // Full IDs are comparable across sequences sharing the map
+  CHECK(line_a->full_hash[0] == line_b->full_hash[1], "same untrimmed line, same ID");
+  CHECK(line_a->full_hash[1] == line_b->full_hash[0], "same untrimmed line, same ID");
+  CHECK(line_a->full_hash[0] != line_b->full_hash[0], "different untrimmed lines");
+  CHECK(line_a->full_hash[3] == line_b->full_hash[2], "unpadded line");
+
+  CHECK(line_a->line_lengths[0] == 9 && line_a->line_lengths[2] == 0, "cached lengths");
+  printf("  ✓ Untrimmed IDs and lengths match the lines\n");
+
+  seq_a->destroy(seq_a);
+  seq_b->destroy(seq_b);
+  string_hash_map_destroy(shared_map);
+
+  printf("✓ PASSED\n");
+}
+
 void test_boundary_scoring() {
   printf("\n=== Test: Boundary Scoring ===\n");
 
@@ -420,6 +461,7 @@ int main() {
   printf("========================================\n");
 
   test_whitespace_handling();
+  test_full_line_identity();
   test_boundary_scoring();
   test_timeout();
 
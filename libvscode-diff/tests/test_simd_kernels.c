@@ -0,0 +1,284 @@
+/**
+ * Test Suite for the SIMD kernels (simd_kernels.h)
+ *
+ * Forces every variant this CPU supports and checks that each kernel returns
+ * exactly what the scalar reference does, on every length and mismatch
+ * position around the vector block sizes, and that whole diffs (line-level
+ * Myers, character refinement, moved-block similarity) come out identical.
+ */
+
+#include "default_lines_diff_computer.h"
+#include "myers.h"
+#include "sequence.h"
+#include "simd_kernels.h"
+#include "string_hash_map.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// Test Infrastructure
+// ============================================================================
+
+#define ASSERT(cond, msg)                                                                          \
+  do {                                                                                             \
+    if (!(cond)) {                                                                                 \
+      printf("  ✗ ASSERTION FAILED: %s\n", msg);                                                   \
+      return false;                                                                                \
+    }                                                                                              \
+  } while (0)
+
+// Longer than two AVX-512 blocks of bytes, so every variant runs its loop
+#define MAX_LEN 200
+
+static unsigned int rng_state = 12345;
+
+static unsigned int next_random(void) {
+  rng_state = rng_state * 1103515245u + 12345u;
+  return (rng_state >> 16) & 0x7FFF;
+}
+
+static const SimdKernels *scalar_kernels(void) {
+  SimdVariant active = simd_active_variant();
+  simd_force_variant(SIMD_SCALAR);
+  const SimdKernels *scalar = simd_kernels();
+  simd_force_variant(active);
+  return scalar;
+}
+
+/**
+ * Compare one variant's kernels with the scalar ones on all lengths up to
+ * MAX_LEN, with the first mismatch / stop byte at every position.
+ */
+static bool check_variant_kernels(const SimdKernels *ref, const SimdKernels *k) {
+  char bytes[MAX_LEN + 64];
+  uint32_t a[MAX_LEN + 16], b[MAX_LEN + 16];
+  int ha[MAX_LEN + 16], hb[MAX_LEN + 16];
+  uint32_t wide_ref[MAX_LEN + 16], wide[MAX_LEN + 16];
+
+  for (int len = 0; len <= MAX_LEN; len++) {
+    // Offset 1 makes every load unaligned
+    for (int misalign = 0; misalign <= 1; misalign++) {
+      for (int pos = 0; pos <= len; pos++) {
+        char *s = bytes + misalign;
+        for (int i = 0; i < len; i++)
+          s[i] = (char)(' ' + next_random() % 90); // Printable, never '\n'
+        if (pos < len)
+          s[pos] = '\n';
+        ASSERT(k->find_byte(s, (size_t)len, '\n') == ref->find_byte(s, (size_t)len, '\n'),
+               "find_byte should match scalar");
+
+        for (int i = 0; i < len; i++)
+          a[misalign + i] = b[i] = next_random();
+        if (pos < len)
+          b[pos] ^= 1u << (next_random() % 32);
+        ASSERT(k->match_length_u32(a + misalign, b, len) ==
+                   ref->match_length_u32(a + misalign, b, len),
+               "match_length_u32 should match scalar");
+        ASSERT(k->match_length_reverse_u32(a + misalign, b, len) ==
+                   ref->match_length_reverse_u32(a + misalign, b, len),
+               "match_length_reverse_u32 should match scalar");
+        ASSERT(ref->match_length_reverse_u32(a + misalign, b, len) ==
+                   (pos < len ? len - 1 - pos : len),
+               "match_length_reverse_u32 should stop at the last mismatch");
+
+        // Stop byte: NUL, first non-ASCII byte, or 0xFF
+        static const char stops[] = {'\0', (char)0x80, (char)0xFF};
+        for (int i = 0; i < len; i++)
+          s[i] = (char)(1 + next_random() % 127);
+        if (pos < len)
+          s[pos] = stops[pos % 3];
+        memset(wide_ref, 0xAB, sizeof(wide_ref));
+        memset(wide, 0xAB, sizeof(wide));
+        int n_ref = ref->widen_ascii(s, len, wide_ref);
+        int n = k->widen_ascii(s, len, wide);
+        ASSERT(n == n_ref && n == pos, "widen_ascii should stop at the first stop byte");
+        ASSERT(memcmp(wide, wide_ref, sizeof(wide)) == 0,
+               "widen_ascii should write exactly the widened prefix");
+      }
+
+      for (int i = 0; i < len; i++) {
+        ha[misalign + i] = (int)(next_random() % 2001) - 1000;
+        hb[i] = (int)(next_random() % 2001) - 1000;
+      }
+      ASSERT(k->sum_abs_diff_i32(ha + misalign, hb, len) ==
+                 ref->sum_abs_diff_i32(ha + misalign, hb, len),
+             "sum_abs_diff_i32 should match scalar");
+    }
+  }
+  return true;
+}
+
+// ============================================================================
+// Diff Fixtures
+// ============================================================================
+
+/**
+ * Every 11th line ends in 2-, 3- and 4-byte UTF-8 and a tab; the modified copy
+ * edits those tails and moves a block, so character refinement and move
+ * detection both run.
+ */
+#define UTF8_TAIL "\tcaf\xc3\xa9 \xe4\xb8\xad\xe6\x96\x87 \xf0\x9f\x98\x80"
+
+static bool same_diff_arrays(const SequenceDiffArray *x, const SequenceDiffArray *y) {
+  if (x->count != y->count)
+    return false;
+  return x->count == 0 || memcmp(x->diffs, y->diffs, (size_t)x->count * sizeof(SequenceDiff)) == 0;
+}
+
+static bool same_lines_diff(const LinesDiff *x, const LinesDiff *y) {
+  if (x->changes.count != y->changes.count || x->moves.count != y->moves.count)
+    return false;
+  for (int i = 0; i < x->changes.count; i++) {
+    const DetailedLineRangeMapping *mx = &x->changes.mappings[i];
+    const DetailedLineRangeMapping *my = &y->changes.mappings[i];
+    if (memcmp(&mx->original, &my->original, sizeof(LineRange)) != 0 ||
+        memcmp(&mx->modified, &my->modified, sizeof(LineRange)) != 0 ||
+        mx->inner_change_count != my->inner_change_count)
+      return false;
+    if (mx->inner_change_count > 0 &&
+        memcmp(mx->inner_changes, my->inner_changes,
+               (size_t)mx->inner_change_count * sizeof(RangeMapping)) != 0)
+      return false;
+  }
+  return x->moves.count == 0 ||
+         memcmp(x->moves.moves, y->moves.moves, (size_t)x->moves.count * sizeof(MovedText)) == 0;
+}
+
+static void free_sequence_diffs(SequenceDiffArray *diffs) {
+  free(diffs->diffs);
+  free(diffs);
+}
+
+// ============================================================================
+// Test Cases
+// ============================================================================
+
+bool test_simd_detection() {
+  printf("Running test_simd_detection...\n");
+
+  SimdVariant best = simd_detect_variant();
+  printf("  Best variant: %s\n", simd_variant_name(best));
+  ASSERT(simd_active_variant() == best, "The best variant should be active by default");
+  ASSERT(simd_force_variant(SIMD_SCALAR), "Scalar should always be available");
+  ASSERT(simd_active_variant() == SIMD_SCALAR, "Forced variant should be active");
+  ASSERT(!simd_force_variant(SIMD_VARIANT_COUNT), "Unknown variants should be rejected");
+  ASSERT(simd_active_variant() == SIMD_SCALAR, "A rejected force should keep the active variant");
+  if (best < SIMD_AVX512)
+    ASSERT(!simd_force_variant(SIMD_AVX512), "Unsupported variants should be rejected");
+  ASSERT(simd_force_variant(best), "Best variant should be selectable again");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_simd_kernels_match_scalar() {
+  printf("Running test_simd_kernels_match_scalar...\n");
+
+  const SimdKernels *ref = scalar_kernels();
+  SimdVariant best = simd_detect_variant();
+  for (int v = SIMD_SSE2; v <= (int)best; v++) {
+    ASSERT(simd_force_variant((SimdVariant)v), "Supported variant should be selectable");
+    printf("  %s\n", simd_variant_name((SimdVariant)v));
+    if (!check_variant_kernels(ref, simd_kernels()))
+      return false;
+  }
+  simd_force_variant(best);
+  if (best == SIMD_SCALAR)
+    printf("  (no vector variants on this CPU)\n");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_simd_diffs_identical() {
+  printf("Running test_simd_diffs_identical...\n");
+
+  const int count = 2000; // Above the DP size limit, so the O(ND) engines run
+  char **original = make_lines(count, 11, UTF8_TAIL);
+  char **modified = make_lines(count, 11, UTF8_TAIL " emoji /* edited */");
+  move_line_block(modified, 200, 30, 1500);
+  DiffOptions options = {.max_computation_time_ms = 0, .compute_moves = true, .max_threads = 1};
+  SimdVariant best = simd_detect_variant();
+
+  simd_force_variant(SIMD_SCALAR);
+  LinesDiff *ref = compute_diff((const char **)original, count, (const char **)modified, count,
+                                &options);
+  StringHashMap *map = string_hash_map_create();
+  ISequence *seq1 = line_sequence_create((const char **)original, count, false, map);
+  ISequence *seq2 = line_sequence_create((const char **)modified, count, false, map);
+  SequenceDiffArray *ref_nd = myers_nd_diff_algorithm(seq1, seq2, 0, NULL);
+  SequenceDiffArray *ref_bidir = myers_bidir_diff_algorithm(seq1, seq2, 0, NULL);
+
+  bool ok = ref && ref->changes.count > 0 && ref->moves.count > 0;
+  for (int v = SIMD_SSE2; ok && v <= (int)best; v++) {
+    simd_force_variant((SimdVariant)v);
+    LinesDiff *diff = compute_diff((const char **)original, count, (const char **)modified,
+                                   count, &options);
+    SequenceDiffArray *nd = myers_nd_diff_algorithm(seq1, seq2, 0, NULL);
+    SequenceDiffArray *bidir = myers_bidir_diff_algorithm(seq1, seq2, 0, NULL);
+    ok = diff && same_lines_diff(ref, diff) && same_diff_arrays(ref_nd, nd) &&
+         same_diff_arrays(ref_bidir, bidir);
+    printf("  %s: %s\n", simd_variant_name((SimdVariant)v), ok ? "identical" : "DIFFERENT");
+    free_lines_diff(diff);
+    free_sequence_diffs(nd);
+    free_sequence_diffs(bidir);
+  }
+  simd_force_variant(best);
+
+  if (ref)
+    printf("  %d changes, %d moves\n", ref->changes.count, ref->moves.count);
+  free_lines_diff(ref);
+  free_sequence_diffs(ref_nd);
+  free_sequence_diffs(ref_bidir);
+  seq1->destroy(seq1);
+  seq2->destroy(seq2);
+  string_hash_map_destroy(map);
+  free_made_lines(original, count);
+  free_made_lines(modified, count);
+
+  ASSERT(ok, "Every variant should produce the scalar diff");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+int main(void) {
+  printf("\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("  SIMD Kernel Dispatch Test Suite\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  int passed = 0;
+  int total = 0;
+
+#undef RUN_TEST // test_utils.h runs void tests; these return bool
+#define RUN_TEST(test)                                                                             \
+  do {                                                                                             \
+    total++;                                                                                       \
+    if (test())                                                                                    \
+      passed++;                                                                                    \
+    printf("\n");                                                                                  \
+  } while (0)
+
+  RUN_TEST(test_simd_detection);
+  RUN_TEST(test_simd_kernels_match_scalar);
+  RUN_TEST(test_simd_diffs_identical);
+
+  printf("═══════════════════════════════════════════════════════════\n");
+  if (passed == total) {
+    printf("  ✅ ALL TESTS PASSED (%d/%d)\n", passed, total);
+  } else {
+    printf("  ❌ SOME TESTS FAILED (%d/%d passed)\n", passed, total);
+  }
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  return (passed == total) ? 0 : 1;
+}
@@ -0,0 +1,227 @@
+/**
+ * Test Suite for timeline tracing (diff_trace_*)
+ *
+ * Built with DIFF_TRACING regardless of DIFF_ENABLE_TRACING. Traces real
+ * compute_diff() calls and checks the Chrome trace JSON: every stage shows
+ * up, begin/end events pair up per thread, the ring buffer bounds what each
+ * thread keeps, and nothing is recorded outside a session.
+ */
+
+#include "default_lines_diff_computer.h"
+#include "test_utils.h"
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// Test Infrastructure
+// ============================================================================
+
+#define ASSERT(cond, msg)                                                                          \
+  do {                                                                                             \
+    if (!(cond)) {                                                                                 \
+      printf("  ✗ ASSERTION FAILED: %s\n", msg);                                                   \
+      return false;                                                                                \
+    }                                                                                              \
+  } while (0)
+
+static const char *TRACE_PATH = "test_trace_output.json";
+
+/**
+ * Diff two generated files (every third line changed) and return the number
+ * of changes.
+ */
+static int run_diff(int line_count) {
+  char **original = make_lines(line_count, 3, "");
+  char **modified = make_lines(line_count, 3, " changed");
+  DiffOptions options = {.max_computation_time_ms = 0, .compute_moves = true, .max_threads = 4};
+  LinesDiff *diff = compute_diff((const char **)original, line_count, (const char **)modified,
+                                 line_count, &options);
+  int count = diff ? diff->changes.count : -1;
+  free_lines_diff(diff);
+  free_made_lines(original, line_count);
+  free_made_lines(modified, line_count);
+  return count;
+}
+
+static char *read_trace(void) {
+  FILE *f = fopen(TRACE_PATH, "rb");
+  if (!f)
+    return NULL;
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  char *text = (char *)malloc((size_t)size + 1);
+  size_t n = fread(text, 1, (size_t)size, f);
+  text[n] = '\0';
+  fclose(f);
+  remove(TRACE_PATH);
+  return text;
+}
+
+static int count_occurrences(const char *text, const char *needle) {
+  int count = 0;
+  for (const char *p = strstr(text, needle); p; p = strstr(p + 1, needle))
+    count++;
+  return count;
+}
+
+/**
+ * Check that within each thread every end event closes the most recent open
+ * begin event of the same name. Returns the number of thread tracks, or -1.
+ */
+static int check_nesting(const char *text, int max_events_per_thread) {
+  enum { MAX_TIDS = 64, MAX_DEPTH = 16 };
+  char open_names[MAX_TIDS][MAX_DEPTH][32];
+  int depth[MAX_TIDS] = {0}, events[MAX_TIDS] = {0};
+  int tracks = 0;
+  // One event per line; skip the "{" of nested args objects
+  for (const char *p = strstr(text, "\n{"); p; p = strstr(p + 1, "\n{")) {
+    char name[32], phase;
+    int tid;
+    if (sscanf(p + 1, "{\"name\":\"%31[^\"]\",\"ph\":\"%c\",\"pid\":1,\"tid\":%d", name, &phase,
+               &tid) != 3 ||
+        tid < 0 || tid >= MAX_TIDS)
+      return -1;
+    if (phase == 'M') {
+      tracks += strcmp(name, "thread_name") == 0;
+      continue;
+    }
+    if (++events[tid] > max_events_per_thread)
+      return -1;
+    if (phase == 'B') {
+      if (depth[tid] == MAX_DEPTH)
+        return -1;
+      strcpy(open_names[tid][depth[tid]++], name);
+    } else if (phase != 'E' || depth[tid] == 0 ||
+               strcmp(open_names[tid][--depth[tid]], name) != 0) {
+      return -1;
+    }
+  }
+  return tracks;
+}
+
+// ============================================================================
+// Test Cases
+// ============================================================================
+
+bool test_trace_records_stages() {
+  printf("Running test_trace_records_stages...\n");
+
+  ASSERT(diff_trace_start(0), "Tracing should start when compiled in");
+  int changes = run_diff(300);
+  diff_trace_stop();
+  ASSERT(changes == 100, "Traced diff should be unaffected");
+  ASSERT(diff_trace_write_json(TRACE_PATH), "Trace should be written");
+
+  char *text = read_trace();
+  ASSERT(text != NULL, "Trace file should exist");
+  bool framed = strncmp(text, "{\"traceEvents\":[", 16) == 0 && strstr(text, "]") != NULL;
+  int stages = count_occurrences(text, "\"compute_diff\",\"ph\":\"B\"") +
+               count_occurrences(text, "\"line_alignments\",\"ph\":\"B\"") +
+               count_occurrences(text, "\"refine\",\"ph\":\"B\"") +
+               count_occurrences(text, "\"line_mappings\",\"ph\":\"B\"") +
+               count_occurrences(text, "\"moves\",\"ph\":\"B\"");
+  int tasks = count_occurrences(text, "\"refine_task\",\"ph\":\"B\"");
+  bool indexed = strstr(text, "\"args\":{\"index\":0}") != NULL;
+  int tracks = check_nesting(text, 1 << 20);
+  free(text);
+
+  printf("  %d refinement tasks on %d thread(s)\n", tasks, tracks);
+  ASSERT(framed, "Output should be a Chrome trace object");
+  ASSERT(stages == 5, "Each stage should be recorded once");
+  ASSERT(tasks == changes, "One task per line-level diff region");
+  ASSERT(indexed, "Tasks should carry their region index");
+  ASSERT(tracks >= 1, "Begin/end events should nest per thread");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_trace_ring_keeps_latest() {
+  printf("Running test_trace_ring_keeps_latest...\n");
+
+  // 5 events are rounded up to 8 per thread; thousands are recorded
+  ASSERT(diff_trace_start(5), "Tracing should start");
+  run_diff(3000);
+  diff_trace_stop();
+  ASSERT(diff_trace_write_json(TRACE_PATH), "Trace should be written");
+
+  char *text = read_trace();
+  ASSERT(text != NULL, "Trace file should exist");
+  int tracks = check_nesting(text, 8);
+  // The last complete span; compute_diff's end is dropped with its begin
+  bool has_latest = strstr(text, "\"moves\",\"ph\":\"E\"") != NULL;
+  free(text);
+
+  ASSERT(tracks >= 1, "Each thread should keep at most 8 well-nested events");
+  ASSERT(has_latest, "The newest events should survive");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_trace_sessions() {
+  printf("Running test_trace_sessions...\n");
+
+  ASSERT(!diff_trace_start((size_t)1 << 40), "Oversized buffers should be rejected");
+
+  // A new session drops the previous one; nothing is recorded after stop
+  ASSERT(diff_trace_start(0), "Tracing should start");
+  run_diff(30);
+  ASSERT(diff_trace_start(0), "Tracing should restart");
+  diff_trace_stop();
+  run_diff(30);
+  ASSERT(diff_trace_write_json(TRACE_PATH), "Trace should be written");
+
+  char *text = read_trace();
+  ASSERT(text != NULL, "Trace file should exist");
+  int events = count_occurrences(text, "\"ph\":\"B\"") + count_occurrences(text, "\"ph\":\"E\"");
+  free(text);
+  ASSERT(events == 0, "Restarted and stopped session should be empty");
+
+  ASSERT(!diff_trace_write_json("/nonexistent/dir/trace.json"), "Unwritable path should fail");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+int main(void) {
+  printf("\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("  Timeline Tracing Test Suite\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  int passed = 0;
+  int total = 0;
+
+#undef RUN_TEST // test_utils.h runs void tests; these return bool
+#define RUN_TEST(test)                                                                             \
+  do {                                                                                             \
+    total++;                                                                                       \
+    if (test())                                                                                    \
+      passed++;                                                                                    \
+    printf("\n");                                                                                  \
+  } while (0)
+
+  RUN_TEST(test_trace_records_stages);
+  RUN_TEST(test_trace_ring_keeps_latest);
+  RUN_TEST(test_trace_sessions);
+
+  printf("═══════════════════════════════════════════════════════════\n");
+  if (passed == total) {
+    printf("  ✅ ALL TESTS PASSED (%d/%d)\n", passed, total);
+  } else {
+    printf("  ❌ SOME TESTS FAILED (%d/%d passed)\n", passed, total);
+  }
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  return (passed == total) ? 0 : 1;
+}
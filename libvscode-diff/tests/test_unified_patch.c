@@ -0,0 +1,301 @@
+/**
+ * Test Suite for build_unified_patch()
+ *
+ * Checks exact patch text for small cases (the format keymaps.lua used to
+ * produce for --unidiff-zero), hunk merging with context, header shifting for
+ * partial selections, and round-trips generated diffs through a strict
+ * in-test applier (no fuzz, both header positions verified).
+ */
+
+#include "default_lines_diff_computer.h"
+#include "unified_patch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// Test Infrastructure
+// ============================================================================
+
+#define ASSERT(cond, msg)                                                                          \
+  do {                                                                                             \
+    if (!(cond)) {                                                                                 \
+      printf("  ✗ ASSERTION FAILED: %s\n", msg);                                                   \
+      return false;                                                                                \
+    }                                                                                              \
+  } while (0)
+
+#define ASSERT_PATCH(actual, expected)                                                             \
+  do {                                                                                             \
+    if (!(actual) || strcmp((actual), (expected)) != 0) {                                          \
+      printf("  ✗ PATCH MISMATCH\n  expected:\n%s  actual:\n%s", (expected),                       \
+             (actual) ? (actual) : "(null)\n");                                                    \
+      return false;                                                                                \
+    }                                                                                              \
+  } while (0)
+
+static const DiffOptions DEFAULT_OPTIONS = {.max_computation_time_ms = 0};
+
+static char *patch_for(const char **original, int original_count, const char **modified,
+                       int modified_count, const int *indices, int index_count, int context,
+                       bool reverse) {
+  LinesDiff *diff = compute_diff(original, original_count, modified, modified_count,
+                                 &DEFAULT_OPTIONS);
+  UnifiedPatchOptions options = {"f.txt", context, reverse};
+  size_t length = 0;
+  char *patch = build_unified_patch(diff, indices, index_count, original, original_count,
+                                    modified, modified_count, &options, &length);
+  if (patch && strlen(patch) != length) {
+    free_unified_patch(patch);
+    patch = NULL;
+  }
+  free_lines_diff(diff);
+  return patch;
+}
+
+/**
+ * Strict patch applier: every context/removed line must match at the exact
+ * position in the source header, and the destination header must agree with
+ * where the hunk lands. Returns the patched lines (pointers into `lines` and
+ * the patch copy `owned`), or NULL on any mismatch.
+ */
+static const char **apply_patch(char *owned, const char **lines, int count, bool reverse,
+                                int *out_count) {
+  const char **out = (const char **)malloc(sizeof(char *) * (size_t)(count + 4096));
+  int n = 0, pos = 0; // pos: 0-based index of the next unconsumed source line
+  char *line = strtok(owned, "\n");
+  line = line ? strtok(NULL, "\n") : NULL; // Skip ---/+++ headers
+  line = line ? strtok(NULL, "\n") : NULL;
+  bool ok = line != NULL;
+  while (ok && line) {
+    int a, b, c, d;
+    ok = sscanf(line, "@@ -%d,%d +%d,%d @@", &a, &b, &c, &d) == 4;
+    int src_start = reverse ? c : a, src_count = reverse ? d : b;
+    int dst_start = reverse ? a : c, dst_count = reverse ? b : d;
+    int skip_to = src_count == 0 ? src_start : src_start - 1;
+    ok = ok && skip_to >= pos && skip_to <= count;
+    while (ok && pos < skip_to)
+      out[n++] = lines[pos++];
+    ok = ok && (dst_count == 0 ? dst_start == n : dst_start == n + 1);
+    char remove = reverse ? '+' : '-', add = reverse ? '-' : '+';
+    line = strtok(NULL, "\n");
+    while (ok && line && line[0] != '@') {
+      if (line[0] == ' ' || line[0] == remove) {
+        ok = pos < count && strcmp(lines[pos], line + 1) == 0;
+        if (ok && line[0] == ' ')
+          out[n++] = lines[pos];
+        pos++;
+      } else {
+        ok = line[0] == add;
+        out[n++] = line + 1;
+      }
+      line = strtok(NULL, "\n");
+    }
+  }
+  while (ok && pos < count)
+    out[n++] = lines[pos++];
+  if (!ok) {
+    free(out);
+    return NULL;
+  }
+  *out_count = n;
+  return out;
+}
+
+static bool same_lines(const char **a, int a_count, const char **b, int b_count) {
+  if (a_count != b_count)
+    return false;
+  for (int i = 0; i < a_count; i++) {
+    if (strcmp(a[i], b[i]) != 0)
+      return false;
+  }
+  return true;
+}
+
+// ============================================================================
+// Test Cases
+// ============================================================================
+
+bool test_zero_context_hunks() {
+  printf("Running test_zero_context_hunks...\n");
+
+  const char *original[] = {"a", "b", "c", "d", "e", "f", "g", "h"};
+  const char *modified[] = {"a", "B", "c", "d", "x", "e", "f", "h"};
+
+  // Change 0: b -> B, change 1: insert x before e, change 2: delete g
+  int first = 0, second = 1, third = 2;
+  char *patch = patch_for(original, 8, modified, 8, &first, 1, 0, false);
+  ASSERT_PATCH(patch, "--- a/f.txt\n+++ b/f.txt\n@@ -2,1 +2,1 @@\n-b\n+B\n");
+  free_unified_patch(patch);
+
+  patch = patch_for(original, 8, modified, 8, &second, 1, 0, false);
+  ASSERT_PATCH(patch, "--- a/f.txt\n+++ b/f.txt\n@@ -4,0 +5,1 @@\n+x\n");
+  free_unified_patch(patch);
+
+  // Only the deletion selected: nothing before it is applied, no shift
+  patch = patch_for(original, 8, modified, 8, &third, 1, 0, false);
+  ASSERT_PATCH(patch, "--- a/f.txt\n+++ b/f.txt\n@@ -7,1 +6,0 @@\n-g\n");
+  free_unified_patch(patch);
+
+  // All three: the deletion's new-side start accounts for the insertion
+  patch = patch_for(original, 8, modified, 8, NULL, 0, 0, false);
+  ASSERT_PATCH(patch, "--- a/f.txt\n+++ b/f.txt\n"
+                      "@@ -2,1 +2,1 @@\n-b\n+B\n"
+                      "@@ -4,0 +5,1 @@\n+x\n"
+                      "@@ -7,1 +7,0 @@\n-g\n");
+  free_unified_patch(patch);
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_context_merges_hunks() {
+  printf("Running test_context_merges_hunks...\n");
+
+  const char *original[] = {"1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "11", "12"};
+  const char *modified[] = {"1", "2", "three", "4", "5", "6", "seven", "8", "9", "10", "11", "12"};
+
+  // Two changes 4 lines apart: 2 lines of context touch and merge
+  char *patch = patch_for(original, 12, modified, 12, NULL, 0, 2, false);
+  ASSERT_PATCH(patch, "--- a/f.txt\n+++ b/f.txt\n"
+                      "@@ -1,9 +1,9 @@\n 1\n 2\n-3\n+three\n 4\n 5\n 6\n-7\n+seven\n 8\n 9\n");
+  free_unified_patch(patch);
+
+  // One line of context keeps them apart
+  patch = patch_for(original, 12, modified, 12, NULL, 0, 1, false);
+  ASSERT_PATCH(patch, "--- a/f.txt\n+++ b/f.txt\n"
+                      "@@ -2,3 +2,3 @@\n 2\n-3\n+three\n 4\n"
+                      "@@ -6,3 +6,3 @@\n 6\n-7\n+seven\n 8\n");
+  free_unified_patch(patch);
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_reverse_uses_modified_base() {
+  printf("Running test_reverse_uses_modified_base...\n");
+
+  const char *original[] = {"a", "b", "c", "d", "e"};
+  const char *modified[] = {"a", "new1", "new2", "b", "c", "D", "e"};
+
+  // Reverse patch for the second change only (d -> D): its position is
+  // exact on the modified side, the original side ignores the insertion
+  int second = 1;
+  char *patch = patch_for(original, 5, modified, 7, &second, 1, 1, true);
+  ASSERT_PATCH(patch, "--- a/f.txt\n+++ b/f.txt\n@@ -5,3 +5,3 @@\n c\n-d\n+D\n e\n");
+  free_unified_patch(patch);
+
+  int invalid = 7;
+  ASSERT(patch_for(original, 5, modified, 7, &invalid, 1, 0, false) == NULL,
+         "Out-of-range index should return NULL");
+  ASSERT(patch_for(original, 5, modified, 7, &second, 0, 0, false) == NULL,
+         "Empty selection should return NULL");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+bool test_round_trip_generated() {
+  printf("Running test_round_trip_generated...\n");
+
+  enum { N = 400 };
+  static char original_buf[N][24], modified_buf[2 * N][24];
+  const char *original[N], *modified[2 * N];
+  int modified_count = 0;
+  unsigned seed = 12345;
+  for (int i = 0; i < N; i++) {
+    snprintf(original_buf[i], sizeof(original_buf[i]), "line %d", i);
+    original[i] = original_buf[i];
+    seed = seed * 1103515245u + 12345u;
+    int action = (int)((seed >> 16) % 20);
+    if (action == 0)
+      continue; // Delete
+    if (action == 1)
+      snprintf(modified_buf[modified_count], 24, "changed %d", i);
+    else
+      snprintf(modified_buf[modified_count], 24, "line %d", i);
+    modified[modified_count] = modified_buf[modified_count];
+    modified_count++;
+    if (action == 2) {
+      snprintf(modified_buf[modified_count], 24, "inserted %d", i);
+      modified[modified_count] = modified_buf[modified_count];
+      modified_count++;
+    }
+  }
+
+  for (int context = 0; context <= 3; context += 3) {
+    for (int reverse = 0; reverse <= 1; reverse++) {
+      char *patch = patch_for(original, N, modified, modified_count, NULL, 0, context, reverse);
+      ASSERT(patch != NULL, "Patch should be built");
+      int out_count = 0;
+      const char **out = reverse ? apply_patch(patch, modified, modified_count, true, &out_count)
+                                 : apply_patch(patch, original, N, false, &out_count);
+      bool matches = out && (reverse ? same_lines(out, out_count, original, N)
+                                     : same_lines(out, out_count, modified, modified_count));
+      free(out);
+      free_unified_patch(patch);
+      ASSERT(matches, "Applying the full patch should reproduce the other side");
+    }
+  }
+
+  // Every other change only: headers must stay consistent with the partial result
+  LinesDiff *diff = compute_diff(original, N, modified, modified_count, &DEFAULT_OPTIONS);
+  int indices[N], index_count = 0;
+  int expected_count = N;
+  for (int i = 0; i < diff->changes.count; i += 2) {
+    const DetailedLineRangeMapping *m = &diff->changes.mappings[i];
+    indices[index_count++] = i;
+    expected_count += (m->modified.end_line - m->modified.start_line) -
+                      (m->original.end_line - m->original.start_line);
+  }
+  free_lines_diff(diff);
+  char *patch = patch_for(original, N, modified, modified_count, indices, index_count, 3, false);
+  int out_count = 0;
+  const char **out = patch ? apply_patch(patch, original, N, false, &out_count) : NULL;
+  bool consistent = out && out_count == expected_count;
+  free(out);
+  free_unified_patch(patch);
+  ASSERT(consistent, "Partial patch should apply with exact header positions");
+
+  printf("  ✓ PASSED\n");
+  return true;
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+int main(void) {
+  printf("\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("  build_unified_patch() Test Suite\n");
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  int passed = 0;
+  int total = 0;
+
+#define RUN_TEST(test)                                                                             \
+  do {                                                                                             \
+    total++;                                                                                       \
+    if (test())                                                                                    \
+      passed++;                                                                                    \
+    printf("\n");                                                                                  \
+  } while (0)
+
+  RUN_TEST(test_zero_context_hunks);
+  RUN_TEST(test_context_merges_hunks);
+  RUN_TEST(test_reverse_uses_modified_base);
+  RUN_TEST(test_round_trip_generated);
+
+  printf("═══════════════════════════════════════════════════════════\n");
+  if (passed == total) {
+    printf("  ✅ ALL TESTS PASSED (%d/%d)\n", passed, total);
+  } else {
+    printf("  ❌ SOME TESTS FAILED (%d/%d passed)\n", passed, total);
+  }
+  printf("═══════════════════════════════════════════════════════════\n");
+  printf("\n");
+
+  return (passed == total) ? 0 : 1;
+}
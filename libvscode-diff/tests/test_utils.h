@@ -13,6 +13,7 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 // ============================================================================
 // Test Helper Macros
@@ -155,6 +156,43 @@ static inline void assert_diffs_equal(const SequenceDiffArray *actual,
   }
 }
 
+// ============================================================================
+// Generated File Helpers
+// ============================================================================
+
+/**
+ * Build `count` distinct lines; every `stride`-th line gets `tag` appended so
+ * two calls with different tags produce a diff with many small hunks.
+ * Free with free_made_lines().
+ */
+static inline char **make_lines(int count, int stride, const char *tag) {
+  char **lines = (char **)malloc((size_t)count * sizeof(char *));
+  for (int i = 0; i < count; i++) {
+    size_t size = 48 + strlen(tag);
+    lines[i] = (char *)malloc(size);
+    snprintf(lines[i], size, "line %d value %d%s", i, i * 7, (i % stride == 0) ? tag : "");
+  }
+  return lines;
+}
+
+/**
+ * Cut lines [from, from + length) and re-insert them before line `to`
+ * (to >= from + length), so a diff against the unmoved lines has a move.
+ */
+static inline void move_line_block(char **lines, int from, int length, int to) {
+  char **block = (char **)malloc((size_t)length * sizeof(char *));
+  memcpy(block, lines + from, (size_t)length * sizeof(char *));
+  memmove(lines + from, lines + from + length, (size_t)(to - from - length) * sizeof(char *));
+  memcpy(lines + to - length, block, (size_t)length * sizeof(char *));
+  free(block);
+}
+
+static inline void free_made_lines(char **lines, int count) {
+  for (int i = 0; i < count; i++)
+    free(lines[i]);
+  free(lines);
+}
+
 // ============================================================================
 // Step 1 Helper (Myers Algorithm Only - No Optimization)
 // ============================================================================
@@ -112,6 +112,9 @@ ffi.cdef([[
     DetailedLineRangeMappingArray changes;
     MovedTextArray moves;
     bool hit_timeout;
+    int degradations;
+    bool is_binary;
+    void* deferred_alignments; // SequenceDiffArray*, set by line_level_only
   } LinesDiff;
 
   // Options
@@ -120,6 +123,11 @@ ffi.cdef([[
     int max_computation_time_ms;
     bool compute_moves;
     bool extend_to_subwords;
+    int max_threads;
+    int64_t max_memory_bytes;
+    bool chunk_anchors;
+    bool strip_char_affixes;
+    bool line_level_only;
   } DiffOptions;
 
   // API functions
@@ -131,15 +139,104 @@ ffi.cdef([[
     const DiffOptions* options
   );
 
+  bool refine_lines_diff(
+    LinesDiff* diff,
+    const char** original_lines,
+    int original_count,
+    const char** modified_lines,
+    int modified_count,
+    const DiffOptions* options
+  );
+
   void free_lines_diff(LinesDiff* diff);
   const char* get_version(void);
+
+  // Render plan (render_plan.h)
+  typedef struct {
+    int kind;        // 0 = line hl, 1 = char hl, 2 = filler below, 3 = filler above
+    int side;        // 0 = original, 1 = modified
+    int start_line;  // 0-based
+    int start_col;   // 0-based byte column
+    int end_line;    // 0-based
+    int end_col;     // 0-based byte column, EXCLUSIVE
+    int count;       // filler line count
+  } RenderItem;
+
+  typedef struct {
+    RenderItem* items;
+    int count;
+    int capacity;
+    int original_filler_count;
+    int modified_filler_count;
+  } RenderPlan;
+
+  RenderPlan* compute_render_plan(
+    const LinesDiff* diff,
+    const char** original_lines,
+    int original_count,
+    const char** modified_lines,
+    int modified_count
+  );
+
+  void free_render_plan(RenderPlan* plan);
+
+  // Native git object store (git_object_store.h)
+  typedef struct GitObjectStore GitObjectStore;
+  GitObjectStore* git_store_open(const char* path);
+  void git_store_close(GitObjectStore* store);
+  int git_store_read_blob(GitObjectStore* store, const char* revision, const char* path, char** out_data, size_t* out_len);
+  void git_store_free_blob(char* data);
+
+  // Diff statistics (diff_stat.h)
+  typedef struct {
+    int insertions;
+    int deletions;
+    int edit_distance;
+    bool exceeded;
+  } DiffStat;
+
+  bool diff_stat(const char** lines_a, int len_a, const char** lines_b, int len_b, DiffStat* out);
+  bool diff_stat_bounded(
+    const char** lines_a,
+    int len_a,
+    const char** lines_b,
+    int len_b,
+    int max_edit_distance,
+    DiffStat* out
+  );
 ]])
 
+-- Older local builds may predate the render plan API
+local has_render_plan = pcall(function()
+  return lib.compute_render_plan
+end)
+
+-- ... or the git object store
+local has_git_store = pcall(function()
+  return lib.git_store_read_blob
+end)
+
+-- ... or diff statistics
+local has_diff_stat = pcall(function()
+  return lib.diff_stat
+end)
+
+-- ... or line-level-only results with deferred refinement
+local has_deferred_refine = pcall(function()
+  return lib.refine_lines_diff
+end)
+
 ---@class DiffOptions
 ---@field ignore_trim_whitespace boolean
 ---@field max_computation_time_ms integer
 ---@field compute_moves boolean
 ---@field extend_to_subwords boolean
+---@field max_threads? integer Threads for character-level refinement (0/nil = default, 1 = serial)
+---@field max_memory_bytes? integer Working memory per stage in bytes (0/nil = unlimited); see result.degradations
+---@field chunk_anchors? boolean Anchor identical line chunks before Myers (huge near-identical files; may differ from VSCode)
+---@field strip_char_affixes? boolean Refine only between the common prefix/suffix of each changed region (faster; may differ from VSCode)
+---@field line_level_only? boolean Stop after line alignment (whole-line inner changes, no moves); upgrade with refine_diff
+---@field render_plan? boolean Attach a native render plan (cdata) to the result for ui.core.render_diff
 
 -- Convert Lua string array to C string array
 local function lua_to_c_strings(lines)
@@ -224,11 +321,32 @@ local function lines_diff_to_lua(c_diff)
     changes = changes,
     moves = moves,
     hit_timeout = c_diff.hit_timeout,
+    degradations = c_diff.degradations,
+    is_binary = c_diff.is_binary,
   }
 end
 
+-- Convert Lua DiffOptions to the C struct
+local function options_to_c(options)
+  ---@type DiffOptions
+  ---@diagnostic disable-next-line: assign-type-mismatch
+  local c_options = ffi.new("DiffOptions")
+  c_options.ignore_trim_whitespace = options.ignore_trim_whitespace or false
+  c_options.max_computation_time_ms = options.max_computation_time_ms or 5000
+  c_options.compute_moves = options.compute_moves or false
+  c_options.extend_to_subwords = options.extend_to_subwords or false
+  c_options.max_threads = options.max_threads or 0
+  c_options.max_memory_bytes = options.max_memory_bytes or 0
+  c_options.chunk_anchors = options.chunk_anchors or false
+  c_options.strip_char_affixes = options.strip_char_affixes or false
+  c_options.line_level_only = (options.line_level_only and has_deferred_refine) or false
+  return c_options
+end
+
 -- Main API: Compute diff between two sets of lines
 -- Returns Lua table representation of LinesDiff
+-- With options.line_level_only, the result has line_level_only = true until
+-- M.refine_diff upgrades it
 function M.compute_diff(original_lines, modified_lines, options)
   options = options or {}
 
@@ -237,13 +355,7 @@ function M.compute_diff(original_lines, modified_lines, options)
   local c_mod, mod_count = lua_to_c_strings(modified_lines)
 
   -- Create options struct
-  ---@type DiffOptions
-  ---@diagnostic disable-next-line: assign-type-mismatch
-  local c_options = ffi.new("DiffOptions")
-  c_options.ignore_trim_whitespace = options.ignore_trim_whitespace or false
-  c_options.max_computation_time_ms = options.max_computation_time_ms or 5000
-  c_options.compute_moves = options.compute_moves or false
-  c_options.extend_to_subwords = options.extend_to_subwords or false
+  local c_options = options_to_c(options)
 
   -- Call C function
   local c_diff = lib.compute_diff(c_orig, orig_count, c_mod, mod_count, c_options)
@@ -255,12 +367,132 @@ function M.compute_diff(original_lines, modified_lines, options)
   -- Convert to Lua table
   local lua_diff = lines_diff_to_lua(c_diff)
 
+  -- Precompute extmark placement while the C result is still alive
+  if options.render_plan and has_render_plan then
+    local plan = lib.compute_render_plan(c_diff, c_orig, orig_count, c_mod, mod_count)
+    if plan ~= nil then
+      lua_diff.render_plan = ffi.gc(plan, lib.free_render_plan)
+    end
+  end
+
+  -- Keep the C result, which holds the line alignments, for M.refine_diff
+  if c_options.line_level_only and c_diff.deferred_alignments ~= nil then
+    lua_diff.line_level_only = true
+    lua_diff._deferred = { c_diff = ffi.gc(c_diff, lib.free_lines_diff), options = options }
+    return lua_diff
+  end
+
   -- Free C memory
   lib.free_lines_diff(c_diff)
 
   return lua_diff
 end
 
+-- Upgrade a line_level_only result of M.compute_diff to full detail, in place:
+-- inner changes, whitespace-only changes and moves are filled in, exactly as
+-- compute_diff without line_level_only would have returned them
+-- original_lines, modified_lines: the lines the diff was computed from
+-- Returns true when lua_diff is fully refined (immediately if it already was)
+function M.refine_diff(lua_diff, original_lines, modified_lines)
+  local deferred = lua_diff._deferred
+  if not deferred then
+    return true
+  end
+
+  local c_orig, orig_count = lua_to_c_strings(original_lines)
+  local c_mod, mod_count = lua_to_c_strings(modified_lines)
+  local c_options = options_to_c(deferred.options)
+  local c_diff = deferred.c_diff
+  if not lib.refine_lines_diff(c_diff, c_orig, orig_count, c_mod, mod_count, c_options) then
+    return false
+  end
+
+  local refined = lines_diff_to_lua(c_diff)
+  lua_diff.changes = refined.changes
+  lua_diff.moves = refined.moves
+  lua_diff.hit_timeout = refined.hit_timeout
+  lua_diff.degradations = refined.degradations
+  if deferred.options.render_plan and has_render_plan then
+    local plan = lib.compute_render_plan(c_diff, c_orig, orig_count, c_mod, mod_count)
+    lua_diff.render_plan = plan ~= nil and ffi.gc(plan, lib.free_render_plan) or nil
+  end
+  lua_diff.line_level_only = nil
+  lua_diff._deferred = nil
+
+  lib.free_lines_diff(ffi.gc(c_diff, nil))
+  return true
+end
+
+-- Count inserted/deleted lines of a minimal line diff without computing the diff
+-- max_edit_distance: optional; stop once insertions + deletions exceed it
+--   (result.exceeded is then true and the counts are lower bounds)
+-- Lines are compared exactly, like `git diff --numstat`
+-- Returns { insertions, deletions, edit_distance, exceeded }, or nil if the
+-- library predates diff_stat
+function M.diff_stat(original_lines, modified_lines, max_edit_distance)
+  if not has_diff_stat then
+    return nil
+  end
+
+  local c_orig, orig_count = lua_to_c_strings(original_lines)
+  local c_mod, mod_count = lua_to_c_strings(modified_lines)
+  local out = ffi.new("DiffStat")
+  local ok
+  if max_edit_distance then
+    ok = lib.diff_stat_bounded(c_orig, orig_count, c_mod, mod_count, max_edit_distance, out)
+  else
+    ok = lib.diff_stat(c_orig, orig_count, c_mod, mod_count, out)
+  end
+  if not ok then
+    return nil
+  end
+
+  return {
+    insertions = out.insertions,
+    deletions = out.deletions,
+    edit_distance = out.edit_distance,
+    exceeded = out.exceeded,
+  }
+end
+
+-- Open git object stores, one per repository root (false = not readable natively)
+local git_stores = {}
+
+local GIT_STORE_OK = 0
+local GIT_STORE_NOT_FOUND = 1
+
+-- Read `<revision>:<rel_path>` straight from the object database
+-- revision: full 40-hex commit, tag or tree id
+-- Returns "ok", content | "not_found" | nil when the caller should fall back to git
+function M.read_git_blob(git_root, revision, rel_path)
+  if not has_git_store then
+    return nil
+  end
+
+  local store = git_stores[git_root]
+  if store == nil then
+    local handle = lib.git_store_open(git_root)
+    store = handle ~= nil and ffi.gc(handle, lib.git_store_close) or false
+    git_stores[git_root] = store
+  end
+  if not store then
+    return nil
+  end
+
+  local out_data = ffi.new("char*[1]")
+  local out_len = ffi.new("size_t[1]")
+  local status = lib.git_store_read_blob(store, revision, rel_path, out_data, out_len)
+  if status == GIT_STORE_NOT_FOUND then
+    return "not_found"
+  elseif status ~= GIT_STORE_OK then
+    return nil
+  end
+
+  local content = ffi.string(out_data[0], out_len[0])
+  lib.git_store_free_blob(out_data[0])
+  return "ok", content
+end
+
 -- Get library version
 function M.get_version()
   return ffi.string(lib.get_version())
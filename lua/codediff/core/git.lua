@@ -257,6 +257,21 @@ function M.resolve_revision(revision, git_root, callback)
   end)
 end
 
+-- Native object store reader from the C library (nil = not available, use git)
+-- The library is only loaded from the main loop; in a fast event (luv callback)
+-- it is used only if something else already loaded it.
+local function read_blob_native(git_root, revision, rel_path)
+  local diff = package.loaded["codediff.core.diff"]
+  if not diff and not vim.in_fast_event() then
+    local ok, loaded = pcall(require, "codediff.core.diff")
+    diff = ok and loaded or nil
+  end
+  if not diff or not diff.read_git_blob then
+    return nil
+  end
+  return diff.read_git_blob(git_root, revision, rel_path)
+end
+
 -- Get file content from a specific git revision (async, atomic)
 -- revision: e.g., "HEAD", "HEAD~1", commit hash, branch name, tag
 -- git_root: absolute path to git repository root
@@ -275,6 +290,24 @@ function M.get_file_content(revision, git_root, rel_path, callback)
     end
   end
 
+  -- Full object ids can be read from the object database without a subprocess
+  if not is_mutable and revision:match("^%x+$") and #revision == 40 then
+    local status, content = read_blob_native(git_root, revision, rel_path)
+    if status == "not_found" then
+      callback(string.format("File '%s' not found in revision '%s'", rel_path, revision), nil)
+      return
+    elseif status == "ok" then
+      -- Same shape as `git show` through vim.system (text mode normalizes CRLF)
+      local lines = vim.split((content:gsub("\r\n", "\n")), "\n")
+      if lines[#lines] == "" then
+        table.remove(lines, #lines)
+      end
+      file_content_cache:put(revision, git_root, rel_path, lines)
+      callback(nil, lines)
+      return
+    end
+  end
+
   -- Cache miss or mutable revision - fetch from git
   local git_object = revision .. ":" .. rel_path
 
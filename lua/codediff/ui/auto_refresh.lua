@@ -91,6 +91,7 @@ local function do_diff_update(bufnr, skip_watcher_check)
       max_computation_time_ms = config.options.diff.max_computation_time_ms,
       ignore_trim_whitespace = config.options.diff.ignore_trim_whitespace,
       compute_moves = config.options.diff.compute_moves,
+      render_plan = true,
     }
     local lines_diff = diff.compute_diff(original_lines, modified_lines, diff_options)
     if not lines_diff then
@@ -305,6 +305,61 @@ local function calculate_fillers(mapping, original_lines, _modified_lines, last_
   return fillers, last_orig_line, last_mod_line
 end
 
+-- ============================================================================
+-- Step 4: Native Render Plan
+-- ============================================================================
+
+-- RenderItemKind / RenderSide from libvscode-diff/include/render_plan.h
+local RENDER_ITEM_LINE_HIGHLIGHT = 0
+local RENDER_ITEM_CHAR_HIGHLIGHT = 1
+local RENDER_ITEM_FILLER_ABOVE = 3
+
+-- Place extmarks from a render plan computed by the C library.
+-- All filler/column arithmetic is already done; only buffer bounds are checked here
+-- because the buffer may have changed since the diff was computed.
+local function render_from_plan(left_bufnr, right_bufnr, plan)
+  local bufs = { [0] = left_bufnr, [1] = right_bufnr }
+  local line_counts = {
+    [0] = vim.api.nvim_buf_line_count(left_bufnr),
+    [1] = vim.api.nvim_buf_line_count(right_bufnr),
+  }
+  local line_hl = { [0] = "CodeDiffLineDelete", [1] = "CodeDiffLineInsert" }
+  local char_hl = { [0] = "CodeDiffCharDelete", [1] = "CodeDiffCharInsert" }
+  local line_priority = config.options.diff.highlight_priority
+
+  for i = 0, plan.count - 1 do
+    local item = plan.items[i]
+    local side = item.side
+    local bufnr = bufs[side]
+    local kind = item.kind
+
+    if kind == RENDER_ITEM_LINE_HIGHLIGHT then
+      for line_idx = item.start_line, math.min(item.end_line, line_counts[side]) - 1 do
+        vim.api.nvim_buf_set_extmark(bufnr, ns_highlight, line_idx, 0, {
+          end_line = line_idx + 1,
+          end_col = 0,
+          hl_group = line_hl[side],
+          hl_eol = true,
+          priority = line_priority,
+        })
+      end
+    elseif kind == RENDER_ITEM_CHAR_HIGHLIGHT then
+      if item.start_line < line_counts[side] then
+        pcall(vim.api.nvim_buf_set_extmark, bufnr, ns_highlight, item.start_line, item.start_col, {
+          end_line = item.end_line,
+          end_col = item.end_col,
+          hl_group = char_hl[side],
+          priority = 200,
+        })
+      end
+    else
+      insert_filler_lines(bufnr, kind == RENDER_ITEM_FILLER_ABOVE and -1 or item.start_line, item.count)
+    end
+  end
+
+  return plan.original_filler_count, plan.modified_filler_count
+end
+
 -- ============================================================================
 -- Main Rendering Function
 -- ============================================================================
@@ -324,42 +379,48 @@ function M.render_diff(left_bufnr, right_bufnr, original_lines, modified_lines,
   local last_orig_line = 1
   local last_mod_line = 1
 
-  for _, mapping in ipairs(lines_diff.changes) do
-    local orig_is_empty = (mapping.original.end_line <= mapping.original.start_line)
-    local mod_is_empty = (mapping.modified.end_line <= mapping.modified.start_line)
+  -- Fast path: highlights and fillers precomputed by the C library
+  -- (diff.compute_diff with render_plan = true)
+  if lines_diff.render_plan then
+    total_left_fillers, total_right_fillers = render_from_plan(left_bufnr, right_bufnr, lines_diff.render_plan)
+  else
+    for _, mapping in ipairs(lines_diff.changes) do
+      local orig_is_empty = (mapping.original.end_line <= mapping.original.start_line)
+      local mod_is_empty = (mapping.modified.end_line <= mapping.modified.start_line)
 
-    if not orig_is_empty then
-      apply_line_highlights(left_bufnr, mapping.original, "CodeDiffLineDelete")
-    end
+      if not orig_is_empty then
+        apply_line_highlights(left_bufnr, mapping.original, "CodeDiffLineDelete")
+      end
 
-    if not mod_is_empty then
-      apply_line_highlights(right_bufnr, mapping.modified, "CodeDiffLineInsert")
-    end
+      if not mod_is_empty then
+        apply_line_highlights(right_bufnr, mapping.modified, "CodeDiffLineInsert")
+      end
 
-    if mapping.inner_changes then
-      for _, inner in ipairs(mapping.inner_changes) do
-        if not is_empty_range(inner.original) then
-          apply_char_highlight(left_bufnr, inner.original, "CodeDiffCharDelete", original_lines)
-        end
+      if mapping.inner_changes then
+        for _, inner in ipairs(mapping.inner_changes) do
+          if not is_empty_range(inner.original) then
+            apply_char_highlight(left_bufnr, inner.original, "CodeDiffCharDelete", original_lines)
+          end
 
-        if not is_empty_range(inner.modified) then
-          apply_char_highlight(right_bufnr, inner.modified, "CodeDiffCharInsert", modified_lines)
+          if not is_empty_range(inner.modified) then
+            apply_char_highlight(right_bufnr, inner.modified, "CodeDiffCharInsert", modified_lines)
+          end
         end
       end
-    end
 
-    local fillers, new_last_orig, new_last_mod = calculate_fillers(mapping, original_lines, modified_lines, last_orig_line, last_mod_line)
+      local fillers, new_last_orig, new_last_mod = calculate_fillers(mapping, original_lines, modified_lines, last_orig_line, last_mod_line)
 
-    last_orig_line = new_last_orig
-    last_mod_line = new_last_mod
+      last_orig_line = new_last_orig
+      last_mod_line = new_last_mod
 
-    for _, filler in ipairs(fillers) do
-      if filler.buffer == "original" then
-        insert_filler_lines(left_bufnr, filler.after_line - 1, filler.count)
-        total_left_fillers = total_left_fillers + filler.count
-      else
-        insert_filler_lines(right_bufnr, filler.after_line - 1, filler.count)
-        total_right_fillers = total_right_fillers + filler.count
+      for _, filler in ipairs(fillers) do
+        if filler.buffer == "original" then
+          insert_filler_lines(left_bufnr, filler.after_line - 1, filler.count)
+          total_left_fillers = total_left_fillers + filler.count
+        else
+          insert_filler_lines(right_bufnr, filler.after_line - 1, filler.count)
+          total_right_fillers = total_right_fillers + filler.count
+        end
       end
     end
   end
@@ -159,6 +159,7 @@ local function resume_diff(tabpage)
       max_computation_time_ms = config.options.diff.max_computation_time_ms,
       ignore_trim_whitespace = config.options.diff.ignore_trim_whitespace,
       compute_moves = config.options.diff.compute_moves,
+      render_plan = true,
     })
     diff_was_recomputed = true
 
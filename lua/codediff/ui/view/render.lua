@@ -74,6 +74,7 @@ function M.compute_and_render(
     max_computation_time_ms = config.options.diff.max_computation_time_ms,
     ignore_trim_whitespace = config.options.diff.ignore_trim_whitespace,
     compute_moves = config.options.diff.compute_moves,
+    render_plan = true,
   }
   local lines_diff = diff_module.compute_diff(original_lines, modified_lines, diff_options)
   if not lines_diff then
@@ -106,4 +106,30 @@ describe("FFI Integration", function()
     -- Note: original had print statement, keeping as comment for parity
     -- print("    (Version: " .. version .. ")")
   end)
+
+  -- Test 11: Diff statistics without a full diff
+  it("Can count changed lines with diff_stat", function()
+    local stat = diff.diff_stat({ "a", "b", "c" }, { "a", "x", "c", "d" })
+    assert.equal(2, stat.insertions, "Should count inserted lines")
+    assert.equal(1, stat.deletions, "Should count deleted lines")
+    assert.equal(3, stat.edit_distance, "Edit distance is the sum")
+    assert.is_false(stat.exceeded)
+
+    local bounded = diff.diff_stat({ "a", "b", "c" }, { "x", "y", "z" }, 2)
+    assert.is_true(bounded.exceeded, "Should stop once the limit is passed")
+  end)
+
+  -- Test 12: Line-level-only results upgrade in place
+  it("Refines a line_level_only diff in place", function()
+    local a = { "local x = 1", "local y = 2", "return x" }
+    local b = { "local x = 10", "  local y = 2", "return x" }
+    local full = diff.compute_diff(a, b)
+    local result = diff.compute_diff(a, b, { line_level_only = true })
+    assert.is_true(result.line_level_only, "Should be marked line-level only")
+
+    assert.is_true(diff.refine_diff(result, a, b))
+    assert.is_nil(result.line_level_only)
+    assert.same(full.changes, result.changes, "Upgraded changes should match a full diff")
+    assert.is_true(diff.refine_diff(result, a, b), "Refining twice is a no-op")
+  end)
 end)
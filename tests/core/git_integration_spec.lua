@@ -304,4 +304,28 @@ describe("Git Integration", function()
     vim.wait(3000, function() return test_passed end)
     assert.is_true(test_passed, "Test should complete")
   end)
+
+  -- Test 12: Native object store reader matches git show
+  it("Native blob reader matches git show", function()
+    local diff = require('codediff.core.diff')
+    local current_file = debug.getinfo(1).source:sub(2)
+    local git_root = vim.trim(vim.fn.system({ "git", "-C", vim.fn.fnamemodify(current_file, ":h"), "rev-parse", "--show-toplevel" }))
+    if vim.v.shell_error ~= 0 then
+      return
+    end
+    local commit_hash = vim.trim(vim.fn.system({ "git", "-C", git_root, "rev-parse", "HEAD" }))
+    local rel_path = git.get_relative_path(current_file, git_root)
+
+    local status, content = diff.read_git_blob(git_root, commit_hash, rel_path)
+    if status == nil then
+      -- Library without the object store, or an unsupported repository layout
+      return
+    end
+    assert.equal("ok", status, "File at HEAD should be found natively")
+    local expected = vim.fn.system({ "git", "-C", git_root, "show", commit_hash .. ":" .. rel_path })
+    assert.equal(expected, content, "Native blob should match git show byte for byte")
+
+    local missing = diff.read_git_blob(git_root, commit_hash, "this/file/does-not-exist.lua")
+    assert.equal("not_found", missing, "Missing path should be reported as not_found")
+  end)
 end)
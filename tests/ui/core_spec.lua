@@ -405,6 +405,46 @@ describe("Render Core", function()
     vim.api.nvim_buf_delete(right_buf, {force = true})
   end)
 
+  -- Test 15b: Native render plan places the same extmarks as the Lua path
+  it("Native render plan matches Lua rendering", function()
+    local original = {"keep", "delete this", "modify caf\195\169 me", "keep", "tail"}
+    local modified = {"keep", "modify caf\195\169 you", "add this", "also add", "keep", "tail"}
+
+    local function render(opts)
+      local left_buf = vim.api.nvim_create_buf(false, true)
+      local right_buf = vim.api.nvim_create_buf(false, true)
+      vim.api.nvim_buf_set_lines(left_buf, 0, -1, false, original)
+      vim.api.nvim_buf_set_lines(right_buf, 0, -1, false, modified)
+
+      local lines_diff = diff.compute_diff(original, modified, opts)
+      local result = core.render_diff(left_buf, right_buf, original, modified, lines_diff)
+      local marks = {
+        left = vim.api.nvim_buf_get_extmarks(left_buf, highlights.ns_highlight, 0, -1, { details = true }),
+        right = vim.api.nvim_buf_get_extmarks(right_buf, highlights.ns_highlight, 0, -1, { details = true }),
+        left_fillers = #vim.api.nvim_buf_get_extmarks(left_buf, highlights.ns_filler, 0, -1, {}),
+        right_fillers = #vim.api.nvim_buf_get_extmarks(right_buf, highlights.ns_filler, 0, -1, {}),
+      }
+
+      vim.api.nvim_buf_delete(left_buf, {force = true})
+      vim.api.nvim_buf_delete(right_buf, {force = true})
+      return result, marks
+    end
+
+    local lua_result, lua_marks = render({})
+    local plan_result, plan_marks = render({ render_plan = true })
+
+    assert.are.same(lua_result, plan_result)
+    assert.are.equal(lua_marks.left_fillers, plan_marks.left_fillers)
+    assert.are.equal(lua_marks.right_fillers, plan_marks.right_fillers)
+    assert.are.equal(#lua_marks.left, #plan_marks.left)
+    assert.are.equal(#lua_marks.right, #plan_marks.right)
+    for i, mark in ipairs(lua_marks.right) do
+      assert.are.equal(mark[2], plan_marks.right[i][2], "Extmark row should match")
+      assert.are.equal(mark[3], plan_marks.right[i][3], "Extmark col should match")
+      assert.are.equal(mark[4].end_col, plan_marks.right[i][4].end_col, "Extmark end_col should match")
+    end
+  end)
+
   -- Test 16: render_single_buffer with modified side
   it("render_single_buffer renders modified side with insert highlights", function()
     local buf = vim.api.nvim_create_buf(false, true)